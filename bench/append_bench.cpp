@@ -0,0 +1,95 @@
+// Appending LogEntry records to a file: one write per record (a fresh Writer, finish(),
+// then AppendFile::write_all) versus AppendWriter batches on the calling thread and on a
+// flushing thread, with and without group-committed syncs.
+//
+// Build (from the repository root):
+//   dezzy compile examples/binary_log.yaml -b cpp -o bench/
+//   g++ -std=c++20 -O2 -DNDEBUG -pthread -Ibench bench/append_bench.cpp -o append_bench
+//   ./append_bench [output path]
+
+#define DEZZY_APPEND_WRITER
+#include "binarylog.hpp"
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+using namespace binarylog;
+
+namespace {
+
+std::vector<LogEntry> make_entries(size_t count) {
+    std::vector<LogEntry> entries;
+    entries.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        LogEntry entry{};
+        entry.timestamp = 1700000000000000 + i * 3;
+        entry.level = static_cast<uint8_t>(i % 4);
+        const std::string text = "GET /api/items/" + std::to_string(i) + " 200 " + std::to_string(i % 997) + "us";
+        entry.message.assign(text.begin(), text.end());
+        entries.push_back(std::move(entry));
+    }
+    return entries;
+}
+
+template<typename F>
+void report(const char* label, size_t records, size_t bytes, F&& body) {
+    const auto start = std::chrono::steady_clock::now();
+    const size_t syncs = body();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::printf("  %-36s %10.0f records/s  %8.1f MB/s  %6zu syncs\n", label, records / elapsed.count(),
+                bytes / 1e6 / elapsed.count(), syncs);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* path = argc > 1 ? argv[1] : "append_bench.log";
+    const auto entries = make_entries(1000000);
+    size_t bytes = 0;
+    for (const auto& entry : entries) {
+        bytes += entry.serialized_size();
+    }
+    std::printf("%zu records, %zu bytes -> %s\n", entries.size(), bytes, path);
+
+    report("write per record", entries.size(), bytes, [&] {
+        std::remove(path);
+        AppendFile file(path);
+        for (const auto& entry : entries) {
+            Writer writer;
+            entry.write(writer);
+            file.write_all(writer.finish());
+        }
+        return size_t{0};
+    });
+
+    auto batched = [&](const char* label, AppendOptions options) {
+        report(label, entries.size(), bytes, [&] {
+            std::remove(path);
+            AppendWriter<LogEntry> log(path, options);
+            for (const auto& entry : entries) {
+                log.append(entry);
+            }
+            log.close();
+            return log.syncs();
+        });
+    };
+
+    AppendOptions options;
+    batched("AppendWriter", options);
+    options.background = true;
+    batched("AppendWriter, background", options);
+    options.sync_every = 8;
+    batched("  + sync every 8 batches", options);
+    options.sync_every = 1;
+    batched("  + sync every batch", options);
+    options = {};
+    options.buffer_size = 64u << 10;
+    options.sync_every = 1;
+    batched("64 KiB batches, sync every batch", options);
+    options.background = true;
+    options.buffers = 8;
+    batched("  background, 8 buffers", options);
+
+    std::remove(path);
+    return 0;
+}
@@ -0,0 +1,78 @@
+// Binary log parsing: synchronous read() versus coroutine read_async().
+//
+// Build (from the repository root):
+//   dezzy compile examples/binary_log.yaml -b cpp -o bench/
+//   g++ -std=c++20 -O2 -Ibench bench/async_bench.cpp -o async_bench
+
+#define DEZZY_ASYNC
+#include "binarylog.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+using namespace binarylog;
+
+namespace {
+
+std::vector<uint8_t> make_log(size_t entries) {
+    std::mt19937 rng(11);
+    LogFile file;
+    for (size_t i = 0; i < entries; ++i) {
+        LogEntry entry;
+        entry.timestamp = i;
+        entry.level = static_cast<uint8_t>(i % 4);
+        entry.message_length = static_cast<uint16_t>(16 + rng() % 112);
+        entry.message.assign(entry.message_length, 'x');
+        file.entries.push_back(entry);
+    }
+    Writer writer;
+    file.write(writer);
+    return writer.finish();
+}
+
+template<typename F>
+double ns_per_entry(int iterations, size_t entries, F&& body) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        body();
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / (static_cast<double>(iterations) * entries);
+}
+
+} // namespace
+
+int main() {
+    const size_t entries = 100000;
+    const auto log = make_log(entries);
+    const int iterations = 20;
+    size_t sink = 0;
+
+    const double sync = ns_per_entry(iterations, entries, [&] {
+        Reader reader(log);
+        sink += LogFile::read(reader).entries.size();
+    });
+
+    // Everything buffered: every require() completes without suspending
+    const double ready = ns_per_entry(iterations, entries, [&] {
+        EventLoop loop;
+        MemorySource source(loop, log);
+        AsyncReader in(source);
+        sink += loop.run(LogFile::read_async(in)).entries.size();
+    });
+
+    // 4 KiB arrivals: the parser suspends and resumes through the event loop
+    const double chunked = ns_per_entry(iterations, entries, [&] {
+        EventLoop loop;
+        MemorySource source(loop, log, 4096);
+        AsyncReader in(source);
+        sink += loop.run(LogFile::read_async(in)).entries.size();
+    });
+
+    std::printf("%zu entries, %zu bytes\n", entries, log.size());
+    std::printf("  %-28s %8.1f ns/entry\n", "read()", sync);
+    std::printf("  %-28s %8.1f ns/entry  (%.2fx)\n", "read_async(), buffered", ready, ready / sync);
+    std::printf("  %-28s %8.1f ns/entry  (%.2fx)\n", "read_async(), 4 KiB chunks", chunked, chunked / sync);
+
+    return sink == 0 ? 1 : 0;
+}
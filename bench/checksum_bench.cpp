@@ -0,0 +1,90 @@
+// Checksum verification overhead on the PNG chunk parser.
+//
+// Build (from the repository root):
+//   dezzy compile examples/png.yaml -b cpp -o bench/png.hpp
+//   g++ -std=c++20 -O2 -Ibench bench/checksum_bench.cpp -o checksum_bench
+//
+// Add -DDEZZY_VERIFY_CHECKSUMS=0 to compile verification out entirely.
+
+#include "png.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+using namespace png;
+
+namespace {
+
+std::vector<uint8_t> make_png(size_t chunk_count, size_t chunk_size) {
+    std::mt19937 rng(42);
+    PNG png;
+    png.signature = {137, 80, 78, 71, 13, 10, 26, 10};
+
+    for (size_t i = 0; i < chunk_count; ++i) {
+        Chunk idat;
+        idat.length = static_cast<uint32_t>(chunk_size);
+        idat.chunk_type = {73, 68, 65, 84};  // 'IDAT'
+        idat.data.resize(chunk_size);
+        for (auto& byte : idat.data) {
+            byte = static_cast<uint8_t>(rng());
+        }
+        idat.crc = 0;
+        png.chunks.push_back(std::move(idat));
+    }
+
+    Chunk iend;
+    iend.length = 0;
+    iend.chunk_type = {73, 69, 78, 68};  // 'IEND'
+    iend.crc = 0;
+    png.chunks.push_back(iend);
+
+    Writer writer;
+    png.write(writer);
+    return writer.finish();
+}
+
+template<typename F>
+double throughput_mb_s(size_t bytes, int iterations, F&& body) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        body();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(bytes) * iterations / elapsed.count() / 1e6;
+}
+
+} // namespace
+
+int main() {
+    const auto file = make_png(64, 256 * 1024);
+    const int iterations = 20;
+    std::printf("PNG stream: %zu bytes\n\n", file.size());
+
+    double raw = throughput_mb_s(file.size(), iterations, [&] {
+        volatile uint32_t sink = Crc32::compute(file);
+        (void)sink;
+    });
+    double adler = throughput_mb_s(file.size(), iterations, [&] {
+        volatile uint32_t sink = Adler32::compute(file);
+        (void)sink;
+    });
+
+    size_t chunks = 0;
+    double verified = throughput_mb_s(file.size(), iterations, [&] {
+        Reader reader(file);
+        chunks += PNG::read(reader).chunks.size();
+    });
+    double unverified = throughput_mb_s(file.size(), iterations, [&] {
+        Reader reader(file);
+        reader.set_verify_checksums(false);
+        chunks += PNG::read(reader).chunks.size();
+    });
+
+    std::printf("%-28s %10.1f MB/s\n", "Crc32::compute", raw);
+    std::printf("%-28s %10.1f MB/s\n", "Adler32::compute", adler);
+    std::printf("%-28s %10.1f MB/s\n", "PNG::read (verify on)", verified);
+    std::printf("%-28s %10.1f MB/s\n", "PNG::read (verify off)", unverified);
+    std::printf("\nverification overhead: %.1f%%\n", (unverified / verified - 1.0) * 100.0);
+
+    return chunks == 0 ? 1 : 0;
+}
@@ -0,0 +1,226 @@
+// Seeded corpus writers shared by corpus_gen.cpp and workload_bench.cpp. Each one builds
+// records with the generated T::random() or by hand, encodes them with write() and streams
+// them to disk in 4 MiB blocks. Each returns the number of records it wrote. The same seed
+// and arguments give the same file.
+//
+// Needs the headers for binary_log, png, test_bitfields, test_container and zip.
+
+#pragma once
+
+#define DEZZY_RANDOM
+#include "binarylog.hpp"
+#include "bitfieldtest.hpp"
+#include "png.hpp"
+#include "testcontainer.hpp"
+#include "zip.hpp"
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+namespace corpus {
+
+// Buffers encoded records and writes them out in large blocks
+class Output {
+public:
+    explicit Output(const char* path) : file_(std::fopen(path, "wb")) {
+        if (file_ == nullptr) {
+            throw std::runtime_error(std::string("cannot create ") + path);
+        }
+    }
+    ~Output() {
+        if (file_ != nullptr) {
+            std::fclose(file_);
+        }
+    }
+    Output(const Output&) = delete;
+    Output& operator=(const Output&) = delete;
+
+    // Writes the block once `writer` holds 4 MiB
+    template<typename Writer>
+    void add(Writer& writer) {
+        if (writer.position() >= (4u << 20)) {
+            flush(writer);
+        }
+    }
+
+    template<typename Writer>
+    void flush(Writer& writer) {
+        const auto bytes = writer.finish();
+        if (std::fwrite(bytes.data(), 1, bytes.size(), file_) != bytes.size()) {
+            throw std::runtime_error("write failed");
+        }
+        written_ += bytes.size();
+    }
+
+    uint64_t written() const { return written_; }
+
+private:
+    std::FILE* file_;
+    uint64_t written_ = 0;
+};
+
+// LogEntry records until the file reaches `target_bytes`; messages are log-normal
+// around `median` bytes
+inline uint64_t write_log(const char* path, uint64_t target_bytes, uint64_t seed, double median = 96) {
+    using namespace binarylog;
+    Rng rng(seed);
+    SizeProfile sizes;
+    sizes.elements = {median, 0.6, 1, 4096};
+
+    Output out(path);
+    Writer writer;
+    uint64_t records = 0;
+    while (out.written() + writer.position() < target_bytes) {
+        LogEntry::random(rng, sizes).write(writer);
+        ++records;
+        out.add(writer);
+    }
+    out.flush(writer);
+    return records;
+}
+
+// A Container of `entries` FileEntry records whose data is log-normal around `median` bytes
+inline uint64_t write_container(const char* path, uint64_t entries, uint64_t seed, double median = 16384) {
+    using namespace testcontainer;
+    if (entries > 0xFFFF) {
+        throw std::runtime_error("num_entries is a u16: at most 65535 entries");
+    }
+    Rng rng(seed);
+    SizeProfile sizes;
+    sizes.strings = {24, 0.4, 1, 255};
+    sizes.blobs = {median, 1.2, 0, size_t{1} << 26};
+
+    Output out(path);
+    Writer writer;
+    // Container::write() would need every entry in memory; its two header fields are
+    // written here and the entries streamed after them
+    writer.write_le(uint32_t{0x434E5452});
+    writer.write_le(static_cast<uint16_t>(entries));
+    for (uint64_t i = 0; i < entries; ++i) {
+        FileEntry::random(rng, sizes).write(writer);
+        out.add(writer);
+    }
+    out.flush(writer);
+    return entries;
+}
+
+// A stored (uncompressed) ZIP archive of `entries` files of about `median` bytes, with a
+// central directory whose offsets point at the local headers
+inline uint64_t write_zip(const char* path, uint64_t entries, uint64_t seed, double median = 1024) {
+    using namespace zip;
+    if (entries > 0xFFFF) {
+        throw std::runtime_error("the end-of-central-directory count is a u16: at most 65535 entries");
+    }
+    Rng rng(seed);
+    const LengthDistribution file_size{median, 1.0, 0, size_t{1} << 24};
+
+    std::vector<CentralDirectoryHeader> directory;
+    directory.reserve(entries);
+    Output out(path);
+    Writer writer;
+    for (uint64_t i = 0; i < entries; ++i) {
+        const std::string name = "dir_" + std::to_string(i % 97) + "/file_" + std::to_string(i) + ".bin";
+        std::vector<uint8_t> data(file_size.draw(rng));
+        rng.fill(data.data(), data.size());
+
+        CentralDirectoryHeader entry{};
+        entry.signature = 0x02014b50;
+        entry.version_made_by = 20;
+        entry.version_needed = 20;
+        entry.last_mod_time = static_cast<uint16_t>(rng.next());
+        entry.last_mod_date = static_cast<uint16_t>(rng.next());
+        entry.crc32 = static_cast<uint32_t>(rng.next());
+        entry.compressed_size = static_cast<uint32_t>(data.size());
+        entry.uncompressed_size = entry.compressed_size;
+        entry.filename.assign(name.begin(), name.end());
+        entry.local_header_offset = static_cast<uint32_t>(out.written() + writer.position());
+
+        LocalFileHeader local{};
+        local.signature = 0x04034b50;
+        local.version_needed = entry.version_needed;
+        local.last_mod_time = entry.last_mod_time;
+        local.last_mod_date = entry.last_mod_date;
+        local.crc32 = entry.crc32;
+        local.compressed_size = entry.compressed_size;
+        local.uncompressed_size = entry.uncompressed_size;
+        local.filename = entry.filename;
+        local.write(writer);
+        writer.write_bytes(data);
+        directory.push_back(std::move(entry));
+        out.add(writer);
+    }
+
+    EndOfCentralDirectory eocd{};
+    eocd.signature = 0x06054b50;
+    eocd.num_entries_this_disk = static_cast<uint16_t>(entries);
+    eocd.num_entries_total = static_cast<uint16_t>(entries);
+    eocd.cd_offset = static_cast<uint32_t>(out.written() + writer.position());
+    for (const auto& entry : directory) {
+        entry.write(writer);
+        out.add(writer);
+    }
+    eocd.cd_size = static_cast<uint32_t>(out.written() + writer.position() - eocd.cd_offset);
+    eocd.write(writer);
+    out.flush(writer);
+    if (out.written() > 0xFFFFFFFF) {
+        throw std::runtime_error("archive passes 4 GiB, which needs ZIP64");
+    }
+    return entries;
+}
+
+// A PNG of a `width` x `height` RGBA image whose compressed data is split into `idat_chunks`
+// IDAT chunks of 8 KiB, between IHDR and IEND
+inline uint64_t write_png(const char* path, uint64_t idat_chunks, uint64_t seed) {
+    using namespace png;
+    Rng rng(seed);
+    const uint32_t width = 4096;
+    const uint32_t height = static_cast<uint32_t>(std::max<uint64_t>(1, idat_chunks * 8192 / (width * 4)));
+
+    Output out(path);
+    Writer writer;
+    writer.write_bytes(std::span<const uint8_t>(PNG::magic_bytes));
+
+    Chunk header{};
+    header.chunk_type = {{'I', 'H', 'D', 'R'}};
+    {
+        Writer fields;
+        fields.write_be(width);
+        fields.write_be(height);
+        for (uint8_t byte : {8, 6, 0, 0, 0}) {  // 8-bit RGBA, deflate, no interlace
+            fields.write_be(byte);
+        }
+        header.data = fields.finish();
+    }
+    header.write(writer);
+
+    Chunk idat{};
+    idat.chunk_type = {{'I', 'D', 'A', 'T'}};
+    idat.data.resize(8192);
+    for (uint64_t i = 0; i < idat_chunks; ++i) {
+        rng.fill(idat.data.data(), idat.data.size());
+        idat.write(writer);
+        out.add(writer);
+    }
+
+    Chunk end{};
+    end.chunk_type = {{'I', 'E', 'N', 'D'}};
+    end.write(writer);
+    out.flush(writer);
+    return idat_chunks + 2;
+}
+
+// `records` back-to-back bit-packed Flags headers
+inline uint64_t write_bitfields(const char* path, uint64_t records, uint64_t seed) {
+    using namespace bitfieldtest;
+    Rng rng(seed);
+    Output out(path);
+    Writer writer;
+    for (uint64_t i = 0; i < records; ++i) {
+        Flags::random(rng).write(writer);
+        out.add(writer);
+    }
+    out.flush(writer);
+    return records;
+}
+
+} // namespace corpus
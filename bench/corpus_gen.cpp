@@ -0,0 +1,86 @@
+// Writes large, valid corpora from a seed (see corpus.hpp): a binary log up to a byte size,
+// or a Container, ZIP archive, PNG or bitfield stream with a given number of records.
+// Records are streamed to disk, so a multi-GB corpus needs a few MB of memory. The same
+// seed and options give the same file.
+//
+// Build with bench/CMakeLists.txt, or by hand (from the repository root):
+//   for f in binary_log png test_bitfields test_container zip; do
+//       dezzy compile examples/$f.yaml -b cpp -o bench/
+//   done
+//   g++ -std=c++20 -O2 -DNDEBUG -Ibench bench/corpus_gen.cpp -o corpus_gen
+//
+// Run:
+//   ./corpus_gen log corpus.log 1G [--seed N] [--median BYTES]
+//   ./corpus_gen container corpus.bin 65535 [--seed N] [--median BYTES]
+//   ./corpus_gen zip corpus.zip 65535 [--seed N] [--median BYTES]
+//   ./corpus_gen png corpus.png 32K [--seed N]
+//   ./corpus_gen bitfields corpus.bits 64M [--seed N]
+// --median is the median message length (log) or file size (container, zip); both are
+// log-normal. For png the count is the number of 8 KiB IDAT chunks.
+
+#include "corpus.hpp"
+#include <cstdlib>
+
+namespace {
+
+// 1024, 64K, 512M, 2G
+uint64_t parse_size(const char* text) {
+    char* end = nullptr;
+    uint64_t value = std::strtoull(text, &end, 10);
+    switch (*end) {
+        case 'G': case 'g': value <<= 10; [[fallthrough]];
+        case 'M': case 'm': value <<= 10; [[fallthrough]];
+        case 'K': case 'k': value <<= 10; break;
+        default: break;
+    }
+    return value;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        std::fprintf(stderr, "usage: %s log|container|zip|png|bitfields PATH SIZE|COUNT [--seed N] [--median BYTES]\n",
+                     argv[0]);
+        return 2;
+    }
+    const std::string kind = argv[1];
+    const char* path = argv[2];
+    const uint64_t amount = parse_size(argv[3]);
+    uint64_t seed = 1;
+    double median = 0;
+    for (int i = 4; i + 1 < argc; i += 2) {
+        const std::string flag = argv[i];
+        if (flag == "--seed") {
+            seed = std::strtoull(argv[i + 1], nullptr, 10);
+        } else if (flag == "--median") {
+            median = static_cast<double>(parse_size(argv[i + 1]));
+        } else {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    try {
+        uint64_t records = 0;
+        if (kind == "log") {
+            records = corpus::write_log(path, amount, seed, median > 0 ? median : 96);
+        } else if (kind == "container") {
+            records = corpus::write_container(path, amount, seed, median > 0 ? median : 16384);
+        } else if (kind == "zip") {
+            records = corpus::write_zip(path, amount, seed, median > 0 ? median : 1024);
+        } else if (kind == "png") {
+            records = corpus::write_png(path, amount, seed);
+        } else if (kind == "bitfields") {
+            records = corpus::write_bitfields(path, amount, seed);
+        } else {
+            std::fprintf(stderr, "unknown corpus kind %s\n", argv[1]);
+            return 2;
+        }
+        std::printf("%s: %llu records\n", path, static_cast<unsigned long long>(records));
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,251 @@
+// read() with CheckedCursor (Reader) versus TrustedCursor (TrustedReader) on every example
+// format. Each format is one record repeated to about 1 MiB and read back to the end.
+// conditional.yaml is left out (its header does not compile) and so is circular.yaml
+// (rejected by design).
+//
+// Build (from the repository root):
+//   formats="binary_log conditional_simple container nested png png_chunk png_file png_ihdr
+//            png_simple simple test_assert test_bitfields test_container test_enum
+//            test_packed_format test_strings zip"
+//   for f in $formats; do dezzy compile examples/$f.yaml -b cpp -o bench/; done
+//   g++ -std=c++20 -O2 -DNDEBUG -Ibench bench/cursor_bench.cpp -o cursor_bench
+
+#include "binarylog.hpp"
+#include "bitfieldtest.hpp"
+#include "container.hpp"
+#include "nestedformat.hpp"
+#include "packedformat.hpp"
+#include "png.hpp"
+#include "pngchunk.hpp"
+#include "pngfile.hpp"
+#include "pngheader.hpp"
+#include "pngsimple.hpp"
+#include "simpleconditional.hpp"
+#include "simpleformat.hpp"
+#include "testassert.hpp"
+#include "testcontainer.hpp"
+#include "testenum.hpp"
+#include "teststrings.hpp"
+#include "zip.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+namespace {
+
+template<typename Writer, typename T>
+std::vector<uint8_t> encode(const T& value) {
+    Writer writer;
+    value.write(writer);
+    return writer.finish();
+}
+
+std::vector<uint8_t> repeat(const std::vector<uint8_t>& record, size_t target = 1u << 20) {
+    std::vector<uint8_t> bytes;
+    while (bytes.size() < target) {
+        bytes.insert(bytes.end(), record.begin(), record.end());
+    }
+    return bytes;
+}
+
+template<typename T, typename R>
+double ns_per_record(const std::vector<uint8_t>& bytes) {
+    const int iterations = 10;
+    size_t records = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        R reader(bytes);
+        records = 0;
+        while (reader.remaining() > 0) {
+            T::read(reader);
+            ++records;
+        }
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / (static_cast<double>(iterations) * records);
+}
+
+// T is read with both cursors of the namespace it lives in; best of alternating rounds
+template<typename T, typename Checked, typename Trusted>
+void compare(const char* name, const std::vector<uint8_t>& record) {
+    const auto bytes = repeat(record);
+    double checked = 1e300;
+    double trusted = 1e300;
+    for (int round = 0; round < 7; ++round) {
+        checked = std::min(checked, ns_per_record<T, Checked>(bytes));
+        trusted = std::min(trusted, ns_per_record<T, Trusted>(bytes));
+    }
+    std::printf("  %-36s %5zu B %9.1f %9.1f  %5.2fx\n", name, record.size(), checked, trusted, checked / trusted);
+}
+
+std::vector<uint8_t> pattern(size_t size) {
+    std::vector<uint8_t> bytes(size);
+    for (size_t i = 0; i < size; ++i) {
+        bytes[i] = static_cast<uint8_t>(i * 31 + 7);
+    }
+    return bytes;
+}
+
+} // namespace
+
+int main() {
+    std::printf("  %-36s %7s %9s %9s  %6s\n", "format", "record", "checked", "trusted", "speedup");
+    std::printf("  %-36s %7s %9s %9s\n", "", "", "ns/rec", "ns/rec");
+
+    {
+        binarylog::LogEntry entry;
+        entry.timestamp = 1700000000000000ull;
+        entry.level = 2;
+        entry.message = pattern(48);
+        entry.message_length = 48;
+        compare<binarylog::LogEntry, binarylog::Reader, binarylog::TrustedReader>(
+            "binary_log LogEntry", encode<binarylog::Writer>(entry));
+    }
+    {
+        bitfieldtest::Flags flags{};
+        flags.version = 5;
+        flags.compressed = 1;
+        flags.value = 0xDEADBEEF;
+        compare<bitfieldtest::Flags, bitfieldtest::Reader, bitfieldtest::TrustedReader>(
+            "test_bitfields Flags", encode<bitfieldtest::Writer>(flags));
+    }
+    {
+        container::Chunk chunk;
+        chunk.length = 64;
+        chunk.chunk_type = {68, 65, 84, 65};
+        chunk.data = pattern(64);
+        chunk.crc = 0;
+        compare<container::Chunk, container::Reader, container::TrustedReader>(
+            "container Chunk", encode<container::Writer>(chunk));
+    }
+    {
+        nestedformat::Document document{};
+        document.version = 1;
+        document.count = 2;
+        document.bounds.bottom_right = {640, 480};
+        compare<nestedformat::Document, nestedformat::Reader, nestedformat::TrustedReader>(
+            "nested Document", encode<nestedformat::Writer>(document));
+    }
+    {
+        packedformat::PackedHeader header{};
+        header.magic = 0x50414B44;
+        header.version = 3;
+        header.data_size = 4096;
+        header.data_offset = 64;
+        header.status = -2;
+        compare<packedformat::PackedHeader, packedformat::Reader, packedformat::TrustedReader>(
+            "test_packed_format PackedHeader", encode<packedformat::Writer>(header));
+    }
+    {
+        png::Chunk chunk;
+        chunk.length = 64;
+        chunk.chunk_type = {73, 68, 65, 84};
+        chunk.data = pattern(64);
+        chunk.crc = 0;
+        compare<png::Chunk, png::Reader, png::TrustedReader>("png Chunk (CRC verified)", encode<png::Writer>(chunk));
+    }
+    {
+        pngchunk::Chunk chunk;
+        chunk.length = 64;
+        chunk.chunk_type = {73, 68, 65, 84};
+        chunk.data = pattern(64);
+        chunk.crc = 0;
+        compare<pngchunk::Chunk, pngchunk::Reader, pngchunk::TrustedReader>(
+            "png_chunk Chunk", encode<pngchunk::Writer>(chunk));
+    }
+    {
+        pngfile::PNGFile file;
+        file.signature = {137, 80, 78, 71, 13, 10, 26, 10};
+        for (int i = 0; i < 4; ++i) {
+            pngfile::Chunk chunk;
+            chunk.length = 32;
+            chunk.chunk_type = {73, 68, 65, 84};
+            chunk.data = pattern(32);
+            chunk.crc = 0;
+            file.chunks.push_back(chunk);
+        }
+        file.num_chunks = 4;
+        compare<pngfile::PNGFile, pngfile::Reader, pngfile::TrustedReader>(
+            "png_file PNGFile", encode<pngfile::Writer>(file));
+    }
+    {
+        pngheader::IHDRChunk ihdr{};
+        ihdr.width = 1920;
+        ihdr.height = 1080;
+        ihdr.bit_depth = 8;
+        ihdr.color_type = pngheader::ColorType::RGBA;
+        compare<pngheader::IHDRChunk, pngheader::Reader, pngheader::TrustedReader>(
+            "png_ihdr IHDRChunk", encode<pngheader::Writer>(ihdr));
+    }
+    {
+        pngsimple::PNGFile file;
+        file.signature = {137, 80, 78, 71, 13, 10, 26, 10};
+        file.ihdr_chunk.length = 13;
+        file.ihdr_chunk.chunk_type = {73, 72, 68, 82};
+        file.ihdr_chunk.data = pattern(13);
+        file.ihdr_chunk.crc = 0;
+        compare<pngsimple::PNGFile, pngsimple::Reader, pngsimple::TrustedReader>(
+            "png_simple PNGFile", encode<pngsimple::Writer>(file));
+    }
+    {
+        // version 2 (u64 payload), flags 1 (u16 extra_info)
+        const std::vector<uint8_t> message = {2, 42, 0, 0, 0, 0, 0, 0, 0, 1, 7, 0};
+        compare<simpleconditional::VersionedMessage, simpleconditional::Reader, simpleconditional::TrustedReader>(
+            "conditional_simple VersionedMessage", message);
+    }
+    {
+        simpleformat::DataBlock block{};
+        block.length = 16;
+        block.checksum = 0x12345678;
+        compare<simpleformat::DataBlock, simpleformat::Reader, simpleformat::TrustedReader>(
+            "simple DataBlock", encode<simpleformat::Writer>(block));
+    }
+    {
+        testassert::Header header;
+        header.magic = {0x89, 0x50, 0x4E, 0x47};
+        header.version = 1;
+        header.width = 800;
+        header.height = 600;
+        header.flags = 3;
+        compare<testassert::Header, testassert::Reader, testassert::TrustedReader>(
+            "test_assert Header", encode<testassert::Writer>(header));
+    }
+    {
+        testcontainer::FileEntry entry;
+        entry.filename = "readme.txt";
+        entry.filename_len = static_cast<uint8_t>(entry.filename.size());
+        entry.file_data = pattern(100);
+        entry.file_size = 100;
+        entry.padding_size = 0;
+        compare<testcontainer::FileEntry, testcontainer::Reader, testcontainer::TrustedReader>(
+            "test_container FileEntry", encode<testcontainer::Writer>(entry));
+    }
+    {
+        testenum::Message message;
+        message.status = testenum::Status::PENDING;
+        message.value = 99;
+        compare<testenum::Message, testenum::Reader, testenum::TrustedReader>(
+            "test_enum Message", encode<testenum::Writer>(message));
+    }
+    {
+        teststrings::FileHeader header;
+        header.signature = "TSTR";
+        header.filename = "data.bin";
+        header.name_len = static_cast<uint8_t>(header.filename.size());
+        header.path = "/var/lib/data";
+        compare<teststrings::FileHeader, teststrings::Reader, teststrings::TrustedReader>(
+            "test_strings FileHeader", encode<teststrings::Writer>(header));
+    }
+    {
+        zip::CentralDirectoryHeader header{};
+        header.signature = 0x02014b50;
+        header.compressed_size = 1000;
+        header.uncompressed_size = 4000;
+        header.filename = pattern(24);
+        header.filename_length = 24;
+        compare<zip::CentralDirectoryHeader, zip::Reader, zip::TrustedReader>(
+            "zip CentralDirectoryHeader", encode<zip::Writer>(header));
+    }
+
+    return 0;
+}
@@ -0,0 +1,84 @@
+// Encoding a container of 60k variable-size entries (num_entries is a u16): write() on one
+// thread versus write_parallel() at 1-32 threads, into a growing Writer and into memory
+// sized up front with serialized_size(). The sizing pass runs on one thread and is timed
+// alone, since it bounds the speedup. On a machine with fewer cores than threads the rows
+// show the cost of oversubscription instead of scaling.
+//
+// Build (from the repository root):
+//   dezzy compile examples/test_container.yaml -b cpp -o bench/
+//   g++ -std=c++20 -O2 -DNDEBUG -pthread -Ibench bench/parallel_write_bench.cpp -o parallel_write_bench
+
+#define DEZZY_PARALLEL_WRITE
+#include "testcontainer.hpp"
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+using namespace testcontainer;
+
+namespace {
+
+Container make_container(size_t entries) {
+    Container container;
+    container.magic = 0x434E5452;
+    container.entries.reserve(entries);
+    for (size_t i = 0; i < entries; ++i) {
+        FileEntry entry;
+        entry.filename = "dir/file_" + std::to_string(i) + ".bin";
+        entry.file_data.assign(400 + (i * 7919) % 2400, static_cast<uint8_t>(i));
+        entry.padding_size = 0;
+        container.entries.push_back(std::move(entry));
+    }
+    return container;
+}
+
+template<typename F>
+double ms_per_run(int iterations, F&& body) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        body();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+} // namespace
+
+int main() {
+    const size_t entries = 60000;
+    const Container container = make_container(entries);
+    const size_t bytes = container.serialized_size();
+    const int iterations = 10;
+    size_t sink = 0;
+
+    auto mb_per_s = [&](double ms) { return static_cast<double>(bytes) / 1e3 / ms; };
+
+    const double sizing = ms_per_run(iterations, [&] { sink += container.serialized_size(); });
+    const double serial = ms_per_run(iterations, [&] {
+        Writer writer;
+        container.write(writer);
+        sink += writer.finish().size();
+    });
+
+    std::printf("%zu entries, %zu bytes, %u hardware threads\n", entries, bytes, std::thread::hardware_concurrency());
+    std::printf("  %-24s %8.2f ms\n", "serialized_size()", sizing);
+    std::printf("  %-24s %8.2f ms  %8.0f MB/s\n", "write()", serial, mb_per_s(serial));
+
+    std::vector<uint8_t> target(bytes);
+    for (size_t threads : {1, 2, 4, 8, 16, 32}) {
+        const double grown = ms_per_run(iterations, [&] {
+            Writer writer;
+            container.write_parallel(writer, threads);
+            sink += writer.finish().size();
+        });
+        const double presized = ms_per_run(iterations, [&] {
+            Writer writer(target);
+            container.write_parallel(writer, threads);
+            sink += writer.position();
+        });
+        std::printf("  write_parallel, %2zu thr   %8.2f ms  %8.0f MB/s  (%.2fx)   presized %8.2f ms  (%.2fx)\n",
+                    threads, grown, mb_per_s(grown), serial / grown, presized, serial / presized);
+    }
+
+    return sink == 0 ? 1 : 0;
+}
@@ -0,0 +1,90 @@
+// Rewriting a ZIP central directory after editing one entry: full re-encode versus
+// DEZZY_PASSTHROUGH, which copies every unedited header's source bytes. A plain memcpy of
+// the whole directory is the lower bound.
+//
+// Build (from the repository root):
+//   dezzy compile examples/zip.yaml -b cpp -o bench/
+//   g++ -std=c++20 -O2 -DNDEBUG -Ibench bench/passthrough_bench.cpp -o passthrough_bench
+
+#define DEZZY_PASSTHROUGH
+#include "zip.hpp"
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+using namespace zip;
+
+namespace {
+
+std::vector<uint8_t> make_directory(size_t entries) {
+    Writer writer;
+    for (size_t i = 0; i < entries; ++i) {
+        CentralDirectoryHeader header{};
+        header.signature = 0x02014b50;
+        header.compressed_size = static_cast<uint32_t>(1000 + i);
+        header.uncompressed_size = static_cast<uint32_t>(4000 + i);
+        header.local_header_offset = static_cast<uint32_t>(i * 64);
+        const std::string name = "dir/file_" + std::to_string(i) + ".txt";
+        header.filename.assign(name.begin(), name.end());
+        header.write(writer);
+    }
+    return writer.finish();
+}
+
+std::vector<Passthrough<CentralDirectoryHeader>> parse(const std::vector<uint8_t>& bytes) {
+    std::vector<Passthrough<CentralDirectoryHeader>> headers;
+    Reader reader(bytes);
+    while (reader.remaining() > 0) {
+        headers.push_back(Passthrough<CentralDirectoryHeader>::read(reader));
+    }
+    return headers;
+}
+
+template<typename F>
+double ns_per_entry(int iterations, size_t entries, F&& body) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        body();
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / (static_cast<double>(iterations) * entries);
+}
+
+} // namespace
+
+int main() {
+    const size_t entries = 200000;
+    const auto directory = make_directory(entries);
+    const int iterations = 20;
+    size_t sink = 0;
+
+    auto edited = parse(directory);
+    edited[entries / 2].edit().compressed_size = 12345;
+    auto reencoded = parse(directory);
+    for (auto& header : reencoded) {
+        header.edit();
+    }
+    reencoded[entries / 2].edit().compressed_size = 12345;
+
+    auto rewrite = [&](const std::vector<Passthrough<CentralDirectoryHeader>>& headers) {
+        Writer writer;
+        for (const auto& header : headers) {
+            header.write(writer);
+        }
+        sink += writer.finish().size();
+    };
+    const double full = ns_per_entry(iterations, entries, [&] { rewrite(reencoded); });
+    const double passthrough = ns_per_entry(iterations, entries, [&] { rewrite(edited); });
+    const double copy = ns_per_entry(iterations, entries, [&] {
+        Writer writer;
+        writer.write_bytes(directory);
+        sink += writer.finish().size();
+    });
+
+    std::printf("%zu entries, %zu bytes, one edited\n", entries, directory.size());
+    std::printf("  %-28s %8.1f ns/entry\n", "re-encode every header", full);
+    std::printf("  %-28s %8.1f ns/entry  (%.2fx)\n", "passthrough", passthrough, full / passthrough);
+    std::printf("  %-28s %8.1f ns/entry  (%.2fx)\n", "memcpy of the directory", copy, full / copy);
+
+    return sink == 0 ? 1 : 0;
+}
@@ -0,0 +1,294 @@
+// End-to-end workloads over seeded corpora on disk. These are the access patterns of the
+// example programs:
+//   zip        find the EOCD, walk the central directory, check each local header against
+//              its entry and checksum the stored data (test_zip.cpp)
+//   png        parse a PNG with many IDAT chunks (CRCs verified), read IHDR and gather the
+//              IDAT data a decoder would inflate (test_real_png.cpp)
+//   log        read a binary log entry by entry and tally levels and message bytes
+//   container  parse a Container and checksum every file it holds (test_container_runner.cpp)
+//   bitfields  decode a stream of bit-packed Flags headers (test_bitfields_runner.cpp)
+// Each repetition reads the file into memory ("open"), then parses and walks it
+// ("process"). The record count is checked against what the generator wrote. Corpora are
+// written to --dir on first use and reused after that, so the page cache is warm for every
+// timed run.
+//
+// Scales:
+//   small  zip 1k entries, png 1k IDAT chunks (8 MiB), log 64 MiB, container 1k entries,
+//          bitfields 1M records
+//   full   zip 65535 entries (the EOCD count is a u16), png 32k IDAT chunks (256 MiB),
+//          log 1 GiB, container 65535 entries (about 550 MB), bitfields 64M records
+//
+// Build with bench/CMakeLists.txt, or by hand like corpus_gen.cpp.
+// Run:  ./workload_bench [--scale small|full] [--dir DIR] [--seed N] [--reps N] [--filter NAME] [--json PATH]
+
+#include "corpus.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+
+namespace {
+
+struct Options {
+    bool full = false;
+    std::filesystem::path dir = "workload-corpus";
+    uint64_t seed = 1;
+    size_t reps = 5;
+    const char* filter = nullptr;
+    const char* json = nullptr;
+};
+
+struct Workload {
+    std::string name;
+    uint64_t amount;  // bytes for the log, records for everything else
+    uint64_t (*generate)(const char* path, uint64_t amount, uint64_t seed);
+    uint64_t (*process)(std::span<const uint8_t> bytes);  // returns the records visited
+};
+
+struct Result {
+    std::string name;
+    size_t bytes;
+    uint64_t records;
+    double open_ms;
+    double process_ms;
+    double total_ms;
+};
+
+// Keeps the optimizer from discarding what a workload computes
+volatile uint64_t sink = 0;
+
+uint64_t checksum(std::span<const uint8_t> data) {
+    return std::accumulate(data.begin(), data.end(), uint64_t{0});
+}
+
+uint64_t walk_zip(std::span<const uint8_t> bytes) {
+    using namespace zip;
+    const auto eocd_offset = EndOfCentralDirectory::find_last(bytes, 22 + 65535);
+    if (!eocd_offset) {
+        throw std::runtime_error("EOCD signature not found");
+    }
+    Reader reader = Reader(bytes).at(*eocd_offset);
+    const auto eocd = EndOfCentralDirectory::read(reader);
+    uint64_t sum = 0;
+    for (const auto& entry : eocd.central_directory()) {
+        const LocalFileHeader& local = entry.local_header();
+        if (local.crc32 != entry.crc32 || local.filename != entry.filename) {
+            throw std::runtime_error("local header does not match its central directory entry");
+        }
+        // Stored entries: the data follows the local header
+        const size_t start = entry.local_header_offset + 30 + local.filename.size() + local.extra_field.size();
+        sum += checksum(bytes.subspan(start, entry.compressed_size));
+    }
+    sink = sum;
+    return eocd.central_directory().size();
+}
+
+uint64_t walk_png(std::span<const uint8_t> bytes) {
+    using namespace png;
+    Reader reader(bytes);
+    const PNG image = PNG::read(reader);
+    if (image.signature != PNG::magic_bytes || image.chunks.empty() || image.chunks.front().data.size() != 13) {
+        throw std::runtime_error("not a PNG with an IHDR chunk");
+    }
+    const auto& ihdr = image.chunks.front().data;
+    const uint32_t width = (uint32_t{ihdr[0]} << 24) | (uint32_t{ihdr[1]} << 16) | (uint32_t{ihdr[2]} << 8) | ihdr[3];
+    std::vector<uint8_t> compressed;
+    for (const auto& chunk : image.chunks) {
+        if (chunk.chunk_type == std::array<uint8_t, 4>{{'I', 'D', 'A', 'T'}}) {
+            compressed.insert(compressed.end(), chunk.data.begin(), chunk.data.end());
+        }
+    }
+    sink = width + compressed.size();
+    return image.chunks.size();
+}
+
+uint64_t walk_log(std::span<const uint8_t> bytes) {
+    using namespace binarylog;
+    // Entry by entry, as a log processor would; LogFile::read() would hold all of them
+    Reader reader(bytes);
+    uint64_t by_level[4] = {};
+    uint64_t message_bytes = 0;
+    uint64_t records = 0;
+    while (reader.remaining() > 0) {
+        const LogEntry entry = LogEntry::read(reader);
+        ++by_level[entry.level & 3];
+        message_bytes += entry.message.size();
+        ++records;
+    }
+    sink = by_level[0] + by_level[3] + message_bytes;
+    return records;
+}
+
+uint64_t walk_container(std::span<const uint8_t> bytes) {
+    using namespace testcontainer;
+    Reader reader(bytes);
+    const Container container = Container::read(reader);
+    uint64_t sum = 0;
+    for (const auto& entry : container.entries) {
+        if (entry.filename.empty()) {
+            throw std::runtime_error("file entry without a name");
+        }
+        sum += checksum(entry.file_data);
+    }
+    sink = sum;
+    return container.entries.size();
+}
+
+uint64_t walk_bitfields(std::span<const uint8_t> bytes) {
+    using namespace bitfieldtest;
+    Reader reader(bytes);
+    uint64_t by_version[8] = {};
+    uint64_t compressed = 0;
+    uint64_t records = 0;
+    while (reader.remaining() > 0) {
+        const Flags flags = Flags::read(reader);
+        ++by_version[flags.version & 7];
+        compressed += flags.compressed;
+        ++records;
+    }
+    sink = by_version[1] + compressed;
+    return records;
+}
+
+std::vector<Workload> workloads(bool full) {
+    return {
+        {full ? "zip-64k" : "zip-1k", full ? 65535u : 1000u,
+         [](const char* path, uint64_t entries, uint64_t seed) { return corpus::write_zip(path, entries, seed); },
+         walk_zip},
+        {full ? "png-32k-idat" : "png-1k-idat", full ? 32768u : 1024u, corpus::write_png, walk_png},
+        {full ? "log-1g" : "log-64m", full ? uint64_t{1} << 30 : uint64_t{64} << 20,
+         [](const char* path, uint64_t bytes, uint64_t seed) { return corpus::write_log(path, bytes, seed); },
+         walk_log},
+        {full ? "container-64k" : "container-1k", full ? 65535u : 1000u,
+         [](const char* path, uint64_t entries, uint64_t seed) {
+             return corpus::write_container(path, entries, seed, 4096);
+         },
+         walk_container},
+        {full ? "bitfields-64m" : "bitfields-1m", full ? uint64_t{64} << 20 : uint64_t{1} << 20, corpus::write_bitfields,
+         walk_bitfields},
+    };
+}
+
+std::vector<uint8_t> read_file(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("cannot open " + path.string());
+    }
+    std::vector<uint8_t> bytes(std::filesystem::file_size(path));
+    if (!file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) {
+        throw std::runtime_error("cannot read " + path.string());
+    }
+    return bytes;
+}
+
+// The corpus for `workload`, written first if it is missing. The record count the generator
+// reported is kept next to it.
+uint64_t prepare(const Options& options, const Workload& workload, const std::filesystem::path& path) {
+    std::filesystem::path records_path = path;
+    records_path += ".records";
+    if (std::filesystem::exists(path) && std::filesystem::exists(records_path)) {
+        uint64_t records = 0;
+        std::ifstream(records_path) >> records;
+        return records;
+    }
+    std::printf("  generating %s ...\n", path.string().c_str());
+    const uint64_t records = workload.generate(path.string().c_str(), workload.amount, options.seed);
+    std::ofstream(records_path) << records << '\n';
+    return records;
+}
+
+Result run(const Options& options, const Workload& workload) {
+    using clock = std::chrono::steady_clock;
+    const auto path = options.dir / (workload.name + "-s" + std::to_string(options.seed) + ".bin");
+    const uint64_t expected = prepare(options, workload, path);
+
+    std::vector<Result> samples;
+    for (size_t rep = 0; rep < options.reps; ++rep) {
+        const auto start = clock::now();
+        const std::vector<uint8_t> bytes = read_file(path);
+        const auto opened = clock::now();
+        const uint64_t records = workload.process(bytes);
+        const auto done = clock::now();
+        if (records != expected) {
+            throw std::runtime_error(workload.name + ": visited " + std::to_string(records) + " records, expected " +
+                                     std::to_string(expected));
+        }
+        const auto ms = [](auto d) { return std::chrono::duration<double, std::milli>(d).count(); };
+        samples.push_back({workload.name, bytes.size(), records, ms(opened - start), ms(done - opened), ms(done - start)});
+    }
+    std::sort(samples.begin(), samples.end(), [](const Result& a, const Result& b) { return a.total_ms < b.total_ms; });
+    const Result result = samples[samples.size() / 2];
+    std::printf("  %-16s %9.1f MB %10llu records  open %8.1f ms  process %8.1f ms  total %8.1f ms %8.1f MB/s\n",
+                result.name.c_str(), static_cast<double>(result.bytes) / 1e6,
+                static_cast<unsigned long long>(result.records), result.open_ms, result.process_ms, result.total_ms,
+                static_cast<double>(result.bytes) / 1e3 / result.total_ms);
+    return result;
+}
+
+Options parse_options(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string flag = argv[i];
+        const std::string value = argv[i + 1];
+        if (flag == "--scale" && (value == "small" || value == "full")) {
+            options.full = value == "full";
+        } else if (flag == "--dir") {
+            options.dir = value;
+        } else if (flag == "--seed") {
+            options.seed = std::strtoull(argv[i + 1], nullptr, 10);
+        } else if (flag == "--reps") {
+            options.reps = std::max<size_t>(std::strtoull(argv[i + 1], nullptr, 10), 1);
+        } else if (flag == "--filter") {
+            options.filter = argv[i + 1];
+        } else if (flag == "--json") {
+            options.json = argv[i + 1];
+        } else {
+            std::fprintf(stderr, "unknown option %s %s\n", argv[i], argv[i + 1]);
+            std::exit(2);
+        }
+    }
+    return options;
+}
+
+void write_json(const Options& options, const std::vector<Result>& results) {
+    std::FILE* out = std::fopen(options.json, "w");
+    if (out == nullptr) {
+        throw std::runtime_error(std::string("cannot write ") + options.json);
+    }
+    std::fprintf(out, "{\n  \"scale\": \"%s\",\n  \"seed\": %llu,\n  \"results\": [\n", options.full ? "full" : "small",
+                 static_cast<unsigned long long>(options.seed));
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        std::fprintf(out,
+                     "    {\"workload\": \"%s\", \"bytes\": %zu, \"records\": %llu, \"open_ms\": %.3f, "
+                     "\"process_ms\": %.3f, \"total_ms\": %.3f}%s\n",
+                     r.name.c_str(), r.bytes, static_cast<unsigned long long>(r.records), r.open_ms, r.process_ms,
+                     r.total_ms, i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n}\n");
+    std::fclose(out);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const Options options = parse_options(argc, argv);
+    try {
+        std::filesystem::create_directories(options.dir);
+        std::vector<Result> results;
+        for (const auto& workload : workloads(options.full)) {
+            if (options.filter == nullptr || workload.name.find(options.filter) != std::string::npos) {
+                results.push_back(run(options, workload));
+            }
+        }
+        if (options.json != nullptr) {
+            write_json(options, results);
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
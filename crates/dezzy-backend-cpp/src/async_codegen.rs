@@ -0,0 +1,313 @@
+//! `read_async()`: the synchronous read path split into awaited runs.
+//!
+//! Operations whose wire size is known before they execute are grouped into runs.
+//! Each run awaits `AsyncReader::require(n)` once and is then parsed by the regular
+//! synchronous code over a `Reader` of exactly those bytes. Only nested structs,
+//! open-ended arrays and NUL-terminated strings await element by element.
+
+use crate::codegen::{
+    checksum_class, checksum_fields, covered_fields, endian_suffix, op_field_name, primitive_read_size, CppBackend,
+};
+use crate::expr_codegen::generate_expr;
+use anyhow::Result;
+use dezzy_core::hir::{Endianness, HirEnum, HirPrimitiveType};
+use dezzy_core::lir::{LirField, LirOperation, LirType, VarId};
+use std::collections::HashMap;
+
+/// Wire size of an operation, if it can be computed before the operation runs
+enum WireSize {
+    Fixed(usize),
+    /// C++ expression over fields read earlier
+    Dynamic(String),
+}
+
+fn wire_size(op: &LirOperation, var_to_field: &HashMap<VarId, String>) -> Option<WireSize> {
+    let field = |var: &VarId| var_to_field.get(var).map(|s| s.as_str()).unwrap_or("unknown");
+
+    if let Some(size) = primitive_read_size(op) {
+        return Some(WireSize::Fixed(size));
+    }
+    match op {
+        LirOperation::ReadArray { element_op, count, .. } => {
+            primitive_read_size(element_op).map(|size| WireSize::Fixed(size * count))
+        }
+        LirOperation::ReadFixedString { length, .. } => Some(WireSize::Fixed(*length)),
+        LirOperation::PadFixed { bytes } => Some(WireSize::Fixed(*bytes)),
+        LirOperation::ReadDynamicArray { element_op, size_var, .. } => primitive_read_size(element_op)
+            .map(|size| WireSize::Dynamic(format!("static_cast<size_t>(result.{}) * {}", field(size_var), size))),
+        LirOperation::ReadBlob { size_var, .. }
+        | LirOperation::ReadSizedStruct { size_var, .. }
+        | LirOperation::Skip { size_var } => {
+            Some(WireSize::Dynamic(format!("static_cast<size_t>(result.{})", field(size_var))))
+        }
+        LirOperation::ReadLengthPrefixedString { length_var, .. } => {
+            Some(WireSize::Dynamic(format!("static_cast<size_t>(result.{})", field(length_var))))
+        }
+        LirOperation::ConditionalBlock { condition, true_ops } if true_ops.len() == 1 => {
+            let condition_code = generate_expr(condition, "result").ok()?;
+            let inner = match wire_size(&true_ops[0], var_to_field)? {
+                WireSize::Fixed(size) => size.to_string(),
+                WireSize::Dynamic(expr) => expr,
+            };
+            Some(WireSize::Dynamic(format!("(({}) ? {} : 0)", condition_code, inner)))
+        }
+        _ => None,
+    }
+}
+
+fn indent(code: &str, prefix: &str) -> String {
+    code.lines()
+        .filter(|line| !line.is_empty())
+        .map(|line| format!("{}{}\n", prefix, line))
+        .collect()
+}
+
+/// A group of operations read synchronously after a single `require()`
+#[derive(Default)]
+struct Run {
+    size: Vec<String>,
+    body: String,
+    bits: bool,
+    bit_count: usize,
+}
+
+impl Run {
+    fn flush(&mut self, code: &mut String) {
+        if self.body.is_empty() {
+            return;
+        }
+        let size = if self.bits {
+            // Consecutive bitfields share bytes, so the group covers whole bytes
+            self.bit_count.div_ceil(8).to_string()
+        } else {
+            self.size.join(" + ")
+        };
+        code.push_str("    {\n");
+        code.push_str(&format!("        const size_t run_size = {};\n", size));
+        code.push_str("        co_await in.require(run_size);\n");
+        code.push_str("        Reader reader = in.take(run_size);\n");
+        if self.bits {
+            code.push_str("        BitReader bit_reader(reader);\n");
+        }
+        code.push_str(&indent(&self.body, "    "));
+        code.push_str("    }\n");
+        *self = Run::default();
+    }
+}
+
+pub(crate) fn generate_read_async(
+    backend: &CppBackend,
+    lir_type: &LirType,
+    endianness: Endianness,
+    enums: &[HirEnum],
+) -> Result<String> {
+    let name = &lir_type.name;
+    let var_to_field = backend.build_var_to_field_map(&lir_type.fields);
+    let enum_types: HashMap<String, HirPrimitiveType> =
+        enums.iter().map(|e| (e.name.clone(), e.underlying_type)).collect();
+    let mut code = String::from("#if defined(DEZZY_ASYNC)\n");
+    code.push_str(&format!("inline Task<{}> {}::read_async(AsyncReader& in) {{\n", name, name));
+    code.push_str(&format!("    {} result;\n", name));
+
+    let checksums = checksum_fields(&lir_type.fields);
+    let covered = covered_fields(&checksums);
+    if !checksums.is_empty() {
+        code.push_str("    const bool verify_checksums = verify_checksums_enabled && in.verify_checksums();\n");
+        for field in &checksums {
+            code.push_str(&format!("    {} {}_checksum;\n", checksum_class(field), field.name));
+        }
+    }
+
+    let mut run = Run::default();
+    for op in &lir_type.operations {
+        if matches!(op, LirOperation::CreateStruct { .. }) {
+            break;
+        }
+
+        let field_name = op_field_name(op, &var_to_field);
+        let accumulators = field_name.and_then(|name| covered.get(name));
+
+        let is_bits = matches!(op, LirOperation::ReadBits { .. });
+        if run.bits != is_bits {
+            run.flush(&mut code);
+        }
+
+        if is_bits {
+            let LirOperation::ReadBits { num_bits, .. } = op else { unreachable!() };
+            run.bits = true;
+            run.bit_count += usize::from(*num_bits);
+            run.body.push_str(&backend.generate_read_operation(op, &var_to_field, &lir_type.fields, &enum_types, endianness)?);
+            if accumulators.is_some() {
+                run.body.push_str(&unsupported_checksum(field_name.unwrap_or("unknown")));
+            }
+            continue;
+        }
+
+        let Some(size) = wire_size(op, &var_to_field) else {
+            run.flush(&mut code);
+            if accumulators.is_some() {
+                code.push_str(&unsupported_checksum(field_name.unwrap_or("unknown")));
+            }
+            code.push_str(&generate_awaited_operation(backend, op, lir_type, &var_to_field, endianness)?);
+            continue;
+        };
+
+        let mut body = String::new();
+        if accumulators.is_some() {
+            body.push_str("    size_t checksum_mark = reader.position();\n");
+        }
+        body.push_str(&backend.generate_read_operation(op, &var_to_field, &lir_type.fields, &enum_types, endianness)?);
+        if let Some(accumulators) = accumulators {
+            body.push_str("    if (verify_checksums) {\n");
+            for accumulator in accumulators {
+                body.push_str(&format!("        {}_checksum.update(reader.bytes_since(checksum_mark));\n", accumulator));
+            }
+            body.push_str("    }\n");
+        }
+        if let Some(field) = checksums.iter().find(|f| Some(f.name.as_str()) == field_name) {
+            body.push_str(&checksum_check(field));
+        }
+        // Wrap so per-field locals (checksum marks) do not collide within a run
+        let body = if accumulators.is_some() { format!("    {{\n{}    }}\n", indent(&body, "    ")) } else { body };
+
+        match size {
+            WireSize::Fixed(bytes) => {
+                run.size.push(bytes.to_string());
+            }
+            WireSize::Dynamic(expr) => {
+                // Depends on fields read so far, so it has to start a new run
+                run.flush(&mut code);
+                run.size.push(expr);
+            }
+        }
+        run.body.push_str(&body);
+    }
+    run.flush(&mut code);
+
+    code.push_str("    co_return result;\n");
+    code.push_str("}\n");
+    code.push_str("#endif\n\n");
+
+    Ok(code)
+}
+
+fn unsupported_checksum(field_name: &str) -> String {
+    format!(
+        "    throw ParseError(\"Checksum over field '{}' is not supported by read_async\");\n",
+        field_name
+    )
+}
+
+fn checksum_check(field: &LirField) -> String {
+    let stored = if field.is_optional {
+        format!("result.{name} && *result.{name}", name = field.name)
+    } else {
+        format!("result.{}", field.name)
+    };
+    let mut code = format!("    if (verify_checksums && {} != {}_checksum.value()) {{\n", stored, field.name);
+    code.push_str(&format!("        throw ParseError(\"Checksum mismatch for field '{}'\", ErrorKind::Checksum);\n", field.name));
+    code.push_str("    }\n");
+    code
+}
+
+/// Element read for open-ended arrays: one awaited struct, or one small run per primitive
+fn awaited_element(element_op: &LirOperation, target: &str, endianness: Endianness) -> Result<String> {
+    if let LirOperation::ReadStruct { type_name, .. } = element_op {
+        return Ok(format!("        {}.push_back(co_await {}::read_async(in));\n", target, type_name));
+    }
+    let size = primitive_read_size(element_op)
+        .ok_or_else(|| anyhow::anyhow!("Unsupported array element in read_async"))?;
+    let cpp_type = match element_op {
+        LirOperation::ReadU8 { .. } => "uint8_t",
+        LirOperation::ReadI8 { .. } => "int8_t",
+        LirOperation::ReadU16 { .. } => "uint16_t",
+        LirOperation::ReadI16 { .. } => "int16_t",
+        LirOperation::ReadU32 { .. } => "uint32_t",
+        LirOperation::ReadI32 { .. } => "int32_t",
+        LirOperation::ReadU64 { .. } => "uint64_t",
+        _ => "int64_t",
+    };
+    let suffix = if size == 1 { "_le" } else { endian_suffix(element_op.endianness().unwrap_or(endianness)) };
+    Ok(format!(
+        "        co_await in.require({size});\n        {target}.push_back(in.take({size}).read{suffix}<{cpp_type}>());\n"
+    ))
+}
+
+fn generate_awaited_operation(
+    backend: &CppBackend,
+    op: &LirOperation,
+    lir_type: &LirType,
+    var_to_field: &HashMap<VarId, String>,
+    endianness: Endianness,
+) -> Result<String> {
+    let field = |var: &VarId| var_to_field.get(var).map(|s| s.as_str()).unwrap_or("unknown").to_string();
+    Ok(match op {
+        LirOperation::ReadStruct { dest, type_name } => {
+            format!("    result.{} = co_await {}::read_async(in);\n", field(dest), type_name)
+        }
+        LirOperation::ReadArray { dest, element_op, count } => {
+            let LirOperation::ReadStruct { type_name, .. } = element_op.as_ref() else {
+                anyhow::bail!("Unsupported array element in read_async");
+            };
+            format!(
+                "    for (size_t i = 0; i < {}; ++i) {{\n        result.{}[i] = co_await {}::read_async(in);\n    }}\n",
+                count, field(dest), type_name
+            )
+        }
+        LirOperation::ReadDynamicArray { dest, element_op, size_var } => {
+            let LirOperation::ReadStruct { type_name, .. } = element_op.as_ref() else {
+                anyhow::bail!("Unsupported array element in read_async");
+            };
+            let (target, count) = (field(dest), field(size_var));
+            format!(
+                "    result.{target}.resize(result.{count});\n    for (size_t i = 0; i < result.{count}; ++i) {{\n        result.{target}[i] = co_await {type_name}::read_async(in);\n    }}\n"
+            )
+        }
+        LirOperation::ReadUntilEofArray { dest, element_op } => {
+            let target = format!("result.{}", field(dest));
+            let mut code = String::from("    while (co_await in.more()) {\n");
+            code.push_str(&awaited_element(element_op, &target, endianness)?);
+            code.push_str("    }\n");
+            code
+        }
+        LirOperation::ReadUntilConditionArray { dest, element_op, condition } => {
+            let target = format!("result.{}", field(dest));
+            let mut code = String::from("    do {\n");
+            code.push_str(&awaited_element(element_op, &target, endianness)?);
+            code.push_str(&format!("    }} while (!{});\n", generate_expr(condition, &target)?));
+            code
+        }
+        LirOperation::ReadNullTerminatedString { dest } => {
+            let target = field(dest);
+            let mut code = String::from("    for (;;) {\n");
+            code.push_str("        co_await in.require(1);\n");
+            code.push_str("        const auto window = in.buffered();\n");
+            code.push_str("        const auto* nul = static_cast<const uint8_t*>(std::memchr(window.data(), 0, window.size()));\n");
+            code.push_str("        const size_t length = nul ? static_cast<size_t>(nul - window.data()) : window.size();\n");
+            code.push_str(&format!("        result.{}.append(reinterpret_cast<const char*>(window.data()), length);\n", target));
+            code.push_str("        in.take(nul ? length + 1 : length);\n");
+            code.push_str("        if (nul) {\n            break;\n        }\n");
+            code.push_str("    }\n");
+            if let Some(assertion) = lir_type.fields.iter().find(|f| f.var_id == *dest).and_then(|f| f.assertion.as_ref()) {
+                code.push_str(&backend.generate_assertion_check(&target, assertion));
+            }
+            code
+        }
+        LirOperation::Align { boundary } => {
+            format!(
+                "    {{\n        const size_t padding = ({b} - (in.position() % {b})) % {b};\n        co_await in.require(padding);\n        in.take(padding);\n    }}\n",
+                b = boundary
+            )
+        }
+        LirOperation::ConditionalBlock { condition, true_ops } => {
+            let condition_code = generate_expr(condition, "result").unwrap_or_else(|_| "false".to_string());
+            let mut code = format!("    if ({}) {{\n", condition_code);
+            for inner in true_ops {
+                code.push_str(&indent(&generate_awaited_operation(backend, inner, lir_type, var_to_field, endianness)?, "    "));
+            }
+            code.push_str("    }\n");
+            code
+        }
+        _ => String::new(),
+    })
+}
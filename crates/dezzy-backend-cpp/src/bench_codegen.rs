@@ -0,0 +1,248 @@
+//! `dezzy bench`: a self-contained C++ micro-benchmark for every type of a format.
+//!
+//! Each type is timed on one `T::random()` value (see `random_codegen`) whose containers
+//! all hold `--scale` elements (blobs `16 * scale` bytes), drawn from a fixed seed so runs
+//! compare. The harness times read, write, round trip, and skip/validate where the type
+//! has them.
+
+use anyhow::Result;
+use dezzy_backend::GeneratedFile;
+use dezzy_core::lir::LirFormat;
+
+/// `<format>_bench.cpp` for `lir`, including the header the C++ backend writes for it
+pub fn generate_bench(lir: &LirFormat) -> Result<GeneratedFile> {
+    let stem = lir.name.to_lowercase().replace('-', "_");
+    let mut code = format!(
+        "// Micro-benchmarks for every type in {name}, generated by `dezzy bench`.\n//\n// Build:  g++ -std=c++20 -O2 -DNDEBUG {stem}_bench.cpp -o {stem}_bench\n// Run:    ./{stem}_bench [--scale N] [--seed N] [--reps N] [--min-time MS] [--filter TYPE] [--json PATH]\n\n#define DEZZY_RANDOM\n#include \"{stem}.hpp\"\n",
+        name = lir.name,
+    );
+    code.push_str(BENCH_RUNTIME_INCLUDES);
+    code.push_str(&format!("\nusing namespace {};\n", stem));
+    code.push_str(BENCH_RUNTIME);
+
+    code.push_str("} // namespace\n\nint main(int argc, char** argv) {\n");
+    code.push_str("    const bench::Options options = bench::parse_options(argc, argv);\n");
+    code.push_str("    const SizeProfile sizes = SizeProfile::fixed(options.scale);\n");
+    code.push_str("    std::vector<bench::Result> results;\n");
+    for lir_type in &lir.types {
+        code.push_str(&format!(
+            "    {{\n        Rng rng(options.seed);\n        bench::run_type<{name}>(options, \"{name}\", {name}::random(rng, sizes), results);\n    }}\n",
+            name = lir_type.name
+        ));
+    }
+    code.push_str(&format!("    return bench::finish(options, \"{}\", results);\n}}\n", lir.name));
+
+    Ok(GeneratedFile {
+        path: format!("{}_bench.cpp", stem),
+        content: code,
+    })
+}
+
+const BENCH_RUNTIME_INCLUDES: &str = "#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+";
+
+/// Timing loop, allocation counting and reporting shared by every generated benchmark
+const BENCH_RUNTIME: &str = r#"
+// Every allocation in the process is counted, to report allocations per operation
+static size_t bench_allocations = 0;
+
+void* operator new(size_t size) {
+    ++bench_allocations;
+    if (void* p = std::malloc(size != 0 ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+namespace bench {
+
+struct Options {
+    size_t scale = 16;          // elements per container in the random values
+    uint64_t seed = 1;          // seed of every type's random value
+    size_t reps = 5;            // timed repetitions; the median is reported
+    double min_time_ms = 50;    // length of each repetition
+    const char* filter = nullptr;
+    const char* json = nullptr;
+};
+
+struct Result {
+    std::string type;
+    std::string op;
+    size_t bytes;
+    double ns_per_op;
+    double mb_per_s;
+    double allocs_per_op;
+};
+
+inline Options parse_options(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string flag = argv[i];
+        if (flag == "--scale") {
+            options.scale = std::strtoull(argv[i + 1], nullptr, 10);
+        } else if (flag == "--seed") {
+            options.seed = std::strtoull(argv[i + 1], nullptr, 10);
+        } else if (flag == "--reps") {
+            options.reps = std::max<size_t>(std::strtoull(argv[i + 1], nullptr, 10), 1);
+        } else if (flag == "--min-time") {
+            options.min_time_ms = std::strtod(argv[i + 1], nullptr);
+        } else if (flag == "--filter") {
+            options.filter = argv[i + 1];
+        } else if (flag == "--json") {
+            options.json = argv[i + 1];
+        } else {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            std::exit(2);
+        }
+    }
+    return options;
+}
+
+// Keeps the optimizer from discarding a result and the work that produced it: the empty asm
+// takes the value's address and may read or write any memory, so nothing can be elided or
+// hoisted across it. A volatile store of the address alone does not stop that.
+template<typename T>
+void keep(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r"(&value) : "memory");
+#else
+    static const void* volatile escape = nullptr;
+    escape = &value;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+// Runs `body` in batches sized to take min_time_ms each: one untimed warm-up batch, then
+// `reps` timed ones. Reports the median.
+template<typename F>
+Result measure(const Options& options, const char* type, const char* op, size_t bytes, F&& body) {
+    using clock = std::chrono::steady_clock;
+    size_t batch = 1;
+    for (;;) {
+        const auto start = clock::now();
+        for (size_t i = 0; i < batch; ++i) {
+            body();
+        }
+        const double ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+        if (ms >= options.min_time_ms / 4 || batch >= (size_t{1} << 30)) {
+            batch = std::max<size_t>(1, static_cast<size_t>(static_cast<double>(batch) * options.min_time_ms / std::max(ms, 1e-3)));
+            break;
+        }
+        batch *= 2;
+    }
+
+    std::vector<double> samples;
+    size_t allocations = 0;
+    for (size_t rep = 0; rep < options.reps; ++rep) {
+        const size_t before = bench_allocations;
+        const auto start = clock::now();
+        for (size_t i = 0; i < batch; ++i) {
+            body();
+        }
+        const double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+        allocations += bench_allocations - before;
+        samples.push_back(ns / static_cast<double>(batch));
+    }
+    std::sort(samples.begin(), samples.end());
+    const double ns_per_op = samples[samples.size() / 2];
+    Result result{type, op, bytes, ns_per_op, static_cast<double>(bytes) * 1e3 / ns_per_op,
+                  static_cast<double>(allocations) / static_cast<double>(batch * options.reps)};
+    std::printf("  %-28s %-10s %10.1f ns/op %10.1f MB/s %8.2f allocs/op\n", type, op, result.ns_per_op,
+                result.mb_per_s, result.allocs_per_op);
+    return result;
+}
+
+template<typename T>
+void run_type(const Options& options, const char* type, const T& sample, std::vector<Result>& results) {
+    if (options.filter != nullptr && std::strcmp(options.filter, type) != 0) {
+        return;
+    }
+
+    // The random value has to survive a round trip to be worth timing
+    std::vector<uint8_t> bytes;
+    try {
+        Writer writer;
+        sample.write(writer);
+        bytes = writer.finish();
+        Reader reader(bytes);
+        const T decoded = T::read(reader);
+        Writer again;
+        decoded.write(again);
+        if (again.finish() != bytes || reader.remaining() != 0) {
+            throw std::runtime_error("decoded value re-encodes differently");
+        }
+    } catch (const std::exception& e) {
+        std::printf("  %-28s skipped: random value does not round-trip (%s)\n", type, e.what());
+        return;
+    }
+
+    results.push_back(measure(options, type, "read", bytes.size(), [&] {
+        Reader reader(bytes);
+        keep(T::read(reader));
+    }));
+    results.push_back(measure(options, type, "write", bytes.size(), [&] {
+        Writer writer;
+        sample.write(writer);
+        keep(writer.finish());
+    }));
+    results.push_back(measure(options, type, "round-trip", bytes.size(), [&] {
+        Reader reader(bytes);
+        Writer writer;
+        T::read(reader).write(writer);
+        keep(writer.finish());
+    }));
+    if constexpr (requires(Reader& reader) { T::skip(reader); }) {
+        results.push_back(measure(options, type, "skip", bytes.size(), [&] {
+            Reader reader(bytes);
+            T::skip(reader);
+            keep(reader.position());
+        }));
+    }
+    if constexpr (requires(Reader& reader) { T::validate(reader); }) {
+        results.push_back(measure(options, type, "validate", bytes.size(), [&] {
+            Reader reader(bytes);
+            keep(T::validate(reader));
+        }));
+    }
+}
+
+// Writes the JSON report if one was asked for
+inline int finish(const Options& options, const char* format, const std::vector<Result>& results) {
+    if (options.json == nullptr) {
+        return 0;
+    }
+    std::FILE* out = std::fopen(options.json, "w");
+    if (out == nullptr) {
+        std::fprintf(stderr, "cannot write %s\n", options.json);
+        return 1;
+    }
+    std::fprintf(out, "{\n  \"format\": \"%s\",\n  \"scale\": %zu,\n  \"seed\": %llu,\n  \"results\": [\n", format, options.scale,
+                 static_cast<unsigned long long>(options.seed));
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        std::fprintf(out,
+                     "    {\"type\": \"%s\", \"op\": \"%s\", \"bytes\": %zu, \"ns_per_op\": %.2f, \"mb_per_s\": %.2f, "
+                     "\"allocs_per_op\": %.3f}%s\n",
+                     r.type.c_str(), r.op.c_str(), r.bytes, r.ns_per_op, r.mb_per_s, r.allocs_per_op,
+                     i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n}\n");
+    std::fclose(out);
+    return 0;
+}
+
+} // namespace bench
+
+"#;
@@ -1,14 +1,31 @@
+use crate::async_codegen;
 use crate::expr_codegen::generate_expr;
+use crate::mutview_codegen;
+use crate::projection_codegen;
+use crate::push_codegen;
+use crate::random_codegen;
 use crate::templates;
+use crate::validate_codegen;
+use crate::visit_codegen;
 use anyhow::Result;
 use dezzy_backend::{Backend, GeneratedCode, GeneratedFile};
-use dezzy_core::hir::{Endianness, HirAssertion, HirAssertValue, HirEnum, HirPrimitiveType};
-use dezzy_core::lir::{LirField, LirFormat, LirOperation, LirType, VarId};
+use dezzy_core::hir::{
+    ChecksumAlgorithm, Endianness, HirAssertion, HirAssertValue, HirEnum, HirPrimitiveType, PosBase,
+};
+use dezzy_core::lir::{LirEndiannessSelector, LirField, LirFormat, LirOperation, LirType, VarId};
 use dezzy_core::topo_sort::topological_sort;
 use std::collections::HashMap;
 
 pub struct CppBackend;
 
+/// How a struct of a runtime-ordered format learns its byte order
+enum ByteOrderSource<'a> {
+    /// It declares the fields the format's `from:` condition reads
+    Condition(&'a LirEndiannessSelector),
+    /// Its first field is a struct that decides it
+    LeadingField { field: &'a str, type_name: &'a str },
+}
+
 impl CppBackend {
     pub fn new() -> Self {
         Self
@@ -45,21 +62,201 @@ impl CppBackend {
         code
     }
 
-    fn generate_type(&self, lir_type: &LirType, endianness: Endianness, enums: &[HirEnum]) -> Result<String> {
+    fn generate_type(
+        &self,
+        lir_type: &LirType,
+        endianness: Endianness,
+        selector: Option<&ByteOrderSource>,
+        enums: &[HirEnum],
+    ) -> Result<String> {
+        if endianness == Endianness::Runtime {
+            return self.generate_runtime_ordered_type(lir_type, selector, enums);
+        }
+
         let fields = self.extract_fields(lir_type)?;
-        let mut code = templates::generate_struct_declaration(&lir_type.name, &fields);
+        let instances: Vec<(String, String)> = lir_type
+            .fields
+            .iter()
+            .filter(|f| f.instance.is_some())
+            .map(|f| (f.name.clone(), self.lir_type_to_cpp_type(&f.type_info)))
+            .collect();
+        let signature = signature_bytes(lir_type, endianness, enums);
+
+        let mut declarations = vec![
+            templates::generate_skip_declaration(),
+            templates::generate_validate_declaration(&lir_type.name),
+            templates::generate_visit_declaration(),
+            templates::generate_async_declaration(&lir_type.name),
+            templates::generate_random_declaration(&lir_type.name),
+        ];
+        if let Some(ref bytes) = signature {
+            declarations.push(templates::generate_signature_declarations(bytes));
+        }
+        declarations.push(templates::generate_passthrough_declarations(&passthrough_alignment(lir_type)));
+        declarations.push(templates::generate_serialized_size_declarations(has_struct_array(lir_type)));
+        declarations.push(templates::generate_heap_bytes_declaration());
+        declarations.push(templates::generate_min_size_declaration(&min_encoded_size(lir_type)));
+
+        let mut code = templates::generate_struct_declaration(&lir_type.name, &fields, &instances, &declarations);
 
         code.push_str(&self.generate_read_impl(lir_type, endianness, enums)?);
-        code.push_str(&self.generate_write_impl(lir_type, endianness, enums)?);
+        code.push_str(&self.generate_write_impl(lir_type, endianness, enums, false)?);
+        if has_struct_array(lir_type) {
+            code.push_str("#if defined(DEZZY_PARALLEL_WRITE)\n");
+            code.push_str(&self.generate_write_impl(lir_type, endianness, enums, true)?);
+            code.push_str("#endif\n\n");
+        }
+        code.push_str(&generate_serialized_size(lir_type));
+        let mut heap_members = heap_owning(&fields, enums);
+        heap_members.extend(instances.iter().map(|(name, _)| format!("{}_", name)));
+        code.push_str(&templates::generate_heap_bytes_impl(&lir_type.name, &heap_members));
+        code.push_str(&projection_codegen::generate_skip(self, lir_type, endianness, enums)?);
+        code.push_str(&validate_codegen::generate_validate(self, lir_type, endianness, enums)?);
+        code.push_str(&visit_codegen::generate_visit(self, lir_type, endianness, enums)?);
+        code.push_str(&async_codegen::generate_read_async(self, lir_type, endianness, enums)?);
+        code.push_str(&push_codegen::generate_push_parser(self, lir_type, endianness, enums)?);
+        code.push_str(&mutview_codegen::generate_mut_view(self, lir_type, endianness, enums));
+        code.push_str(&random_codegen::generate_random(lir_type, enums)?);
+
+        if signature.is_some() {
+            code.push_str(&templates::generate_signature_impl(&lir_type.name));
+        }
+
+        for field in lir_type.fields.iter().filter(|f| f.instance.is_some()) {
+            code.push_str(&self.generate_instance_accessor(lir_type, field, endianness, enums)?);
+        }
+
+        Ok(code)
+    }
+
+    /// Formats whose byte order comes from the data get `read_in<Order>`/`write_in<Order>`
+    /// for both orders. read()/write() pick one up front, so no field branches on it.
+    fn generate_runtime_ordered_type(
+        &self,
+        lir_type: &LirType,
+        source: Option<&ByteOrderSource>,
+        enums: &[HirEnum],
+    ) -> Result<String> {
+        if lir_type.fields.iter().any(|f| f.instance.is_some()) {
+            anyhow::bail!("'{}': pos: fields are not supported with runtime endianness", lir_type.name);
+        }
+
+        let fields = self.extract_fields(lir_type)?;
+        let mut declarations = vec![
+            templates::generate_byte_order_declarations(&lir_type.name, source.is_some()),
+            templates::generate_random_declaration(&lir_type.name),
+            templates::generate_heap_bytes_declaration(),
+            templates::generate_min_size_declaration(&min_encoded_size(lir_type)),
+        ];
+        let signature = signature_bytes(lir_type, Endianness::Runtime, enums);
+        if let Some(ref bytes) = signature {
+            declarations.push(templates::generate_signature_declarations(bytes));
+        }
+
+        let mut code = templates::generate_struct_declaration(&lir_type.name, &fields, &[], &declarations);
+        code.push_str(&self.generate_read_impl(lir_type, Endianness::Runtime, enums)?);
+        code.push_str(&self.generate_write_impl(lir_type, Endianness::Runtime, enums, false)?);
+        match source {
+            Some(ByteOrderSource::Condition(selector)) => {
+                code.push_str(&self.generate_byte_order_selection(lir_type, selector, enums)?);
+            }
+            Some(ByteOrderSource::LeadingField { field, type_name }) => {
+                code.push_str(&templates::generate_forwarded_byte_order(&lir_type.name, type_name, field));
+            }
+            None => code.push_str(&templates::generate_default_order_dispatch(&lir_type.name)),
+        }
+        code.push_str(&random_codegen::generate_random(lir_type, enums)?);
+        code.push_str(&templates::generate_heap_bytes_impl(&lir_type.name, &heap_owning(&fields, enums)));
+        if signature.is_some() {
+            code.push_str(&templates::generate_signature_impl(&lir_type.name));
+        }
+        Ok(code)
+    }
+
+    /// `byte_order()` decodes the selector's fields (all fixed-order) from a copy of the
+    /// reader; read() and write() dispatch on it once
+    fn generate_byte_order_selection(
+        &self,
+        lir_type: &LirType,
+        selector: &LirEndiannessSelector,
+        enums: &[HirEnum],
+    ) -> Result<String> {
+        let var_to_field = self.build_var_to_field_map(&lir_type.fields);
+        let enum_types: HashMap<String, HirPrimitiveType> =
+            enums.iter().map(|e| (e.name.clone(), e.underlying_type)).collect();
+
+        // Sequential fields up to the last one the condition reads (checked by the pipeline)
+        let mut pending = selector.condition.referenced_names();
+        let mut prefix = Vec::new();
+        for (field, op) in lir_type.fields.iter().zip(&lir_type.operations) {
+            if pending.is_empty() {
+                break;
+            }
+            pending.retain(|name| *name != field.name);
+            prefix.push((field, op));
+        }
 
+        let name = &lir_type.name;
+        let mut code = format!("template<typename Cursor>\ninline std::endian {name}::byte_order(const BasicReader<Cursor>& input) {{\n");
+        code.push_str("    BasicReader<Cursor> reader = input;\n");
+        code.push_str("    struct {\n");
+        for (field, _) in prefix.iter().filter(|(f, _)| f.skip.is_none()) {
+            code.push_str(&format!("        {} {};\n", self.lir_type_to_cpp_type(&field.type_info), field.name));
+        }
+        code.push_str("    } result{};\n");
+        let ops: Vec<&LirOperation> = prefix.iter().map(|(_, op)| *op).collect();
+        if ops.iter().any(|op| matches!(op, LirOperation::ReadBits { .. })) {
+            code.push_str("    BitReader bit_reader(reader);\n");
+        }
+        let run = fixed_run_size(&ops);
+        if run > 0 {
+            code.push_str(&format!("    reader.validate_ahead({});\n", run));
+        }
+        for op in &ops {
+            code.push_str(&self.generate_read_operation(op, &var_to_field, &lir_type.fields, &enum_types, Endianness::Runtime)?);
+        }
+        code.push_str(&format!(
+            "    return ({}) ? std::endian::big : std::endian::little;\n}}\n\n",
+            generate_expr(&selector.condition, "result")?
+        ));
+
+        code.push_str(&format!("inline std::endian {name}::byte_order() const {{\n"));
+        code.push_str(&format!(
+            "    return ({}) ? std::endian::big : std::endian::little;\n}}\n\n",
+            generate_expr(&selector.condition, "")?
+        ));
+
+        code.push_str(&templates::generate_selected_order_dispatch(name));
         Ok(code)
     }
 
+    /// The struct holding the selector decides the byte order, and so does any struct that
+    /// starts with one that does; everything else follows its parent
+    fn byte_order_sources(lir: &LirFormat) -> HashMap<String, ByteOrderSource<'_>> {
+        let mut sources = HashMap::new();
+        let Some(ref selector) = lir.endianness_selector else {
+            return sources;
+        };
+        // Types are sorted, so a leading struct is classified before its parents
+        for lir_type in &lir.types {
+            let leading = lir_type.fields.first().zip(lir_type.operations.first());
+            if lir_type.name == selector.type_name {
+                sources.insert(lir_type.name.clone(), ByteOrderSource::Condition(selector));
+            } else if let Some((field, LirOperation::ReadStruct { type_name, .. })) = leading {
+                if field.instance.is_none() && sources.contains_key(type_name) {
+                    let source = ByteOrderSource::LeadingField { field: &field.name, type_name };
+                    sources.insert(lir_type.name.clone(), source);
+                }
+            }
+        }
+        sources
+    }
+
     fn extract_fields(&self, lir_type: &LirType) -> Result<Vec<(String, String)>> {
         let fields = lir_type
             .fields
             .iter()
-            .filter(|f| f.skip.is_none())  // Exclude skip fields from struct
+            .filter(|f| f.skip.is_none() && f.instance.is_none())  // Skip and pos: fields are not stored inline
             .map(|f| {
                 let cpp_type = self.lir_type_to_cpp_type(&f.type_info);
                 // Wrap conditional fields in std::optional
@@ -75,7 +272,7 @@ impl CppBackend {
         Ok(fields)
     }
 
-    fn lir_type_to_cpp_type(&self, type_str: &str) -> String {
+    pub(crate) fn lir_type_to_cpp_type(&self, type_str: &str) -> String {
         // Handle string types
         if type_str == "cstr" || type_str.starts_with("str(") {
             return "std::string".to_string();
@@ -127,9 +324,27 @@ impl CppBackend {
 
 
     fn generate_read_impl(&self, lir_type: &LirType, endianness: Endianness, enums: &[HirEnum]) -> Result<String> {
-        let mut code = format!("inline {} {}::read(Reader& reader) {{\n", lir_type.name, lir_type.name);
+        let mut code = if endianness == Endianness::Runtime {
+            format!(
+                "template<std::endian Order, typename Cursor>\ninline {name} {name}::read_in(BasicReader<Cursor>& reader) {{\n",
+                name = lir_type.name
+            )
+        } else {
+            format!("template<typename Cursor>\ninline {name} {name}::read(BasicReader<Cursor>& reader) {{\n", name = lir_type.name)
+        };
+        code.push_str(&format!(
+            "#if defined(DEZZY_COUNT_ALLOCATIONS)\n    detail::AllocationScope allocation_scope(TypeId::{});\n#endif\n",
+            lir_type.name
+        ));
+        code.push_str("    const LimitScope limit_scope(reader.limits());\n");
         code.push_str(&format!("    {} result;\n", lir_type.name));
 
+        code.push_str("    [[maybe_unused]] size_t hook_start = 0;\n    [[maybe_unused]] size_t hook_mark = 0;\n");
+        code.push_str(&format!(
+            "    if constexpr (Hooks::enabled) {{\n        hook_start = hook_mark = reader.position();\n        Hooks::on_enter(TypeId::{name}, hook_start);\n    }}\n    const HookFrame hook_frame(TypeId::{name});\n",
+            name = lir_type.name
+        ));
+
         let var_to_field = self.build_var_to_field_map(&lir_type.fields);
 
         // Build enum map: enum_name -> underlying_type
@@ -138,34 +353,193 @@ impl CppBackend {
             enum_types.insert(enum_def.name.clone(), enum_def.underlying_type);
         }
 
+        // Remember where we came from so pos: instances can be read later
+        if lir_type.fields.iter().any(|f| f.instance.is_some()) {
+            code.push_str("    result.source_ = Reader(reader);\n");
+            // Instances are read after this parse, when its limits may be gone
+            code.push_str("    result.source_.set_limits(nullptr);\n");
+            code.push_str("    result.origin_ = reader.position();\n");
+        }
+
         // Check if we need BitReader (if any ReadBits operations exist)
         let has_read_bits = lir_type.operations.iter().any(|op| matches!(op, LirOperation::ReadBits { .. }));
         if has_read_bits {
-            code.push_str("    static BitReader bit_reader(reader);\n");
+            code.push_str("    BitReader bit_reader(reader);\n");
         }
 
-        for op in &lir_type.operations {
-            if matches!(op, LirOperation::CreateStruct { .. }) {
-                break;
+        let checksum_fields = checksum_fields(&lir_type.fields);
+        let covered = covered_fields(&checksum_fields);
+        if !checksum_fields.is_empty() {
+            code.push_str("    const bool verify_checksums = verify_checksums_enabled && reader.verify_checksums();\n");
+            for field in &checksum_fields {
+                code.push_str(&format!("    {} {}_checksum;\n", checksum_class(field), field.name));
+            }
+            code.push_str("    size_t checksum_mark = 0;\n");
+        }
+
+        let reads: Vec<&LirOperation> = lir_type
+            .operations
+            .iter()
+            .take_while(|op| !matches!(op, LirOperation::CreateStruct { .. }))
+            .collect();
+
+        for (index, op) in reads.iter().enumerate() {
+            // Trusted cursors bounds-check each run of fixed-size fields once, up front
+            let starts_run = index == 0 || !is_fixed_or_bits(reads[index - 1]);
+            if starts_run {
+                let run = fixed_run_size(&reads[index..]);
+                if run > 0 {
+                    code.push_str(&format!("    reader.validate_ahead({});\n", run));
+                }
+            }
+
+            let field_name = op_field_name(op, &var_to_field);
+            let accumulators = field_name.and_then(|name| covered.get(name));
+
+            if accumulators.is_some() {
+                code.push_str("    checksum_mark = reader.position();\n");
+            }
+
+            let mut op_code = self.generate_read_operation(op, &var_to_field, &lir_type.fields, &enum_types, endianness)?;
+            if let LirOperation::ConditionalBlock { true_ops, .. } = op {
+                let inner: Vec<&LirOperation> = true_ops.iter().collect();
+                let run = fixed_run_size(&inner);
+                if run > 0 && inner.iter().all(|op| is_fixed_or_bits(op)) {
+                    if let Some(open) = op_code.find("{\n") {
+                        op_code.insert_str(open + 2, &format!("        reader.validate_ahead({});\n", run));
+                    }
+                }
+            }
+            code.push_str(&op_code);
+
+            if let Some(accumulators) = accumulators {
+                code.push_str("    if (verify_checksums) {\n");
+                for accumulator in accumulators {
+                    code.push_str(&format!("        {}_checksum.update(reader.bytes_since(checksum_mark));\n", accumulator));
+                }
+                code.push_str("    }\n");
+            }
+
+            if let Some(field) = checksum_fields.iter().find(|f| Some(f.name.as_str()) == field_name) {
+                let stored = if field.is_optional {
+                    format!("result.{name} && *result.{name}", name = field.name)
+                } else {
+                    format!("result.{}", field.name)
+                };
+                code.push_str(&format!("    if (verify_checksums && {} != {}_checksum.value()) {{\n", stored, field.name));
+                code.push_str(&format!("        throw ParseError(\"Checksum mismatch for field '{}'\", ErrorKind::Checksum);\n", field.name));
+                code.push_str("    }\n");
             }
 
-            code.push_str(&self.generate_read_operation(op, &var_to_field, &lir_type.fields, &enum_types, endianness)?);
+            code.push_str(&field_hook(lir_type, field_name));
         }
 
+        code.push_str(&format!(
+            "    if constexpr (Hooks::enabled) {{\n        Hooks::on_exit(TypeId::{}, reader.position() - hook_start);\n    }}\n",
+            lir_type.name
+        ));
         code.push_str("    return result;\n");
         code.push_str("}\n\n");
 
         Ok(code)
     }
 
-    fn build_var_to_field_map(&self, fields: &[LirField]) -> HashMap<VarId, String> {
+    fn generate_instance_accessor(
+        &self,
+        lir_type: &LirType,
+        field: &LirField,
+        endianness: Endianness,
+        enums: &[HirEnum],
+    ) -> Result<String> {
+        let Some(ref instance) = field.instance else {
+            return Ok(String::new());
+        };
+
+        let cpp_type = self.lir_type_to_cpp_type(&field.type_info);
+        let var_to_field = self.build_var_to_field_map(&lir_type.fields);
+
+        // Offsets are evaluated against this struct's own members
+        let offset = generate_expr(&instance.offset, "")?;
+        let offset = match instance.base {
+            PosBase::Stream => format!("static_cast<size_t>({})", offset),
+            PosBase::Struct => format!("origin_ + static_cast<size_t>({})", offset),
+        };
+
+        let mut code = format!(
+            "inline const {}& {}::{}() const {{\n",
+            cpp_type, lir_type.name, field.name
+        );
+        code.push_str(&format!("    return {}_.get([this] {{\n", field.name));
+        code.push_str(&format!("        Reader reader = source_.at({});\n", offset));
+        code.push_str(&format!("        {} value{{}};\n", cpp_type));
+
+        let element_read = |op: &LirOperation| self.generate_array_element_read(op, endianness);
+        match &instance.read_op {
+            LirOperation::ReadArray { element_op, count, .. } => {
+                code.push_str(&format!("        for (size_t i = 0; i < {}; ++i) {{\n", count));
+                code.push_str(&format!("            value[i] = {};\n", element_read(element_op)?));
+                code.push_str("        }\n");
+            }
+            LirOperation::ReadDynamicArray { element_op, size_var, .. } => {
+                let size_field = var_to_field.get(size_var).map(|s| s.as_str()).unwrap_or("unknown_size");
+                code.push_str(&format!("        reader.{};\n", admit_elements(size_field, element_op)));
+                code.push_str(&format!("        value.resize({});\n", size_field));
+                code.push_str(&format!("        for (size_t i = 0; i < {}; ++i) {{\n", size_field));
+                code.push_str(&format!("            value[i] = {};\n", element_read(element_op)?));
+                code.push_str("        }\n");
+            }
+            LirOperation::ReadUntilEofArray { element_op, .. } => {
+                code.push_str("        while (reader.remaining() > 0) {\n");
+                code.push_str(&admit_next("value", element_op, "            "));
+                code.push_str(&format!("            value.push_back({});\n", element_read(element_op)?));
+                code.push_str("        }\n");
+            }
+            LirOperation::ReadBlob { size_var, .. } => {
+                let size_field = var_to_field.get(size_var).map(|s| s.as_str()).unwrap_or("unknown_size");
+                code.push_str(&format!("        reader.admit({}, 1, 1);\n", size_field));
+                code.push_str(&format!("        value.resize({});\n", size_field));
+                code.push_str(&format!("        for (size_t i = 0; i < {}; ++i) {{\n", size_field));
+                code.push_str("            value[i] = reader.read_le<uint8_t>();\n");
+                code.push_str("        }\n");
+            }
+            scalar @ (LirOperation::ReadU8 { .. }
+            | LirOperation::ReadU16 { .. }
+            | LirOperation::ReadU32 { .. }
+            | LirOperation::ReadU64 { .. }
+            | LirOperation::ReadI8 { .. }
+            | LirOperation::ReadI16 { .. }
+            | LirOperation::ReadI32 { .. }
+            | LirOperation::ReadI64 { .. }
+            | LirOperation::ReadStruct { .. }) => {
+                let read_expr = element_read(scalar)?;
+                if enums.iter().any(|e| e.name == field.type_info) {
+                    code.push_str(&format!("        value = static_cast<{}>({});\n", cpp_type, read_expr));
+                } else {
+                    code.push_str(&format!("        value = {};\n", read_expr));
+                }
+            }
+            _ => anyhow::bail!(
+                "Field '{}' of type '{}' cannot be used with pos:",
+                field.name,
+                field.type_info
+            ),
+        }
+
+        code.push_str("        return value;\n");
+        code.push_str("    });\n");
+        code.push_str("}\n\n");
+
+        Ok(code)
+    }
+
+    pub(crate) fn build_var_to_field_map(&self, fields: &[LirField]) -> HashMap<VarId, String> {
         fields
             .iter()
             .map(|f| (f.var_id, f.name.clone()))
             .collect()
     }
 
-    fn generate_assertion_check(
+    pub(crate) fn generate_assertion_check(
         &self,
         field_name: &str,
         assertion: &HirAssertion,
@@ -177,7 +551,7 @@ impl CppBackend {
                 match assert_val {
                     HirAssertValue::Int(value) => {
                         code.push_str(&format!("    if (result.{} != {}) {{\n", field_name, value));
-                        code.push_str(&format!("        throw ParseError(\"Field '{}' must equal {}, got \" + std::to_string(result.{}));\n", field_name, value, field_name));
+                        code.push_str(&format!("        throw ParseError(\"Field '{}' must equal {}, got \" + std::to_string(result.{}), ErrorKind::Assertion);\n", field_name, value, field_name));
                         code.push_str("    }\n");
                     }
                     HirAssertValue::IntArray(values) => {
@@ -189,7 +563,7 @@ impl CppBackend {
                         }
                         code.push_str("};\n");
                         code.push_str(&format!("        if (!std::equal(result.{}.begin(), result.{}.end(), expected.begin())) {{\n", field_name, field_name));
-                        code.push_str(&format!("            throw ParseError(\"Field '{}' does not match expected value\");\n", field_name));
+                        code.push_str(&format!("            throw ParseError(\"Field '{}' does not match expected value\", ErrorKind::Assertion);\n", field_name));
                         code.push_str("        }\n");
                         code.push_str("    }\n");
                     }
@@ -199,7 +573,7 @@ impl CppBackend {
                 match assert_val {
                     HirAssertValue::Int(value) => {
                         code.push_str(&format!("    if (result.{} == {}) {{\n", field_name, value));
-                        code.push_str(&format!("        throw ParseError(\"Field '{}' must not equal {}\");\n", field_name, value));
+                        code.push_str(&format!("        throw ParseError(\"Field '{}' must not equal {}\", ErrorKind::Assertion);\n", field_name, value));
                         code.push_str("    }\n");
                     }
                     HirAssertValue::IntArray(_) => {
@@ -209,22 +583,22 @@ impl CppBackend {
             }
             HirAssertion::GreaterThan(threshold) => {
                 code.push_str(&format!("    if (result.{} <= {}) {{\n", field_name, threshold));
-                code.push_str(&format!("        throw ParseError(\"Field '{}' must be greater than {}, got \" + std::to_string(result.{}));\n", field_name, threshold, field_name));
+                code.push_str(&format!("        throw ParseError(\"Field '{}' must be greater than {}, got \" + std::to_string(result.{}), ErrorKind::Assertion);\n", field_name, threshold, field_name));
                 code.push_str("    }\n");
             }
             HirAssertion::GreaterOrEqual(threshold) => {
                 code.push_str(&format!("    if (result.{} < {}) {{\n", field_name, threshold));
-                code.push_str(&format!("        throw ParseError(\"Field '{}' must be >= {}, got \" + std::to_string(result.{}));\n", field_name, threshold, field_name));
+                code.push_str(&format!("        throw ParseError(\"Field '{}' must be >= {}, got \" + std::to_string(result.{}), ErrorKind::Assertion);\n", field_name, threshold, field_name));
                 code.push_str("    }\n");
             }
             HirAssertion::LessThan(threshold) => {
                 code.push_str(&format!("    if (result.{} >= {}) {{\n", field_name, threshold));
-                code.push_str(&format!("        throw ParseError(\"Field '{}' must be less than {}, got \" + std::to_string(result.{}));\n", field_name, threshold, field_name));
+                code.push_str(&format!("        throw ParseError(\"Field '{}' must be less than {}, got \" + std::to_string(result.{}), ErrorKind::Assertion);\n", field_name, threshold, field_name));
                 code.push_str("    }\n");
             }
             HirAssertion::LessOrEqual(threshold) => {
                 code.push_str(&format!("    if (result.{} > {}) {{\n", field_name, threshold));
-                code.push_str(&format!("        throw ParseError(\"Field '{}' must be <= {}, got \" + std::to_string(result.{}));\n", field_name, threshold, field_name));
+                code.push_str(&format!("        throw ParseError(\"Field '{}' must be <= {}, got \" + std::to_string(result.{}), ErrorKind::Assertion);\n", field_name, threshold, field_name));
                 code.push_str("    }\n");
             }
             HirAssertion::In(values) => {
@@ -236,7 +610,7 @@ impl CppBackend {
                 }
                 code.push_str("};\n");
                 code.push_str(&format!("        if (std::find(allowed.begin(), allowed.end(), result.{}) == allowed.end()) {{\n", field_name));
-                code.push_str(&format!("            throw ParseError(\"Field '{}' has invalid value \" + std::to_string(result.{}));\n", field_name, field_name));
+                code.push_str(&format!("            throw ParseError(\"Field '{}' has invalid value \" + std::to_string(result.{}), ErrorKind::Assertion);\n", field_name, field_name));
                 code.push_str("        }\n");
                 code.push_str("    }\n");
             }
@@ -249,13 +623,13 @@ impl CppBackend {
                 }
                 code.push_str("};\n");
                 code.push_str(&format!("        if (std::find(forbidden.begin(), forbidden.end(), result.{}) != forbidden.end()) {{\n", field_name));
-                code.push_str(&format!("            throw ParseError(\"Field '{}' has forbidden value \" + std::to_string(result.{}));\n", field_name, field_name));
+                code.push_str(&format!("            throw ParseError(\"Field '{}' has forbidden value \" + std::to_string(result.{}), ErrorKind::Assertion);\n", field_name, field_name));
                 code.push_str("        }\n");
                 code.push_str("    }\n");
             }
             HirAssertion::Range { min, max } => {
                 code.push_str(&format!("    if (result.{} < {} || result.{} > {}) {{\n", field_name, min, field_name, max));
-                code.push_str(&format!("        throw ParseError(\"Field '{}' must be in range [{}, {}], got \" + std::to_string(result.{}));\n", field_name, min, max, field_name));
+                code.push_str(&format!("        throw ParseError(\"Field '{}' must be in range [{}, {}], got \" + std::to_string(result.{}), ErrorKind::Assertion);\n", field_name, min, max, field_name));
                 code.push_str("    }\n");
             }
         }
@@ -263,7 +637,7 @@ impl CppBackend {
         code
     }
 
-    fn generate_read_operation(
+    pub(crate) fn generate_read_operation(
         &self,
         op: &LirOperation,
         var_to_field: &HashMap<VarId, String>,
@@ -271,11 +645,7 @@ impl CppBackend {
         enum_types: &HashMap<String, HirPrimitiveType>,
         endianness: Endianness,
     ) -> Result<String> {
-        let endian_suffix = match endianness {
-            Endianness::Little => "_le",
-            Endianness::Big => "_be",
-            Endianness::Native => "_le",
-        };
+        let order = op.endianness().unwrap_or(endianness);
 
         // Helper to find if a field is an enum and return its name
         let get_enum_type_for_dest = |dest: &VarId| -> Option<String> {
@@ -301,9 +671,9 @@ impl CppBackend {
             LirOperation::ReadU8 { dest } => {
                 let field_name = var_to_field.get(dest).map(|s| s.as_str()).unwrap_or("unknown");
                 let mut code = if let Some(enum_name) = get_enum_type_for_dest(dest) {
-                    format!("    result.{} = static_cast<{}>(reader.read_le<uint8_t>());\n", field_name, enum_name)
+                    format!("    result.{} = static_cast<{}>(reader.template read_le<uint8_t>());\n", field_name, enum_name)
                 } else {
-                    format!("    result.{} = reader.read_le<uint8_t>();\n", field_name)
+                    format!("    result.{} = reader.template read_le<uint8_t>();\n", field_name)
                 };
                 add_assertion(&mut code, dest);
                 code
@@ -311,9 +681,9 @@ impl CppBackend {
             LirOperation::ReadU16 { dest, .. } => {
                 let field_name = var_to_field.get(dest).map(|s| s.as_str()).unwrap_or("unknown");
                 let mut code = if let Some(enum_name) = get_enum_type_for_dest(dest) {
-                    format!("    result.{} = static_cast<{}>(reader.read{}<uint16_t>());\n", field_name, enum_name, endian_suffix)
+                    format!("    result.{} = static_cast<{}>({});\n", field_name, enum_name, read_call(order, "uint16_t"))
                 } else {
-                    format!("    result.{} = reader.read{}<uint16_t>();\n", field_name, endian_suffix)
+                    format!("    result.{} = {};\n", field_name, read_call(order, "uint16_t"))
                 };
                 add_assertion(&mut code, dest);
                 code
@@ -321,9 +691,9 @@ impl CppBackend {
             LirOperation::ReadU32 { dest, .. } => {
                 let field_name = var_to_field.get(dest).map(|s| s.as_str()).unwrap_or("unknown");
                 let mut code = if let Some(enum_name) = get_enum_type_for_dest(dest) {
-                    format!("    result.{} = static_cast<{}>(reader.read{}<uint32_t>());\n", field_name, enum_name, endian_suffix)
+                    format!("    result.{} = static_cast<{}>({});\n", field_name, enum_name, read_call(order, "uint32_t"))
                 } else {
-                    format!("    result.{} = reader.read{}<uint32_t>();\n", field_name, endian_suffix)
+                    format!("    result.{} = {};\n", field_name, read_call(order, "uint32_t"))
                 };
                 add_assertion(&mut code, dest);
                 code
@@ -331,9 +701,9 @@ impl CppBackend {
             LirOperation::ReadU64 { dest, .. } => {
                 let field_name = var_to_field.get(dest).map(|s| s.as_str()).unwrap_or("unknown");
                 let mut code = if let Some(enum_name) = get_enum_type_for_dest(dest) {
-                    format!("    result.{} = static_cast<{}>(reader.read{}<uint64_t>());\n", field_name, enum_name, endian_suffix)
+                    format!("    result.{} = static_cast<{}>({});\n", field_name, enum_name, read_call(order, "uint64_t"))
                 } else {
-                    format!("    result.{} = reader.read{}<uint64_t>();\n", field_name, endian_suffix)
+                    format!("    result.{} = {};\n", field_name, read_call(order, "uint64_t"))
                 };
                 add_assertion(&mut code, dest);
                 code
@@ -341,9 +711,9 @@ impl CppBackend {
             LirOperation::ReadI8 { dest } => {
                 let field_name = var_to_field.get(dest).map(|s| s.as_str()).unwrap_or("unknown");
                 let mut code = if let Some(enum_name) = get_enum_type_for_dest(dest) {
-                    format!("    result.{} = static_cast<{}>(reader.read_le<int8_t>());\n", field_name, enum_name)
+                    format!("    result.{} = static_cast<{}>(reader.template read_le<int8_t>());\n", field_name, enum_name)
                 } else {
-                    format!("    result.{} = reader.read_le<int8_t>();\n", field_name)
+                    format!("    result.{} = reader.template read_le<int8_t>();\n", field_name)
                 };
                 add_assertion(&mut code, dest);
                 code
@@ -351,9 +721,9 @@ impl CppBackend {
             LirOperation::ReadI16 { dest, .. } => {
                 let field_name = var_to_field.get(dest).map(|s| s.as_str()).unwrap_or("unknown");
                 let mut code = if let Some(enum_name) = get_enum_type_for_dest(dest) {
-                    format!("    result.{} = static_cast<{}>(reader.read{}<int16_t>());\n", field_name, enum_name, endian_suffix)
+                    format!("    result.{} = static_cast<{}>({});\n", field_name, enum_name, read_call(order, "int16_t"))
                 } else {
-                    format!("    result.{} = reader.read{}<int16_t>();\n", field_name, endian_suffix)
+                    format!("    result.{} = {};\n", field_name, read_call(order, "int16_t"))
                 };
                 add_assertion(&mut code, dest);
                 code
@@ -361,9 +731,9 @@ impl CppBackend {
             LirOperation::ReadI32 { dest, .. } => {
                 let field_name = var_to_field.get(dest).map(|s| s.as_str()).unwrap_or("unknown");
                 let mut code = if let Some(enum_name) = get_enum_type_for_dest(dest) {
-                    format!("    result.{} = static_cast<{}>(reader.read{}<int32_t>());\n", field_name, enum_name, endian_suffix)
+                    format!("    result.{} = static_cast<{}>({});\n", field_name, enum_name, read_call(order, "int32_t"))
                 } else {
-                    format!("    result.{} = reader.read{}<int32_t>();\n", field_name, endian_suffix)
+                    format!("    result.{} = {};\n", field_name, read_call(order, "int32_t"))
                 };
                 add_assertion(&mut code, dest);
                 code
@@ -371,9 +741,9 @@ impl CppBackend {
             LirOperation::ReadI64 { dest, .. } => {
                 let field_name = var_to_field.get(dest).map(|s| s.as_str()).unwrap_or("unknown");
                 let mut code = if let Some(enum_name) = get_enum_type_for_dest(dest) {
-                    format!("    result.{} = static_cast<{}>(reader.read{}<int64_t>());\n", field_name, enum_name, endian_suffix)
+                    format!("    result.{} = static_cast<{}>({});\n", field_name, enum_name, read_call(order, "int64_t"))
                 } else {
-                    format!("    result.{} = reader.read{}<int64_t>();\n", field_name, endian_suffix)
+                    format!("    result.{} = {};\n", field_name, read_call(order, "int64_t"))
                 };
                 add_assertion(&mut code, dest);
                 code
@@ -390,25 +760,61 @@ impl CppBackend {
             LirOperation::ReadDynamicArray { dest, element_op, size_var } => {
                 let field_name = var_to_field.get(dest).map(|s| s.as_str()).unwrap_or("unknown");
                 let size_field_name = var_to_field.get(size_var).map(|s| s.as_str()).unwrap_or("unknown_size");
-                let mut array_code = format!("    result.{}.resize(result.{});\n", field_name, size_field_name);
-                array_code.push_str(&format!("    for (size_t i = 0; i < result.{}; ++i) {{\n", size_field_name));
+                // Reject impossible counts before allocating for them
+                let mut array_code = format!("    reader.{};\n", admit_elements(&format!("result.{}", size_field_name), element_op));
+                let recoverable = recoverable_element(element_op, endianness);
+                let indent = if recoverable.is_some() { "    " } else { "" };
+                if recoverable.is_some() {
+                    array_code.push_str("    if (reader.recovery() == nullptr) {\n");
+                }
+                array_code.push_str(&format!("{indent}    result.{}.resize(result.{});\n", field_name, size_field_name));
+                array_code.push_str(&format!("{indent}    for (size_t i = 0; i < result.{}; ++i) {{\n", size_field_name));
                 let element_read = self.generate_array_element_read(element_op, endianness)?;
-                array_code.push_str(&format!("        result.{}[i] = {};\n", field_name, element_read));
-                array_code.push_str("    }\n");
+                array_code.push_str(&format!("{indent}        result.{}[i] = {};\n", field_name, element_read));
+                array_code.push_str(&format!("{indent}    }}\n"));
+                if let Some(type_name) = recoverable {
+                    // Elements that fail are left out, so the array may end up shorter
+                    array_code.push_str("    } else {\n");
+                    array_code.push_str(&format!("        result.{}.reserve(result.{});\n", field_name, size_field_name));
+                    array_code.push_str(&format!("        for (size_t i = 0; i < result.{}; ++i) {{\n", size_field_name));
+                    array_code.push_str(&format!(
+                        "            if (!detail::read_recovering<{}>(reader, result.{})) {{\n                break;\n            }}\n        }}\n",
+                        type_name, field_name
+                    ));
+                    array_code.push_str("    }\n");
+                }
                 array_code
             }
             LirOperation::ReadUntilEofArray { dest, element_op } => {
                 let field_name = var_to_field.get(dest).map(|s| s.as_str()).unwrap_or("unknown");
-                let mut array_code = String::from("    while (reader.remaining() > 0) {\n");
+                let recoverable = recoverable_element(element_op, endianness);
+                let indent = if recoverable.is_some() { "    " } else { "" };
+                let mut array_code = String::new();
+                if recoverable.is_some() {
+                    array_code.push_str("    if (reader.recovery() == nullptr) {\n");
+                }
+                array_code.push_str(&format!("{indent}    while (reader.remaining() > 0) {{\n"));
                 let element_read = self.generate_array_element_read(element_op, endianness)?;
-                array_code.push_str(&format!("        result.{}.push_back({});\n", field_name, element_read));
-                array_code.push_str("    }\n");
+                array_code.push_str(&admit_next(&format!("result.{}", field_name), element_op, &format!("{indent}        ")));
+                array_code.push_str(&format!("{indent}        result.{}.push_back({});\n", field_name, element_read));
+                array_code.push_str(&format!("{indent}    }}\n"));
+                if let Some(type_name) = recoverable {
+                    array_code.push_str("    } else {\n");
+                    array_code.push_str("        while (reader.remaining() > 0) {\n");
+                    array_code.push_str(&admit_next(&format!("result.{}", field_name), element_op, "            "));
+                    array_code.push_str(&format!(
+                        "            if (!detail::read_recovering<{}>(reader, result.{})) {{\n                break;\n            }}\n",
+                        type_name, field_name
+                    ));
+                    array_code.push_str("        }\n    }\n");
+                }
                 array_code
             }
             LirOperation::ReadUntilConditionArray { dest, element_op, condition } => {
                 let field_name = var_to_field.get(dest).map(|s| s.as_str()).unwrap_or("unknown");
                 let mut array_code = String::from("    do {\n");
                 let element_read = self.generate_array_element_read(element_op, endianness)?;
+                array_code.push_str(&admit_next(&format!("result.{}", field_name), element_op, "        "));
                 array_code.push_str(&format!("        result.{}.push_back({});\n", field_name, element_read));
                 array_code.push_str("    } while (");
                 // Generate condition - negated because we continue while condition is false
@@ -419,7 +825,17 @@ impl CppBackend {
             }
             LirOperation::ReadStruct { dest, type_name } => {
                 let field_name = var_to_field.get(dest).map(|s| s.as_str()).unwrap_or("unknown");
-                format!("    result.{} = {}::read(reader);\n", field_name, type_name)
+                format!("    result.{} = {};\n", field_name, struct_read(order, type_name))
+            }
+            LirOperation::ReadSizedStruct { dest, type_name, size_var } => {
+                let field_name = var_to_field.get(dest).map(|s| s.as_str()).unwrap_or("unknown");
+                let size_field = var_to_field.get(size_var).map(|s| s.as_str()).unwrap_or("unknown");
+                format!(
+                    "    {{\n        auto window = reader.window(result.{});\n        result.{} = {};\n    }}\n",
+                    size_field,
+                    field_name,
+                    struct_read_from(order, type_name, "window")
+                )
             }
             LirOperation::ReadFixedString { dest, length } => {
                 let field_name = var_to_field.get(dest).map(|s| s.as_str()).unwrap_or("unknown");
@@ -427,7 +843,7 @@ impl CppBackend {
                 code.push_str("    {\n");
                 code.push_str(&format!("        std::vector<uint8_t> bytes({});\n", length));
                 code.push_str(&format!("        for (size_t i = 0; i < {}; ++i) {{\n", length));
-                code.push_str("            bytes[i] = reader.read_le<uint8_t>();\n");
+                code.push_str("            bytes[i] = reader.template read_le<uint8_t>();\n");
                 code.push_str("        }\n");
                 code.push_str(&format!("        result.{} = std::string(reinterpret_cast<const char*>(bytes.data()), bytes.size());\n", field_name));
                 code.push_str("    }\n");
@@ -440,9 +856,10 @@ impl CppBackend {
                 code.push_str("    {\n");
                 code.push_str("        std::vector<uint8_t> bytes;\n");
                 code.push_str("        uint8_t byte;\n");
-                code.push_str("        while ((byte = reader.read_le<uint8_t>()) != 0) {\n");
+                code.push_str("        while ((byte = reader.template read_le<uint8_t>()) != 0) {\n");
                 code.push_str("            bytes.push_back(byte);\n");
                 code.push_str("        }\n");
+                code.push_str("        reader.charge(bytes.size(), 1);\n");
                 code.push_str(&format!("        result.{} = std::string(reinterpret_cast<const char*>(bytes.data()), bytes.size());\n", field_name));
                 code.push_str("    }\n");
                 add_assertion(&mut code, dest);
@@ -453,9 +870,10 @@ impl CppBackend {
                 let length_field = var_to_field.get(length_var).map(|s| s.as_str()).unwrap_or("unknown");
                 let mut code = String::new();
                 code.push_str("    {\n");
+                code.push_str(&format!("        reader.admit(result.{}, 1, 1);\n", length_field));
                 code.push_str(&format!("        std::vector<uint8_t> bytes(result.{});\n", length_field));
                 code.push_str(&format!("        for (size_t i = 0; i < result.{}; ++i) {{\n", length_field));
-                code.push_str("            bytes[i] = reader.read_le<uint8_t>();\n");
+                code.push_str("            bytes[i] = reader.template read_le<uint8_t>();\n");
                 code.push_str("        }\n");
                 code.push_str(&format!("        result.{} = std::string(reinterpret_cast<const char*>(bytes.data()), bytes.size());\n", field_name));
                 code.push_str("    }\n");
@@ -466,9 +884,10 @@ impl CppBackend {
                 let field_name = var_to_field.get(dest).map(|s| s.as_str()).unwrap_or("unknown");
                 let size_field = var_to_field.get(size_var).map(|s| s.as_str()).unwrap_or("unknown");
                 let mut code = String::new();
+                code.push_str(&format!("    reader.admit(result.{}, 1, 1);\n", size_field));
                 code.push_str(&format!("    result.{}.resize(result.{});\n", field_name, size_field));
                 code.push_str(&format!("    for (size_t i = 0; i < result.{}; ++i) {{\n", size_field));
-                code.push_str(&format!("        result.{}[i] = reader.read_le<uint8_t>();\n", field_name));
+                code.push_str(&format!("        result.{}[i] = reader.template read_le<uint8_t>();\n", field_name));
                 code.push_str("    }\n");
                 add_assertion(&mut code, dest);
                 code
@@ -524,31 +943,38 @@ impl CppBackend {
     }
 
     fn generate_array_element_read(&self, op: &LirOperation, endianness: Endianness) -> Result<String> {
-        let endian_suffix = match endianness {
-            Endianness::Little => "_le",
-            Endianness::Big => "_be",
-            Endianness::Native => "_le",
-        };
+        let order = op.endianness().unwrap_or(endianness);
 
         Ok(match op {
-            LirOperation::ReadU8 { .. } => "reader.read_le<uint8_t>()".to_string(),
-            LirOperation::ReadU16 { .. } => format!("reader.read{}<uint16_t>()", endian_suffix),
-            LirOperation::ReadU32 { .. } => format!("reader.read{}<uint32_t>()", endian_suffix),
-            LirOperation::ReadU64 { .. } => format!("reader.read{}<uint64_t>()", endian_suffix),
-            LirOperation::ReadI8 { .. } => "reader.read_le<int8_t>()".to_string(),
-            LirOperation::ReadI16 { .. } => format!("reader.read{}<int16_t>()", endian_suffix),
-            LirOperation::ReadI32 { .. } => format!("reader.read{}<int32_t>()", endian_suffix),
-            LirOperation::ReadI64 { .. } => format!("reader.read{}<int64_t>()", endian_suffix),
-            LirOperation::ReadStruct { type_name, .. } => format!("{}::read(reader)", type_name),
+            LirOperation::ReadU8 { .. } => "reader.template read_le<uint8_t>()".to_string(),
+            LirOperation::ReadU16 { .. } => read_call(order, "uint16_t"),
+            LirOperation::ReadU32 { .. } => read_call(order, "uint32_t"),
+            LirOperation::ReadU64 { .. } => read_call(order, "uint64_t"),
+            LirOperation::ReadI8 { .. } => "reader.template read_le<int8_t>()".to_string(),
+            LirOperation::ReadI16 { .. } => read_call(order, "int16_t"),
+            LirOperation::ReadI32 { .. } => read_call(order, "int32_t"),
+            LirOperation::ReadI64 { .. } => read_call(order, "int64_t"),
+            LirOperation::ReadStruct { type_name, .. } => struct_read(order, type_name),
             _ => "/* unsupported */".to_string(),
         })
     }
 
-    fn generate_write_impl(&self, lir_type: &LirType, endianness: Endianness, enums: &[HirEnum]) -> Result<String> {
-        let mut code = format!("inline void {}::write(Writer& writer) const {{\n", lir_type.name);
+    /// write(), or with `parallel` set, write_parallel(): the same encoding with arrays of
+    /// structs handed to the runtime's write_each_parallel()
+    fn generate_write_impl(&self, lir_type: &LirType, endianness: Endianness, enums: &[HirEnum], parallel: bool) -> Result<String> {
+        let mut code = if endianness == Endianness::Runtime {
+            format!("template<std::endian Order>\ninline void {}::write_in(Writer& writer) const {{\n", lir_type.name)
+        } else {
+            if parallel {
+                format!("inline void {}::write_parallel(Writer& writer, size_t threads) const {{\n", lir_type.name)
+            } else {
+                format!("inline void {}::write(Writer& writer) const {{\n", lir_type.name)
+            }
+        };
 
         let mut var_to_field: HashMap<VarId, String> = HashMap::new();
         let mut in_write_section = false;
+        let mut pending_bits = false;
 
         // Build enum map: enum_name -> underlying_type
         let mut enum_types = HashMap::new();
@@ -559,7 +985,45 @@ impl CppBackend {
         // Check if we need BitWriter (if any WriteBits operations exist)
         let has_write_bits = lir_type.operations.iter().any(|op| matches!(op, LirOperation::WriteBits { .. }));
         if has_write_bits {
-            code.push_str("    static BitWriter bit_writer(writer);\n");
+            code.push_str("    BitWriter bit_writer(writer);\n");
+        }
+
+        // Checksum fields are written from the accumulated value, not the stored member
+        let checksum_fields = checksum_fields(&lir_type.fields);
+        let covered = covered_fields(&checksum_fields);
+        let mut overrides = HashMap::new();
+        if !checksum_fields.is_empty() {
+            for field in &checksum_fields {
+                code.push_str(&format!("    {} {}_checksum;\n", checksum_class(field), field.name));
+                overrides.insert(field.name.clone(), format!("{}_checksum.value()", field.name));
+            }
+            code.push_str("    size_t checksum_mark = 0;\n");
+        }
+
+        // Length and count fields are written from the containers they describe
+        for field in lir_type.fields.iter().filter(|f| !f.length_of.is_empty()) {
+            let sized: Vec<&str> = field
+                .length_of
+                .iter()
+                .filter_map(|var| lir_type.fields.iter().find(|f| f.var_id == *var))
+                .map(|f| f.name.as_str())
+                .collect();
+            code.push_str(&format!(
+                "    const auto derived_{name} = checked_length<{ty}>({first}.size(), \"{owner}.{name}\");\n",
+                name = field.name,
+                ty = self.lir_type_to_cpp_type(&field.type_info),
+                first = sized[0],
+                owner = lir_type.name,
+            ));
+            for other in &sized[1..] {
+                code.push_str(&format!(
+                    "    if ({other}.size() != {first}.size()) {{\n        throw WriteError(\"{owner}.{other}: size differs from {first}, which shares {name}\");\n    }}\n",
+                    first = sized[0],
+                    owner = lir_type.name,
+                    name = field.name,
+                ));
+            }
+            overrides.insert(field.name.clone(), format!("derived_{}", field.name));
         }
 
         for op in &lir_type.operations {
@@ -572,7 +1036,27 @@ impl CppBackend {
             }
 
             if in_write_section {
-                code.push_str(&self.generate_write_operation(op, &var_to_field, &lir_type.fields, &enum_types, endianness)?);
+                // A partial byte of bitfields is padded out before the next byte-aligned field
+                let writes_bits = matches!(op, LirOperation::WriteBits { .. });
+                if has_write_bits && !writes_bits && pending_bits {
+                    code.push_str("    bit_writer.flush();\n");
+                }
+                pending_bits = writes_bits;
+
+                let accumulators = write_op_field_name(op, &var_to_field, &lir_type.fields)
+                    .and_then(|name| covered.get(&name));
+
+                if accumulators.is_some() {
+                    code.push_str("    checksum_mark = writer.position();\n");
+                }
+
+                code.push_str(&self.generate_write_operation(op, &var_to_field, &lir_type.fields, &enum_types, &overrides, endianness, parallel)?);
+
+                if let Some(accumulators) = accumulators {
+                    for accumulator in accumulators {
+                        code.push_str(&format!("    {}_checksum.update(writer.bytes_since(checksum_mark));\n", accumulator));
+                    }
+                }
             }
         }
 
@@ -587,23 +1071,23 @@ impl CppBackend {
         var_to_field: &HashMap<VarId, String>,
         fields: &[LirField],
         enum_types: &HashMap<String, HirPrimitiveType>,
+        overrides: &HashMap<String, String>,
         endianness: Endianness,
+        parallel: bool,
     ) -> Result<String> {
-        let endian_suffix = match endianness {
-            Endianness::Little => "_le",
-            Endianness::Big => "_be",
-            Endianness::Native => "_le",
-        };
+        let order = op.endianness().unwrap_or(endianness);
 
         // Helper to find if a field is an enum and return cast string
         let get_field_with_cast = |src: &VarId, cpp_type: &str| -> String {
-            let field_name = var_to_field.get(src).map(|s| s.as_str()).unwrap_or("unknown");
-            if let Some(field) = fields.iter().find(|f| var_to_field.get(&f.var_id).map(|s| s.as_str()) == Some(field_name)) {
-                if enum_types.contains_key(&field.type_info) {
-                    return format!("static_cast<{}>({})", cpp_type, field_name);
-                }
+            let member = var_to_field.get(src).map(|s| s.as_str()).unwrap_or("unknown");
+            let field = fields.iter().find(|f| member_expr(f) == member);
+            if let Some(value_expr) = field.and_then(|f| overrides.get(&f.name)) {
+                return value_expr.clone();
+            }
+            if field.is_some_and(|f| enum_types.contains_key(&f.type_info)) {
+                return format!("static_cast<{}>({})", cpp_type, member);
             }
-            field_name.to_string()
+            member.to_string()
         };
 
         Ok(match op {
@@ -613,15 +1097,15 @@ impl CppBackend {
             }
             LirOperation::WriteU16 { src, .. } => {
                 let value_expr = get_field_with_cast(src, "uint16_t");
-                format!("    writer.write{}({});\n", endian_suffix, value_expr)
+                format!("    {};\n", write_call(order, &value_expr))
             }
             LirOperation::WriteU32 { src, .. } => {
                 let value_expr = get_field_with_cast(src, "uint32_t");
-                format!("    writer.write{}({});\n", endian_suffix, value_expr)
+                format!("    {};\n", write_call(order, &value_expr))
             }
             LirOperation::WriteU64 { src, .. } => {
                 let value_expr = get_field_with_cast(src, "uint64_t");
-                format!("    writer.write{}({});\n", endian_suffix, value_expr)
+                format!("    {};\n", write_call(order, &value_expr))
             }
             LirOperation::WriteI8 { src } => {
                 let value_expr = get_field_with_cast(src, "int8_t");
@@ -629,52 +1113,74 @@ impl CppBackend {
             }
             LirOperation::WriteI16 { src, .. } => {
                 let value_expr = get_field_with_cast(src, "int16_t");
-                format!("    writer.write{}({});\n", endian_suffix, value_expr)
+                format!("    {};\n", write_call(order, &value_expr))
             }
             LirOperation::WriteI32 { src, .. } => {
                 let value_expr = get_field_with_cast(src, "int32_t");
-                format!("    writer.write{}({});\n", endian_suffix, value_expr)
+                format!("    {};\n", write_call(order, &value_expr))
             }
             LirOperation::WriteI64 { src, .. } => {
                 let value_expr = get_field_with_cast(src, "int64_t");
-                format!("    writer.write{}({});\n", endian_suffix, value_expr)
+                format!("    {};\n", write_call(order, &value_expr))
             }
             LirOperation::WriteArray { src, element_op, count } => {
                 let field_name = var_to_field.get(src).map(|s| s.as_str()).unwrap_or("unknown");
-                let mut array_code = format!("    for (size_t i = 0; i < {}; ++i) {{\n", count);
-                let element_write = self.generate_array_element_write(element_op, field_name, endianness)?;
-                array_code.push_str(&format!("        {};\n", element_write));
-                array_code.push_str("    }\n");
-                array_code
+                self.generate_array_write(element_op, field_name, &count.to_string(), endianness, parallel)?
             }
-            LirOperation::WriteDynamicArray { src, element_op, size_field_name, .. } => {
+            LirOperation::WriteDynamicArray { src, element_op, size_var, size_field_name } => {
                 let field_name = var_to_field.get(src).map(|s| s.as_str()).unwrap_or("unknown");
-                let mut array_code = format!("    for (size_t i = 0; i < {}; ++i) {{\n", size_field_name);
-                let element_write = self.generate_array_element_write(element_op, field_name, endianness)?;
-                array_code.push_str(&format!("        {};\n", element_write));
-                array_code.push_str("    }\n");
+                let mut array_code = String::new();
+                // A count that is not derived on write is stored as given, so it has to match
+                let size_field = fields.iter().find(|f| f.var_id == *size_var);
+                if let Some(size_field) = size_field.filter(|f| !overrides.contains_key(&f.name)) {
+                    array_code.push_str(&format!(
+                        "    if ({}.size() != static_cast<size_t>({})) {{\n        throw WriteError(\"{}: size differs from {}\");\n    }}\n",
+                        field_name,
+                        member_expr(size_field),
+                        field_name.trim_start_matches("(*").trim_end_matches(')'),
+                        size_field_name
+                    ));
+                }
+                array_code.push_str(&self.generate_array_write(
+                    element_op,
+                    field_name,
+                    &format!("{}.size()", field_name),
+                    endianness,
+                    parallel,
+                )?);
                 array_code
             }
             LirOperation::WriteUntilEofArray { src, element_op } => {
                 let field_name = var_to_field.get(src).map(|s| s.as_str()).unwrap_or("unknown");
-                let mut array_code = format!("    for (size_t i = 0; i < {}.size(); ++i) {{\n", field_name);
-                let element_write = self.generate_array_element_write(element_op, field_name, endianness)?;
-                array_code.push_str(&format!("        {};\n", element_write));
-                array_code.push_str("    }\n");
-                array_code
+                self.generate_array_write(element_op, field_name, &format!("{}.size()", field_name), endianness, parallel)?
             }
             LirOperation::WriteUntilConditionArray { src, element_op } => {
                 // Same as WriteUntilEofArray - just write all elements in the array
                 let field_name = var_to_field.get(src).map(|s| s.as_str()).unwrap_or("unknown");
-                let mut array_code = format!("    for (size_t i = 0; i < {}.size(); ++i) {{\n", field_name);
-                let element_write = self.generate_array_element_write(element_op, field_name, endianness)?;
-                array_code.push_str(&format!("        {};\n", element_write));
-                array_code.push_str("    }\n");
-                array_code
+                self.generate_array_write(element_op, field_name, &format!("{}.size()", field_name), endianness, parallel)?
             }
             LirOperation::WriteStruct { src, .. } => {
                 let field_name = var_to_field.get(src).map(|s| s.as_str()).unwrap_or("unknown");
-                format!("    {}.write(writer);\n", field_name)
+                format!("    {};\n", struct_write(order, field_name))
+            }
+            LirOperation::WriteSizedStruct { src, size_var, .. } => {
+                let field_name = var_to_field.get(src).map(|s| s.as_str()).unwrap_or("unknown");
+                let size_field = fields.iter().find(|f| f.var_id == *size_var);
+                let size = size_field
+                    .map(|f| overrides.get(&f.name).cloned().unwrap_or_else(|| member_expr(f)))
+                    .unwrap_or_else(|| "unknown".to_string());
+                // The window keeps the size it was given; the struct has to fit inside it
+                let mut code = String::from("    {\n");
+                code.push_str(&format!("        const size_t window_end = writer.position() + static_cast<size_t>({});\n", size));
+                code.push_str(&format!("        {};\n", struct_write(order, field_name)));
+                code.push_str(&format!(
+                    "        if (writer.position() > window_end) {{\n            throw WriteError(\"{}: does not fit in the {} bytes of its window\");\n        }}\n",
+                    field_name.trim_start_matches("(*").trim_end_matches(')'),
+                    size_field.map_or("unknown", |f| f.name.as_str())
+                ));
+                code.push_str("        writer.write_padding(window_end - writer.position());\n");
+                code.push_str("    }\n");
+                code
             }
             LirOperation::WriteFixedString { src, length } => {
                 let field_name = var_to_field.get(src).map(|s| s.as_str()).unwrap_or("unknown");
@@ -703,11 +1209,7 @@ impl CppBackend {
             }
             LirOperation::WriteBlob { src } => {
                 let field_name = var_to_field.get(src).map(|s| s.as_str()).unwrap_or("unknown");
-                let mut code = String::new();
-                code.push_str(&format!("    for (size_t i = 0; i < {}.size(); ++i) {{\n", field_name));
-                code.push_str(&format!("        writer.write_le({}[i]);\n", field_name));
-                code.push_str("    }\n");
-                code
+                format!("    writer.write_bytes({});\n", field_name)
             }
             LirOperation::WriteBits { src, num_bits } => {
                 let field_name = var_to_field.get(src).map(|s| s.as_str()).unwrap_or("unknown");
@@ -738,12 +1240,13 @@ impl CppBackend {
                     // Special handling for AccessField - update local mapping
                     if let LirOperation::AccessField { dest, field_index, .. } = inner_op {
                         if *field_index < fields.len() {
-                            local_var_to_field.insert(*dest, fields[*field_index].name.clone());
+                            local_var_to_field.insert(*dest, member_expr(&fields[*field_index]));
                         }
                         continue; // Don't generate code for AccessField itself
                     }
 
-                    let inner_code = self.generate_write_operation(inner_op, &local_var_to_field, fields, enum_types, endianness)?;
+                    let inner_code =
+                        self.generate_write_operation(inner_op, &local_var_to_field, fields, enum_types, overrides, endianness, parallel)?;
                     // Indent the inner code by one level
                     for line in inner_code.lines() {
                         if !line.is_empty() {
@@ -761,28 +1264,558 @@ impl CppBackend {
         })
     }
 
+    /// Loop writing `count` elements; write_parallel() hands arrays of structs to the runtime
+    fn generate_array_write(
+        &self,
+        element_op: &LirOperation,
+        field_name: &str,
+        count: &str,
+        endianness: Endianness,
+        parallel: bool,
+    ) -> Result<String> {
+        if let (true, LirOperation::WriteStruct { type_name, .. }) = (parallel, element_op) {
+            return Ok(format!(
+                "    write_each_parallel(writer, std::span<const {}>({}), threads);\n",
+                type_name, field_name
+            ));
+        }
+        let element_write = self.generate_array_element_write(element_op, field_name, endianness)?;
+        Ok(format!("    for (size_t i = 0; i < {}; ++i) {{\n        {};\n    }}\n", count, element_write))
+    }
+
     fn generate_array_element_write(&self, op: &LirOperation, field_name: &str, endianness: Endianness) -> Result<String> {
-        let endian_suffix = match endianness {
-            Endianness::Little => "_le",
-            Endianness::Big => "_be",
-            Endianness::Native => "_le",
-        };
+        let order = op.endianness().unwrap_or(endianness);
 
         Ok(match op {
             LirOperation::WriteU8 { .. } => format!("writer.write_le({}[i])", field_name),
-            LirOperation::WriteU16 { .. } => format!("writer.write{}({}[i])", endian_suffix, field_name),
-            LirOperation::WriteU32 { .. } => format!("writer.write{}({}[i])", endian_suffix, field_name),
-            LirOperation::WriteU64 { .. } => format!("writer.write{}({}[i])", endian_suffix, field_name),
+            LirOperation::WriteU16 { .. } => write_call(order, &format!("{}[i]", field_name)),
+            LirOperation::WriteU32 { .. } => write_call(order, &format!("{}[i]", field_name)),
+            LirOperation::WriteU64 { .. } => write_call(order, &format!("{}[i]", field_name)),
             LirOperation::WriteI8 { .. } => format!("writer.write_le({}[i])", field_name),
-            LirOperation::WriteI16 { .. } => format!("writer.write{}({}[i])", endian_suffix, field_name),
-            LirOperation::WriteI32 { .. } => format!("writer.write{}({}[i])", endian_suffix, field_name),
-            LirOperation::WriteI64 { .. } => format!("writer.write{}({}[i])", endian_suffix, field_name),
-            LirOperation::WriteStruct { .. } => format!("{}[i].write(writer)", field_name),
+            LirOperation::WriteI16 { .. } => write_call(order, &format!("{}[i]", field_name)),
+            LirOperation::WriteI32 { .. } => write_call(order, &format!("{}[i]", field_name)),
+            LirOperation::WriteI64 { .. } => write_call(order, &format!("{}[i]", field_name)),
+            LirOperation::WriteStruct { .. } => struct_write(order, &format!("{}[i]", field_name)),
             _ => "/* unsupported */".to_string(),
         })
     }
 }
 
+/// Wire size of a top-level read that does not depend on the data
+pub(crate) fn fixed_read_size(op: &LirOperation) -> Option<usize> {
+    match op {
+        LirOperation::ReadArray { element_op, count, .. } => primitive_read_size(element_op).map(|size| size * count),
+        LirOperation::ReadFixedString { length, .. } => Some(*length),
+        LirOperation::PadFixed { bytes } => Some(*bytes),
+        other => primitive_read_size(other),
+    }
+}
+
+fn is_fixed_or_bits(op: &LirOperation) -> bool {
+    fixed_read_size(op).is_some() || matches!(op, LirOperation::ReadBits { .. })
+}
+
+/// Bytes covered by the leading run of fixed-size and bitfield reads
+fn fixed_run_size(ops: &[&LirOperation]) -> usize {
+    let mut bytes = 0;
+    let mut bits = 0;
+    for op in ops {
+        match op {
+            LirOperation::ReadBits { num_bits, .. } => bits += usize::from(*num_bits),
+            other => match fixed_read_size(other) {
+                Some(size) => {
+                    bytes += bits.div_ceil(8) + size;
+                    bits = 0;
+                }
+                None => break,
+            },
+        }
+    }
+    bytes + bits.div_ceil(8)
+}
+
+/// C++ type and fewest encoded bytes of an array element
+pub(crate) fn element_layout(element_op: &LirOperation) -> (String, String) {
+    let cpp_type = match element_op {
+        LirOperation::ReadStruct { type_name, .. } => return (type_name.clone(), format!("{}::min_encoded_size", type_name)),
+        LirOperation::ReadU8 { .. } => "uint8_t",
+        LirOperation::ReadU16 { .. } => "uint16_t",
+        LirOperation::ReadU32 { .. } => "uint32_t",
+        LirOperation::ReadU64 { .. } => "uint64_t",
+        LirOperation::ReadI8 { .. } => "int8_t",
+        LirOperation::ReadI16 { .. } => "int16_t",
+        LirOperation::ReadI32 { .. } => "int32_t",
+        LirOperation::ReadI64 { .. } => "int64_t",
+        _ => return ("uint8_t".to_string(), "0".to_string()),
+    };
+    (cpp_type.to_string(), primitive_read_size(element_op).unwrap_or(0).to_string())
+}
+
+/// Struct elements of a fixed-order format can be recovered from (they have skip())
+fn recoverable_element(element_op: &LirOperation, endianness: Endianness) -> Option<&str> {
+    match element_op {
+        LirOperation::ReadStruct { type_name, .. } if endianness != Endianness::Runtime => Some(type_name),
+        _ => None,
+    }
+}
+
+/// `admit(...)` call for `count` elements, made before the array is allocated
+fn admit_elements(count: &str, element_op: &LirOperation) -> String {
+    let (cpp_type, min_size) = element_layout(element_op);
+    format!("admit({}, {}, sizeof({}))", count, min_size, cpp_type)
+}
+
+/// Limits check before each element of an array that grows as it is read
+fn admit_next(target: &str, element_op: &LirOperation, indent: &str) -> String {
+    let (cpp_type, _) = element_layout(element_op);
+    format!("{}reader.admit_next({}.size(), sizeof({}));\n", indent, target, cpp_type)
+}
+
+/// lcm of the `align:` boundaries in the struct's encoding, nested structs included, as a C++
+/// constant expression; 1 when nothing is aligned
+fn passthrough_alignment(lir_type: &LirType) -> String {
+    fn collect(op: &LirOperation, boundaries: &mut Vec<usize>, nested: &mut Vec<String>) {
+        match op {
+            LirOperation::Align { boundary } if *boundary > 1 => boundaries.push(*boundary),
+            LirOperation::ReadStruct { type_name, .. } | LirOperation::ReadSizedStruct { type_name, .. } => {
+                if !nested.contains(type_name) {
+                    nested.push(type_name.clone());
+                }
+            }
+            LirOperation::ReadArray { element_op, .. }
+            | LirOperation::ReadDynamicArray { element_op, .. }
+            | LirOperation::ReadUntilEofArray { element_op, .. }
+            | LirOperation::ReadUntilConditionArray { element_op, .. } => collect(element_op, boundaries, nested),
+            LirOperation::ConditionalBlock { true_ops, .. } => {
+                for op in true_ops {
+                    collect(op, boundaries, nested);
+                }
+            }
+            _ => {}
+        }
+    }
+
+    let mut boundaries = Vec::new();
+    let mut nested = Vec::new();
+    for op in lir_type.operations.iter().take_while(|op| !matches!(op, LirOperation::CreateStruct { .. })) {
+        collect(op, &mut boundaries, &mut nested);
+    }
+    let own = boundaries.into_iter().fold(1, |a, b| a / gcd(a, b) * b);
+    let mut terms = nested.iter().map(|type_name| format!("{}::passthrough_alignment", type_name));
+    let first = if own == 1 { terms.next() } else { None };
+    terms.fold(first.unwrap_or_else(|| own.to_string()), |expr, term| format!("std::lcm<size_t>({}, {})", expr, term))
+}
+
+fn gcd(a: usize, b: usize) -> usize {
+    if b == 0 { a } else { gcd(b, a % b) }
+}
+
+/// Fewest bytes any encoding of the struct takes, as a C++ constant expression: fixed-size
+/// fields in full, nested structs by their own minimum, and data-sized or conditional
+/// fields as nothing
+fn min_encoded_size(lir_type: &LirType) -> String {
+    let mut bytes = 0;
+    let mut bits = 0;
+    let mut terms = Vec::new();
+    let reads = lir_type.operations.iter().take_while(|op| !matches!(op, LirOperation::CreateStruct { .. }));
+    for op in reads {
+        if let LirOperation::ReadBits { num_bits, .. } = op {
+            bits += usize::from(*num_bits);
+            continue;
+        }
+        // Bitfields are padded out to a byte before the next field
+        bytes += bits.div_ceil(8);
+        bits = 0;
+        match op {
+            LirOperation::ReadStruct { type_name, .. } | LirOperation::ReadSizedStruct { type_name, .. } => {
+                terms.push(format!("{}::min_encoded_size", type_name))
+            }
+            LirOperation::ReadArray { element_op, count, .. } => match &**element_op {
+                LirOperation::ReadStruct { type_name, .. } => {
+                    terms.push(format!("{} * {}::min_encoded_size", count, type_name))
+                }
+                other => bytes += primitive_read_size(other).unwrap_or(0) * count,
+            },
+            // At least the terminating element
+            LirOperation::ReadUntilConditionArray { element_op, .. } => match &**element_op {
+                LirOperation::ReadStruct { type_name, .. } => terms.push(format!("{}::min_encoded_size", type_name)),
+                other => bytes += primitive_read_size(other).unwrap_or(0),
+            },
+            LirOperation::ReadNullTerminatedString { .. } => bytes += 1,
+            other => bytes += fixed_read_size(other).unwrap_or(0),
+        }
+    }
+    bytes += bits.div_ceil(8);
+    if bytes > 0 || terms.is_empty() {
+        terms.insert(0, bytes.to_string());
+    }
+    terms.join(" + ")
+}
+
+/// Encoded size of a fixed-width element read, if known
+pub(crate) fn primitive_read_size(op: &LirOperation) -> Option<usize> {
+    match op {
+        LirOperation::ReadU8 { .. } | LirOperation::ReadI8 { .. } => Some(1),
+        LirOperation::ReadU16 { .. } | LirOperation::ReadI16 { .. } => Some(2),
+        LirOperation::ReadU32 { .. } | LirOperation::ReadI32 { .. } => Some(4),
+        LirOperation::ReadU64 { .. } | LirOperation::ReadI64 { .. } => Some(8),
+        _ => None,
+    }
+}
+
+/// Wire bytes of a struct's leading `equals` assertion, if it has one
+fn signature_bytes(lir_type: &LirType, endianness: Endianness, enums: &[HirEnum]) -> Option<Vec<u8>> {
+    let first = lir_type.fields.first()?;
+    if first.skip.is_some() || first.is_optional || first.instance.is_some() {
+        return None;
+    }
+
+    match first.assertion.as_ref()? {
+        HirAssertion::Equals(HirAssertValue::IntArray(values)) => {
+            // Only byte arrays have a well-defined wire image
+            if !first.type_info.starts_with("u8[") && !first.type_info.starts_with("i8[") {
+                return None;
+            }
+            Some(values.iter().map(|v| *v as u8).collect())
+        }
+        HirAssertion::Equals(HirAssertValue::Int(value)) => {
+            let underlying = enums
+                .iter()
+                .find(|e| e.name == first.type_info)
+                .map(|e| e.underlying_type);
+            let width = match (first.type_info.as_str(), underlying) {
+                ("u8" | "i8", _) | (_, Some(HirPrimitiveType::U8 | HirPrimitiveType::I8)) => 1,
+                ("u16" | "i16", _) | (_, Some(HirPrimitiveType::U16 | HirPrimitiveType::I16)) => 2,
+                ("u32" | "i32", _) | (_, Some(HirPrimitiveType::U32 | HirPrimitiveType::I32)) => 4,
+                ("u64" | "i64", _) | (_, Some(HirPrimitiveType::U64 | HirPrimitiveType::I64)) => 8,
+                _ => return None,
+            };
+            let le = (*value as u64).to_le_bytes();
+            let mut bytes = le[..width].to_vec();
+            let endianness = lir_type.operations.first().and_then(LirOperation::endianness).unwrap_or(endianness);
+            if endianness == Endianness::Runtime {
+                return None;
+            }
+            if endianness == Endianness::Big {
+                bytes.reverse();
+            }
+            Some(bytes)
+        }
+        _ => None,
+    }
+}
+
+/// Reader/Writer method suffix for a byte order; native order is written as little-endian.
+/// Runtime-ordered formats go through `read_call`/`write_call` instead.
+pub(crate) fn endian_suffix(endianness: Endianness) -> &'static str {
+    match endianness {
+        Endianness::Little | Endianness::Native => "_le",
+        Endianness::Big => "_be",
+        Endianness::Runtime => unreachable!("runtime byte order has no fixed suffix"),
+    }
+}
+
+/// Read of one scalar; runtime-ordered reads use the `Order` parameter of `read_in`
+pub(crate) fn read_call(endianness: Endianness, cpp_type: &str) -> String {
+    match endianness {
+        Endianness::Runtime => format!("reader.template read<Order, {}>()", cpp_type),
+        fixed => format!("reader.template read{}<{}>()", endian_suffix(fixed), cpp_type),
+    }
+}
+
+fn write_call(endianness: Endianness, value: &str) -> String {
+    match endianness {
+        Endianness::Runtime => format!("writer.write<Order>({})", value),
+        fixed => format!("writer.write{}({})", endian_suffix(fixed), value),
+    }
+}
+
+/// Nested structs of a runtime-ordered format are read and written in the caller's order
+fn struct_read(endianness: Endianness, type_name: &str) -> String {
+    struct_read_from(endianness, type_name, "reader")
+}
+
+fn struct_read_from(endianness: Endianness, type_name: &str, reader: &str) -> String {
+    match endianness {
+        Endianness::Runtime => format!("{}::read_in<Order>({})", type_name, reader),
+        _ => format!("{}::read({})", type_name, reader),
+    }
+}
+
+fn struct_write(endianness: Endianness, value: &str) -> String {
+    match endianness {
+        Endianness::Runtime => format!("{}.write_in<Order>(writer)", value),
+        _ => format!("{}.write(writer)", value),
+    }
+}
+
+pub(crate) fn checksum_fields(fields: &[LirField]) -> Vec<&LirField> {
+    fields.iter().filter(|f| f.checksum.is_some()).collect()
+}
+
+/// Map each covered field to the checksum fields that accumulate its bytes
+pub(crate) fn covered_fields(checksum_fields: &[&LirField]) -> HashMap<String, Vec<String>> {
+    let mut covered: HashMap<String, Vec<String>> = HashMap::new();
+    for field in checksum_fields {
+        if let Some(ref checksum) = field.checksum {
+            for name in &checksum.over {
+                covered.entry(name.clone()).or_default().push(field.name.clone());
+            }
+        }
+    }
+    covered
+}
+
+pub(crate) fn checksum_class(field: &LirField) -> &'static str {
+    match field.checksum.as_ref().map(|c| c.algorithm) {
+        Some(ChecksumAlgorithm::Adler32) => "Adler32",
+        _ => "Crc32",
+    }
+}
+
+/// Field populated by a top-level read operation (conditional blocks hold a single field)
+pub(crate) fn op_field_name<'a>(op: &LirOperation, var_to_field: &'a HashMap<VarId, String>) -> Option<&'a str> {
+    let dest = match op {
+        LirOperation::ReadU8 { dest }
+        | LirOperation::ReadU16 { dest, .. }
+        | LirOperation::ReadU32 { dest, .. }
+        | LirOperation::ReadU64 { dest, .. }
+        | LirOperation::ReadI8 { dest }
+        | LirOperation::ReadI16 { dest, .. }
+        | LirOperation::ReadI32 { dest, .. }
+        | LirOperation::ReadI64 { dest, .. }
+        | LirOperation::ReadArray { dest, .. }
+        | LirOperation::ReadDynamicArray { dest, .. }
+        | LirOperation::ReadUntilEofArray { dest, .. }
+        | LirOperation::ReadUntilConditionArray { dest, .. }
+        | LirOperation::ReadStruct { dest, .. }
+        | LirOperation::ReadSizedStruct { dest, .. }
+        | LirOperation::ReadFixedString { dest, .. }
+        | LirOperation::ReadNullTerminatedString { dest }
+        | LirOperation::ReadLengthPrefixedString { dest, .. }
+        | LirOperation::ReadBlob { dest, .. }
+        | LirOperation::ReadBits { dest, .. } => dest,
+        LirOperation::ConditionalBlock { true_ops, .. } => {
+            return true_ops.first().and_then(|inner| op_field_name(inner, var_to_field));
+        }
+        _ => return None,
+    };
+    var_to_field.get(dest).map(|s| s.as_str())
+}
+
+/// Hooks::on_field() after a field is read; padding and skipped ranges only move the mark
+fn field_hook(lir_type: &LirType, field_name: Option<&str>) -> String {
+    let field = field_name.and_then(|name| visit_codegen::visited_fields(lir_type).find(|f| f.name == name));
+    let Some(field) = field else {
+        return "    if constexpr (Hooks::enabled) {\n        hook_mark = reader.position();\n    }\n".to_string();
+    };
+    let report = format!(
+        "Hooks::on_field(FieldId::{}, reader.position() - hook_mark);",
+        visit_codegen::field_id(&lir_type.name, &field.name)
+    );
+    if field.is_optional {
+        format!(
+            "    if constexpr (Hooks::enabled) {{\n        if (result.{}) {{\n            {report}\n        }}\n        hook_mark = reader.position();\n    }}\n",
+            field.name
+        )
+    } else {
+        format!("    if constexpr (Hooks::enabled) {{\n        {report}\n        hook_mark = reader.position();\n    }}\n")
+    }
+}
+
+/// Whether write_parallel() has anything to split: an array of structs, possibly optional
+fn has_struct_array(lir_type: &LirType) -> bool {
+    fn struct_array(op: &LirOperation) -> bool {
+        match op {
+            LirOperation::WriteArray { element_op, .. }
+            | LirOperation::WriteDynamicArray { element_op, .. }
+            | LirOperation::WriteUntilEofArray { element_op, .. }
+            | LirOperation::WriteUntilConditionArray { element_op, .. } => {
+                matches!(**element_op, LirOperation::WriteStruct { .. })
+            }
+            LirOperation::ConditionalBlock { true_ops, .. } => true_ops.iter().any(struct_array),
+            _ => false,
+        }
+    }
+    lir_type.operations.iter().any(struct_array)
+}
+
+/// Encoded size of a fixed-width element write
+fn primitive_write_size(op: &LirOperation) -> Option<usize> {
+    match op {
+        LirOperation::WriteU8 { .. } | LirOperation::WriteI8 { .. } => Some(1),
+        LirOperation::WriteU16 { .. } | LirOperation::WriteI16 { .. } => Some(2),
+        LirOperation::WriteU32 { .. } | LirOperation::WriteI32 { .. } => Some(4),
+        LirOperation::WriteU64 { .. } | LirOperation::WriteI64 { .. } => Some(8),
+        _ => None,
+    }
+}
+
+/// serialized_size(at): what write() emits when it starts at output offset `at`, which
+/// only matters to `align:`. Walks the write ops, folding fixed-size runs into constants.
+fn generate_serialized_size(lir_type: &LirType) -> String {
+    let mut body = String::new();
+    let mut sizer = SizeTerms { fixed: 0, bits: 0, code: &mut body, indent: "    ".to_string() };
+    let mut var_to_field = HashMap::new();
+    let writes = lir_type.operations.iter().skip_while(|op| !matches!(op, LirOperation::CreateStruct { .. }));
+    for op in writes {
+        sizer.add(op, &mut var_to_field, &lir_type.fields);
+    }
+    sizer.flush();
+
+    format!(
+        "inline size_t {}::serialized_size(size_t at) const {{\n    size_t end = at;\n{}    return end - at;\n}}\n\n",
+        lir_type.name, body
+    )
+}
+
+/// Accumulates the size terms of a run of write ops
+struct SizeTerms<'a> {
+    fixed: usize,
+    bits: usize,
+    code: &'a mut String,
+    indent: String,
+}
+
+impl SizeTerms<'_> {
+    fn flush(&mut self) {
+        let bytes = self.fixed + self.bits.div_ceil(8);
+        if bytes > 0 {
+            self.code.push_str(&format!("{}end += {};\n", self.indent, bytes));
+        }
+        self.fixed = 0;
+        self.bits = 0;
+    }
+
+    fn line(&mut self, line: String) {
+        self.flush();
+        self.code.push_str(&format!("{}{}\n", self.indent, line));
+    }
+
+    /// Structs size themselves from their own start, since they may align
+    fn each_struct(&mut self, sequence: String) {
+        self.line(format!("for (const auto& element : {}) {{", sequence));
+        self.code.push_str(&format!("{}    end += element.serialized_size(end);\n{}}}\n", self.indent, self.indent));
+    }
+
+    fn add(&mut self, op: &LirOperation, var_to_field: &mut HashMap<VarId, String>, fields: &[LirField]) {
+        if let LirOperation::AccessField { dest, field_index, .. } = op {
+            if let Some(field) = fields.get(*field_index) {
+                var_to_field.insert(*dest, member_expr(field));
+            }
+            return;
+        }
+        if let LirOperation::WriteBits { num_bits, .. } = op {
+            self.bits += usize::from(*num_bits);
+            return;
+        }
+        // Bitfields are padded out to a byte before the next field
+        self.fixed += self.bits.div_ceil(8);
+        self.bits = 0;
+
+        let name = |src: &VarId| var_to_field.get(src).cloned().unwrap_or_else(|| "unknown".to_string());
+        match op {
+            LirOperation::WriteArray { element_op, count, src } => match primitive_write_size(element_op) {
+                Some(size) => self.fixed += size * count,
+                None => self.each_struct(name(src)),
+            },
+            LirOperation::WriteDynamicArray { src, element_op, .. }
+            | LirOperation::WriteUntilEofArray { src, element_op }
+            | LirOperation::WriteUntilConditionArray { src, element_op } => match primitive_write_size(element_op) {
+                Some(1) => self.line(format!("end += {}.size();", name(src))),
+                Some(size) => self.line(format!("end += {}.size() * {};", name(src), size)),
+                None => self.each_struct(name(src)),
+            },
+            LirOperation::WriteStruct { src, .. } => self.line(format!("end += {}.serialized_size(end);", name(src))),
+            LirOperation::WriteSizedStruct { size_var, .. } => {
+                let size = fields.iter().find(|f| f.var_id == *size_var).map_or("unknown".to_string(), member_expr);
+                self.line(format!("end += static_cast<size_t>({});", size))
+            }
+            LirOperation::WriteFixedString { length, .. } => self.fixed += length,
+            LirOperation::WriteNullTerminatedString { src } => self.line(format!("end += {}.size() + 1;", name(src))),
+            LirOperation::WriteLengthPrefixedString { src, .. } | LirOperation::WriteBlob { src } => {
+                self.line(format!("end += {}.size();", name(src)))
+            }
+            LirOperation::WritePadFixed { bytes } => self.fixed += bytes,
+            LirOperation::WriteAlign { boundary } => self.line(format!("end += ({b} - end % {b}) % {b};", b = boundary)),
+            LirOperation::ConditionalBlock { condition, true_ops } => {
+                let condition_code =
+                    crate::expr_codegen::generate_expr(condition, "").unwrap_or_else(|_| "false".to_string());
+                self.line(format!("if ({}) {{", condition_code));
+                let mut inner = SizeTerms { fixed: 0, bits: 0, code: &mut *self.code, indent: format!("{}    ", self.indent) };
+                let mut local_var_to_field = var_to_field.clone();
+                for inner_op in true_ops {
+                    inner.add(inner_op, &mut local_var_to_field, fields);
+                }
+                inner.flush();
+                self.code.push_str(&format!("{}}}\n", self.indent));
+            }
+            other => self.fixed += primitive_write_size(other).unwrap_or(0),
+        }
+    }
+}
+
+/// Members whose C++ type can own heap memory: strings, vectors, and structs, arrays or
+/// optionals that may hold them
+fn heap_owning(members: &[(String, String)], enums: &[HirEnum]) -> Vec<String> {
+    fn owns_heap(cpp_type: &str, enums: &[HirEnum]) -> bool {
+        if cpp_type == "std::string" || cpp_type.starts_with("std::vector<") {
+            return true;
+        }
+        if let Some(inner) = cpp_type.strip_prefix("std::optional<").and_then(|t| t.strip_suffix('>')) {
+            return owns_heap(inner, enums);
+        }
+        if let Some(inner) = cpp_type.strip_prefix("std::array<").and_then(|t| t.rsplit_once(',')) {
+            return owns_heap(inner.0, enums);
+        }
+        let scalar = cpp_type.ends_with("_t") || matches!(cpp_type, "bool" | "float" | "double");
+        !scalar && !enums.iter().any(|e| e.name == cpp_type)
+    }
+    members.iter().filter(|(_, ty)| owns_heap(ty, enums)).map(|(name, _)| name.clone()).collect()
+}
+
+/// How write() names a field's value: `if:` fields are std::optional members
+fn member_expr(field: &LirField) -> String {
+    if field.is_optional {
+        format!("(*{})", field.name)
+    } else {
+        field.name.clone()
+    }
+}
+
+/// Field emitted by a top-level write operation
+fn write_op_field_name(op: &LirOperation, var_to_field: &HashMap<VarId, String>, fields: &[LirField]) -> Option<String> {
+    let src = match op {
+        LirOperation::WriteU8 { src }
+        | LirOperation::WriteU16 { src, .. }
+        | LirOperation::WriteU32 { src, .. }
+        | LirOperation::WriteU64 { src, .. }
+        | LirOperation::WriteI8 { src }
+        | LirOperation::WriteI16 { src, .. }
+        | LirOperation::WriteI32 { src, .. }
+        | LirOperation::WriteI64 { src, .. }
+        | LirOperation::WriteArray { src, .. }
+        | LirOperation::WriteDynamicArray { src, .. }
+        | LirOperation::WriteUntilEofArray { src, .. }
+        | LirOperation::WriteUntilConditionArray { src, .. }
+        | LirOperation::WriteStruct { src, .. }
+        | LirOperation::WriteSizedStruct { src, .. }
+        | LirOperation::WriteFixedString { src, .. }
+        | LirOperation::WriteNullTerminatedString { src }
+        | LirOperation::WriteLengthPrefixedString { src, .. }
+        | LirOperation::WriteBlob { src }
+        | LirOperation::WriteBits { src, .. } => src,
+        LirOperation::ConditionalBlock { true_ops, .. } => {
+            return true_ops.iter().find_map(|inner| match inner {
+                LirOperation::AccessField { field_index, .. } => fields.get(*field_index).map(|f| f.name.clone()),
+                _ => None,
+            });
+        }
+        _ => return None,
+    };
+    var_to_field.get(src).cloned()
+}
+
 impl Backend for CppBackend {
     fn name(&self) -> &str {
         "cpp"
@@ -791,19 +1824,90 @@ impl Backend for CppBackend {
     fn generate(&self, lir: &LirFormat) -> Result<GeneratedCode> {
         let mut lir_sorted = lir.clone();
         topological_sort(&mut lir_sorted)?;
+        if lir_sorted.endianness == Endianness::Runtime && !lir_sorted.projections.is_empty() {
+            anyhow::bail!("Projections are not supported with runtime endianness");
+        }
 
         let namespace = lir_sorted.name.to_lowercase().replace('-', "_");
-        let mut code = templates::generate_header_start(&namespace);
+        let uses_checksums = lir_sorted
+            .types
+            .iter()
+            .any(|t| t.fields.iter().any(|f| f.checksum.is_some()));
+
+        let uses_signatures = lir_sorted
+            .types
+            .iter()
+            .any(|t| signature_bytes(t, lir_sorted.endianness, &lir_sorted.enums).is_some());
+
+        let mut extra_includes = String::new();
+        if uses_checksums || uses_signatures {
+            extra_includes.push_str(&templates::generate_simd_includes());
+        }
+        if uses_signatures {
+            extra_includes.push_str(&templates::generate_scan_includes());
+        }
+        extra_includes.push_str(&templates::generate_parallel_write_includes());
+        extra_includes.push_str(&templates::generate_async_includes());
+        extra_includes.push_str(&templates::generate_append_includes());
+        extra_includes.push_str(&templates::generate_random_includes());
+        extra_includes.push_str(&templates::generate_hooks_includes());
+        extra_includes.push_str(&templates::generate_memory_includes());
+        let mut code = templates::generate_header_start(&namespace, &extra_includes);
+
+        if uses_checksums {
+            code.push_str(&templates::generate_checksum_support());
+        }
+        if uses_signatures {
+            code.push_str(&templates::generate_signature_search_support());
+        }
+        code.push_str(&templates::generate_parallel_write_support());
+        code.push_str(&templates::generate_async_support());
+        code.push_str(&templates::generate_append_writer_support());
+        code.push_str(&templates::generate_random_support());
+        code.push_str(&templates::generate_push_parser_support());
 
         // Generate enum definitions first
         for enum_def in &lir_sorted.enums {
             code.push_str(&self.generate_enum(enum_def));
         }
 
+        let field_ids: Vec<(String, String)> = lir_sorted
+            .types
+            .iter()
+            .flat_map(|t| {
+                visit_codegen::visited_fields(t)
+                    .map(|f| (visit_codegen::field_id(&t.name, &f.name), format!("{}.{}", t.name, f.name)))
+            })
+            .collect();
+        code.push_str(&templates::generate_visitor_support(&field_ids));
+        let type_names: Vec<&str> = lir_sorted.types.iter().map(|t| t.name.as_str()).collect();
+        code.push_str(&templates::generate_hooks_support(&type_names, field_ids.len()));
+        code.push_str(&templates::generate_memory_support());
+        if lir_sorted.types.iter().any(|t| t.fields.iter().any(|f| f.instance.is_some())) {
+            code.push_str(&templates::generate_instance_support());
+        }
+
+        let byte_order_sources = Self::byte_order_sources(&lir_sorted);
         for lir_type in &lir_sorted.types {
-            code.push_str(&self.generate_type(lir_type, lir_sorted.endianness, &lir_sorted.enums)?);
+            code.push_str(&self.generate_type(
+                lir_type,
+                lir_sorted.endianness,
+                byte_order_sources.get(&lir_type.name),
+                &lir_sorted.enums,
+            )?);
+            for projection in lir_sorted.projections.iter().filter(|p| p.type_name == lir_type.name) {
+                code.push_str(&projection_codegen::generate_projection(
+                    self,
+                    lir_type,
+                    projection,
+                    lir_sorted.endianness,
+                    &lir_sorted.enums,
+                )?);
+            }
         }
 
+        code.push_str(&templates::generate_read_instantiations(&type_names));
+
         code.push_str(&templates::generate_header_end(&namespace));
 
         let filename = format!("{}.hpp", lir.name.to_lowercase().replace('-', "_"));
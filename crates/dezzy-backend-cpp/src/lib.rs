@@ -2,8 +2,17 @@
 #![allow(clippy::module_name_repetitions)]
 #![allow(clippy::too_many_lines)]
 
+mod async_codegen;
+mod bench_codegen;
 mod codegen;
 mod expr_codegen;
+mod mutview_codegen;
+mod projection_codegen;
+mod push_codegen;
+mod random_codegen;
 mod templates;
+mod validate_codegen;
+mod visit_codegen;
 
+pub use bench_codegen::generate_bench;
 pub use codegen::CppBackend;
@@ -0,0 +1,154 @@
+//! Mutable views: in-place access to the fields of an encoded struct that sit at a fixed
+//! offset from its start.
+//!
+//! The offset is known up to the first field whose size depends on the data (or on a
+//! condition). Fields before it that have a fixed width get a getter and a `set_<field>()`
+//! that load and store the wire bytes directly, converting byte order as they go. Fields
+//! that size later data are read-only, since changing them would misplace what follows, and
+//! so are asserted fields and fields a checksum covers, which a store would invalidate.
+
+use crate::codegen::{fixed_read_size, op_field_name, CppBackend};
+use dezzy_core::hir::{Endianness, HirEnum, HirPrimitiveType};
+use dezzy_core::lir::{LirOperation, LirType};
+use std::collections::{HashMap, HashSet};
+
+/// A field the view can reach, at `offset` bytes from the start of the struct
+struct ViewField<'a> {
+    name: &'a str,
+    offset: usize,
+    op: &'a LirOperation,
+    read_only: bool,
+}
+
+/// `<Type>MutView` for `lir_type`, or nothing if no field has a fixed offset and width
+pub fn generate_mut_view(backend: &CppBackend, lir_type: &LirType, endianness: Endianness, enums: &[HirEnum]) -> String {
+    let var_to_field = backend.build_var_to_field_map(&lir_type.fields);
+    let enum_types: HashMap<&str, HirPrimitiveType> =
+        enums.iter().map(|e| (e.name.as_str(), e.underlying_type)).collect();
+    let sizes: HashSet<_> = lir_type.operations.iter().flat_map(LirOperation::size_refs).collect();
+    let checksummed: HashSet<&str> = lir_type
+        .fields
+        .iter()
+        .filter_map(|f| f.checksum.as_ref())
+        .flat_map(|c| c.over.iter().map(String::as_str))
+        .collect();
+
+    let mut fields = Vec::new();
+    let mut offset = 0;
+    let mut bits = 0;
+    let reads = lir_type.operations.iter().take_while(|op| !matches!(op, LirOperation::CreateStruct { .. }));
+    for op in reads {
+        if let LirOperation::ReadBits { num_bits, .. } = op {
+            bits += usize::from(*num_bits);
+            continue;
+        }
+        let Some(size) = fixed_read_size(op) else {
+            break;
+        };
+        offset += bits.div_ceil(8);
+        bits = 0;
+        if let Some(name) = op_field_name(op, &var_to_field) {
+            if let Some(field) = lir_type.fields.iter().find(|f| f.name == name) {
+                let read_only =
+                    sizes.contains(&field.var_id) || field.assertion.is_some() || checksummed.contains(name);
+                fields.push(ViewField { name, offset, op, read_only });
+            }
+        }
+        offset += size;
+    }
+    if fields.is_empty() {
+        return String::new();
+    }
+    let fixed_size = offset + bits.div_ceil(8);
+
+    let view = format!("{}MutView", lir_type.name);
+    let mut code = format!("// Reads and patches the fixed-offset fields of an encoded {} in place\n", lir_type.name);
+    code.push_str(&format!("class {} {{\npublic:\n", view));
+    code.push_str("    // Bytes from the start of the struct to the end of the last field the view covers\n");
+    code.push_str(&format!("    static constexpr size_t fixed_size = {};\n\n", fixed_size));
+    code.push_str(&format!("    explicit {}(std::span<uint8_t> bytes) : data_(bytes.data()) {{\n", view));
+    code.push_str("        if (bytes.size() < fixed_size) {\n");
+    code.push_str(&format!(
+        "            throw ParseError(\"{}MutView needs \" + std::to_string(fixed_size) + \" bytes, got \" + std::to_string(bytes.size()), ErrorKind::Truncated);\n",
+        lir_type.name
+    ));
+    code.push_str("        }\n    }\n\n");
+
+    for field in &fields {
+        let field_info = lir_type.fields.iter().find(|f| f.name == field.name);
+        let type_info = field_info.map(|f| f.type_info.as_str()).unwrap_or("");
+        let cpp_type = backend.lir_type_to_cpp_type(type_info);
+        let order = field.op.endianness().unwrap_or(endianness);
+        let at = format!("data_ + {}", field.offset);
+        let (getter, setter) = match field.op {
+            LirOperation::ReadArray { element_op, count, .. } => {
+                let element = scalar_type(element_op);
+                let element_order = element_op.endianness().unwrap_or(endianness);
+                let width = fixed_read_size(element_op).unwrap_or(1);
+                (
+                    format!(
+                        "{cpp_type} value{{}};\n        for (size_t i = 0; i < {count}; ++i) {{\n            value[i] = static_cast<{cpp_type}::value_type>(load_wire<{order}, {element}>({at} + i * {width}));\n        }}\n        return value;",
+                        order = order_name(element_order),
+                    ),
+                    format!(
+                        "for (size_t i = 0; i < {count}; ++i) {{\n            store_wire<{order}>({at} + i * {width}, static_cast<{element}>(value[i]));\n        }}",
+                        order = order_name(element_order),
+                    ),
+                )
+            }
+            LirOperation::ReadFixedString { length, .. } => (
+                format!("return std::string(reinterpret_cast<const char*>({at}), {length});"),
+                format!(
+                    "const size_t copied = std::min<size_t>(value.size(), {length});\n        std::memcpy({at}, value.data(), copied);\n        std::memset({at} + copied, 0, {length} - copied);"
+                ),
+            ),
+            scalar => {
+                let wire = scalar_type(scalar);
+                let order = order_name(order);
+                if enum_types.contains_key(type_info) {
+                    (
+                        format!("return static_cast<{cpp_type}>(load_wire<{order}, {wire}>({at}));"),
+                        format!("store_wire<{order}>({at}, static_cast<{wire}>(value));"),
+                    )
+                } else {
+                    (format!("return load_wire<{order}, {wire}>({at});"), format!("store_wire<{order}>({at}, value);"))
+                }
+            }
+        };
+        code.push_str(&format!("    {} {}() const {{\n        {}\n    }}\n", cpp_type, field.name, getter));
+        if !field.read_only {
+            let param = if matches!(field.op, LirOperation::ReadFixedString { .. }) {
+                "std::string_view".to_string()
+            } else if matches!(field.op, LirOperation::ReadArray { .. }) {
+                format!("const {}&", cpp_type)
+            } else {
+                cpp_type.clone()
+            };
+            code.push_str(&format!("    void set_{}({} value) {{\n        {}\n    }}\n", field.name, param, setter));
+        }
+    }
+
+    code.push_str("\nprivate:\n    uint8_t* data_;\n};\n\n");
+    code
+}
+
+fn scalar_type(op: &LirOperation) -> &'static str {
+    match op {
+        LirOperation::ReadU16 { .. } => "uint16_t",
+        LirOperation::ReadU32 { .. } => "uint32_t",
+        LirOperation::ReadU64 { .. } => "uint64_t",
+        LirOperation::ReadI8 { .. } => "int8_t",
+        LirOperation::ReadI16 { .. } => "int16_t",
+        LirOperation::ReadI32 { .. } => "int32_t",
+        LirOperation::ReadI64 { .. } => "int64_t",
+        _ => "uint8_t",
+    }
+}
+
+fn order_name(order: Endianness) -> &'static str {
+    match order {
+        Endianness::Little | Endianness::Native => "std::endian::little",
+        Endianness::Big => "std::endian::big",
+        Endianness::Runtime => unreachable!("mutable views are not generated for runtime byte order"),
+    }
+}
@@ -0,0 +1,209 @@
+//! Projections: slim readers that decode a chosen subset of a struct's fields.
+//!
+//! A projection keeps the selected fields plus whatever later fields need for their
+//! sizes and conditions (`LirType::retained_fields`). Retained fields go through the
+//! regular read generator; everything else becomes skip arithmetic. `T::skip()` is
+//! the projection with nothing selected, and is how skipped nested structs are
+//! stepped over.
+
+use crate::codegen::{fixed_read_size, op_field_name, primitive_read_size, CppBackend};
+use crate::expr_codegen::generate_expr;
+use crate::templates;
+use anyhow::Result;
+use dezzy_core::hir::{Endianness, HirEnum, HirPrimitiveType};
+use dezzy_core::lir::{LirOperation, LirProjection, LirType, VarId};
+use std::collections::{HashMap, HashSet};
+
+struct SkipEmitter<'a> {
+    backend: &'a CppBackend,
+    lir_type: &'a LirType,
+    var_to_field: HashMap<VarId, String>,
+    enum_types: HashMap<String, HirPrimitiveType>,
+    retained: HashSet<VarId>,
+    endianness: Endianness,
+}
+
+impl<'a> SkipEmitter<'a> {
+    fn new(backend: &'a CppBackend, lir_type: &'a LirType, selected: &[VarId], endianness: Endianness, enums: &[HirEnum]) -> Self {
+        Self {
+            backend,
+            lir_type,
+            var_to_field: backend.build_var_to_field_map(&lir_type.fields),
+            enum_types: enums.iter().map(|e| (e.name.clone(), e.underlying_type)).collect(),
+            retained: lir_type.retained_fields(selected).into_iter().collect(),
+            endianness,
+        }
+    }
+
+    fn name(&self, var: &VarId) -> &str {
+        self.var_to_field.get(var).map(|s| s.as_str()).unwrap_or("unknown")
+    }
+
+    fn is_retained(&self, op: &LirOperation) -> bool {
+        op_field_name(op, &self.var_to_field)
+            .and_then(|name| self.lir_type.fields.iter().find(|f| f.name == name))
+            .is_some_and(|field| self.retained.contains(&field.var_id))
+    }
+
+    /// Members of the struct the retained fields are decoded into
+    fn members(&self) -> Vec<(String, String)> {
+        self.lir_type
+            .fields
+            .iter()
+            .filter(|f| self.retained.contains(&f.var_id))
+            .map(|f| {
+                let cpp_type = self.backend.lir_type_to_cpp_type(&f.type_info);
+                let cpp_type = if f.is_optional { format!("std::optional<{}>", cpp_type) } else { cpp_type };
+                (f.name.clone(), cpp_type)
+            })
+            .collect()
+    }
+
+    fn body(&self) -> Result<String> {
+        let mut code = String::new();
+        if self.lir_type.operations.iter().any(|op| matches!(op, LirOperation::ReadBits { .. })) {
+            code.push_str("    BitReader bit_reader(reader);\n");
+        }
+        let reads: Vec<&LirOperation> = self
+            .lir_type
+            .operations
+            .iter()
+            .take_while(|op| !matches!(op, LirOperation::CreateStruct { .. }))
+            .collect();
+        code.push_str(&self.operations(&reads)?);
+        Ok(code)
+    }
+
+    /// Consecutive fixed-size skips are folded into a single `reader.skip()`
+    fn operations(&self, ops: &[&LirOperation]) -> Result<String> {
+        let mut code = String::new();
+        let mut pending = 0;
+        for op in ops {
+            if !self.is_retained(op) {
+                if let Some(size) = fixed_read_size(op) {
+                    pending += size;
+                    continue;
+                }
+            }
+            if pending > 0 {
+                code.push_str(&format!("    reader.skip({});\n", pending));
+                pending = 0;
+            }
+            code.push_str(&self.operation(op)?);
+        }
+        if pending > 0 {
+            code.push_str(&format!("    reader.skip({});\n", pending));
+        }
+        Ok(code)
+    }
+
+    fn operation(&self, op: &LirOperation) -> Result<String> {
+        if self.is_retained(op) || matches!(op, LirOperation::Skip { .. } | LirOperation::Align { .. }) {
+            return self.backend.generate_read_operation(
+                op,
+                &self.var_to_field,
+                &self.lir_type.fields,
+                &self.enum_types,
+                self.endianness,
+            );
+        }
+
+        Ok(match op {
+            LirOperation::ReadArray { element_op, count, .. } => {
+                self.skip_elements(element_op, &count.to_string())?
+            }
+            LirOperation::ReadDynamicArray { element_op, size_var, .. } => {
+                let count = format!("result.{}", self.name(size_var));
+                match primitive_read_size(element_op) {
+                    Some(1) => format!("    reader.skip({});\n", count),
+                    Some(size) => format!(
+                        "    reader.admit({count}, {size}, 0);\n    reader.skip(static_cast<size_t>({count}) * {size});\n"
+                    ),
+                    None => self.skip_elements(element_op, &count)?,
+                }
+            }
+            LirOperation::ReadUntilEofArray { element_op, .. } => match (primitive_read_size(element_op), element_op.as_ref()) {
+                (Some(1), _) => "    reader.skip(reader.remaining());\n".to_string(),
+                (Some(size), _) => format!("    while (reader.remaining() > 0) {{\n        reader.skip({});\n    }}\n", size),
+                (None, LirOperation::ReadStruct { type_name, .. }) => {
+                    format!("    while (reader.remaining() > 0) {{\n        {}::skip(reader);\n    }}\n", type_name)
+                }
+                _ => anyhow::bail!("Unsupported array element in skip()"),
+            },
+            LirOperation::ReadNullTerminatedString { .. } => {
+                "    while (reader.read_le<uint8_t>() != 0) {\n    }\n".to_string()
+            }
+            LirOperation::ReadLengthPrefixedString { length_var, .. } => {
+                format!("    reader.skip(result.{});\n", self.name(length_var))
+            }
+            LirOperation::ReadBlob { size_var, .. } => format!("    reader.skip(result.{});\n", self.name(size_var)),
+            LirOperation::ReadBits { num_bits, .. } => format!("    bit_reader.read_bits_msb({});\n", num_bits),
+            LirOperation::ReadStruct { type_name, .. } => format!("    {}::skip(reader);\n", type_name),
+            // The window's size is known, so nothing inside it is decoded
+            LirOperation::ReadSizedStruct { size_var, .. } => format!("    reader.skip(result.{});\n", self.name(size_var)),
+            LirOperation::ConditionalBlock { condition, true_ops } => {
+                let mut code = format!("    if ({}) {{\n", generate_expr(condition, "result")?);
+                let inner: Vec<&LirOperation> = true_ops.iter().collect();
+                for line in self.operations(&inner)?.lines() {
+                    code.push_str("    ");
+                    code.push_str(line);
+                    code.push('\n');
+                }
+                code.push_str("    }\n");
+                code
+            }
+            _ => String::new(),
+        })
+    }
+
+    fn skip_elements(&self, element_op: &LirOperation, count: &str) -> Result<String> {
+        match element_op {
+            LirOperation::ReadStruct { type_name, .. } => Ok(format!(
+                "    reader.admit({count}, {type_name}::min_encoded_size, 0);\n    for (size_t i = 0; i < {count}; ++i) {{\n        {type_name}::skip(reader);\n    }}\n"
+            )),
+            _ => anyhow::bail!("Unsupported array element in skip()"),
+        }
+    }
+}
+
+/// `T::skip(reader)`: advance past one encoded `T`, decoding only sizes and conditions
+pub(crate) fn generate_skip(
+    backend: &CppBackend,
+    lir_type: &LirType,
+    endianness: Endianness,
+    enums: &[HirEnum],
+) -> Result<String> {
+    let emitter = SkipEmitter::new(backend, lir_type, &[], endianness, enums);
+
+    let mut code = format!("inline void {}::skip(Reader& reader) {{\n", lir_type.name);
+    let members = emitter.members();
+    if !members.is_empty() {
+        code.push_str("    struct {\n");
+        for (name, cpp_type) in &members {
+            code.push_str(&format!("        {} {};\n", cpp_type, name));
+        }
+        code.push_str("    } result{};\n");
+    }
+    code.push_str(&emitter.body()?);
+    code.push_str("}\n\n");
+    Ok(code)
+}
+
+/// Slim struct and reader for one projection of `lir_type`
+pub(crate) fn generate_projection(
+    backend: &CppBackend,
+    lir_type: &LirType,
+    projection: &LirProjection,
+    endianness: Endianness,
+    enums: &[HirEnum],
+) -> Result<String> {
+    let emitter = SkipEmitter::new(backend, lir_type, &projection.fields, endianness, enums);
+
+    let mut code = templates::generate_projection_declaration(&projection.name, &lir_type.name, &emitter.members());
+    code.push_str(&format!("inline {name} {name}::read(Reader& reader) {{\n", name = projection.name));
+    code.push_str(&format!("    {} result;\n", projection.name));
+    code.push_str(&emitter.body()?);
+    code.push_str("    return result;\n");
+    code.push_str("}\n\n");
+    Ok(code)
+}
@@ -0,0 +1,595 @@
+//! Push-style parsers: `Parser<T>::feed()` resumes mid-struct as bytes arrive.
+//!
+//! Each read operation of a type becomes one or more numbered states of a
+//! `switch` inside `feed()`. Partially read scalars live in the base class
+//! scratch buffer and partially filled vectors/strings live in the result
+//! itself, so every input byte is consumed exactly once regardless of how the
+//! stream is fragmented.
+
+use crate::codegen::{checksum_class, checksum_fields, covered_fields, endian_suffix, CppBackend};
+use crate::expr_codegen::generate_expr;
+use anyhow::Result;
+use dezzy_core::hir::{Endianness, HirEnum};
+use dezzy_core::lir::{LirField, LirOperation, LirType, VarId};
+use std::collections::HashMap;
+
+const INDENT: &str = "            ";
+
+struct PushEmitter<'a> {
+    backend: &'a CppBackend,
+    fields: &'a [LirField],
+    var_to_field: HashMap<VarId, String>,
+    enums: &'a [HirEnum],
+    endianness: Endianness,
+    /// Field name -> checksum accumulator members fed by it
+    covered: HashMap<String, Vec<String>>,
+    /// Bodies of the numbered states; `None` until a forward-referencing state is filled in
+    states: Vec<Option<String>>,
+    /// Nested `Parser<U>` members, one per struct-typed field
+    sub_parsers: Vec<(String, String)>,
+}
+
+impl<'a> PushEmitter<'a> {
+    fn push_state(&mut self, body: String) -> usize {
+        self.states.push(Some(body));
+        self.states.len() - 1
+    }
+
+    fn field_for(&self, dest: &VarId) -> Option<&'a LirField> {
+        self.fields.iter().find(|f| f.var_id == *dest)
+    }
+
+    fn hash_updates(&self, field_name: &str, bytes: &str) -> String {
+        self.covered
+            .get(field_name)
+            .map(|accumulators| {
+                accumulators
+                    .iter()
+                    .map(|acc| format!("{}{}_checksum_.update({});\n", INDENT, acc, bytes))
+                    .collect()
+            })
+            .unwrap_or_default()
+    }
+
+    fn is_covered(&self, field_name: &str) -> bool {
+        self.covered.contains_key(field_name)
+    }
+
+    /// Width and C++ type of a fixed-size scalar read
+    fn scalar(op: &LirOperation) -> Option<(usize, &'static str)> {
+        match op {
+            LirOperation::ReadU8 { .. } => Some((1, "uint8_t")),
+            LirOperation::ReadI8 { .. } => Some((1, "int8_t")),
+            LirOperation::ReadU16 { .. } => Some((2, "uint16_t")),
+            LirOperation::ReadI16 { .. } => Some((2, "int16_t")),
+            LirOperation::ReadU32 { .. } => Some((4, "uint32_t")),
+            LirOperation::ReadI32 { .. } => Some((4, "int32_t")),
+            LirOperation::ReadU64 { .. } => Some((8, "uint64_t")),
+            LirOperation::ReadI64 { .. } => Some((8, "int64_t")),
+            _ => None,
+        }
+    }
+
+    fn load(&self, op: &LirOperation, width: usize, cpp_type: &str) -> String {
+        // Single bytes have no byte order
+        let suffix = if width == 1 { "_le" } else { endian_suffix(op.endianness().unwrap_or(self.endianness)) };
+        format!("load{}<{}>()", suffix, cpp_type)
+    }
+
+    fn emit_top_level(&mut self, op: &LirOperation) -> Result<()> {
+        match op {
+            LirOperation::ConditionalBlock { condition, true_ops } => {
+                // Filled in once the inner states are numbered
+                self.states.push(None);
+                let cond_state = self.states.len() - 1;
+
+                let condition_code = generate_expr(condition, "result").unwrap_or_else(|_| "false".to_string());
+                let mut entry = String::new();
+                for inner in true_ops {
+                    let field = dest_of(inner).and_then(|d| self.field_for(&d));
+                    let target = match field {
+                        Some(f) => {
+                            // Containers are filled in place, so engage the optional up front
+                            entry.push_str(&format!("{}result.{}.emplace();\n", INDENT, f.name));
+                            format!("(*result.{})", f.name)
+                        }
+                        None => "result".to_string(),
+                    };
+                    self.emit_op(inner, &target, field)?;
+                }
+                let after = self.states.len();
+
+                let mut body = format!("{}if (!{}) {{\n", INDENT, condition_code);
+                body.push_str(&format!("{}    state_ = {};\n{}    continue;\n{}}}\n", INDENT, after, INDENT, INDENT));
+                body.push_str(&entry);
+                self.states[cond_state] = Some(body);
+                Ok(())
+            }
+            _ => {
+                let field = dest_of(op).and_then(|d| self.field_for(&d));
+                let target = field.map(|f| format!("result.{}", f.name)).unwrap_or_default();
+                self.emit_op(op, &target, field)
+            }
+        }
+    }
+
+    fn emit_op(&mut self, op: &LirOperation, target: &str, field: Option<&'a LirField>) -> Result<()> {
+        let field_name = field.map(|f| f.name.clone()).unwrap_or_default();
+
+        if let Some((width, cpp_type)) = Self::scalar(op) {
+            let mut body = format!("{}if (!fill(input, {})) {{\n{}    return ParseStatus::NeedMore;\n{}}}\n", INDENT, width, INDENT, INDENT);
+            body.push_str(&self.hash_updates(&field_name, &format!("std::span<const uint8_t>(scratch_, {})", width)));
+            let load = self.load(op, width, cpp_type);
+            let enum_type = field.filter(|f| self.enums.iter().any(|e| e.name == f.type_info));
+            match enum_type {
+                Some(f) => body.push_str(&format!("{}{} = static_cast<{}>({});\n", INDENT, target, f.type_info, load)),
+                None => body.push_str(&format!("{}{} = {};\n", INDENT, target, load)),
+            }
+            body.push_str(&self.after_field(field));
+            self.push_state(body);
+            return Ok(());
+        }
+
+        match op {
+            LirOperation::ReadArray { element_op, count, .. } => {
+                self.emit_sequence(element_op, target, &count.to_string(), false, field)
+            }
+            LirOperation::ReadDynamicArray { element_op, size_var, .. } => {
+                let count = self.size_expr(size_var);
+                self.emit_sequence(element_op, target, &count, true, field)
+            }
+            LirOperation::ReadBlob { size_var, .. } => {
+                let count = self.size_expr(size_var);
+                self.emit_sequence(&LirOperation::ReadU8 { dest: VarId::new(0) }, target, &count, true, field)
+            }
+            LirOperation::ReadUntilEofArray { element_op, .. } => self.emit_open_array(element_op, target, None, field),
+            LirOperation::ReadUntilConditionArray { element_op, condition, .. } => {
+                let condition_code = generate_expr(condition, target)?;
+                self.emit_open_array(element_op, target, Some(condition_code), field)
+            }
+            LirOperation::ReadFixedString { length, .. } => self.emit_string(target, &length.to_string(), field),
+            LirOperation::ReadLengthPrefixedString { length_var, .. } => {
+                let count = self.size_expr(length_var);
+                self.emit_string(target, &count, field)
+            }
+            LirOperation::ReadNullTerminatedString { .. } => {
+                let mut body = String::new();
+                body.push_str(&format!("{}for (;;) {{\n", INDENT));
+                body.push_str(&format!("{}    if (input.empty()) {{\n{}        return ParseStatus::NeedMore;\n{}    }}\n", INDENT, INDENT, INDENT));
+                body.push_str(&format!("{}    const auto* nul = static_cast<const uint8_t*>(std::memchr(input.data(), 0, input.size()));\n", INDENT));
+                body.push_str(&format!("{}    const size_t length = nul ? static_cast<size_t>(nul - input.data()) : input.size();\n", INDENT));
+                body.push_str(&format!("{}    {}.append(reinterpret_cast<const char*>(input.data()), length);\n", INDENT, target));
+                body.push_str(&format!("{}    auto bytes = consume(input, nul ? length + 1 : length);\n", INDENT));
+                body.push_str(&indent_by(&self.hash_updates(&field_name, "bytes"), "    "));
+                body.push_str(&format!("{}    if (nul) {{\n{}        break;\n{}    }}\n", INDENT, INDENT, INDENT));
+                body.push_str(&format!("{}}}\n", INDENT));
+                body.push_str(&self.after_field(field));
+                self.push_state(body);
+                Ok(())
+            }
+            LirOperation::ReadStruct { type_name, .. } => {
+                let parser = self.sub_parser(&field_name, type_name);
+                let mut prepare = self.unsupported_hash(&field_name);
+                prepare.push_str(&reset_sub_parser(&parser));
+                self.push_state(prepare);
+
+                let mut body = self.feed_sub_parser(&parser);
+                body.push_str(&format!("{}{} = {}.take();\n", INDENT, target, parser));
+                body.push_str(&self.after_field(field));
+                self.push_state(body);
+                Ok(())
+            }
+            LirOperation::ReadSizedStruct { type_name, size_var, .. } => {
+                let parser = self.sub_parser(&field_name, type_name);
+                let mut prepare = self.unsupported_hash(&field_name);
+                prepare.push_str(&format!("{}pending_ = static_cast<size_t>({});\n", INDENT, self.size_expr(size_var)));
+                prepare.push_str(&reset_sub_parser(&parser));
+                self.push_state(prepare);
+
+                // The nested parser is offered no more than the window, and its end is the
+                // nested parser's end of input
+                let mut body = format!("{}{{\n", INDENT);
+                body.push_str(&format!("{}    auto window = input.first(std::min(input.size(), pending_));\n", INDENT));
+                body.push_str(&format!("{}    const size_t offered = window.size();\n", INDENT));
+                body.push_str(&format!("{}    ParseStatus status = {}.feed(window);\n", INDENT, parser));
+                body.push_str(&format!("{}    pending_ -= consume(input, offered - window.size()).size();\n", INDENT));
+                body.push_str(&format!("{}    if (status == ParseStatus::NeedMore) {{\n", INDENT));
+                body.push_str(&format!("{}        if (pending_ != 0) {{\n{}            return ParseStatus::NeedMore;\n{}        }}\n", INDENT, INDENT, INDENT));
+                body.push_str(&format!("{}        status = {}.finish();\n", INDENT, parser));
+                body.push_str(&format!("{}    }}\n", INDENT));
+                body.push_str(&format!("{}    if (status == ParseStatus::Error) {{\n{}        return fail({}.error());\n{}    }}\n", INDENT, INDENT, parser, INDENT));
+                body.push_str(&format!("{}    {} = {}.take();\n", INDENT, target, parser));
+                body.push_str(&format!("{}}}\n", INDENT));
+                self.push_state(body);
+
+                // Then whatever the struct left of its window
+                let mut rest = format!("{}pending_ -= consume(input, pending_).size();\n", INDENT);
+                rest.push_str(&format!("{}if (pending_ != 0) {{\n{}    return ParseStatus::NeedMore;\n{}}}\n", INDENT, INDENT, INDENT));
+                rest.push_str(&self.after_field(field));
+                self.push_state(rest);
+                Ok(())
+            }
+            LirOperation::Skip { size_var } => {
+                let count = format!("static_cast<size_t>({})", self.size_expr(size_var));
+                self.emit_skip(&count);
+                Ok(())
+            }
+            LirOperation::PadFixed { bytes } => {
+                self.emit_skip(&bytes.to_string());
+                Ok(())
+            }
+            LirOperation::Align { boundary } => {
+                self.emit_skip(&format!("({b} - (position_ % {b})) % {b}", b = boundary));
+                Ok(())
+            }
+            LirOperation::ReadBits { num_bits, signed, .. } => {
+                let mut body = self.unsupported_hash(&field_name);
+                body.push_str(&format!("{}if (!fill_bits(input, {})) {{\n{}    return ParseStatus::NeedMore;\n{}}}\n", INDENT, num_bits, INDENT, INDENT));
+                let take = if *signed { "take_signed_bits" } else { "take_bits" };
+                body.push_str(&format!("{}{} = {}({});\n", INDENT, target, take, num_bits));
+                body.push_str(&self.after_field(field));
+                self.push_state(body);
+                Ok(())
+            }
+            _ => Ok(()),
+        }
+    }
+
+    fn size_expr(&self, size_var: &VarId) -> String {
+        let size_field = self.var_to_field.get(size_var).map(|s| s.as_str()).unwrap_or("unknown_size");
+        format!("result.{}", size_field)
+    }
+
+    /// Checksums over nested structs and bitfields would need the raw bytes of a
+    /// sub-parser; report that at runtime instead of silently skipping verification.
+    fn unsupported_hash(&self, field_name: &str) -> String {
+        if self.is_covered(field_name) {
+            format!(
+                "{}return fail(\"Checksum over field '{}' is not supported by the push parser\");\n",
+                INDENT, field_name
+            )
+        } else {
+            String::new()
+        }
+    }
+
+    fn sub_parser(&mut self, field_name: &str, type_name: &str) -> String {
+        let member = format!("{}_parser_", field_name);
+        if !self.sub_parsers.iter().any(|(m, _)| *m == member) {
+            self.sub_parsers.push((member.clone(), type_name.to_string()));
+        }
+        member
+    }
+
+    fn feed_sub_parser(&self, parser: &str) -> String {
+        let mut body = String::new();
+        body.push_str(&format!("{}{{\n", INDENT));
+        body.push_str(&format!("{}    const size_t available = input.size();\n", INDENT));
+        body.push_str(&format!("{}    ParseStatus status = {}.feed(input);\n", INDENT, parser));
+        body.push_str(&format!("{}    position_ += available - input.size();\n", INDENT));
+        // At end of stream the nested parser is finished too, so its own until-eof arrays can end
+        body.push_str(&format!("{}    if (status == ParseStatus::NeedMore) {{\n", INDENT));
+        body.push_str(&format!("{}        if (!eof_) {{\n{}            return ParseStatus::NeedMore;\n{}        }}\n", INDENT, INDENT, INDENT));
+        body.push_str(&format!("{}        status = {}.finish();\n", INDENT, parser));
+        body.push_str(&format!("{}    }}\n", INDENT));
+        body.push_str(&format!("{}    if (status == ParseStatus::Error) {{\n{}        return fail({}.error());\n{}    }}\n", INDENT, INDENT, parser, INDENT));
+        body.push_str(&format!("{}}}\n", INDENT));
+        body
+    }
+
+    fn emit_skip(&mut self, count: &str) {
+        self.push_state(format!("{}pending_ = {};\n", INDENT, count));
+        let mut body = format!("{}pending_ -= consume(input, pending_).size();\n", INDENT);
+        body.push_str(&format!("{}if (pending_ != 0) {{\n{}    return ParseStatus::NeedMore;\n{}}}\n", INDENT, INDENT, INDENT));
+        self.push_state(body);
+    }
+
+    fn emit_string(&mut self, target: &str, count: &str, field: Option<&'a LirField>) -> Result<()> {
+        let field_name = field.map(|f| f.name.clone()).unwrap_or_default();
+        self.push_state(format!("{}pending_ = {};\n{}reserve_up_to({}, pending_);\n", INDENT, count, INDENT, target));
+
+        let mut body = format!("{}{{\n", INDENT);
+        body.push_str(&format!("{}    auto bytes = consume(input, pending_);\n", INDENT));
+        body.push_str(&format!("{}    {}.append(reinterpret_cast<const char*>(bytes.data()), bytes.size());\n", INDENT, target));
+        body.push_str(&indent_by(&self.hash_updates(&field_name, "bytes"), "    "));
+        body.push_str(&format!("{}    pending_ -= bytes.size();\n", INDENT));
+        body.push_str(&format!("{}}}\n", INDENT));
+        body.push_str(&format!("{}if (pending_ != 0) {{\n{}    return ParseStatus::NeedMore;\n{}}}\n", INDENT, INDENT, INDENT));
+        body.push_str(&self.after_field(field));
+        self.push_state(body);
+        Ok(())
+    }
+
+    /// Arrays with a known element count (fixed, size-field driven, blobs). Vectors (`grow`)
+    /// are filled as elements arrive, since the count is not checked against any input yet
+    fn emit_sequence(
+        &mut self,
+        element_op: &LirOperation,
+        target: &str,
+        count: &str,
+        grow: bool,
+        field: Option<&'a LirField>,
+    ) -> Result<()> {
+        let field_name = field.map(|f| f.name.clone()).unwrap_or_default();
+
+        let mut prepare = String::new();
+        if matches!(element_op, LirOperation::ReadStruct { .. }) {
+            prepare.push_str(&self.unsupported_hash(&field_name));
+        }
+        if grow {
+            prepare.push_str(&format!("{}{}.clear();\n", INDENT, target));
+            prepare.push_str(&format!("{}reserve_up_to({}, {});\n", INDENT, target, count));
+        }
+        prepare.push_str(&format!("{}index_ = 0;\n", INDENT));
+        let store = |value: &str| {
+            if grow {
+                format!("{}    {}.push_back({});\n{}    ++index_;\n", INDENT, target, value, INDENT)
+            } else {
+                format!("{}    {}[index_++] = {};\n", INDENT, target, value)
+            }
+        };
+
+        let mut body = String::new();
+        match element_op {
+            LirOperation::ReadU8 { .. } | LirOperation::ReadI8 { .. } => {
+                // Byte payloads are copied straight out of the input fragment
+                body.push_str(&format!("{}{{\n", INDENT));
+                body.push_str(&format!("{}    auto bytes = consume(input, {} - index_);\n", INDENT, count));
+                if grow {
+                    body.push_str(&format!("{}    {}.insert({}.end(), bytes.begin(), bytes.end());\n", INDENT, target, target));
+                } else {
+                    body.push_str(&format!("{}    if (!bytes.empty()) {{\n", INDENT));
+                    body.push_str(&format!("{}        std::memcpy({}.data() + index_, bytes.data(), bytes.size());\n", INDENT, target));
+                    body.push_str(&format!("{}    }}\n", INDENT));
+                }
+                body.push_str(&indent_by(&self.hash_updates(&field_name, "bytes"), "    "));
+                body.push_str(&format!("{}    index_ += bytes.size();\n", INDENT));
+                body.push_str(&format!("{}}}\n", INDENT));
+                body.push_str(&format!("{}if (index_ < static_cast<size_t>({})) {{\n{}    return ParseStatus::NeedMore;\n{}}}\n", INDENT, count, INDENT, INDENT));
+            }
+            LirOperation::ReadStruct { type_name, .. } => {
+                let parser = self.sub_parser(&field_name, type_name);
+                prepare.push_str(&reset_sub_parser(&parser));
+                body.push_str(&format!("{}while (index_ < static_cast<size_t>({})) {{\n", INDENT, count));
+                body.push_str(&indent_by(&self.feed_sub_parser(&parser), "    "));
+                body.push_str(&store(&format!("{}.take()", parser)));
+                body.push_str(&format!("{}}}\n", INDENT));
+            }
+            other => {
+                let (width, cpp_type) = Self::scalar(other)
+                    .ok_or_else(|| anyhow::anyhow!("Unsupported array element in push parser for '{}'", field_name))?;
+                body.push_str(&format!("{}while (index_ < static_cast<size_t>({})) {{\n", INDENT, count));
+                body.push_str(&format!("{}    if (!fill(input, {})) {{\n{}        return ParseStatus::NeedMore;\n{}    }}\n", INDENT, width, INDENT, INDENT));
+                body.push_str(&indent_by(&self.hash_updates(&field_name, &format!("std::span<const uint8_t>(scratch_, {})", width)), "    "));
+                body.push_str(&store(&self.load(other, width, cpp_type)));
+                body.push_str(&format!("{}}}\n", INDENT));
+            }
+        }
+        body.push_str(&self.after_field(field));
+
+        self.push_state(prepare);
+        self.push_state(body);
+        Ok(())
+    }
+
+    /// Arrays terminated by end of stream (`condition == None`) or by a condition on the last element
+    fn emit_open_array(
+        &mut self,
+        element_op: &LirOperation,
+        target: &str,
+        condition: Option<String>,
+        field: Option<&'a LirField>,
+    ) -> Result<()> {
+        let field_name = field.map(|f| f.name.clone()).unwrap_or_default();
+        let mut prepare = String::new();
+        let mut body = format!("{}for (;;) {{\n", INDENT);
+
+        match element_op {
+            LirOperation::ReadStruct { type_name, .. } => {
+                let parser = self.sub_parser(&field_name, type_name);
+                prepare.push_str(&self.unsupported_hash(&field_name));
+                prepare.push_str(&reset_sub_parser(&parser));
+                if condition.is_none() {
+                    body.push_str(&format!("{}    if (input.empty() && !{}.started()) {{\n", INDENT, parser));
+                    body.push_str(&format!("{}        if (eof_) {{\n{}            break;\n{}        }}\n", INDENT, INDENT, INDENT));
+                    body.push_str(&format!("{}        return ParseStatus::NeedMore;\n{}    }}\n", INDENT, INDENT));
+                }
+                body.push_str(&indent_by(&self.feed_sub_parser(&parser), "    "));
+                body.push_str(&format!("{}    {}.push_back({}.take());\n", INDENT, target, parser));
+            }
+            other => {
+                let (width, cpp_type) = Self::scalar(other)
+                    .ok_or_else(|| anyhow::anyhow!("Unsupported array element in push parser for '{}'", field_name))?;
+                if condition.is_none() {
+                    body.push_str(&format!("{}    if (input.empty() && scratch_len_ == 0) {{\n", INDENT));
+                    body.push_str(&format!("{}        if (eof_) {{\n{}            break;\n{}        }}\n", INDENT, INDENT, INDENT));
+                    body.push_str(&format!("{}        return ParseStatus::NeedMore;\n{}    }}\n", INDENT, INDENT));
+                }
+                body.push_str(&format!("{}    if (!fill(input, {})) {{\n{}        return ParseStatus::NeedMore;\n{}    }}\n", INDENT, width, INDENT, INDENT));
+                body.push_str(&indent_by(&self.hash_updates(&field_name, &format!("std::span<const uint8_t>(scratch_, {})", width)), "    "));
+                body.push_str(&format!("{}    {}.push_back({});\n", INDENT, target, self.load(other, width, cpp_type)));
+            }
+        }
+
+        if let Some(condition_code) = condition {
+            body.push_str(&format!("{}    if ({}) {{\n{}        break;\n{}    }}\n", INDENT, condition_code, INDENT, INDENT));
+        }
+        body.push_str(&format!("{}}}\n", INDENT));
+        body.push_str(&self.after_field(field));
+
+        if !prepare.is_empty() {
+            self.push_state(prepare);
+        }
+        self.push_state(body);
+        Ok(())
+    }
+
+    /// Assertion and checksum checks that run once a field is complete
+    fn after_field(&self, field: Option<&LirField>) -> String {
+        let Some(field) = field else {
+            return String::new();
+        };
+        let mut code = String::new();
+
+        if let Some(ref assertion) = field.assertion {
+            // Assertion checks throw ParseError, which feed() turns into ParseStatus::Error
+            code.push_str(&indent_by(&self.backend.generate_assertion_check(&field.name, assertion), "        "));
+        }
+
+        if field.checksum.is_some() {
+            let stored = if field.is_optional {
+                format!("result.{name} && *result.{name}", name = field.name)
+            } else {
+                format!("result.{}", field.name)
+            };
+            code.push_str(&format!(
+                "{}if (verify_checksums_enabled && verify_checksums_ && {} != {}_checksum_.value()) {{\n",
+                INDENT, stored, field.name
+            ));
+            code.push_str(&format!(
+                "{}    return fail(\"Checksum mismatch for field '{}'\");\n{}}}\n",
+                INDENT, field.name, INDENT
+            ));
+        }
+
+        code
+    }
+}
+
+fn dest_of(op: &LirOperation) -> Option<VarId> {
+    match op {
+        LirOperation::ReadU8 { dest }
+        | LirOperation::ReadU16 { dest, .. }
+        | LirOperation::ReadU32 { dest, .. }
+        | LirOperation::ReadU64 { dest, .. }
+        | LirOperation::ReadI8 { dest }
+        | LirOperation::ReadI16 { dest, .. }
+        | LirOperation::ReadI32 { dest, .. }
+        | LirOperation::ReadI64 { dest, .. }
+        | LirOperation::ReadArray { dest, .. }
+        | LirOperation::ReadDynamicArray { dest, .. }
+        | LirOperation::ReadUntilEofArray { dest, .. }
+        | LirOperation::ReadUntilConditionArray { dest, .. }
+        | LirOperation::ReadStruct { dest, .. }
+        | LirOperation::ReadSizedStruct { dest, .. }
+        | LirOperation::ReadFixedString { dest, .. }
+        | LirOperation::ReadNullTerminatedString { dest }
+        | LirOperation::ReadLengthPrefixedString { dest, .. }
+        | LirOperation::ReadBlob { dest, .. }
+        | LirOperation::ReadBits { dest, .. } => Some(*dest),
+        _ => None,
+    }
+}
+
+/// Restart a nested parser at the current offset, inheriting the checksum setting
+fn reset_sub_parser(parser: &str) -> String {
+    format!(
+        "{i}{p}.reset(position_);\n{i}{p}.set_verify_checksums(verify_checksums_);\n",
+        i = INDENT,
+        p = parser
+    )
+}
+
+fn indent_by(code: &str, prefix: &str) -> String {
+    code.lines()
+        .filter(|line| !line.is_empty())
+        .map(|line| format!("{}{}\n", prefix, line))
+        .collect()
+}
+
+pub(crate) fn generate_push_parser(
+    backend: &CppBackend,
+    lir_type: &LirType,
+    endianness: Endianness,
+    enums: &[HirEnum],
+) -> Result<String> {
+    let checksums = checksum_fields(&lir_type.fields);
+    let covered = covered_fields(&checksums);
+
+    let mut emitter = PushEmitter {
+        backend,
+        fields: &lir_type.fields,
+        var_to_field: lir_type.fields.iter().map(|f| (f.var_id, f.name.clone())).collect(),
+        enums,
+        endianness,
+        covered,
+        states: Vec::new(),
+        sub_parsers: Vec::new(),
+    };
+
+    for op in &lir_type.operations {
+        if matches!(op, LirOperation::CreateStruct { .. }) {
+            break;
+        }
+        emitter.emit_top_level(op)?;
+    }
+
+    let name = &lir_type.name;
+    let done_state = emitter.states.len();
+
+    // Class declaration
+    let mut code = "#if defined(DEZZY_PUSH_PARSER)\ntemplate<>\n".to_string();
+    code.push_str(&format!("class Parser<{}> : public PushParser {{\n", name));
+    code.push_str("public:\n");
+    code.push_str("    ParseStatus feed(std::span<const uint8_t>& input);\n");
+    code.push_str("    ParseStatus finish();\n");
+    code.push_str(&format!("    const {}& value() const {{ return result_; }}\n", name));
+    code.push_str(&format!("    {} take() {{\n", name));
+    code.push_str(&format!("        {} value = std::move(result_);\n", name));
+    code.push_str("        reset(position_);\n");
+    code.push_str("        return value;\n");
+    code.push_str("    }\n");
+    code.push_str("    void reset(size_t position = 0) {\n");
+    code.push_str("        reset_base(position);\n");
+    code.push_str("        result_ = {};\n");
+    code.push_str("        state_ = 0;\n");
+    for checksum in &checksums {
+        code.push_str(&format!("        {}_checksum_ = {{}};\n", checksum.name));
+    }
+    code.push_str("    }\n");
+    code.push_str("\nprivate:\n");
+    code.push_str(&format!("    {} result_{{}};\n", name));
+    code.push_str("    size_t state_ = 0;\n");
+    for (member, type_name) in &emitter.sub_parsers {
+        code.push_str(&format!("    Parser<{}> {};\n", type_name, member));
+    }
+    for checksum in &checksums {
+        code.push_str(&format!("    {} {}_checksum_;\n", checksum_class(checksum), checksum.name));
+    }
+    code.push_str("};\n\n");
+
+    // feed(): one case per state, falling through while input lasts
+    code.push_str(&format!("inline ParseStatus Parser<{}>::feed(std::span<const uint8_t>& input) {{\n", name));
+    code.push_str("    if (failed_) {\n        return ParseStatus::Error;\n    }\n");
+    code.push_str("    auto& result = result_;\n");
+    code.push_str("    try {\n");
+    code.push_str("        for (;;) {\n");
+    code.push_str("            switch (state_) {\n");
+    for (index, body) in emitter.states.iter().enumerate() {
+        code.push_str(&format!("            case {}:\n", index));
+        if let Some(body) = body {
+            code.push_str(&indent_by(body, "    "));
+        }
+        code.push_str(&format!("                state_ = {};\n", index + 1));
+        code.push_str("                [[fallthrough]];\n");
+    }
+    code.push_str(&format!("            case {}:\n", done_state));
+    code.push_str("            default:\n");
+    code.push_str("                return ParseStatus::Done;\n");
+    code.push_str("            }\n");
+    code.push_str("        }\n");
+    code.push_str("    } catch (const ParseError& e) {\n");
+    code.push_str("        return fail(e.what());\n");
+    code.push_str("    }\n");
+    code.push_str("}\n\n");
+
+    code.push_str(&format!("inline ParseStatus Parser<{}>::finish() {{\n", name));
+    code.push_str("    eof_ = true;\n");
+    code.push_str("    std::span<const uint8_t> none;\n");
+    code.push_str("    const ParseStatus status = feed(none);\n");
+    code.push_str("    return status == ParseStatus::NeedMore ? fail(\"Unexpected end of data\") : status;\n");
+    code.push_str("}\n");
+    code.push_str("#endif\n\n");
+
+    Ok(code)
+}
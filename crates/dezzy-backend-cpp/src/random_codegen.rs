@@ -0,0 +1,332 @@
+//! `T::random(rng, sizes)`: a valid value with random contents, for benchmark and stress
+//! corpora (`DEZZY_RANDOM`).
+//!
+//! Fields are drawn in read order, so a condition sees the fields it tests. Assertions and
+//! enum domains bound the scalars, and skipped ranges stay empty. Every container gets a
+//! length from the matching `SizeProfile` distribution, clipped to what its count or
+//! length field can hold. `until:` arrays end on the first element that meets their
+//! condition. A simple `x[-1].f equals LIT` terminator is set on the last element directly.
+//! For any other condition, elements are redrawn until one meets it.
+
+use crate::expr_codegen::generate_expr;
+use anyhow::Result;
+use dezzy_core::expr::{ComparisonOp, Expr, IndexExpr};
+use dezzy_core::hir::{HirAssertValue, HirAssertion, HirEnum};
+use dezzy_core::lir::{LirField, LirOperation, LirType, VarId};
+use std::cell::RefCell;
+use std::collections::HashSet;
+
+/// Definition of `<Type>::random()`
+pub fn generate_random(lir_type: &LirType, enums: &[HirEnum]) -> Result<String> {
+    let skipped: HashSet<VarId> = lir_type
+        .operations
+        .iter()
+        .filter_map(|op| match op {
+            LirOperation::Skip { size_var } => Some(*size_var),
+            _ => None,
+        })
+        .collect();
+    let random = RandomValue { lir_type, enums, skipped, sized: RefCell::default() };
+
+    let mut code = String::from("#if defined(DEZZY_RANDOM)\n");
+    code.push_str(&format!(
+        "inline {name} {name}::random(Rng& rng, const SizeProfile& sizes) {{\n    {name} result{{}};\n",
+        name = lir_type.name
+    ));
+    let reads = lir_type.operations.iter().take_while(|op| !matches!(op, LirOperation::CreateStruct { .. }));
+    for op in reads {
+        code.push_str(&random.fill(op, "    ")?);
+    }
+    code.push_str("    (void)rng;\n    (void)sizes;\n    return result;\n}\n#endif\n\n");
+    Ok(code)
+}
+
+struct RandomValue<'a> {
+    lir_type: &'a LirType,
+    enums: &'a [HirEnum],
+    /// Sizes of skipped ranges, which write() does not emit and so must stay zero
+    skipped: HashSet<VarId>,
+    /// Count fields already set by an earlier container that shares them
+    sized: RefCell<HashSet<VarId>>,
+}
+
+impl RandomValue<'_> {
+    fn field(&self, var: VarId) -> Option<&LirField> {
+        self.lir_type.fields.iter().find(|f| f.var_id == var)
+    }
+
+    fn target(&self, dest: VarId) -> Option<String> {
+        self.field(dest)
+            .map(|f| if f.is_optional { format!("(*result.{})", f.name) } else { format!("result.{}", f.name) })
+    }
+
+    /// Statements that give the field `op` reads a random valid value
+    fn fill(&self, op: &LirOperation, indent: &str) -> Result<String> {
+        let mut code = String::new();
+        match op {
+            LirOperation::ReadU8 { dest }
+            | LirOperation::ReadU16 { dest, .. }
+            | LirOperation::ReadU32 { dest, .. }
+            | LirOperation::ReadU64 { dest, .. }
+            | LirOperation::ReadI8 { dest }
+            | LirOperation::ReadI16 { dest, .. }
+            | LirOperation::ReadI32 { dest, .. }
+            | LirOperation::ReadI64 { dest, .. }
+            | LirOperation::ReadBits { dest, .. } => {
+                let (Some(field), Some(target)) = (self.field(*dest), self.target(*dest)) else {
+                    return Ok(code);
+                };
+                code.push_str(&format!("{indent}{}\n", self.scalar(op, field, &target, indent)));
+            }
+            LirOperation::ReadArray { dest, element_op, .. } => {
+                let (Some(field), Some(target)) = (self.field(*dest), self.target(*dest)) else {
+                    return Ok(code);
+                };
+                if let Some(HirAssertion::Equals(HirAssertValue::IntArray(values))) = &field.assertion {
+                    let values: Vec<String> = values.iter().map(ToString::to_string).collect();
+                    code.push_str(&format!("{indent}detail::assign_each({target}, {{{}}});\n", values.join(", ")));
+                } else {
+                    code.push_str(&format!(
+                        "{indent}for (auto& element : {target}) {{\n{indent}    element = {};\n{indent}}}\n",
+                        element(element_op, &target)
+                    ));
+                }
+            }
+            LirOperation::ReadDynamicArray { dest, element_op, size_var } => {
+                let Some(target) = self.target(*dest) else {
+                    return Ok(code);
+                };
+                code.push_str(&format!("{indent}{target}.resize({});\n", self.length(*size_var, "elements")));
+                code.push_str(&format!(
+                    "{indent}for (auto& element : {target}) {{\n{indent}    element = {};\n{indent}}}\n",
+                    element(element_op, &target)
+                ));
+                code.push_str(&self.record_length(*size_var, &target, indent));
+            }
+            LirOperation::ReadUntilEofArray { dest, element_op } => {
+                let Some(target) = self.target(*dest) else {
+                    return Ok(code);
+                };
+                code.push_str(&format!("{indent}{target}.resize(sizes.elements.draw(rng));\n"));
+                code.push_str(&format!(
+                    "{indent}for (auto& element : {target}) {{\n{indent}    element = {};\n{indent}}}\n",
+                    element(element_op, &target)
+                ));
+            }
+            LirOperation::ReadUntilConditionArray { dest, element_op, condition } => {
+                let (Some(field), Some(target)) = (self.field(*dest), self.target(*dest)) else {
+                    return Ok(code);
+                };
+                code.push_str(&self.until_condition(field, &target, element_op, condition, indent)?);
+            }
+            LirOperation::ReadStruct { dest, type_name } => {
+                if let Some(target) = self.target(*dest) {
+                    code.push_str(&format!("{indent}{target} = {type_name}::random(rng, sizes);\n"));
+                }
+            }
+            LirOperation::ReadSizedStruct { dest, type_name, size_var } => {
+                if let Some(target) = self.target(*dest) {
+                    code.push_str(&format!("{indent}{target} = {type_name}::random(rng, sizes);\n"));
+                    // The window fits the struct exactly
+                    if let Some(size) = self.field(*size_var).filter(|f| !f.is_optional) {
+                        code.push_str(&format!("{indent}detail::assign(result.{}, {target}.serialized_size());\n", size.name));
+                    }
+                }
+            }
+            LirOperation::ReadFixedString { dest, length } => {
+                if let Some(target) = self.target(*dest) {
+                    code.push_str(&format!("{indent}{target} = detail::random_text(rng, {length});\n"));
+                }
+            }
+            LirOperation::ReadNullTerminatedString { dest } => {
+                if let Some(target) = self.target(*dest) {
+                    code.push_str(&format!("{indent}{target} = detail::random_text(rng, sizes.strings.draw(rng));\n"));
+                }
+            }
+            LirOperation::ReadLengthPrefixedString { dest, length_var } => {
+                if let Some(target) = self.target(*dest) {
+                    code.push_str(&format!(
+                        "{indent}{target} = detail::random_text(rng, {});\n",
+                        self.length(*length_var, "strings")
+                    ));
+                    code.push_str(&self.record_length(*length_var, &target, indent));
+                }
+            }
+            LirOperation::ReadBlob { dest, size_var } => {
+                if let Some(target) = self.target(*dest) {
+                    code.push_str(&format!("{indent}{target}.resize({});\n", self.length(*size_var, "blobs")));
+                    code.push_str(&format!("{indent}rng.fill({target}.data(), {target}.size());\n"));
+                    code.push_str(&self.record_length(*size_var, &target, indent));
+                }
+            }
+            LirOperation::ConditionalBlock { condition, true_ops } => {
+                code.push_str(&format!("{indent}if ({}) {{\n", generate_expr(condition, "result")?));
+                let inner_indent = format!("{indent}    ");
+                for inner in true_ops {
+                    if let Some(field) = read_dest(inner).and_then(|dest| self.field(dest)) {
+                        code.push_str(&format!("{inner_indent}result.{}.emplace();\n", field.name));
+                    }
+                    code.push_str(&self.fill(inner, &inner_indent)?);
+                }
+                code.push_str(&format!("{indent}}}\n"));
+            }
+            _ => {}
+        }
+        Ok(code)
+    }
+
+    /// One statement drawing a scalar within its assertion, enum or bit width
+    fn scalar(&self, op: &LirOperation, field: &LirField, target: &str, indent: &str) -> String {
+        if self.skipped.contains(&field.var_id) {
+            return format!("detail::assign({target}, 0);");
+        }
+        let list = |values: &[i64]| values.iter().map(ToString::to_string).collect::<Vec<_>>().join(", ");
+        match &field.assertion {
+            Some(HirAssertion::Equals(HirAssertValue::Int(value))) => return format!("detail::assign({target}, {value});"),
+            Some(HirAssertion::NotEquals(HirAssertValue::Int(value))) => {
+                return format!("do {{\n{indent}    detail::draw({target}, rng);\n{indent}}} while (detail::as_int({target}) == {value});")
+            }
+            Some(HirAssertion::GreaterThan(threshold)) => {
+                return format!("detail::assign({target}, rng.between({}, detail::max_of({target})));", threshold + 1)
+            }
+            Some(HirAssertion::GreaterOrEqual(threshold)) => {
+                return format!("detail::assign({target}, rng.between({threshold}, detail::max_of({target})));")
+            }
+            Some(HirAssertion::LessThan(threshold)) => {
+                return format!("detail::assign({target}, rng.between(detail::min_of({target}), {}));", threshold - 1)
+            }
+            Some(HirAssertion::LessOrEqual(threshold)) => {
+                return format!("detail::assign({target}, rng.between(detail::min_of({target}), {threshold}));")
+            }
+            Some(HirAssertion::Range { min, max }) => return format!("detail::assign({target}, rng.between({min}, {max}));"),
+            Some(HirAssertion::In(values)) => return format!("detail::assign({target}, rng.pick({{{}}}));", list(values)),
+            Some(HirAssertion::NotIn(values)) => {
+                return format!(
+                    "do {{\n{indent}    detail::draw({target}, rng);\n{indent}}} while (detail::contains({{{}}}, detail::as_int({target})));",
+                    list(values)
+                )
+            }
+            _ => {}
+        }
+        if let Some(enum_def) = self.enums.iter().find(|e| e.name == field.type_info) {
+            let values: Vec<i64> = enum_def.values.iter().map(|v| v.value).collect();
+            return format!("detail::assign({target}, rng.pick({{{}}}));", list(&values));
+        }
+        match op {
+            LirOperation::ReadBits { num_bits, signed: true, .. } => {
+                let half = 1i64 << (num_bits - 1);
+                format!("detail::assign({target}, rng.between({}, {}));", -half, half - 1)
+            }
+            LirOperation::ReadBits { num_bits, .. } => {
+                format!("detail::assign({target}, rng.between(0, {}));", (1i64 << num_bits) - 1)
+            }
+            _ => format!("detail::draw({target}, rng);"),
+        }
+    }
+
+    /// Length of a container sized by `size_var`: drawn from `distribution` and clipped to
+    /// what the field can hold, or the field's value when an earlier container set it
+    fn length(&self, size_var: VarId, distribution: &str) -> String {
+        match self.field(size_var) {
+            Some(size) if size.is_optional => format!("sizes.{distribution}.draw(rng)"),
+            Some(size) if self.sized.borrow().contains(&size_var) => format!("static_cast<size_t>(result.{})", size.name),
+            Some(size) => format!("detail::length_for(result.{}, sizes.{distribution}.draw(rng))", size.name),
+            None => format!("sizes.{distribution}.draw(rng)"),
+        }
+    }
+
+    /// Stores a container's length in its count field; write() derives most of them anyway
+    fn record_length(&self, size_var: VarId, target: &str, indent: &str) -> String {
+        match self.field(size_var) {
+            Some(size) if !size.is_optional => {
+                self.sized.borrow_mut().insert(size_var);
+                format!("{indent}detail::assign(result.{}, {target}.size());\n", size.name)
+            }
+            _ => String::new(),
+        }
+    }
+
+    fn until_condition(
+        &self,
+        field: &LirField,
+        target: &str,
+        element_op: &LirOperation,
+        condition: &Expr,
+        indent: &str,
+    ) -> Result<String> {
+        let ends = generate_expr(condition, &format!("result.{}", field.name))?;
+        let draw = element(element_op, target);
+        let mut code = format!("{indent}{{\n");
+        code.push_str(&format!("{indent}    const size_t count = std::max<size_t>(sizes.elements.draw(rng), 1);\n"));
+        code.push_str(&format!("{indent}    // Elements before the last must not end the array\n"));
+        code.push_str(&format!(
+            "{indent}    for (size_t rejected = 0; {target}.size() + 1 < count && rejected < 1000;) {{\n"
+        ));
+        code.push_str(&format!("{indent}        {target}.push_back({draw});\n"));
+        code.push_str(&format!("{indent}        if ({ends}) {{\n{indent}            {target}.pop_back();\n{indent}            ++rejected;\n{indent}        }}\n"));
+        code.push_str(&format!("{indent}    }}\n"));
+        if let Some((member, literal)) = last_element_terminator(condition) {
+            code.push_str(&format!("{indent}    {target}.push_back({draw});\n"));
+            code.push_str(&format!("{indent}    {target}.back().{member} = {};\n", generate_expr(literal, "")?));
+        } else {
+            code.push_str(&format!("{indent}    for (size_t attempt = 0;; ++attempt) {{\n"));
+            code.push_str(&format!("{indent}        {target}.push_back({draw});\n"));
+            code.push_str(&format!("{indent}        if ({ends}) {{\n{indent}            break;\n{indent}        }}\n"));
+            code.push_str(&format!("{indent}        {target}.pop_back();\n"));
+            code.push_str(&format!(
+                "{indent}        if (attempt == 10000) {{\n{indent}            throw std::runtime_error(\"{}.{}: no random element meets the until condition\");\n{indent}        }}\n",
+                self.lir_type.name, field.name
+            ));
+            code.push_str(&format!("{indent}    }}\n"));
+        }
+        code.push_str(&format!("{indent}}}\n"));
+        Ok(code)
+    }
+}
+
+/// Expression drawing one element of `container`
+fn element(element_op: &LirOperation, container: &str) -> String {
+    match element_op {
+        LirOperation::ReadStruct { type_name, .. } => format!("{type_name}::random(rng, sizes)"),
+        _ => format!("detail::drawn<std::remove_cvref_t<decltype({container})>::value_type>(rng)"),
+    }
+}
+
+fn read_dest(op: &LirOperation) -> Option<VarId> {
+    match op {
+        LirOperation::ReadU8 { dest }
+        | LirOperation::ReadU16 { dest, .. }
+        | LirOperation::ReadU32 { dest, .. }
+        | LirOperation::ReadU64 { dest, .. }
+        | LirOperation::ReadI8 { dest }
+        | LirOperation::ReadI16 { dest, .. }
+        | LirOperation::ReadI32 { dest, .. }
+        | LirOperation::ReadI64 { dest, .. }
+        | LirOperation::ReadArray { dest, .. }
+        | LirOperation::ReadDynamicArray { dest, .. }
+        | LirOperation::ReadUntilEofArray { dest, .. }
+        | LirOperation::ReadUntilConditionArray { dest, .. }
+        | LirOperation::ReadStruct { dest, .. }
+        | LirOperation::ReadSizedStruct { dest, .. }
+        | LirOperation::ReadFixedString { dest, .. }
+        | LirOperation::ReadNullTerminatedString { dest }
+        | LirOperation::ReadLengthPrefixedString { dest, .. }
+        | LirOperation::ReadBlob { dest, .. }
+        | LirOperation::ReadBits { dest, .. } => Some(*dest),
+        _ => None,
+    }
+}
+
+/// `name[-1].member equals <literal>`: the member to set on the last element, and its value
+fn last_element_terminator(condition: &Expr) -> Option<(&str, &Expr)> {
+    let Expr::Comparison { left, op: ComparisonOp::Equals, right } = condition else {
+        return None;
+    };
+    let Expr::FieldAccess { base, field } = left.as_ref() else {
+        return None;
+    };
+    match (base.as_ref(), right.as_ref()) {
+        (Expr::ArrayIndex { index: IndexExpr::Negative(1), .. }, Expr::Literal(_)) => Some((field.as_str(), right.as_ref())),
+        _ => None,
+    }
+}
@@ -0,0 +1,358 @@
+//! Validators: `T::validate(reader)` tells whether a `T` parses at the reader's position,
+//! without throwing and without allocating for the data it steps over.
+//!
+//! The validator follows read() field by field, but decodes only what later checks need.
+//! Fixed-width fields go into a scratch `T`, where assertions, sizes and conditions find
+//! them, and nested structs validate into their member of it. Strings, blobs and arrays of
+//! scalars are bounds-checked and skipped unless an assertion or condition reads them.
+//! Every failure read() would throw for returns false instead, so rejecting a candidate
+//! costs neither an exception nor a `ParseError`, and no hook sees it. Limits and recovery
+//! do not apply.
+
+use crate::codegen::{checksum_class, checksum_fields, covered_fields, element_layout, fixed_read_size, op_field_name, primitive_read_size, read_call, CppBackend};
+use crate::expr_codegen::generate_expr;
+use anyhow::Result;
+use dezzy_core::hir::{Endianness, HirAssertValue, HirAssertion, HirEnum};
+use dezzy_core::lir::{LirField, LirOperation, LirType, VarId};
+use std::collections::{HashMap, HashSet};
+
+struct ValidateEmitter<'a> {
+    lir_type: &'a LirType,
+    var_to_field: HashMap<VarId, String>,
+    enums: HashSet<&'a str>,
+    /// Fields assertions, sizes and conditions read; only these are decoded if that allocates
+    needed: HashSet<VarId>,
+    covered: HashMap<String, Vec<String>>,
+    endianness: Endianness,
+}
+
+impl<'a> ValidateEmitter<'a> {
+    fn field(&self, var: &VarId) -> Option<&'a LirField> {
+        self.lir_type.fields.iter().find(|f| f.var_id == *var)
+    }
+
+    fn name(&self, var: &VarId) -> &str {
+        self.var_to_field.get(var).map(|s| s.as_str()).unwrap_or("unknown")
+    }
+
+    /// Statement that makes an `if:` member hold a value, and the expression naming it
+    fn target(&self, var: &VarId) -> (String, String) {
+        let name = self.name(var);
+        match self.field(var) {
+            Some(field) if field.is_optional => (format!("    result.{}.emplace();\n", name), format!("(*result.{})", name)),
+            _ => (String::new(), format!("result.{}", name)),
+        }
+    }
+
+    fn element_read(&self, op: &LirOperation) -> String {
+        let (cpp_type, _) = element_layout(op);
+        if cpp_type.ends_with("8_t") {
+            format!("reader.template read_le<{}>()", cpp_type)
+        } else {
+            read_call(op.endianness().unwrap_or(self.endianness), &cpp_type)
+        }
+    }
+
+    fn scalar_read(&self, op: &LirOperation, dest: &VarId) -> String {
+        match self.field(dest) {
+            Some(field) if self.enums.contains(field.type_info.as_str()) => {
+                format!("static_cast<{}>({})", field.type_info, self.element_read(op))
+            }
+            _ => self.element_read(op),
+        }
+    }
+
+    fn assertion(&self, dest: &VarId) -> String {
+        let Some(field) = self.field(dest) else {
+            return String::new();
+        };
+        match field.assertion.as_ref().and_then(|a| assertion_fails(&format!("result.{}", field.name), a)) {
+            Some(fails) => format!("    if ({}) {{\n        return false;\n    }}\n", fails),
+            None => String::new(),
+        }
+    }
+
+    /// Ops in sequence; each run of fixed-size fields is bounds-checked once
+    fn operations(&self, ops: &[&LirOperation]) -> Result<String> {
+        let mut code = String::new();
+        for (index, op) in ops.iter().enumerate() {
+            if fixed_read_size(op).is_some() && (index == 0 || fixed_read_size(ops[index - 1]).is_none()) {
+                let run: usize = ops[index..].iter().map_while(|op| fixed_read_size(op)).sum();
+                code.push_str(&format!("    if (reader.remaining() < {}) {{\n        return false;\n    }}\n", run));
+            }
+
+            let accumulators = op_field_name(op, &self.var_to_field).and_then(|name| self.covered.get(name));
+            if accumulators.is_some() {
+                code.push_str("    checksum_mark = reader.position();\n");
+            }
+            code.push_str(&self.operation(op)?);
+            if let Some(accumulators) = accumulators {
+                code.push_str("    if (verify_checksums) {\n");
+                for accumulator in accumulators {
+                    code.push_str(&format!("        {}_checksum.update(reader.bytes_since(checksum_mark));\n", accumulator));
+                }
+                code.push_str("    }\n");
+            }
+
+            let checksum = op_field_name(op, &self.var_to_field)
+                .and_then(|name| self.lir_type.fields.iter().find(|f| f.name == name && f.checksum.is_some()));
+            if let Some(field) = checksum {
+                let stored = if field.is_optional {
+                    format!("result.{name} && *result.{name}", name = field.name)
+                } else {
+                    format!("result.{}", field.name)
+                };
+                code.push_str(&format!(
+                    "    if (verify_checksums && {} != {}_checksum.value()) {{\n        return false;\n    }}\n",
+                    stored, field.name
+                ));
+            }
+        }
+        Ok(code)
+    }
+
+    fn operation(&self, op: &LirOperation) -> Result<String> {
+        Ok(match op {
+            LirOperation::ReadU8 { dest }
+            | LirOperation::ReadU16 { dest, .. }
+            | LirOperation::ReadU32 { dest, .. }
+            | LirOperation::ReadU64 { dest, .. }
+            | LirOperation::ReadI8 { dest }
+            | LirOperation::ReadI16 { dest, .. }
+            | LirOperation::ReadI32 { dest, .. }
+            | LirOperation::ReadI64 { dest, .. } => {
+                format!("    result.{} = {};\n{}", self.name(dest), self.scalar_read(op, dest), self.assertion(dest))
+            }
+            LirOperation::ReadArray { dest, element_op, count } => {
+                let (prelude, target) = self.target(dest);
+                let element = match element_op.as_ref() {
+                    LirOperation::ReadStruct { type_name, .. } => format!(
+                        "        if (!{}::validate_into(reader, {}[i])) {{\n            return false;\n        }}\n",
+                        type_name, target
+                    ),
+                    scalar => format!("        {}[i] = {};\n", target, self.element_read(scalar)),
+                };
+                format!("{}    for (size_t i = 0; i < {}; ++i) {{\n{}    }}\n{}", prelude, count, element, self.assertion(dest))
+            }
+            LirOperation::ReadDynamicArray { dest, element_op, size_var } => {
+                let count = format!("result.{}", self.name(size_var));
+                self.elements(dest, element_op, &count)?
+            }
+            LirOperation::ReadUntilEofArray { element_op, .. } => match (primitive_read_size(element_op), element_op.as_ref()) {
+                (Some(size), _) => format!(
+                    "    if (reader.remaining() % {size} != 0) {{\n        return false;\n    }}\n    reader.skip(reader.remaining());\n"
+                ),
+                (None, LirOperation::ReadStruct { type_name, .. }) => format!(
+                    "    while (reader.remaining() > 0) {{\n        const size_t start = reader.position();\n        if (!{}::validate(reader) || reader.position() == start) {{\n            return false;\n        }}\n    }}\n",
+                    type_name
+                ),
+                _ => anyhow::bail!("Unsupported array element in validate()"),
+            },
+            LirOperation::ReadUntilConditionArray { dest, element_op, condition } => {
+                // Only the last element is kept, for the terminating condition
+                let (cpp_type, _) = element_layout(element_op);
+                let last = format!("last.{}", self.name(dest));
+                let mut code = format!(
+                    "    {{\n        struct {{\n            std::array<{}, 1> {};\n        }} last{{}};\n        do {{\n",
+                    cpp_type,
+                    self.name(dest)
+                );
+                match element_op.as_ref() {
+                    LirOperation::ReadStruct { type_name, .. } => code.push_str(&format!(
+                        "            const size_t start = reader.position();\n            {last}[0] = {type_name}{{}};\n            if (!{type_name}::validate_into(reader, {last}[0]) || reader.position() == start) {{\n                return false;\n            }}\n"
+                    )),
+                    scalar => {
+                        let size = primitive_read_size(scalar).ok_or_else(|| anyhow::anyhow!("Unsupported array element in validate()"))?;
+                        code.push_str(&format!(
+                            "            if (reader.remaining() < {}) {{\n                return false;\n            }}\n            {}[0] = {};\n",
+                            size,
+                            last,
+                            self.element_read(scalar)
+                        ));
+                    }
+                }
+                code.push_str(&format!("        }} while (!{});\n    }}\n", generate_expr(condition, &last)?));
+                code
+            }
+            LirOperation::ReadFixedString { dest, length } => {
+                if self.needed.contains(dest) {
+                    format!(
+                        "    {{\n        const auto bytes = reader.read_bytes({});\n        result.{} = std::string(reinterpret_cast<const char*>(bytes.data()), bytes.size());\n    }}\n{}",
+                        length,
+                        self.name(dest),
+                        self.assertion(dest)
+                    )
+                } else {
+                    format!("    reader.skip({});\n", length)
+                }
+            }
+            LirOperation::ReadNullTerminatedString { dest } => {
+                let mut code = String::from("    {\n        const auto rest = reader.data().subspan(reader.position());\n");
+                code.push_str("        const auto* end = static_cast<const uint8_t*>(std::memchr(rest.data(), 0, rest.size()));\n");
+                code.push_str("        if (end == nullptr) {\n            return false;\n        }\n");
+                code.push_str("        const auto bytes = reader.read_bytes(static_cast<size_t>(end - rest.data()) + 1);\n");
+                if self.needed.contains(dest) {
+                    code.push_str(&format!(
+                        "        result.{} = std::string(reinterpret_cast<const char*>(bytes.data()), bytes.size() - 1);\n",
+                        self.name(dest)
+                    ));
+                } else {
+                    code.push_str("        static_cast<void>(bytes);\n");
+                }
+                code.push_str("    }\n");
+                code.push_str(&self.assertion(dest));
+                code
+            }
+            LirOperation::ReadLengthPrefixedString { dest, length_var } => self.bytes(dest, length_var, true),
+            LirOperation::ReadBlob { dest, size_var } => self.bytes(dest, size_var, false),
+            LirOperation::Skip { size_var } => {
+                format!("    if (result.{size} > reader.remaining()) {{\n        return false;\n    }}\n    reader.skip(result.{size});\n", size = self.name(size_var))
+            }
+            LirOperation::PadFixed { bytes } => format!("    reader.skip({});\n", bytes),
+            LirOperation::Align { boundary } => format!(
+                "    {{\n        const size_t padding = ({b} - (reader.position() % {b})) % {b};\n        if (padding > reader.remaining()) {{\n            return false;\n        }}\n        reader.skip(padding);\n    }}\n",
+                b = boundary
+            ),
+            LirOperation::ReadBits { dest, num_bits, signed } => {
+                let read = if *signed { "read_signed_bits_msb" } else { "read_bits_msb" };
+                format!(
+                    "    if (!bit_reader.can_read({bits})) {{\n        return false;\n    }}\n    result.{} = bit_reader.{read}({bits});\n{}",
+                    self.name(dest),
+                    self.assertion(dest),
+                    bits = num_bits
+                )
+            }
+            LirOperation::ReadStruct { dest, type_name } => {
+                let (prelude, target) = self.target(dest);
+                format!("{}    if (!{}::validate_into(reader, {})) {{\n        return false;\n    }}\n", prelude, type_name, target)
+            }
+            LirOperation::ReadSizedStruct { dest, type_name, size_var } => {
+                let (prelude, target) = self.target(dest);
+                format!(
+                    "{prelude}    if (result.{size} > reader.remaining()) {{\n        return false;\n    }}\n    {{\n        Reader window = reader.window(result.{size});\n        if (!{type_name}::validate_into(window, {target})) {{\n            return false;\n        }}\n    }}\n",
+                    size = self.name(size_var)
+                )
+            }
+            LirOperation::ConditionalBlock { condition, true_ops } => {
+                let mut code = format!("    if ({}) {{\n", generate_expr(condition, "result")?);
+                let inner: Vec<&LirOperation> = true_ops.iter().collect();
+                for line in self.operations(&inner)?.lines() {
+                    code.push_str("    ");
+                    code.push_str(line);
+                    code.push('\n');
+                }
+                code.push_str("    }\n");
+                code
+            }
+            _ => String::new(),
+        })
+    }
+
+    /// `count` elements of a dynamic array: scalars are skipped in one step, structs validated
+    fn elements(&self, dest: &VarId, element_op: &LirOperation, count: &str) -> Result<String> {
+        if let LirOperation::ReadStruct { type_name, .. } = element_op {
+            return Ok(format!(
+                "    if ({type_name}::min_encoded_size > 0 ? {count} > reader.remaining() / {type_name}::min_encoded_size : {count} > reader.remaining() + Reader::max_empty_elements) {{\n        return false;\n    }}\n    for (size_t i = 0; i < {count}; ++i) {{\n        if (!{type_name}::validate(reader)) {{\n            return false;\n        }}\n    }}\n"
+            ));
+        }
+        let size = primitive_read_size(element_op).ok_or_else(|| anyhow::anyhow!("Unsupported array element in validate()"))?;
+        let mut code = format!("    if ({count} > reader.remaining() / {size}) {{\n        return false;\n    }}\n");
+        if self.needed.contains(dest) {
+            let (prelude, target) = self.target(dest);
+            code.push_str(&prelude);
+            code.push_str(&format!("    {target}.resize({count});\n    for (size_t i = 0; i < {count}; ++i) {{\n"));
+            code.push_str(&format!("        {}[i] = {};\n    }}\n", target, self.element_read(element_op)));
+            code.push_str(&self.assertion(dest));
+        } else {
+            code.push_str(&format!("    reader.skip(static_cast<size_t>({count}) * {size});\n"));
+        }
+        Ok(code)
+    }
+
+    /// Strings and blobs whose length another field holds
+    fn bytes(&self, dest: &VarId, length_var: &VarId, string: bool) -> String {
+        let length = format!("result.{}", self.name(length_var));
+        let mut code = format!("    if ({length} > reader.remaining()) {{\n        return false;\n    }}\n");
+        if self.needed.contains(dest) {
+            let (prelude, target) = self.target(dest);
+            code.push_str(&prelude);
+            code.push_str(&format!("    {{\n        const auto bytes = reader.read_bytes({length});\n"));
+            if string {
+                code.push_str(&format!("        {target} = std::string(reinterpret_cast<const char*>(bytes.data()), bytes.size());\n"));
+            } else {
+                code.push_str(&format!("        {target}.assign(bytes.begin(), bytes.end());\n"));
+            }
+            code.push_str("    }\n");
+            code.push_str(&self.assertion(dest));
+        } else {
+            code.push_str(&format!("    reader.skip({length});\n"));
+        }
+        code
+    }
+}
+
+/// C++ condition that holds when `target` breaks `assertion`
+fn assertion_fails(target: &str, assertion: &HirAssertion) -> Option<String> {
+    let any = |values: &[i64], op: &str, join: &str| {
+        values.iter().map(|v| format!("{} {} {}", target, op, v)).collect::<Vec<_>>().join(join)
+    };
+    Some(match assertion {
+        HirAssertion::Equals(HirAssertValue::Int(value)) => format!("{} != {}", target, value),
+        HirAssertion::Equals(HirAssertValue::IntArray(values)) => {
+            let bytes: Vec<String> = values.iter().map(ToString::to_string).collect();
+            format!(
+                "!std::equal({t}.begin(), {t}.end(), std::array<uint8_t, {}>{{{{{}}}}}.begin())",
+                values.len(),
+                bytes.join(", "),
+                t = target
+            )
+        }
+        HirAssertion::NotEquals(HirAssertValue::Int(value)) => format!("{} == {}", target, value),
+        HirAssertion::NotEquals(HirAssertValue::IntArray(_)) => return None,
+        HirAssertion::GreaterThan(threshold) => format!("{} <= {}", target, threshold),
+        HirAssertion::GreaterOrEqual(threshold) => format!("{} < {}", target, threshold),
+        HirAssertion::LessThan(threshold) => format!("{} >= {}", target, threshold),
+        HirAssertion::LessOrEqual(threshold) => format!("{} > {}", target, threshold),
+        HirAssertion::In(values) => format!("({})", any(values, "!=", " && ")),
+        HirAssertion::NotIn(values) => format!("({})", any(values, "==", " || ")),
+        HirAssertion::Range { min, max } => format!("{t} < {} || {t} > {}", min, max, t = target),
+    })
+}
+
+/// `T::validate()` and `T::validate_into()` for `lir_type`
+pub(crate) fn generate_validate(backend: &CppBackend, lir_type: &LirType, endianness: Endianness, enums: &[HirEnum]) -> Result<String> {
+    let asserted: Vec<VarId> = lir_type.fields.iter().filter(|f| f.assertion.is_some()).map(|f| f.var_id).collect();
+    let checksums = checksum_fields(&lir_type.fields);
+    let emitter = ValidateEmitter {
+        lir_type,
+        var_to_field: backend.build_var_to_field_map(&lir_type.fields),
+        enums: enums.iter().map(|e| e.name.as_str()).collect(),
+        needed: lir_type.retained_fields(&asserted).into_iter().collect(),
+        covered: covered_fields(&checksums),
+        endianness,
+    };
+
+    let name = &lir_type.name;
+    let mut code = format!(
+        "inline bool {name}::validate(Reader& reader) noexcept {{\n    {name} result{{}};\n    return validate_into(reader, result);\n}}\n\n"
+    );
+    code.push_str(&format!("inline bool {name}::validate_into(Reader& reader, {name}& result) noexcept {{\n"));
+    if lir_type.operations.iter().any(|op| matches!(op, LirOperation::ReadBits { .. })) {
+        code.push_str("    BitReader bit_reader(reader);\n");
+    }
+    if !checksums.is_empty() {
+        code.push_str("    const bool verify_checksums = verify_checksums_enabled && reader.verify_checksums();\n");
+        for field in &checksums {
+            code.push_str(&format!("    {} {}_checksum;\n", checksum_class(field), field.name));
+        }
+        code.push_str("    size_t checksum_mark = 0;\n");
+    }
+    let reads: Vec<&LirOperation> = lir_type
+        .operations
+        .iter()
+        .take_while(|op| !matches!(op, LirOperation::CreateStruct { .. }))
+        .collect();
+    code.push_str(&emitter.operations(&reads)?);
+    code.push_str("    return true;\n}\n\n");
+    Ok(code)
+}
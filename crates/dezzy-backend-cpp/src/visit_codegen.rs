@@ -0,0 +1,441 @@
+//! `visit()`: SAX-style traversal that reports fields to a visitor in wire order.
+//!
+//! Nothing is materialized except the values later fields depend on. Those live
+//! in a local `result` struct holding only scalars, fixed arrays and views into
+//! the input, so sizes, conditions and assertions reuse the read-side generators
+//! unchanged.
+
+use crate::codegen::{checksum_class, checksum_fields, covered_fields, element_layout, endian_suffix, op_field_name, CppBackend};
+use crate::expr_codegen::generate_expr;
+use anyhow::Result;
+use dezzy_core::hir::{Endianness, HirEnum, HirPrimitiveType};
+use dezzy_core::lir::{LirField, LirOperation, LirType, VarId};
+use std::collections::HashMap;
+
+/// Identifier of a field in the format-wide `FieldId` enum
+pub(crate) fn field_id(type_name: &str, field_name: &str) -> String {
+    format!("{}_{}", type_name, field_name)
+}
+
+/// Fields that produce visitor events (skips and `pos:` instances do not)
+pub(crate) fn visited_fields(lir_type: &LirType) -> impl Iterator<Item = &LirField> {
+    lir_type.fields.iter().filter(|f| f.skip.is_none() && f.instance.is_none())
+}
+
+fn scalar_name(cpp_type: &str) -> Option<&'static str> {
+    Some(match cpp_type {
+        "uint8_t" => "u8",
+        "uint16_t" => "u16",
+        "uint32_t" => "u32",
+        "uint64_t" => "u64",
+        "int8_t" => "i8",
+        "int16_t" => "i16",
+        "int32_t" => "i32",
+        "int64_t" => "i64",
+        _ => return None,
+    })
+}
+
+fn underlying_cpp_type(primitive: HirPrimitiveType) -> &'static str {
+    match primitive {
+        HirPrimitiveType::U16 => "uint16_t",
+        HirPrimitiveType::U32 => "uint32_t",
+        HirPrimitiveType::U64 => "uint64_t",
+        HirPrimitiveType::I8 => "int8_t",
+        HirPrimitiveType::I16 => "int16_t",
+        HirPrimitiveType::I32 => "int32_t",
+        HirPrimitiveType::I64 => "int64_t",
+        _ => "uint8_t",
+    }
+}
+
+struct VisitEmitter<'a> {
+    backend: &'a CppBackend,
+    lir_type: &'a LirType,
+    var_to_field: HashMap<VarId, String>,
+    enums: &'a [HirEnum],
+    endianness: Endianness,
+}
+
+impl<'a> VisitEmitter<'a> {
+    fn name(&self, var: &VarId) -> &str {
+        self.var_to_field.get(var).map(|s| s.as_str()).unwrap_or("unknown")
+    }
+
+    fn field(&self, var: &VarId) -> Option<&'a LirField> {
+        self.lir_type.fields.iter().find(|f| f.var_id == *var)
+    }
+
+    fn id(&self, field: &LirField) -> String {
+        format!("FieldId::{}", field_id(&self.lir_type.name, &field.name))
+    }
+
+    fn is_enum(&self, type_name: &str) -> Option<&'a HirEnum> {
+        self.enums.iter().find(|e| e.name == type_name)
+    }
+
+    /// Type of the field in the local `result` struct, or None if it is never kept
+    fn shadow_type(&self, field: &LirField, until_condition: bool) -> Option<String> {
+        let cpp_type = self.backend.lir_type_to_cpp_type(&field.type_info);
+        if until_condition {
+            // Only the last element is kept, for evaluating the terminating condition
+            let element = cpp_type.strip_prefix("std::vector<")?.strip_suffix('>')?;
+            return Some(format!("std::array<{}, 1>", element));
+        }
+        if scalar_name(&cpp_type).is_some() || self.is_enum(&cpp_type).is_some() {
+            return Some(cpp_type);
+        }
+        if cpp_type == "std::string" {
+            return Some("std::string_view".to_string());
+        }
+        if cpp_type == "std::vector<uint8_t>" {
+            return Some("std::span<const uint8_t>".to_string());
+        }
+        if let Some(inner) = cpp_type.strip_prefix("std::array<") {
+            let element = inner.split(',').next()?;
+            if scalar_name(element).is_some() {
+                return Some(cpp_type);
+            }
+        }
+        None
+    }
+
+    fn read_expr(&self, op: &LirOperation, cpp_type: &str) -> String {
+        let suffix = if cpp_type.ends_with("8_t") { "_le" } else { endian_suffix(op.endianness().unwrap_or(self.endianness)) };
+        format!("reader.read{}<{}>()", suffix, cpp_type)
+    }
+
+    fn element_type(op: &LirOperation) -> Option<&'static str> {
+        Some(match op {
+            LirOperation::ReadU8 { .. } => "uint8_t",
+            LirOperation::ReadI8 { .. } => "int8_t",
+            LirOperation::ReadU16 { .. } => "uint16_t",
+            LirOperation::ReadI16 { .. } => "int16_t",
+            LirOperation::ReadU32 { .. } => "uint32_t",
+            LirOperation::ReadI32 { .. } => "int32_t",
+            LirOperation::ReadU64 { .. } => "uint64_t",
+            LirOperation::ReadI64 { .. } => "int64_t",
+            _ => return None,
+        })
+    }
+
+    fn assertion(&self, field: &LirField) -> String {
+        match field.assertion {
+            Some(ref assertion) => self.backend.generate_assertion_check(&field.name, assertion),
+            None => String::new(),
+        }
+    }
+
+    /// Per-element events for arrays that are not plain bytes
+    fn element(&self, element_op: &LirOperation, id: &str, keep: Option<&str>) -> Result<String> {
+        if let LirOperation::ReadStruct { type_name, .. } = element_op {
+            let mut code = format!("        visitor.begin_struct({});\n", id);
+            match keep {
+                Some(last) => {
+                    // Terminating conditions look at the last element, so that one is materialized
+                    code.push_str("        {\n");
+                    code.push_str("            Reader element = reader;\n");
+                    code.push_str(&format!("            {}::visit(reader, visitor);\n", type_name));
+                    code.push_str(&format!("            {}[0] = {}::read(element);\n", last, type_name));
+                    code.push_str("        }\n");
+                }
+                None => code.push_str(&format!("        {}::visit(reader, visitor);\n", type_name)),
+            }
+            code.push_str(&format!("        visitor.end_struct({});\n", id));
+            return Ok(code);
+        }
+
+        let cpp_type = Self::element_type(element_op)
+            .ok_or_else(|| anyhow::anyhow!("Unsupported array element in visit()"))?;
+        let callback = scalar_name(cpp_type).unwrap_or("u8");
+        Ok(match keep {
+            Some(last) => format!(
+                "        {last}[0] = {};\n        visitor.on_{callback}({id}, {last}[0]);\n",
+                self.read_expr(element_op, cpp_type)
+            ),
+            None => format!("        visitor.on_{callback}({id}, {});\n", self.read_expr(element_op, cpp_type)),
+        })
+    }
+
+    fn operation(&self, op: &LirOperation) -> Result<String> {
+        let dest_field = op_field_name(op, &self.var_to_field).and_then(|name| {
+            self.lir_type.fields.iter().find(|f| f.name == name)
+        });
+
+        if let Some(cpp_type) = Self::element_type(op) {
+            let field = dest_field.expect("scalar read without a field");
+            let target = format!("result.{}", field.name);
+            let mut code = match self.is_enum(&field.type_info) {
+                Some(enum_def) => {
+                    let raw = underlying_cpp_type(enum_def.underlying_type);
+                    format!(
+                        "    {} = static_cast<{}>({});\n    visitor.on_{}({}, static_cast<{}>({}));\n",
+                        target, enum_def.name, self.read_expr(op, cpp_type), scalar_name(raw).unwrap_or("u8"),
+                        self.id(field), raw, target
+                    )
+                }
+                None => format!(
+                    "    {} = {};\n    visitor.on_{}({}, {});\n",
+                    target, self.read_expr(op, cpp_type), scalar_name(cpp_type).unwrap_or("u8"), self.id(field), target
+                ),
+            };
+            code.push_str(&self.assertion(field));
+            return Ok(code);
+        }
+
+        Ok(match op {
+            LirOperation::ReadArray { dest, element_op, count } => {
+                let field = self.field(dest).expect("array without a field");
+                let id = self.id(field);
+                if matches!(element_op.as_ref(), LirOperation::ReadU8 { .. } | LirOperation::ReadI8 { .. }) {
+                    let mut code = "    {\n".to_string();
+                    code.push_str(&format!("        const auto bytes = reader.read_bytes({});\n", count));
+                    code.push_str(&format!("        std::memcpy(result.{}.data(), bytes.data(), bytes.size());\n", field.name));
+                    code.push_str(&format!("        visitor.on_bytes({}, bytes);\n", id));
+                    code.push_str("    }\n");
+                    code.push_str(&self.assertion(field));
+                    code
+                } else {
+                    let mut code = format!("    visitor.begin_array({}, {});\n", id, count);
+                    code.push_str(&format!("    for (size_t i = 0; i < {}; ++i) {{\n", count));
+                    if let Some(cpp_type) = Self::element_type(element_op) {
+                        code.push_str(&format!("        result.{}[i] = {};\n", field.name, self.read_expr(element_op, cpp_type)));
+                        code.push_str(&format!(
+                            "        visitor.on_{}({}, result.{}[i]);\n",
+                            scalar_name(cpp_type).unwrap_or("u8"), id, field.name
+                        ));
+                    } else {
+                        code.push_str(&self.element(element_op, &id, None)?);
+                    }
+                    code.push_str("    }\n");
+                    code.push_str(&format!("    visitor.end_array({});\n", id));
+                    code
+                }
+            }
+            LirOperation::ReadDynamicArray { dest, element_op, size_var } => {
+                let field = self.field(dest).expect("array without a field");
+                let id = self.id(field);
+                let count = format!("static_cast<size_t>(result.{})", self.name(size_var));
+                if matches!(element_op.as_ref(), LirOperation::ReadU8 { .. }) {
+                    format!(
+                        "    result.{name} = reader.read_bytes({count});\n    visitor.on_bytes({id}, result.{name});\n",
+                        name = field.name
+                    )
+                } else {
+                    // Nothing is allocated, but a count the input cannot hold still fails up front
+                    let (_, min_size) = element_layout(element_op);
+                    let mut code = format!("    reader.admit({}, {}, 0);\n", count, min_size);
+                    code.push_str(&format!("    visitor.begin_array({}, {});\n", id, count));
+                    code.push_str(&format!("    for (size_t i = 0; i < {}; ++i) {{\n", count));
+                    code.push_str(&self.element(element_op, &id, None)?);
+                    code.push_str("    }\n");
+                    code.push_str(&format!("    visitor.end_array({});\n", id));
+                    code
+                }
+            }
+            LirOperation::ReadBlob { dest, size_var } => {
+                let field = self.field(dest).expect("blob without a field");
+                let mut code = format!(
+                    "    result.{name} = reader.read_bytes(static_cast<size_t>(result.{size}));\n    visitor.on_bytes({id}, result.{name});\n",
+                    name = field.name,
+                    size = self.name(size_var),
+                    id = self.id(field)
+                );
+                code.push_str(&self.assertion(field));
+                code
+            }
+            LirOperation::ReadUntilEofArray { dest, element_op } => {
+                let field = self.field(dest).expect("array without a field");
+                let id = self.id(field);
+                let mut code = format!("    visitor.begin_array({}, unknown_count);\n", id);
+                code.push_str("    while (reader.remaining() > 0) {\n");
+                code.push_str(&self.element(element_op, &id, None)?);
+                code.push_str("    }\n");
+                code.push_str(&format!("    visitor.end_array({});\n", id));
+                code
+            }
+            LirOperation::ReadUntilConditionArray { dest, element_op, condition } => {
+                let field = self.field(dest).expect("array without a field");
+                let id = self.id(field);
+                let target = format!("result.{}", field.name);
+                let mut code = format!("    visitor.begin_array({}, unknown_count);\n", id);
+                code.push_str("    do {\n");
+                code.push_str(&self.element(element_op, &id, Some(&target))?);
+                code.push_str(&format!("    }} while (!{});\n", generate_expr(condition, &target)?));
+                code.push_str(&format!("    visitor.end_array({});\n", id));
+                code
+            }
+            LirOperation::ReadStruct { dest, type_name } => {
+                let field = self.field(dest).expect("struct without a field");
+                let id = self.id(field);
+                format!(
+                    "    visitor.begin_struct({id});\n    {type_name}::visit(reader, visitor);\n    visitor.end_struct({id});\n"
+                )
+            }
+            LirOperation::ReadSizedStruct { dest, type_name, size_var } => {
+                let field = self.field(dest).expect("struct without a field");
+                let id = self.id(field);
+                format!(
+                    "    visitor.begin_struct({id});\n    {{\n        auto window = reader.window(result.{size});\n        {type_name}::visit(window, visitor);\n    }}\n    visitor.end_struct({id});\n",
+                    size = self.name(size_var)
+                )
+            }
+            LirOperation::ReadFixedString { dest, length } => self.string(dest, &length.to_string()),
+            LirOperation::ReadLengthPrefixedString { dest, length_var } => {
+                self.string(dest, &format!("static_cast<size_t>(result.{})", self.name(length_var)))
+            }
+            LirOperation::ReadNullTerminatedString { dest } => {
+                let field = self.field(dest).expect("string without a field");
+                let mut code = "    {\n".to_string();
+                code.push_str("        const auto rest = reader.data().subspan(reader.position());\n");
+                code.push_str("        const void* nul = std::memchr(rest.data(), 0, rest.size());\n");
+                code.push_str("        if (nul == nullptr) {\n");
+                code.push_str("            throw ParseError(\"Unexpected end of data\", ErrorKind::Truncated);\n");
+                code.push_str("        }\n");
+                code.push_str("        const size_t length = static_cast<size_t>(static_cast<const uint8_t*>(nul) - rest.data());\n");
+                code.push_str(&format!(
+                    "        result.{} = std::string_view(reinterpret_cast<const char*>(rest.data()), length);\n",
+                    field.name
+                ));
+                code.push_str("        reader.skip(length + 1);\n");
+                code.push_str("    }\n");
+                code.push_str(&format!("    visitor.on_string({}, result.{});\n", self.id(field), field.name));
+                code.push_str(&self.assertion(field));
+                code
+            }
+            LirOperation::ReadBits { dest, num_bits, signed } => {
+                let field = self.field(dest).expect("bitfield without a field");
+                let read = if *signed { "read_signed_bits_msb" } else { "read_bits_msb" };
+                let mut code = format!("    result.{} = bit_reader.{}({});\n", field.name, read, num_bits);
+                code.push_str(&format!(
+                    "    visitor.on_bits({}, result.{}, {});\n",
+                    self.id(field), field.name, num_bits
+                ));
+                code.push_str(&self.assertion(field));
+                code
+            }
+            LirOperation::Skip { size_var } => {
+                format!("    reader.skip(result.{});\n", self.name(size_var))
+            }
+            LirOperation::PadFixed { bytes } => format!("    reader.skip({});\n", bytes),
+            LirOperation::Align { boundary } => format!(
+                "    reader.skip(({b} - (reader.position() % {b})) % {b});\n",
+                b = boundary
+            ),
+            LirOperation::ConditionalBlock { condition, true_ops } => {
+                let condition_code = generate_expr(condition, "result").unwrap_or_else(|_| "false".to_string());
+                let mut code = format!("    if ({}) {{\n", condition_code);
+                for inner in true_ops {
+                    for line in self.operation(inner)?.lines().filter(|l| !l.is_empty()) {
+                        code.push_str("    ");
+                        code.push_str(line);
+                        code.push('\n');
+                    }
+                }
+                code.push_str("    }\n");
+                code
+            }
+            _ => String::new(),
+        })
+    }
+
+    fn string(&self, dest: &VarId, length: &str) -> String {
+        let field = self.field(dest).expect("string without a field");
+        let mut code = "    {\n".to_string();
+        code.push_str(&format!("        const auto bytes = reader.read_bytes({});\n", length));
+        code.push_str(&format!(
+            "        result.{} = std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size());\n",
+            field.name
+        ));
+        code.push_str("    }\n");
+        code.push_str(&format!("    visitor.on_string({}, result.{});\n", self.id(field), field.name));
+        code.push_str(&self.assertion(field));
+        code
+    }
+}
+
+pub(crate) fn generate_visit(
+    backend: &CppBackend,
+    lir_type: &LirType,
+    endianness: Endianness,
+    enums: &[HirEnum],
+) -> Result<String> {
+    let emitter = VisitEmitter {
+        backend,
+        lir_type,
+        var_to_field: backend.build_var_to_field_map(&lir_type.fields),
+        enums,
+        endianness,
+    };
+
+    let until_condition: Vec<VarId> = lir_type
+        .operations
+        .iter()
+        .filter_map(|op| match op {
+            LirOperation::ReadUntilConditionArray { dest, .. } => Some(*dest),
+            _ => None,
+        })
+        .collect();
+
+    let mut code = "#if defined(DEZZY_VISITOR)\ntemplate<typename V>\n".to_string();
+    code.push_str(&format!("inline void {}::visit(Reader& reader, V& visitor) {{\n", lir_type.name));
+
+    // Values later fields may depend on (sizes, conditions, assertions); no allocation
+    let members: Vec<String> = visited_fields(lir_type)
+        .filter_map(|field| {
+            emitter
+                .shadow_type(field, until_condition.contains(&field.var_id))
+                .map(|shadow| format!("        {} {};\n", shadow, field.name))
+        })
+        .collect();
+    if !members.is_empty() {
+        code.push_str("    struct {\n");
+        code.push_str(&members.concat());
+        code.push_str("    } result{};\n");
+    }
+
+    if lir_type.operations.iter().any(|op| matches!(op, LirOperation::ReadBits { .. })) {
+        code.push_str("    BitReader bit_reader(reader);\n");
+    }
+
+    let checksums = checksum_fields(&lir_type.fields);
+    let covered = covered_fields(&checksums);
+    if !checksums.is_empty() {
+        code.push_str("    const bool verify_checksums = verify_checksums_enabled && reader.verify_checksums();\n");
+        for field in &checksums {
+            code.push_str(&format!("    {} {}_checksum;\n", checksum_class(field), field.name));
+        }
+        code.push_str("    size_t checksum_mark = 0;\n");
+    }
+
+    for op in &lir_type.operations {
+        if matches!(op, LirOperation::CreateStruct { .. }) {
+            break;
+        }
+
+        let field_name = op_field_name(op, &emitter.var_to_field);
+        let accumulators = field_name.and_then(|name| covered.get(name));
+        if accumulators.is_some() {
+            code.push_str("    checksum_mark = reader.position();\n");
+        }
+
+        code.push_str(&emitter.operation(op)?);
+
+        if let Some(accumulators) = accumulators {
+            code.push_str("    if (verify_checksums) {\n");
+            for accumulator in accumulators {
+                code.push_str(&format!("        {}_checksum.update(reader.bytes_since(checksum_mark));\n", accumulator));
+            }
+            code.push_str("    }\n");
+        }
+        if let Some(field) = checksums.iter().find(|f| Some(f.name.as_str()) == field_name) {
+            code.push_str(&format!("    if (verify_checksums && result.{} != {}_checksum.value()) {{\n", field.name, field.name));
+            code.push_str(&format!("        throw ParseError(\"Checksum mismatch for field '{}'\", ErrorKind::Checksum);\n", field.name));
+            code.push_str("    }\n");
+        }
+    }
+
+    code.push_str("}\n");
+    code.push_str("#endif\n\n");
+    Ok(code)
+}
@@ -3,10 +3,10 @@
 
 use anyhow::{Context, Result};
 use clap::{Parser, Subcommand};
-use dezzy_backend::{PluginRegistry, WasmBackend};
-use dezzy_backend_cpp::CppBackend;
+use dezzy_backend::{Backend, PluginRegistry, WasmBackend};
+use dezzy_backend_cpp::{generate_bench, CppBackend};
 use dezzy_core::pipeline::Pipeline;
-use dezzy_parser::parse_format;
+use dezzy_parser::{parse_format, parse_projection_spec};
 use serde::Deserialize;
 use std::fs;
 use std::path::{Path, PathBuf};
@@ -31,11 +31,26 @@ enum Commands {
 
         #[arg(short, long, help = "Output directory")]
         output: String,
+
+        #[arg(
+            long = "project",
+            value_name = "TYPE=FIELD,...",
+            help = "Also generate a slim reader for TYPE that decodes only the listed fields"
+        )]
+        projections: Vec<String>,
     },
     Validate {
         #[arg(help = "Input format definition file")]
         input: String,
     },
+    #[command(about = "Generate the C++ header plus a benchmark of read/write for every type")]
+    Bench {
+        #[arg(help = "Input format definition file")]
+        input: String,
+
+        #[arg(short, long, help = "Output directory")]
+        output: String,
+    },
     #[command(about = "List all available code generation backends")]
     ListBackends,
 }
@@ -62,8 +77,10 @@ fn main() -> Result<()> {
             input,
             backend,
             output,
-        } => compile_command(&input, &backend, &output),
+            projections,
+        } => compile_command(&input, &backend, &output, &projections),
         Commands::Validate { input } => validate_command(&input),
+        Commands::Bench { input, output } => bench_command(&input, &output),
         Commands::ListBackends => list_backends_command(),
     }
 }
@@ -132,11 +149,11 @@ fn list_backends_command() -> Result<()> {
     Ok(())
 }
 
-fn compile_command(input_path: &str, backend_name: &str, output_spec: &str) -> Result<()> {
+fn compile_command(input_path: &str, backend_name: &str, output_spec: &str, projections: &[String]) -> Result<()> {
     let yaml_content = fs::read_to_string(input_path)
         .with_context(|| format!("Failed to read input file: {}", input_path))?;
 
-    let hir_format = match parse_format(&yaml_content) {
+    let mut hir_format = match parse_format(&yaml_content) {
         Ok(format) => format,
         Err(e) => {
             eprintln!("Error parsing format definition:");
@@ -147,6 +164,10 @@ fn compile_command(input_path: &str, backend_name: &str, output_spec: &str) -> R
 
     println!("Parsed format: {}", hir_format.name);
 
+    for spec in projections {
+        hir_format.projections.push(parse_projection_spec(spec)?);
+    }
+
     let mut pipeline = Pipeline::new();
     let lir_format = pipeline
         .lower(hir_format)
@@ -194,6 +215,40 @@ fn compile_command(input_path: &str, backend_name: &str, output_spec: &str) -> R
     Ok(())
 }
 
+fn bench_command(input_path: &str, output_dir: &str) -> Result<()> {
+    let yaml_content = fs::read_to_string(input_path)
+        .with_context(|| format!("Failed to read input file: {}", input_path))?;
+    let hir_format = parse_format(&yaml_content)?;
+    let lir_format = Pipeline::new()
+        .lower(hir_format)
+        .context("Failed to lower HIR to LIR")?;
+
+    let mut files = CppBackend::new()
+        .generate(&lir_format)
+        .context("Backend 'cpp' failed to generate code")?
+        .files;
+    files.push(generate_bench(&lir_format)?);
+
+    let output_dir = Path::new(output_dir);
+    fs::create_dir_all(output_dir)
+        .with_context(|| format!("Failed to create output directory: {}", output_dir.display()))?;
+    for file in &files {
+        let file_path = output_dir.join(&file.path);
+        fs::write(&file_path, &file.content)
+            .with_context(|| format!("Failed to write output file: {}", file_path.display()))?;
+        println!("Generated: {}", file_path.display());
+    }
+
+    let bench = &files[files.len() - 1].path;
+    println!(
+        "Build with: g++ -std=c++20 -O2 -DNDEBUG {} -o {}",
+        output_dir.join(bench).display(),
+        bench.trim_end_matches(".cpp")
+    );
+
+    Ok(())
+}
+
 fn validate_command(input_path: &str) -> Result<()> {
     let yaml_content = fs::read_to_string(input_path)
         .with_context(|| format!("Failed to read input file: {}", input_path))?;
@@ -72,6 +72,29 @@ pub enum Literal {
     String(String),
 }
 
+impl Expr {
+    /// Names this expression reads from the enclosing struct (roots of accesses)
+    #[must_use]
+    pub fn referenced_names(&self) -> Vec<&str> {
+        let mut names = Vec::new();
+        self.collect_names(&mut names);
+        names
+    }
+
+    fn collect_names<'a>(&'a self, names: &mut Vec<&'a str>) {
+        match self {
+            Expr::FieldAccess { base, .. } => base.collect_names(names),
+            Expr::ArrayIndex { array, .. } => array.collect_names(names),
+            Expr::Variable(name) => names.push(name),
+            Expr::Comparison { left, right, .. } | Expr::Logical { left, right, .. } => {
+                left.collect_names(names);
+                right.collect_names(names);
+            }
+            Expr::Literal(_) => {}
+        }
+    }
+}
+
 impl ComparisonOp {
     pub fn from_str(s: &str) -> Option<Self> {
         match s {
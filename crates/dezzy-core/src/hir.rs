@@ -6,9 +6,22 @@ pub struct HirFormat {
     pub name: String,
     pub version: Option<String>,
     pub endianness: Endianness,
+    /// Condition selecting big-endian input when `endianness` is `Runtime`
+    #[serde(default)]
+    pub endianness_from: Option<Expr>,
     pub bit_order: BitOrder,
     pub enums: Vec<HirEnum>,
     pub types: Vec<HirTypeDef>,
+    #[serde(default)]
+    pub projections: Vec<HirProjection>,
+}
+
+/// Slim variant of a struct that decodes only `fields` (plus what they depend on)
+#[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
+pub struct HirProjection {
+    pub name: String,
+    pub type_name: String,
+    pub fields: Vec<String>,
 }
 
 #[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
@@ -75,6 +88,16 @@ pub struct HirField {
     pub skip: Option<Skip>,
     /// If set, field only exists when condition is true
     pub if_condition: Option<Expr>,
+    /// If set, field holds a checksum computed over earlier fields
+    pub checksum: Option<HirChecksum>,
+    /// If set, field lives at an offset elsewhere in the data and is read lazily
+    pub pos: Option<HirPos>,
+    /// If set, overrides the format's byte order for this field's integers
+    #[serde(default)]
+    pub endianness: Option<Endianness>,
+    /// If set, the struct is read within a window of as many bytes as this field holds
+    #[serde(default)]
+    pub size: Option<String>,
 }
 
 #[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
@@ -87,6 +110,35 @@ pub enum Skip {
     Align(usize),
 }
 
+#[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
+pub struct HirPos {
+    pub offset: Expr,
+    pub base: PosBase,
+}
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Serialize, Deserialize)]
+pub enum PosBase {
+    /// Offset counts from the start of the underlying buffer
+    Stream,
+    /// Offset counts from the start of the enclosing struct
+    Struct,
+}
+
+#[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
+pub struct HirChecksum {
+    pub algorithm: ChecksumAlgorithm,
+    /// Fields (in wire order) whose encoded bytes feed the checksum
+    pub over: Vec<String>,
+}
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Serialize, Deserialize)]
+pub enum ChecksumAlgorithm {
+    /// CRC-32 with the ISO-HDLC polynomial (PNG, ZIP, gzip)
+    Crc32,
+    /// Adler-32 (zlib)
+    Adler32,
+}
+
 #[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
 pub enum HirAssertion {
     /// Value must equal the specified constant
@@ -180,6 +232,8 @@ pub enum Endianness {
     Little,
     Big,
     Native,
+    /// Chosen per input from a header value (`endianness: { from: <expr> }`)
+    Runtime,
 }
 
 #[derive(Debug, Clone, Copy, PartialEq, Eq, Serialize, Deserialize)]
@@ -1,6 +1,7 @@
 use crate::expr::Expr;
-use crate::hir::{Endianness, HirAssertion, HirEnum};
+use crate::hir::{Endianness, HirAssertion, HirChecksum, HirEnum, PosBase};
 use serde::{Deserialize, Serialize};
+use std::collections::HashSet;
 
 /// Type-safe wrapper for variable IDs in LIR
 #[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, Serialize, Deserialize)]
@@ -27,6 +28,27 @@ pub struct LirFormat {
     pub enums: Vec<HirEnum>,
     pub types: Vec<LirType>,
     pub endianness: Endianness,
+    /// Set when `endianness` is `Runtime`
+    #[serde(default)]
+    pub endianness_selector: Option<LirEndiannessSelector>,
+    #[serde(default)]
+    pub projections: Vec<LirProjection>,
+}
+
+/// Where a runtime byte order is decided: `condition` holds for big-endian input and
+/// only reads fields that `type_name` decodes before any byte-order-dependent field
+#[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
+pub struct LirEndiannessSelector {
+    pub type_name: String,
+    pub condition: Expr,
+}
+
+/// Slim reader for `type_name` that decodes `fields` and skips everything else
+#[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
+pub struct LirProjection {
+    pub name: String,
+    pub type_name: String,
+    pub fields: Vec<VarId>,
 }
 
 #[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
@@ -38,6 +60,33 @@ pub struct LirType {
     pub write_param: VarId,
 }
 
+impl LirType {
+    /// Fields a reader must decode to keep `selected` and still step over the rest of
+    /// the struct: the selection plus every field a read operation uses as a size,
+    /// length or condition. Returned in declaration order.
+    #[must_use]
+    pub fn retained_fields(&self, selected: &[VarId]) -> Vec<VarId> {
+        let mut keep: HashSet<VarId> = selected.iter().copied().collect();
+        for op in self.operations.iter().take_while(|op| !matches!(op, LirOperation::CreateStruct { .. })) {
+            // The end of an until-condition array is only known by decoding it
+            if let LirOperation::ReadUntilConditionArray { dest, .. } = op {
+                keep.insert(*dest);
+            }
+            keep.extend(op.size_refs());
+            for name in op.condition_refs() {
+                if let Some(field) = self.fields.iter().find(|f| f.name == name) {
+                    keep.insert(field.var_id);
+                }
+            }
+        }
+        self.fields
+            .iter()
+            .filter(|f| f.instance.is_none() && keep.contains(&f.var_id))
+            .map(|f| f.var_id)
+            .collect()
+    }
+}
+
 #[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
 pub struct LirField {
     pub name: String,
@@ -48,6 +97,23 @@ pub struct LirField {
     pub skip: Option<String>,
     /// True if field is conditional (has an if clause)
     pub is_optional: bool,
+    /// Checksum verified on read and filled on write
+    #[serde(default)]
+    pub checksum: Option<HirChecksum>,
+    /// Offset-addressed field, read on first access instead of in sequence
+    #[serde(default)]
+    pub instance: Option<LirInstance>,
+    /// Vectors, strings or blobs whose length this field holds; writers store their size
+    #[serde(default)]
+    pub length_of: Vec<VarId>,
+}
+
+#[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
+pub struct LirInstance {
+    pub offset: Expr,
+    pub base: PosBase,
+    /// Read operation executed at `offset` (its dest is the field's var_id)
+    pub read_op: LirOperation,
 }
 
 #[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
@@ -134,6 +200,12 @@ pub enum LirOperation {
         dest: VarId,
         type_name: String,
     },
+    /// Struct read from a window of `size_var` bytes; what it leaves of the window is skipped
+    ReadSizedStruct {
+        dest: VarId,
+        type_name: String,
+        size_var: VarId,
+    },
     WriteU8 {
         src: VarId,
     },
@@ -211,6 +283,12 @@ pub enum LirOperation {
         src: VarId,
         type_name: String,
     },
+    /// Struct padded with zeros to the `size_var` bytes its window was given
+    WriteSizedStruct {
+        src: VarId,
+        type_name: String,
+        size_var: VarId,
+    },
     CreateStruct {
         dest: VarId,
         type_name: String,
@@ -227,3 +305,68 @@ pub enum LirOperation {
         true_ops: Vec<LirOperation>,
     },
 }
+
+impl LirOperation {
+    /// Byte order of a multi-byte scalar read or write; `None` for every other operation
+    #[must_use]
+    pub fn endianness(&self) -> Option<Endianness> {
+        match self {
+            LirOperation::ReadU16 { endianness, .. }
+            | LirOperation::ReadU32 { endianness, .. }
+            | LirOperation::ReadU64 { endianness, .. }
+            | LirOperation::ReadI16 { endianness, .. }
+            | LirOperation::ReadI32 { endianness, .. }
+            | LirOperation::ReadI64 { endianness, .. }
+            | LirOperation::WriteU16 { endianness, .. }
+            | LirOperation::WriteU32 { endianness, .. }
+            | LirOperation::WriteU64 { endianness, .. }
+            | LirOperation::WriteI16 { endianness, .. }
+            | LirOperation::WriteI32 { endianness, .. }
+            | LirOperation::WriteI64 { endianness, .. } => Some(*endianness),
+            _ => None,
+        }
+    }
+
+    /// True if the operation decodes the same way whatever the runtime byte order is
+    #[must_use]
+    pub fn is_order_independent(&self) -> bool {
+        match self {
+            LirOperation::ReadStruct { .. }
+            | LirOperation::ReadSizedStruct { .. }
+            | LirOperation::ConditionalBlock { .. } => false,
+            LirOperation::ReadArray { element_op, .. }
+            | LirOperation::ReadDynamicArray { element_op, .. }
+            | LirOperation::ReadUntilEofArray { element_op, .. }
+            | LirOperation::ReadUntilConditionArray { element_op, .. } => element_op.is_order_independent(),
+            _ => self.endianness() != Some(Endianness::Runtime),
+        }
+    }
+
+    /// Variables a read operation takes its byte or element count from
+    #[must_use]
+    pub fn size_refs(&self) -> Vec<VarId> {
+        match self {
+            LirOperation::ReadDynamicArray { size_var, .. }
+            | LirOperation::ReadBlob { size_var, .. }
+            | LirOperation::ReadSizedStruct { size_var, .. }
+            | LirOperation::Skip { size_var } => vec![*size_var],
+            LirOperation::ReadLengthPrefixedString { length_var, .. } => vec![*length_var],
+            LirOperation::ConditionalBlock { true_ops, .. } => true_ops.iter().flat_map(LirOperation::size_refs).collect(),
+            _ => Vec::new(),
+        }
+    }
+
+    /// Names read by the conditions guarding or terminating a read operation
+    #[must_use]
+    pub fn condition_refs(&self) -> Vec<&str> {
+        match self {
+            LirOperation::ReadUntilConditionArray { condition, .. } => condition.referenced_names(),
+            LirOperation::ConditionalBlock { condition, true_ops } => {
+                let mut names = condition.referenced_names();
+                names.extend(true_ops.iter().flat_map(LirOperation::condition_refs));
+                names
+            }
+            _ => Vec::new(),
+        }
+    }
+}
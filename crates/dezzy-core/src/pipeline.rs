@@ -1,5 +1,7 @@
-use crate::hir::{HirFormat, HirPrimitiveType, HirStruct, HirType, HirTypeDef, Skip};
-use crate::lir::{LirField, LirFormat, LirOperation, LirType, VarId};
+use crate::hir::{Endianness, HirField, HirFormat, HirPrimitiveType, HirStruct, HirType, HirTypeDef, Skip};
+use crate::hir::HirProjection;
+use crate::expr::Expr;
+use crate::lir::{LirEndiannessSelector, LirField, LirFormat, LirInstance, LirOperation, LirProjection, LirType, VarId};
 use std::collections::HashMap;
 use thiserror::Error;
 
@@ -30,12 +32,56 @@ fn primitive_to_hir_type(prim: HirPrimitiveType) -> HirType {
     }
 }
 
+/// A plain integer field that sizes an unconditional vector, string or blob is written
+/// from that container's size; if it sizes several, they must agree
+fn mark_length_fields(fields: &mut [LirField], read_ops: &[LirOperation]) {
+    const INTEGERS: [&str; 8] = ["u8", "u16", "u32", "u64", "i8", "i16", "i32", "i64"];
+    for op in read_ops {
+        let (dest, size_var) = match op {
+            LirOperation::ReadDynamicArray { dest, size_var, .. } | LirOperation::ReadBlob { dest, size_var } => {
+                (*dest, *size_var)
+            }
+            LirOperation::ReadLengthPrefixedString { dest, length_var } => (*dest, *length_var),
+            _ => continue,
+        };
+        if let Some(field) = fields.iter_mut().find(|f| f.var_id == size_var) {
+            let derivable = !field.is_optional
+                && field.instance.is_none()
+                && field.checksum.is_none()
+                && INTEGERS.contains(&field.type_info.as_str());
+            if derivable {
+                field.length_of.push(dest);
+            }
+        }
+    }
+}
+
+/// Nested structs with a `size:` read from a window sized by an earlier field, and are
+/// padded out to it on write
+fn windowed(op: LirOperation, field: &HirField, field_map: &HashMap<String, VarId>) -> Result<LirOperation, PipelineError> {
+    let Some(ref size_field) = field.size else {
+        return Ok(op);
+    };
+    let size_var = *field_map
+        .get(size_field)
+        .ok_or_else(|| PipelineError::UnknownType(format!("Window size field '{}' not found", size_field)))?;
+    Ok(match op {
+        LirOperation::ReadStruct { dest, type_name } => LirOperation::ReadSizedStruct { dest, type_name, size_var },
+        LirOperation::WriteStruct { src, type_name } => LirOperation::WriteSizedStruct { src, type_name, size_var },
+        other => other,
+    })
+}
+
 #[derive(Debug, Error)]
 pub enum PipelineError {
     #[error("Unknown type reference: {0}")]
     UnknownType(String),
     #[error("Recursive type reference: {0}")]
     RecursiveType(String),
+    #[error("Invalid projection '{name}': {message}")]
+    InvalidProjection { name: String, message: String },
+    #[error("Invalid endianness selector: {0}")]
+    InvalidEndianness(String),
 }
 
 pub struct Pipeline {
@@ -60,11 +106,116 @@ impl Pipeline {
             }
         }
 
+        let mut projections = Vec::new();
+        for projection in &hir.projections {
+            let lir_projection = Self::lower_projection(projection, &lir_types, &hir)?;
+            if projections.iter().any(|p: &LirProjection| p.name == lir_projection.name) {
+                return Err(PipelineError::InvalidProjection {
+                    name: projection.name.clone(),
+                    message: "defined more than once".to_string(),
+                });
+            }
+            projections.push(lir_projection);
+        }
+
+        let endianness_selector = match (hir.endianness, &hir.endianness_from) {
+            (Endianness::Runtime, Some(condition)) => Some(Self::lower_endianness_selector(condition, &lir_types)?),
+            (Endianness::Runtime, None) => {
+                return Err(PipelineError::InvalidEndianness("runtime endianness needs a 'from' condition".to_string()));
+            }
+            (_, Some(_)) => {
+                return Err(PipelineError::InvalidEndianness("'from' requires runtime endianness".to_string()));
+            }
+            (_, None) => None,
+        };
+
         Ok(LirFormat {
             name: hir.name,
             enums: hir.enums,
             types: lir_types,
             endianness: hir.endianness,
+            endianness_selector,
+            projections,
+        })
+    }
+
+    /// The first struct that declares every field the condition reads decides the byte
+    /// order. Those fields, and every field before them, must decode the same either way.
+    fn lower_endianness_selector(condition: &Expr, types: &[LirType]) -> Result<LirEndiannessSelector, PipelineError> {
+        let names = condition.referenced_names();
+        if names.is_empty() {
+            return Err(PipelineError::InvalidEndianness("the condition reads no fields".to_string()));
+        }
+
+        let declares = |t: &&LirType| {
+            names
+                .iter()
+                .all(|name| t.fields.iter().any(|f| f.name == *name && f.skip.is_none() && f.instance.is_none()))
+        };
+        let entry = types.iter().find(declares).ok_or_else(|| {
+            PipelineError::InvalidEndianness(format!("no struct declares all of {}", names.join(", ")))
+        })?;
+
+        // lower_struct emits one read operation per sequential field, in declaration order
+        let mut pending: Vec<&str> = names.clone();
+        let sequential = entry.fields.iter().filter(|f| f.instance.is_none());
+        for (field, op) in sequential.zip(&entry.operations) {
+            if pending.is_empty() {
+                break;
+            }
+            if !op.is_order_independent() {
+                return Err(PipelineError::InvalidEndianness(format!(
+                    "'{}.{}' is read before the byte order is known; give it an explicit 'endian:'",
+                    entry.name, field.name
+                )));
+            }
+            pending.retain(|name| *name != field.name);
+        }
+
+        Ok(LirEndiannessSelector {
+            type_name: entry.name.clone(),
+            condition: condition.clone(),
+        })
+    }
+
+    fn lower_projection(
+        projection: &HirProjection,
+        types: &[LirType],
+        format: &HirFormat,
+    ) -> Result<LirProjection, PipelineError> {
+        let invalid = |message: String| PipelineError::InvalidProjection {
+            name: projection.name.clone(),
+            message,
+        };
+
+        let name_taken = format.enums.iter().any(|e| e.name == projection.name)
+            || types.iter().any(|t| t.name == projection.name);
+        if name_taken {
+            return Err(invalid("name collides with a type".to_string()));
+        }
+
+        let lir_type = types
+            .iter()
+            .find(|t| t.name == projection.type_name)
+            .ok_or_else(|| invalid(format!("unknown struct '{}'", projection.type_name)))?;
+
+        let mut fields = Vec::new();
+        for name in &projection.fields {
+            let field = lir_type
+                .fields
+                .iter()
+                .find(|f| &f.name == name)
+                .ok_or_else(|| invalid(format!("'{}' has no field '{}'", lir_type.name, name)))?;
+            if field.skip.is_some() || field.instance.is_some() {
+                return Err(invalid(format!("'{}' is a skip or pos: field and cannot be projected", name)));
+            }
+            fields.push(field.var_id);
+        }
+
+        Ok(LirProjection {
+            name: projection.name.clone(),
+            type_name: projection.type_name.clone(),
+            fields,
         })
     }
 
@@ -84,10 +235,22 @@ impl Pipeline {
             field_name_to_var.insert(field.name.clone(), field_var);
 
             let type_info = self.hir_type_to_string(&field.field_type);
+            let endianness = field.endianness.unwrap_or(format.endianness);
 
             // Convert Skip enum to Option<String> for LIR (just for metadata)
             let skip_marker = field.skip.as_ref().map(|_| "skip".to_string());
 
+            // Instances are read on demand at their offset, not in sequence
+            let instance = match field.pos {
+                Some(ref pos) => Some(LirInstance {
+                    offset: pos.offset.clone(),
+                    base: pos.base,
+                    read_op: self.lower_read_type(&field.field_type, field_var, format, endianness, &field_name_to_var)?,
+                }),
+                None => None,
+            };
+            let is_instance = instance.is_some();
+
             lir_fields.push(LirField {
                 name: field.name.clone(),
                 doc: field.doc.clone(),
@@ -96,8 +259,15 @@ impl Pipeline {
                 assertion: field.assertion.clone(),
                 skip: skip_marker,
                 is_optional: field.if_condition.is_some(),
+                checksum: field.checksum.clone(),
+                instance,
+                length_of: Vec::new(),
             });
 
+            if is_instance {
+                continue;
+            }
+
             // If this is a skip/pad/align field, generate appropriate operation instead of read
             if let Some(ref skip) = field.skip {
                 use crate::hir::Skip;
@@ -116,7 +286,8 @@ impl Pipeline {
                     }
                 }
             } else {
-                let read_op = self.lower_read_type(&field.field_type, field_var, format, &field_name_to_var)?;
+                let read_op = self.lower_read_type(&field.field_type, field_var, format, endianness, &field_name_to_var)?;
+                let read_op = windowed(read_op, field, &field_name_to_var)?;
 
                 // Wrap in conditional block if field has an if clause
                 if let Some(ref condition) = field.if_condition {
@@ -130,6 +301,8 @@ impl Pipeline {
             }
         }
 
+        mark_length_fields(&mut lir_fields, &read_ops);
+
         let result_var = self.next_var();
         read_ops.push(LirOperation::CreateStruct {
             dest: result_var,
@@ -141,6 +314,11 @@ impl Pipeline {
         let write_param = self.next_var();
 
         for (idx, field) in struct_def.fields.iter().enumerate() {
+            // Instances live outside the struct's own byte range
+            if field.pos.is_some() {
+                continue;
+            }
+
             // Handle skip/padding/alignment directives
             if let Some(ref skip) = field.skip {
                 match skip {
@@ -162,13 +340,15 @@ impl Pipeline {
             }
 
             let field_var = self.next_var();
+            let endianness = field.endianness.unwrap_or(format.endianness);
             let access_op = LirOperation::AccessField {
                 dest: field_var,
                 struct_var: write_param,
                 field_index: idx,
             };
 
-            let write_op = self.lower_write_type(&field.field_type, field_var, format, &field_name_to_var)?;
+            let write_op = self.lower_write_type(&field.field_type, field_var, format, endianness, &field_name_to_var)?;
+            let write_op = windowed(write_op, field, &field_name_to_var)?;
 
             // Wrap in conditional block if field has an if clause
             if let Some(ref condition) = field.if_condition {
@@ -244,34 +424,35 @@ impl Pipeline {
         ty: &HirType,
         dest: VarId,
         format: &HirFormat,
+        endianness: Endianness,
         field_map: &HashMap<String, VarId>,
     ) -> Result<LirOperation, PipelineError> {
         Ok(match ty {
             HirType::U8 => LirOperation::ReadU8 { dest },
             HirType::U16 => LirOperation::ReadU16 {
                 dest,
-                endianness: format.endianness,
+                endianness,
             },
             HirType::U32 => LirOperation::ReadU32 {
                 dest,
-                endianness: format.endianness,
+                endianness,
             },
             HirType::U64 => LirOperation::ReadU64 {
                 dest,
-                endianness: format.endianness,
+                endianness,
             },
             HirType::I8 => LirOperation::ReadI8 { dest },
             HirType::I16 => LirOperation::ReadI16 {
                 dest,
-                endianness: format.endianness,
+                endianness,
             },
             HirType::I32 => LirOperation::ReadI32 {
                 dest,
-                endianness: format.endianness,
+                endianness,
             },
             HirType::I64 => LirOperation::ReadI64 {
                 dest,
-                endianness: format.endianness,
+                endianness,
             },
             // Bitfield types
             HirType::U1 => LirOperation::ReadBits { dest, num_bits: 1, signed: false },
@@ -290,7 +471,7 @@ impl Pipeline {
             HirType::I7 => LirOperation::ReadBits { dest, num_bits: 7, signed: true },
             HirType::Array { element_type, size } => {
                 let dummy_var = self.next_var();
-                let element_op = self.lower_read_type(element_type, dummy_var, format, field_map)?;
+                let element_op = self.lower_read_type(element_type, dummy_var, format, endianness, field_map)?;
                 LirOperation::ReadArray {
                     dest,
                     element_op: Box::new(element_op),
@@ -302,7 +483,7 @@ impl Pipeline {
                     PipelineError::UnknownType(format!("Size field '{}' not found", size_field))
                 })?;
                 let dummy_var = self.next_var();
-                let element_op = self.lower_read_type(element_type, dummy_var, format, field_map)?;
+                let element_op = self.lower_read_type(element_type, dummy_var, format, endianness, field_map)?;
                 LirOperation::ReadDynamicArray {
                     dest,
                     element_op: Box::new(element_op),
@@ -311,7 +492,7 @@ impl Pipeline {
             }
             HirType::UntilEofArray { element_type } => {
                 let dummy_var = self.next_var();
-                let element_op = self.lower_read_type(element_type, dummy_var, format, field_map)?;
+                let element_op = self.lower_read_type(element_type, dummy_var, format, endianness, field_map)?;
                 LirOperation::ReadUntilEofArray {
                     dest,
                     element_op: Box::new(element_op),
@@ -319,7 +500,7 @@ impl Pipeline {
             }
             HirType::UntilConditionArray { element_type, condition } => {
                 let dummy_var = self.next_var();
-                let element_op = self.lower_read_type(element_type, dummy_var, format, field_map)?;
+                let element_op = self.lower_read_type(element_type, dummy_var, format, endianness, field_map)?;
                 LirOperation::ReadUntilConditionArray {
                     dest,
                     element_op: Box::new(element_op),
@@ -357,7 +538,7 @@ impl Pipeline {
 
                 // Lower as the underlying primitive type
                 let underlying_hir_type = primitive_to_hir_type(enum_def.underlying_type);
-                self.lower_read_type(&underlying_hir_type, dest, format, field_map)?
+                self.lower_read_type(&underlying_hir_type, dest, format, endianness, field_map)?
             }
             HirType::UserDefined(name) => LirOperation::ReadStruct {
                 dest,
@@ -371,34 +552,35 @@ impl Pipeline {
         ty: &HirType,
         src: VarId,
         format: &HirFormat,
+        endianness: Endianness,
         field_map: &HashMap<String, VarId>,
     ) -> Result<LirOperation, PipelineError> {
         Ok(match ty {
             HirType::U8 => LirOperation::WriteU8 { src },
             HirType::U16 => LirOperation::WriteU16 {
                 src,
-                endianness: format.endianness,
+                endianness,
             },
             HirType::U32 => LirOperation::WriteU32 {
                 src,
-                endianness: format.endianness,
+                endianness,
             },
             HirType::U64 => LirOperation::WriteU64 {
                 src,
-                endianness: format.endianness,
+                endianness,
             },
             HirType::I8 => LirOperation::WriteI8 { src },
             HirType::I16 => LirOperation::WriteI16 {
                 src,
-                endianness: format.endianness,
+                endianness,
             },
             HirType::I32 => LirOperation::WriteI32 {
                 src,
-                endianness: format.endianness,
+                endianness,
             },
             HirType::I64 => LirOperation::WriteI64 {
                 src,
-                endianness: format.endianness,
+                endianness,
             },
             // Bitfield types
             HirType::U1 => LirOperation::WriteBits { src, num_bits: 1 },
@@ -417,7 +599,7 @@ impl Pipeline {
             HirType::I7 => LirOperation::WriteBits { src, num_bits: 7 },
             HirType::Array { element_type, size } => {
                 let dummy_var = self.next_var();
-                let element_op = self.lower_write_type(element_type, dummy_var, format, field_map)?;
+                let element_op = self.lower_write_type(element_type, dummy_var, format, endianness, field_map)?;
                 LirOperation::WriteArray {
                     src,
                     element_op: Box::new(element_op),
@@ -429,7 +611,7 @@ impl Pipeline {
                     PipelineError::UnknownType(format!("Size field '{}' not found", size_field))
                 })?;
                 let dummy_var = self.next_var();
-                let element_op = self.lower_write_type(element_type, dummy_var, format, field_map)?;
+                let element_op = self.lower_write_type(element_type, dummy_var, format, endianness, field_map)?;
                 LirOperation::WriteDynamicArray {
                     src,
                     element_op: Box::new(element_op),
@@ -439,7 +621,7 @@ impl Pipeline {
             }
             HirType::UntilEofArray { element_type } => {
                 let dummy_var = self.next_var();
-                let element_op = self.lower_write_type(element_type, dummy_var, format, field_map)?;
+                let element_op = self.lower_write_type(element_type, dummy_var, format, endianness, field_map)?;
                 LirOperation::WriteUntilEofArray {
                     src,
                     element_op: Box::new(element_op),
@@ -447,7 +629,7 @@ impl Pipeline {
             }
             HirType::UntilConditionArray { element_type, .. } => {
                 let dummy_var = self.next_var();
-                let element_op = self.lower_write_type(element_type, dummy_var, format, field_map)?;
+                let element_op = self.lower_write_type(element_type, dummy_var, format, endianness, field_map)?;
                 LirOperation::WriteUntilConditionArray {
                     src,
                     element_op: Box::new(element_op),
@@ -478,7 +660,7 @@ impl Pipeline {
 
                 // Lower as the underlying primitive type
                 let underlying_hir_type = primitive_to_hir_type(enum_def.underlying_type);
-                self.lower_write_type(&underlying_hir_type, src, format, field_map)?
+                self.lower_write_type(&underlying_hir_type, src, format, endianness, field_map)?
             }
             HirType::UserDefined(name) => LirOperation::WriteStruct {
                 src,
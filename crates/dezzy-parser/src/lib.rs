@@ -9,4 +9,4 @@ mod parser;
 
 pub use error::ParseError;
 pub use expr_parser::parse_expr;
-pub use parser::parse_format;
+pub use parser::{parse_format, parse_projection_spec};
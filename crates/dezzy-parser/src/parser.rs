@@ -1,9 +1,10 @@
 use crate::error::ParseError;
 use crate::expr_parser::parse_expr;
-use crate::schema::{YamlEnum, YamlField, YamlFormat, YamlTypeDef};
+use crate::schema::{YamlChecksum, YamlEndianness, YamlEnum, YamlField, YamlFormat, YamlProjection, YamlTypeDef};
 use dezzy_core::hir::{
-    BitOrder, Endianness, HirAssertion, HirAssertValue, HirEnum, HirEnumValue, HirField,
-    HirFormat, HirPrimitiveType, HirStruct, HirType, HirTypeDef, Skip,
+    BitOrder, ChecksumAlgorithm, Endianness, HirAssertion, HirAssertValue, HirChecksum, HirEnum,
+    HirEnumValue, HirField, HirFormat, HirPos, HirPrimitiveType, HirProjection, HirStruct, HirType,
+    HirTypeDef, PosBase, Skip,
 };
 use std::collections::HashSet;
 
@@ -11,7 +12,11 @@ use std::collections::HashSet;
 pub fn parse_format(yaml_content: &str) -> Result<HirFormat, ParseError> {
     let yaml_format: YamlFormat = serde_yaml::from_str(yaml_content)?;
 
-    let endianness = parse_endianness(yaml_format.endianness.as_deref())?;
+    let (endianness, endianness_from) = match yaml_format.endianness {
+        Some(YamlEndianness::From { ref from }) => (Endianness::Runtime, Some(parse_expr(from)?)),
+        Some(YamlEndianness::Fixed(ref fixed)) => (parse_endianness(Some(fixed))?, None),
+        None => (parse_endianness(None)?, None),
+    };
     let bit_order = parse_bit_order(yaml_format.bit_order.as_deref())?;
 
     // Parse enums first
@@ -39,16 +44,58 @@ pub fn parse_format(yaml_content: &str) -> Result<HirFormat, ParseError> {
         hir_types.push(hir_type);
     }
 
+    let projections = yaml_format.projections.iter().map(parse_projection).collect();
+
     Ok(HirFormat {
         name: yaml_format.name,
         version: yaml_format.version,
         endianness,
+        endianness_from,
         bit_order,
         enums: hir_enums,
         types: hir_types,
+        projections,
     })
 }
 
+fn parse_projection(projection: &YamlProjection) -> HirProjection {
+    HirProjection {
+        name: projection
+            .name
+            .clone()
+            .unwrap_or_else(|| format!("{}Projection", projection.type_name)),
+        type_name: projection.type_name.clone(),
+        fields: projection.fields.clone(),
+    }
+}
+
+/// Parse a command-line projection such as `CentralDirectoryHeader=filename,compressed_size`
+#[must_use]
+pub fn parse_projection_spec(spec: &str) -> Result<HirProjection, ParseError> {
+    let invalid = |message: &str| ParseError::InvalidValue {
+        field: format!("projection '{}'", spec),
+        message: message.to_string(),
+    };
+
+    let (type_name, fields) = spec.split_once('=').ok_or_else(|| invalid("Expected TYPE=FIELD,..."))?;
+    let type_name = type_name.trim();
+    let fields: Vec<String> = fields
+        .split(',')
+        .map(str::trim)
+        .filter(|f| !f.is_empty())
+        .map(str::to_string)
+        .collect();
+    if type_name.is_empty() || fields.is_empty() {
+        return Err(invalid("Expected TYPE=FIELD,..."));
+    }
+
+    Ok(parse_projection(&YamlProjection {
+        type_name: type_name.to_string(),
+        name: None,
+        fields,
+    }))
+}
+
 fn parse_enum(enum_def: &YamlEnum) -> Result<HirEnum, ParseError> {
     let underlying_type = parse_primitive_type(&enum_def.underlying_type)?;
 
@@ -160,6 +207,8 @@ fn parse_type_def(
                 .map(|f| parse_field(f, known_types, enum_names))
                 .collect::<Result<Vec<_>, _>>()?;
 
+            validate_checksums(&hir_fields)?;
+
             Ok(HirTypeDef::Struct(HirStruct {
                 name: type_def.name.clone(),
                 doc: type_def.doc.clone(),
@@ -212,6 +261,35 @@ fn parse_field(
         None
     };
 
+    let checksum = if let Some(ref checksum) = field.checksum {
+        Some(parse_checksum(checksum, &field.name)?)
+    } else {
+        None
+    };
+
+    let pos = if let Some(ref pos_str) = field.pos {
+        Some(parse_pos(field, pos_str)?)
+    } else if field.pos_base.is_some() {
+        return Err(ParseError::InvalidValue {
+            field: field.name.clone(),
+            message: "'pos_base' requires 'pos'".to_string(),
+        });
+    } else {
+        None
+    };
+
+    if field.size.is_some() {
+        validate_size(field, &field_type, pos.is_some())?;
+    }
+
+    let endianness = match field.endian.as_deref() {
+        Some(endian) => Some(parse_endianness(Some(endian)).map_err(|_| ParseError::InvalidValue {
+            field: field.name.clone(),
+            message: format!("Unknown endian '{}', expected 'little', 'big', or 'native'", endian),
+        })?),
+        None => None,
+    };
+
     Ok(HirField {
         name: field.name.clone(),
         doc: field.doc.clone(),
@@ -219,9 +297,124 @@ fn parse_field(
         assertion,
         skip,
         if_condition,
+        checksum,
+        pos,
+        endianness,
+        size: field.size.clone(),
     })
 }
 
+/// `size:` gives a nested struct a window of bytes to be read from
+fn validate_size(field: &YamlField, field_type: &HirType, is_instance: bool) -> Result<(), ParseError> {
+    if !matches!(field_type, HirType::UserDefined(_)) {
+        return Err(ParseError::InvalidValue {
+            field: field.name.clone(),
+            message: "'size' applies only to struct-typed fields".to_string(),
+        });
+    }
+    if is_instance || field.skip.is_some() || field.padding.is_some() || field.align.is_some() {
+        return Err(ParseError::InvalidValue {
+            field: field.name.clone(),
+            message: "'size' cannot be combined with 'pos' or skip/padding/align".to_string(),
+        });
+    }
+    Ok(())
+}
+
+fn parse_pos(field: &YamlField, pos_str: &str) -> Result<HirPos, ParseError> {
+    if field.skip.is_some() || field.padding.is_some() || field.align.is_some() {
+        return Err(ParseError::InvalidValue {
+            field: field.name.clone(),
+            message: "'pos' cannot be combined with skip/padding/align".to_string(),
+        });
+    }
+    if field.if_condition.is_some() || field.checksum.is_some() || field.assertion.is_some() {
+        return Err(ParseError::InvalidValue {
+            field: field.name.clone(),
+            message: "'pos' cannot be combined with 'if', 'assert' or 'checksum'".to_string(),
+        });
+    }
+
+    let base = match field.pos_base.as_deref() {
+        None | Some("stream") => PosBase::Stream,
+        Some("struct") => PosBase::Struct,
+        Some(other) => {
+            return Err(ParseError::InvalidValue {
+                field: field.name.clone(),
+                message: format!("Unknown pos_base '{}', expected 'stream' or 'struct'", other),
+            })
+        }
+    };
+
+    Ok(HirPos {
+        offset: parse_expr(pos_str)?,
+        base,
+    })
+}
+
+fn parse_checksum(checksum: &YamlChecksum, field_name: &str) -> Result<HirChecksum, ParseError> {
+    let algorithm = match checksum.algo.as_str() {
+        "crc32" => ChecksumAlgorithm::Crc32,
+        "adler32" => ChecksumAlgorithm::Adler32,
+        other => {
+            return Err(ParseError::InvalidValue {
+                field: field_name.to_string(),
+                message: format!("Unknown checksum algo '{}', expected 'crc32' or 'adler32'", other),
+            })
+        }
+    };
+
+    if checksum.over.is_empty() {
+        return Err(ParseError::InvalidValue {
+            field: field_name.to_string(),
+            message: "Checksum 'over' must list at least one field".to_string(),
+        });
+    }
+
+    Ok(HirChecksum {
+        algorithm,
+        over: checksum.over.clone(),
+    })
+}
+
+/// Checksums are computed from bytes already on the wire, so every covered field
+/// must be a data field that precedes the checksum field itself.
+fn validate_checksums(fields: &[HirField]) -> Result<(), ParseError> {
+    for (index, field) in fields.iter().enumerate() {
+        let Some(ref checksum) = field.checksum else {
+            continue;
+        };
+
+        if field.field_type != HirType::U32 {
+            return Err(ParseError::InvalidValue {
+                field: field.name.clone(),
+                message: "Checksum fields must have type u32".to_string(),
+            });
+        }
+
+        for covered in &checksum.over {
+            let Some(target) = fields[..index].iter().find(|f| &f.name == covered) else {
+                return Err(ParseError::InvalidValue {
+                    field: field.name.clone(),
+                    message: format!(
+                        "Checksum covers '{}', which is not a field declared before '{}'",
+                        covered, field.name
+                    ),
+                });
+            };
+
+            if target.skip.is_some() {
+                return Err(ParseError::InvalidValue {
+                    field: field.name.clone(),
+                    message: format!("Checksum cannot cover skip/padding field '{}'", covered),
+                });
+            }
+        }
+    }
+
+    Ok(())
+}
+
 fn parse_assertion(
     value: &serde_yaml::Value,
     field_name: &str,
@@ -533,4 +726,255 @@ types:
         assert!(result2.is_ok());
         assert_eq!(result2.expect("parse_array_type should succeed (checked above)"), Some(("u8".to_string(), "length".to_string())));
     }
+
+    #[test]
+    fn test_parse_field_endian() {
+        let yaml = r#"
+name: Mixed
+endianness: little
+types:
+  - name: Header
+    type: struct
+    fields:
+      - name: magic
+        type: u32
+        endian: big
+      - name: count
+        type: u16
+"#;
+
+        let format = parse_format(yaml).expect("mixed-endian format should parse");
+        let HirTypeDef::Struct(ref header) = format.types[0];
+        assert_eq!(header.fields[0].endianness, Some(Endianness::Big));
+        assert_eq!(header.fields[1].endianness, None);
+
+        let bad = yaml.replace("endian: big", "endian: middle");
+        assert!(parse_format(&bad).is_err());
+    }
+
+    #[test]
+    fn test_parse_runtime_endianness() {
+        let yaml = r#"
+name: Capture
+endianness:
+  from: magic equals 0xd4c3b2a1
+types:
+  - name: GlobalHeader
+    type: struct
+    fields:
+      - name: magic
+        type: u32
+        endian: little
+      - name: version_major
+        type: u16
+"#;
+
+        let format = parse_format(yaml).expect("runtime endianness should parse");
+        assert_eq!(format.endianness, Endianness::Runtime);
+        assert!(format.endianness_from.is_some());
+
+        let lir = dezzy_core::pipeline::Pipeline::new().lower(format).expect("selector should lower");
+        let selector = lir.endianness_selector.expect("runtime formats carry a selector");
+        assert_eq!(selector.type_name, "GlobalHeader");
+
+        // The magic itself would be decoded differently depending on the outcome
+        let unpinned = parse_format(&yaml.replace("        endian: little\n", "")).expect("should parse");
+        assert!(dezzy_core::pipeline::Pipeline::new().lower(unpinned).is_err());
+    }
+
+    #[test]
+    fn test_parse_checksum_field() {
+        let yaml = r#"
+name: Chunked
+endianness: big
+types:
+  - name: Chunk
+    type: struct
+    fields:
+      - name: length
+        type: u32
+      - name: chunk_type
+        type: u8[4]
+      - name: data
+        type: u8[length]
+      - name: crc
+        type: u32
+        checksum:
+          algo: crc32
+          over: [chunk_type, data]
+"#;
+
+        let format = parse_format(yaml).expect("checksum format should parse");
+        let HirTypeDef::Struct(ref chunk) = format.types[0];
+        let checksum = chunk.fields[3].checksum.as_ref().expect("crc should carry a checksum");
+        assert_eq!(checksum.algorithm, ChecksumAlgorithm::Crc32);
+        assert_eq!(checksum.over, vec!["chunk_type".to_string(), "data".to_string()]);
+
+        // Covered fields must come before the checksum field
+        let forward = yaml.replace("over: [chunk_type, data]", "over: [crc]");
+        assert!(parse_format(&forward).is_err());
+
+        let unknown_algo = yaml.replace("algo: crc32", "algo: md5");
+        assert!(parse_format(&unknown_algo).is_err());
+    }
+
+    #[test]
+    fn test_parse_pos_instance() {
+        let yaml = r#"
+name: Archive
+types:
+  - name: Entry
+    type: struct
+    fields:
+      - name: value
+        type: u32
+  - name: Trailer
+    type: struct
+    fields:
+      - name: entry_offset
+        type: u32
+      - name: entry
+        type: Entry
+        pos: entry_offset
+        pos_base: struct
+"#;
+
+        let format = parse_format(yaml).expect("pos format should parse");
+        let HirTypeDef::Struct(ref trailer) = format.types[1];
+        let pos = trailer.fields[1].pos.as_ref().expect("entry should be an instance");
+        assert_eq!(pos.base, PosBase::Struct);
+
+        let bad_base = yaml.replace("pos_base: struct", "pos_base: parent");
+        assert!(parse_format(&bad_base).is_err());
+    }
+
+    #[test]
+    fn test_parse_sized_field() {
+        let yaml = r#"
+name: Archive
+types:
+  - name: Header
+    type: struct
+    fields:
+      - name: id
+        type: u32
+  - name: Record
+    type: struct
+    fields:
+      - name: header_size
+        type: u16
+      - name: header
+        type: Header
+        size: header_size
+"#;
+
+        let format = parse_format(yaml).expect("sized format should parse");
+        let HirTypeDef::Struct(ref record) = format.types[1];
+        assert_eq!(record.fields[1].size.as_deref(), Some("header_size"));
+
+        let not_struct = yaml.replace("type: Header\n", "type: u32\n");
+        assert!(parse_format(&not_struct).is_err());
+
+        let with_pos = yaml.replace("size: header_size", "size: header_size\n        pos: header_size");
+        assert!(parse_format(&with_pos).is_err());
+    }
+
+    #[test]
+    fn test_parse_projection() {
+        let yaml = r#"
+name: Archive
+types:
+  - name: Record
+    type: struct
+    fields:
+      - name: flags
+        type: u8
+      - name: name_length
+        type: u16
+      - name: extra_length
+        type: u16
+      - name: size
+        type: u32
+      - name: name
+        type: u8[name_length]
+      - name: extra
+        type: u8[extra_length]
+      - name: checksum
+        type: u32
+        if: flags equals 1
+projections:
+  - type: Record
+    fields: [size]
+"#;
+
+        let format = parse_format(yaml).expect("projection format should parse");
+        assert_eq!(format.projections[0].name, "RecordProjection");
+
+        let spec = parse_projection_spec("Record = size, name").expect("spec should parse");
+        assert_eq!(spec.type_name, "Record");
+        assert_eq!(spec.fields, vec!["size".to_string(), "name".to_string()]);
+        assert!(parse_projection_spec("Record").is_err());
+        assert!(parse_projection_spec("Record=").is_err());
+
+        // Sizes and conditions of skipped fields are retained, payloads are not
+        let lir = dezzy_core::pipeline::Pipeline::new().lower(format.clone()).expect("projection should lower");
+        let record = &lir.types[0];
+        let retained: Vec<&str> = record
+            .retained_fields(&lir.projections[0].fields)
+            .iter()
+            .filter_map(|var| record.fields.iter().find(|f| f.var_id == *var))
+            .map(|f| f.name.as_str())
+            .collect();
+        assert_eq!(retained, vec!["flags", "name_length", "extra_length", "size"]);
+
+        let mut unknown = format;
+        unknown.projections[0].fields.push("missing".to_string());
+        assert!(dezzy_core::pipeline::Pipeline::new().lower(unknown).is_err());
+    }
+
+    #[test]
+    fn test_length_fields_marked() {
+        let yaml = r#"
+name: Lengths
+types:
+  - name: Entry
+    type: struct
+    fields:
+      - name: count
+        type: u16
+      - name: name_len
+        type: u8
+      - name: name
+        type: str(name_len)
+      - name: keys
+        type: u32[count]
+      - name: values
+        type: u32[count]
+      - name: flags
+        type: u8
+      - name: extra_len
+        type: u8
+      - name: extra
+        type: blob(extra_len)
+        if: flags equals 1
+"#;
+
+        let format = parse_format(yaml).expect("length format should parse");
+        let lir = dezzy_core::pipeline::Pipeline::new().lower(format).expect("length format should lower");
+        let entry = &lir.types[0];
+        let sized = |name: &str| -> Vec<&str> {
+            let field = entry.fields.iter().find(|f| f.name == name).unwrap();
+            field
+                .length_of
+                .iter()
+                .filter_map(|var| entry.fields.iter().find(|f| f.var_id == *var))
+                .map(|f| f.name.as_str())
+                .collect()
+        };
+        assert_eq!(sized("count"), vec!["keys", "values"]);
+        assert_eq!(sized("name_len"), vec!["name"]);
+        // A conditional payload may be absent, so its length is left as given
+        assert!(sized("extra_len").is_empty());
+        assert!(sized("flags").is_empty());
+    }
 }
@@ -4,11 +4,29 @@ use serde::{Deserialize, Serialize};
 pub struct YamlFormat {
     pub name: String,
     pub version: Option<String>,
-    pub endianness: Option<String>,
+    pub endianness: Option<YamlEndianness>,
     pub bit_order: Option<String>,
     #[serde(default)]
     pub enums: Vec<YamlEnum>,
     pub types: Vec<YamlTypeDef>,
+    #[serde(default)]
+    pub projections: Vec<YamlProjection>,
+}
+
+/// `endianness: big`, or `endianness: { from: <expr> }` to decide per input
+#[derive(Debug, Clone, Deserialize, Serialize)]
+#[serde(untagged)]
+pub enum YamlEndianness {
+    Fixed(String),
+    From { from: String },
+}
+
+#[derive(Debug, Clone, Deserialize, Serialize)]
+pub struct YamlProjection {
+    #[serde(rename = "type")]
+    pub type_name: String,
+    pub name: Option<String>,
+    pub fields: Vec<String>,
 }
 
 #[derive(Debug, Clone, Deserialize, Serialize)]
@@ -43,4 +61,15 @@ pub struct YamlField {
     pub align: Option<usize>,
     #[serde(rename = "if")]
     pub if_condition: Option<String>,
+    pub checksum: Option<YamlChecksum>,
+    pub pos: Option<String>,
+    pub pos_base: Option<String>,
+    pub endian: Option<String>,
+    pub size: Option<String>,
+}
+
+#[derive(Debug, Clone, Deserialize, Serialize)]
+pub struct YamlChecksum {
+    pub algo: String,
+    pub over: Vec<String>,
 }
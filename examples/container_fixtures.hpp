@@ -0,0 +1,25 @@
+#pragma once
+// Encoded containers shared by the example runners. Include after any DEZZY_* settings the
+// runner needs for testcontainer.hpp.
+#include "testcontainer.hpp"
+#include <string>
+
+namespace fixtures {
+
+// Entry i is named `name(i)` and holds `data_size(i)` bytes, each equal to i
+template<typename Name, typename DataSize>
+std::vector<uint8_t> make_container(size_t entries, Name&& name, DataSize&& data_size) {
+    testcontainer::Container container{};
+    container.magic = 0x434E5452;
+    for (size_t i = 0; i < entries; ++i) {
+        testcontainer::FileEntry entry{};
+        entry.filename = name(i);
+        entry.file_data.assign(data_size(i), static_cast<uint8_t>(i));
+        container.entries.push_back(entry);
+    }
+    testcontainer::Writer writer;
+    container.write(writer);
+    return writer.finish();
+}
+
+} // namespace fixtures
@@ -0,0 +1,48 @@
+#pragma once
+// Encoded binary logs shared by the example runners. Include after any DEZZY_* settings the
+// runner needs for binarylog.hpp.
+#include "binarylog.hpp"
+#include <random>
+
+namespace fixtures {
+
+// Entry i has timestamp `first + i * step`, level i % 4 and the bytes `message(i)`
+template<typename Message>
+std::vector<uint8_t> make_log(size_t entries, Message&& message, uint64_t first = 0, uint64_t step = 1) {
+    binarylog::Writer writer;
+    for (size_t i = 0; i < entries; ++i) {
+        binarylog::LogEntry entry{};
+        entry.timestamp = first + i * step;
+        entry.level = static_cast<uint8_t>(i % 4);
+        entry.message = message(i);
+        entry.message_length = static_cast<uint16_t>(entry.message.size());
+        entry.write(writer);
+    }
+    return writer.finish();
+}
+
+// Entries of 11 + `message_size` bytes, each message that many 'm's
+inline std::vector<uint8_t> make_uniform_log(size_t entries, size_t message_size = 8) {
+    return make_log(entries, [&](size_t) { return std::vector<uint8_t>(message_size, 'm'); });
+}
+
+// Entries a millisecond apart, each message fewer than `max_length` random lowercase letters
+inline std::vector<uint8_t> make_random_log(std::mt19937& rng, size_t entries, size_t max_length = 300) {
+    return make_log(
+        entries,
+        [&](size_t) {
+            std::vector<uint8_t> message(rng() % max_length);
+            for (auto& byte : message) {
+                byte = static_cast<uint8_t>('a' + rng() % 26);
+            }
+            return message;
+        },
+        1700000000000000ull, 1000);
+}
+
+inline bool same_entry(const binarylog::LogEntry& a, const binarylog::LogEntry& b) {
+    return a.timestamp == b.timestamp && a.level == b.level && a.message_length == b.message_length &&
+           a.message == b.message;
+}
+
+} // namespace fixtures
@@ -0,0 +1,198 @@
+#define DEZZY_APPEND_WRITER
+#include "binarylog.hpp"
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+
+using namespace binarylog;
+
+namespace {
+
+LogEntry make_entry(size_t i) {
+    LogEntry entry;
+    entry.timestamp = 1700000000000000 + i;
+    entry.level = static_cast<uint8_t>(i % 4);
+    const std::string text = "request " + std::to_string(i) + " served";
+    entry.message.assign(text.begin(), text.end());
+    return entry;
+}
+
+std::vector<uint8_t> file_bytes(const char* path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+// Appends `count` entries with `options`, then checks the file holds exactly their encodings
+template<typename Check>
+void round_trip(const char* path, size_t count, AppendOptions options, Check&& check) {
+    std::remove(path);
+    Writer expected;
+    {
+        AppendWriter<LogEntry> log(path, options);
+        for (size_t i = 0; i < count; ++i) {
+            const auto entry = make_entry(i);
+            entry.write(expected);
+            log.append(entry);
+        }
+        log.close();
+        assert(log.records() == count && log.bytes() == expected.position());
+        check(log);
+    }
+    const auto bytes = file_bytes(path);
+    assert(bytes == expected.finish());
+
+    Reader reader(bytes);
+    const auto parsed = LogFile::read(reader);
+    assert(parsed.entries.size() == count && parsed.entries.back().timestamp == 1700000000000000 + count - 1);
+    std::remove(path);
+}
+
+} // namespace
+
+int main() {
+    const char* path = "test_append_runner.log";
+
+    // Test 1: records fill fixed-size batches, one write per batch
+    {
+        AppendOptions options;
+        options.buffer_size = 4096;
+        round_trip(path, 1000, options, [](const auto& log) {
+            assert(log.batches() == (log.bytes() + 4095) / 4096 || log.batches() == (log.bytes() + 4095) / 4096 + 1);
+            assert(log.syncs() == 0);
+        });
+        std::cout << "[OK] Batched appends match write()\n";
+    }
+
+    // Test 2: a record-count limit ends batches early, and syncs are grouped
+    {
+        AppendOptions options;
+        options.max_records = 10;
+        options.sync_every = 4;
+        round_trip(path, 1000, options, [](const auto& log) {
+            assert(log.batches() == 100);
+            assert(log.syncs() == 25);
+        });
+        std::cout << "[OK] max_records and sync_every group commits\n";
+    }
+
+    // Test 3: a flushing thread behind the ring writes the same bytes
+    {
+        AppendOptions options;
+        options.buffer_size = 512;
+        options.buffers = 3;
+        options.background = true;
+        options.sync_every = 50;
+        round_trip(path, 20000, options, [](const auto& log) {
+            assert(log.batches() > 1000);
+            assert(log.syncs() >= log.batches() / 50);
+        });
+        std::cout << "[OK] Background flushing preserves order\n";
+    }
+
+    // Test 4: records larger than a batch are written on their own, in order
+    {
+        AppendOptions options;
+        options.buffer_size = 64;
+        options.background = true;
+        std::remove(path);
+        Writer expected;
+        {
+            AppendWriter<LogEntry> log(path, options);
+            for (size_t i = 0; i < 50; ++i) {
+                auto entry = make_entry(i);
+                if (i % 7 == 0) {
+                    entry.message.assign(200, static_cast<uint8_t>('x'));
+                }
+                entry.write(expected);
+                log.append(entry);
+            }
+        }
+        assert(file_bytes(path) == expected.finish());
+        std::remove(path);
+        std::cout << "[OK] Oversized records bypass the batch buffers\n";
+    }
+
+    // Test 5: appending to an existing file keeps what is there
+    {
+        std::remove(path);
+        {
+            AppendWriter<LogEntry> log(path);
+            log.append(make_entry(1));
+        }
+        {
+            AppendWriter<LogEntry> log(path);
+            log.append(make_entry(2));
+            log.sync();
+            assert(log.syncs() == 1);
+        }
+        const auto bytes = file_bytes(path);
+        Reader reader(bytes);
+        const auto parsed = LogFile::read(reader);
+        assert(parsed.entries.size() == 2 && parsed.entries[1].timestamp == 1700000000000002);
+        std::remove(path);
+        std::cout << "[OK] Reopened files are appended to\n";
+    }
+
+    // Test 6: with a flushing thread, max_delay ends a batch even when no further record arrives
+    {
+        std::remove(path);
+        AppendOptions options;
+        options.background = true;
+        options.max_delay = std::chrono::milliseconds(5);
+        AppendWriter<LogEntry> log(path, options);
+        Writer expected;
+        for (size_t i = 0; i < 3; ++i) {
+            const auto entry = make_entry(i);
+            entry.write(expected);
+            log.append(entry);
+        }
+        const auto written = expected.finish();
+        const auto give_up = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (file_bytes(path) != written && std::chrono::steady_clock::now() < give_up) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        assert(file_bytes(path) == written && log.batches() == 1);
+
+        // Later records start a new batch, which ends the same way
+        log.append(make_entry(3));
+        while (log.batches() < 2 && std::chrono::steady_clock::now() < give_up) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        assert(log.batches() == 2);
+        log.close();
+        const auto bytes = file_bytes(path);
+        Reader reader(bytes);
+        assert(LogFile::read(reader).entries.size() == 4);
+        std::remove(path);
+        std::cout << "[OK] Idle batches are written after max_delay\n";
+    }
+
+    // Test 7: append() after close() throws instead of waiting for a stopped thread
+    for (bool background : {false, true}) {
+        std::remove(path);
+        AppendOptions options;
+        options.background = background;
+        options.buffers = 2;
+        options.buffer_size = 64;
+        AppendWriter<LogEntry> log(path, options);
+        log.append(make_entry(0));
+        log.close();
+        for (size_t i = 0; i < 4; ++i) {
+            try {
+                log.append(make_entry(i));
+                assert(false && "append() after close() should throw");
+            } catch (const std::logic_error&) {
+            }
+        }
+        assert(log.records() == 1);
+        std::remove(path);
+    }
+    std::cout << "[OK] Appends after close() are refused\n";
+
+    std::cout << "\nAll tests passed!\n";
+    return 0;
+}
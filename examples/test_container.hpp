@@ -1,87 +1,2823 @@
 #pragma once
 
 #include <cstdint>
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdlib>
 #include <array>
+#include <limits>
+#include <numeric>
+#include <type_traits>
 #include <vector>
 #include <span>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <stdexcept>
+#include <exception>
 #include <cstring>
+#include <atomic>
+#include <chrono>
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#ifndef DEZZY_HAVE_X86_SIMD
+#define DEZZY_HAVE_X86_SIMD 1
+#endif
+#endif
+#include <atomic>
+#include <thread>
+#if defined(DEZZY_ENABLE_MAPPED_FILE)
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#endif
+#if defined(DEZZY_PARALLEL_WRITE)
+#include <exception>
+#include <thread>
+#endif
+#if defined(DEZZY_ASYNC)
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <utility>
+#if defined(__linux__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <unordered_map>
+#endif
+#endif
+#if defined(DEZZY_APPEND_WRITER)
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#endif
+#if defined(DEZZY_RANDOM)
+#include <cmath>
+#include <initializer_list>
+#endif
+#if defined(DEZZY_STATS_HOOKS) || defined(DEZZY_TRACE_HOOKS)
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#endif
+#if defined(DEZZY_COUNT_ALLOCATIONS) && !defined(DEZZY_ALLOCATION_COUNTER)
+#define DEZZY_ALLOCATION_COUNTER
+#include <new>
+namespace dezzy_alloc {
+// Allocations made through operator new on this thread, once one translation unit defines
+// DEZZY_DEFINE_ALLOCATION_COUNTER before including a generated header
+struct Counter {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+};
+inline thread_local Counter counter;
+} // namespace dezzy_alloc
+#if defined(DEZZY_DEFINE_ALLOCATION_COUNTER)
+void* operator new(std::size_t size) {
+    ++dezzy_alloc::counter.allocations;
+    dezzy_alloc::counter.bytes += size;
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+#endif
+#endif
+
+namespace testcontainer {
+
+// ---- Instrumentation hooks ----
+
+enum class TypeId : uint32_t;   // one per struct, defined after the runtime
+enum class FieldId : uint32_t;  // one per field, likewise
+
+// What a ParseError reports, and what Hooks::on_error() receives
+enum class ErrorKind : uint8_t {
+    Truncated,  // the input ended inside a value
+    Assertion,  // a field failed its assert:
+    Checksum,   // a checksum: field did not match its data
+    Malformed,  // anything else
+    Limit,      // a ParseLimits bound was reached
+};
+inline constexpr size_t error_kind_count = 5;
+
+// Hooks every generated read() calls: on_enter/on_exit around each struct (with the reader
+// position it starts at, and the bytes it took), on_field after each field (with its bytes; bit fields count the bytes they start),
+// on_error when a ParseError is raised, and on_abort instead of on_exit for each struct an
+// exception unwinds. An error that recovery mode catches aborts only the structs it left.
+// `#define DEZZY_STATS_HOOKS` or `#define DEZZY_TRACE_HOOKS` before including the header
+// to declare and select a bundled registry, or `#define DEZZY_HOOKS MyHooks` for your own
+// type with these static members and `enabled = true` (DEZZY_HOOKS wins if both are set).
+// Taking the ids as `auto` lets one hooks type serve several formats. Without any of them
+// every call sits behind `if constexpr (Hooks::enabled)` and no code is generated for it.
+struct NoHooks {
+    static constexpr bool enabled = false;
+    static void on_enter(TypeId, size_t /*offset*/) {}
+    static void on_exit(TypeId, size_t /*bytes*/) {}
+    static void on_field(FieldId, size_t /*bytes*/) {}
+    static void on_error(ErrorKind) {}
+    static void on_abort(TypeId) {}
+};
+
+#if defined(DEZZY_STATS_HOOKS)
+// Per-thread counters: reads, bytes and a latency histogram per type, reads and bytes per
+// field, and errors by kind. Each thread only writes its own counters, with plain stores;
+// snapshot() and json() add up every thread, including threads that have exited.
+class StatsHooks {
+public:
+    static constexpr bool enabled = true;
+    // Bucket i counts reads that took less than 2^i ns (and at least 2^(i-1)); the last is open
+    static constexpr size_t latency_buckets = 36;
+
+    static void on_enter(TypeId type, size_t offset);
+    static void on_exit(TypeId type, size_t bytes);
+    static void on_field(FieldId field, size_t bytes);
+    static void on_error(ErrorKind kind);
+    // Drops a read an exception ended, without counting it
+    static void on_abort(TypeId type);
+
+    struct TypeStats {
+        uint64_t reads = 0;
+        uint64_t bytes = 0;
+        uint64_t total_ns = 0;
+        std::array<uint64_t, latency_buckets> latency{};
+    };
+    struct FieldStats {
+        uint64_t reads = 0;
+        uint64_t bytes = 0;
+    };
+    struct Snapshot {
+        std::vector<TypeStats> types;       // indexed by TypeId
+        std::vector<FieldStats> fields;     // indexed by FieldId
+        std::array<uint64_t, error_kind_count> errors{};  // indexed by ErrorKind
+    };
+
+    static Snapshot snapshot();
+    // Zeroes every counter; meant for points where no thread is parsing
+    static void reset();
+    // snapshot() with names, totals and p50/p90/p99 latency bounds per type
+    static std::string json();
+
+private:
+    // One writer; relaxed load and store instead of a locked read-modify-write
+    struct Counter {
+        std::atomic<uint64_t> value{0};
+        void add(uint64_t n) { value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+        uint64_t get() const { return value.load(std::memory_order_relaxed); }
+    };
+    struct Local;
+    struct Registry;
+    static Local& local();
+    static Registry& registry();
+};
+#endif
+
+#if defined(DEZZY_TRACE_HOOKS)
+// Chrome trace-event spans, one per struct read, with its offset and size. Each thread
+// appends to its own fixed-size buffer without locks; once it is full further spans are
+// dropped and counted. set_sampling(n) traces every nth outermost read on each thread
+// together with everything read inside it. json() is a trace file for Perfetto
+// (ui.perfetto.dev) or chrome://tracing.
+class TraceHooks {
+public:
+    static constexpr bool enabled = true;
+
+    static void on_enter(TypeId type, size_t offset);
+    static void on_exit(TypeId type, size_t bytes);
+    static void on_field(FieldId, size_t) {}
+    // Marks the innermost open span with the error
+    static void on_error(ErrorKind kind);
+    // Ends the innermost span where an exception left it; the error it carries (its own, or
+    // one it passed through) is recorded, and handed on to the span enclosing it
+    static void on_abort(TypeId type);
+
+    // Traces every nth outermost read per thread; 1 (the default) traces all of them
+    static void set_sampling(uint32_t every);
+    // Spans per thread buffer, for threads that record their first span afterwards
+    static void set_capacity(size_t spans);
+
+    struct Span {
+        TypeId type;
+        uint8_t error;         // 0, or 1 + ErrorKind if the read failed inside this span
+        uint64_t offset;       // reader position at the start
+        uint64_t bytes;        // 0 if the read failed
+        uint64_t start_ns;     // since the first traced thread started
+        uint64_t duration_ns;
+    };
+
+    // The spans recorded so far, one vector per thread (the trace's tid - 1), in the order
+    // the reads finished. Safe while other threads parse.
+    static std::vector<std::vector<Span>> spans();
+    // Spans lost to full buffers
+    static uint64_t dropped();
+    // Empties every buffer; meant for points where no thread is parsing
+    static void reset();
+    static std::string json();
+
+private:
+    struct Buffer;
+    struct Registry;
+    static Buffer& local();
+    static Registry& registry();
+};
+#endif
+
+#if defined(DEZZY_HOOKS)
+using Hooks = DEZZY_HOOKS;
+#elif defined(DEZZY_STATS_HOOKS)
+using Hooks = StatsHooks;
+#elif defined(DEZZY_TRACE_HOOKS)
+using Hooks = TraceHooks;
+#else
+using Hooks = NoHooks;
+#endif
+
+// Held by every read() from on_enter on; calls on_abort if an exception leaves the read
+class HookFrame {
+public:
+    explicit HookFrame(TypeId type) : type_(type) {
+        if constexpr (Hooks::enabled) {
+            exceptions_ = std::uncaught_exceptions();
+        }
+    }
+    ~HookFrame() {
+        if constexpr (Hooks::enabled) {
+            if (std::uncaught_exceptions() > exceptions_) {
+                Hooks::on_abort(type_);
+            }
+        }
+    }
+    HookFrame(const HookFrame&) = delete;
+    HookFrame& operator=(const HookFrame&) = delete;
+
+private:
+    TypeId type_;
+    int exceptions_ = 0;
+};
+
+class ParseError : public std::runtime_error {
+public:
+    explicit ParseError(const std::string& message, ErrorKind kind = ErrorKind::Malformed)
+        : std::runtime_error(message), kind_(kind) {
+        if constexpr (Hooks::enabled) {
+            Hooks::on_error(kind);
+        }
+    }
+
+    ErrorKind kind() const { return kind_; }
+
+private:
+    ErrorKind kind_;
+};
+
+// Thrown by write() when a value cannot be encoded as described
+class WriteError : public std::runtime_error {
+public:
+    explicit WriteError(const std::string& message)
+        : std::runtime_error(message) {}
+};
+
+// Size of a container as the integer type of the field that records it
+template<typename T>
+inline T checked_length(size_t length, const char* field) {
+    if (length > static_cast<uint64_t>(std::numeric_limits<T>::max())) {
+        throw WriteError(std::string(field) + ": length " + std::to_string(length) + " does not fit");
+    }
+    return static_cast<T>(length);
+}
+
+// Reverses the bytes of an integer; a single bswap/rev instruction on every major compiler
+template<typename T>
+inline T byteswap(T value) {
+    using U = std::make_unsigned_t<T>;
+    const U bits = static_cast<U>(value);
+    if constexpr (sizeof(T) == 1) {
+        return value;
+    } else if constexpr (sizeof(T) == 2) {
+#if defined(_MSC_VER) && !defined(__clang__)
+        return static_cast<T>(_byteswap_ushort(bits));
+#else
+        return static_cast<T>(__builtin_bswap16(bits));
+#endif
+    } else if constexpr (sizeof(T) == 4) {
+#if defined(_MSC_VER) && !defined(__clang__)
+        return static_cast<T>(_byteswap_ulong(bits));
+#else
+        return static_cast<T>(__builtin_bswap32(bits));
+#endif
+    } else {
+        static_assert(sizeof(T) == 8, "byteswap supports 1, 2, 4 and 8 byte integers");
+#if defined(_MSC_VER) && !defined(__clang__)
+        return static_cast<T>(_byteswap_uint64(bits));
+#else
+        return static_cast<T>(__builtin_bswap64(bits));
+#endif
+    }
+}
+
+// Converts between host and wire byte order. Resolved at compile time: a no-op when the
+// orders agree, otherwise a byteswap.
+template<std::endian Order, typename T>
+inline T host_to(T value) {
+    if constexpr (Order == std::endian::native) {
+        return value;
+    } else {
+        return byteswap(value);
+    }
+}
+
+// Unaligned loads and stores in a fixed wire byte order, for views over encoded bytes
+template<std::endian Order, typename T>
+inline T load_wire(const uint8_t* bytes) {
+    T value;
+    std::memcpy(&value, bytes, sizeof(T));
+    return host_to<Order>(value);
+}
+
+template<std::endian Order, typename T>
+inline void store_wire(uint8_t* bytes, T value) {
+    value = host_to<Order>(value);
+    std::memcpy(bytes, &value, sizeof(T));
+}
+
+// Bounds for parsing untrusted input, attached to a reader with set_limits(). Copies of
+// the reader and readers from at() share the same object, which must outlive them.
+// Going past a bound throws ParseError with ErrorKind::Limit.
+struct ParseLimits {
+    uint64_t max_allocation = UINT64_MAX;  // bytes of array, blob and string elements over the parse
+    uint64_t max_elements = UINT64_MAX;    // elements of any one array, blob or string
+    uint32_t max_depth = UINT32_MAX;       // structs read inside one another
+    std::optional<std::chrono::steady_clock::time_point> deadline;  // checked every 64 structs
+    const std::atomic<bool>* cancel = nullptr;  // set from another thread to abandon the parse
+
+    // Use so far; reset() before reusing the object for another parse
+    uint64_t allocated = 0;
+    uint32_t depth = 0;
+    uint32_t entered = 0;
+
+    void reset() {
+        allocated = 0;
+        depth = 0;
+        entered = 0;
+    }
+
+    // An array, blob or string of `count` elements
+    void check_elements(uint64_t count) const {
+        if (count > max_elements) {
+            throw ParseError(std::to_string(count) + " elements exceed the limit of " + std::to_string(max_elements),
+                             ErrorKind::Limit);
+        }
+    }
+
+    // `count` elements of `element_bytes` each are about to be allocated
+    void charge(uint64_t count, size_t element_bytes) {
+        if (element_bytes != 0 && count > (max_allocation - allocated) / element_bytes) {
+            throw ParseError("Allocation limit of " + std::to_string(max_allocation) + " bytes exceeded", ErrorKind::Limit);
+        }
+        allocated += count * element_bytes;
+    }
+
+    // A struct read starts; leave() when it ends
+    void enter() {
+        if (depth >= max_depth) {
+            throw ParseError("Nesting deeper than " + std::to_string(max_depth) + " structs", ErrorKind::Limit);
+        }
+        if (cancel != nullptr && cancel->load(std::memory_order_relaxed)) {
+            throw ParseError("Parse cancelled", ErrorKind::Limit);
+        }
+        if (deadline && (entered++ & 63) == 0 && std::chrono::steady_clock::now() > *deadline) {
+            throw ParseError("Parse deadline passed", ErrorKind::Limit);
+        }
+        ++depth;
+    }
+
+    void leave() { --depth; }
+};
+
+// Held by every generated read() for the reader's limits, if it has any
+class LimitScope {
+public:
+    explicit LimitScope(ParseLimits* limits) : limits_(limits) {
+        if (limits_ != nullptr) {
+            limits_->enter();
+        }
+    }
+    ~LimitScope() {
+        if (limits_ != nullptr) {
+            limits_->leave();
+        }
+    }
+    LimitScope(const LimitScope&) = delete;
+    LimitScope& operator=(const LimitScope&) = delete;
+
+private:
+    ParseLimits* limits_;
+};
+
+// An element of an array that failed to parse and was left out in recovery mode
+struct RecoveredError {
+    size_t offset;  // reader position where the element started
+    ErrorKind kind;
+    std::string message;
+};
+
+// Recovery mode, attached to a reader with set_recovery(). Arrays of structs (count-sized
+// and until: eof) then record an element that fails to parse and carry on after it: at the
+// next occurrence of the element's magic that validates, or else past the bytes skip()
+// measures for it. The elements that parsed are kept. An array stops where neither finds
+// a next element. Limit errors are never recovered.
+struct RecoveryLog {
+    std::vector<RecoveredError> errors;
+    size_t max_errors = SIZE_MAX;  // the failure after this many is thrown
+};
+
+// Bounds policies for BasicReader. CheckedCursor validates every access and throws
+// ParseError. TrustedCursor is for data this program wrote itself: single reads are a
+// pointer bump checked only by assert(), and generated read() functions validate each
+// run of fixed-size fields once through validate_ahead().
+struct CheckedCursor {
+    static constexpr bool checked = true;
+};
+
+struct TrustedCursor {
+    static constexpr bool checked = false;
+};
+
+template<typename Cursor>
+class BasicReader {
+public:
+    explicit BasicReader(std::span<const uint8_t> data)
+        : begin_(data.data()), cursor_(data.data()), end_(data.data() + data.size()) {}
+
+    // Same buffer and position under another bounds policy
+    template<typename Other>
+    explicit BasicReader(const BasicReader<Other>& other)
+        : begin_(other.begin_), cursor_(other.cursor_), end_(other.end_),
+          verify_checksums_(other.verify_checksums_), limits_(other.limits_), recovery_(other.recovery_) {}
+
+    template<typename T>
+    T read_le() {
+        return read<std::endian::little, T>();
+    }
+
+    template<typename T>
+    T read_be() {
+        return read<std::endian::big, T>();
+    }
+
+    template<std::endian Order, typename T>
+    T read() {
+        require(sizeof(T));
+        T value;
+        std::memcpy(&value, cursor_, sizeof(T));
+        cursor_ += sizeof(T);
+        return host_to<Order>(value);
+    }
+
+    void skip(size_t bytes) {
+        if (bytes > remaining()) {
+            throw ParseError("Unexpected end of data during skip", ErrorKind::Truncated);
+        }
+        cursor_ += bytes;
+    }
+
+    size_t position() const { return static_cast<size_t>(cursor_ - begin_); }
+    size_t remaining() const { return static_cast<size_t>(end_ - cursor_); }
+
+    // Elements that may encode to nothing cannot be checked against the input, so there may
+    // be at most this many more of them than bytes left
+    static constexpr uint64_t max_empty_elements = 4096;
+
+    // Before allocating or skipping `count` elements that take at least `min_size` encoded
+    // bytes and `element_bytes` of memory each: a count the rest of the input cannot hold
+    // fails here, in constant time, and the allocation is charged to the limits
+    void admit(uint64_t count, size_t min_size, size_t element_bytes) {
+        if (min_size == 0) {
+            if (count > remaining() + max_empty_elements) {
+                throw ParseError(std::to_string(count) + " possibly empty elements with " + std::to_string(remaining()) +
+                                 " bytes left", ErrorKind::Limit);
+            }
+        } else if (count > remaining() / min_size) {
+            throw ParseError("Unexpected end of data", ErrorKind::Truncated);
+        }
+        charge(count, element_bytes);
+    }
+
+    // `count` elements decoded from input already consumed: only the limits apply
+    void charge(uint64_t count, size_t element_bytes) {
+        if (limits_ != nullptr) {
+            limits_->check_elements(count);
+            limits_->charge(count, element_bytes);
+        }
+    }
+
+    // One more element for an array that grows as it is read, which holds `size` so far
+    void admit_next(size_t size, size_t element_bytes) {
+        if (limits_ != nullptr) {
+            limits_->check_elements(size + 1);
+            limits_->charge(1, element_bytes);
+        }
+    }
+
+    // Up-front check for the next `bytes` bytes; checked cursors test each read instead
+    void validate_ahead(size_t bytes) const {
+        if constexpr (!Cursor::checked) {
+            if (bytes > remaining()) {
+                throw ParseError("Unexpected end of data", ErrorKind::Truncated);
+            }
+        }
+    }
+
+    // View of the next `count` bytes, which are consumed (no copy)
+    std::span<const uint8_t> read_bytes(size_t count) {
+        if (count > remaining()) {
+            throw ParseError("Unexpected end of data", ErrorKind::Truncated);
+        }
+        std::span<const uint8_t> bytes(cursor_, count);
+        cursor_ += count;
+        return bytes;
+    }
+
+    // Underlying buffer, independent of the current position
+    std::span<const uint8_t> data() const { return {begin_, end_}; }
+
+    // Reader over the same buffer, positioned at an absolute offset (no copy)
+    BasicReader at(size_t offset) const {
+        if (offset > static_cast<size_t>(end_ - begin_)) {
+            throw ParseError("Offset " + std::to_string(offset) + " is out of range");
+        }
+        BasicReader sub(*this);
+        sub.cursor_ = begin_ + offset;
+        return sub;
+    }
+
+    // Reader confined to the next `bytes` bytes, which this reader moves past (no copy).
+    // Positions inside stay those of the whole buffer; reads past the window's end fail
+    // as truncated, and whatever the window's reader leaves unread is skipped.
+    BasicReader window(size_t bytes) {
+        if (bytes > remaining()) {
+            throw ParseError("Unexpected end of data", ErrorKind::Truncated);
+        }
+        BasicReader sub(*this);
+        sub.end_ = cursor_ + bytes;
+        cursor_ += bytes;
+        return sub;
+    }
+
+    // Bytes consumed since an earlier position() mark
+    std::span<const uint8_t> bytes_since(size_t mark) const {
+        return {begin_ + mark, cursor_};
+    }
+
+    bool verify_checksums() const { return verify_checksums_; }
+    void set_verify_checksums(bool enabled) { verify_checksums_ = enabled; }
+
+    // Bounds for reading untrusted input; nullptr (the default) for none
+    ParseLimits* limits() const { return limits_; }
+    void set_limits(ParseLimits* limits) { limits_ = limits; }
+
+    // Where arrays of structs record the elements they leave out; nullptr (the default)
+    // lets the first failure throw
+    RecoveryLog* recovery() const { return recovery_; }
+    void set_recovery(RecoveryLog* log) { recovery_ = log; }
+
+private:
+    template<typename> friend class BasicReader;
+
+    void require(size_t bytes) const {
+        if constexpr (Cursor::checked) {
+            if (bytes > remaining()) {
+                throw ParseError("Unexpected end of data", ErrorKind::Truncated);
+            }
+        } else {
+            assert(bytes <= remaining() && "TrustedReader read past the end of its data");
+        }
+    }
+
+    const uint8_t* begin_;
+    const uint8_t* cursor_;
+    const uint8_t* end_;
+    bool verify_checksums_ = true;
+    ParseLimits* limits_ = nullptr;
+    RecoveryLog* recovery_ = nullptr;
+};
+
+using Reader = BasicReader<CheckedCursor>;
+using TrustedReader = BasicReader<TrustedCursor>;
+
+namespace detail {
+
+// Moves `reader` to where the element after a failed one at `start` begins. Returns false
+// when there is none to find.
+template<typename T, typename Cursor>
+bool resynchronize(BasicReader<Cursor>& reader, size_t start) {
+    const auto data = reader.data();
+    if constexpr (requires { T::magic_bytes; }) {
+        if (start >= data.size()) {
+            return false;
+        }
+        if (const auto next = T::find_first(data.subspan(start + 1))) {
+            reader = reader.at(start + 1 + *next);
+            return true;
+        }
+        return false;
+    } else {
+        // Length framing: skip() reads only what it needs to find the element's end
+        Reader framed = Reader(data).at(start);
+        try {
+            T::skip(framed);
+        } catch (const ParseError& e) {
+            if (e.kind() == ErrorKind::Limit) {
+                throw;
+            }
+            return false;
+        }
+        reader = reader.at(framed.position());
+        return framed.position() > start;
+    }
+}
+
+// Appends the next element to `out`, or in recovery mode records why it failed and
+// resynchronizes. Returns false where the array has to end.
+template<typename T, typename Cursor, typename Elements>
+bool read_recovering(BasicReader<Cursor>& reader, Elements& out) {
+    const size_t start = reader.position();
+    try {
+        out.push_back(T::read(reader));
+        return true;
+    } catch (const ParseError& e) {
+        RecoveryLog& log = *reader.recovery();
+        if (e.kind() == ErrorKind::Limit || log.errors.size() >= log.max_errors) {
+            throw;
+        }
+        log.errors.push_back({start, e.kind(), e.what()});
+    }
+    return resynchronize<T>(reader, start);
+}
+
+} // namespace detail
+
+class Writer {
+public:
+    Writer() = default;
+
+    // Encodes into caller-owned memory (a slice of a larger buffer, or a mapped file) instead
+    // of a growing vector. `origin` is the absolute offset of target[0] in the final output,
+    // so position() and align() agree with a writer that produced everything before it.
+    // Writing past the end of `target` throws WriteError.
+    explicit Writer(std::span<uint8_t> target, size_t origin = 0)
+        : begin_(target.data()), cursor_(target.data()), end_(target.data() + target.size()), origin_(origin), external_(true) {}
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    template<typename T>
+    void write_le(T value) {
+        write<std::endian::little>(value);
+    }
+
+    template<typename T>
+    void write_be(T value) {
+        write<std::endian::big>(value);
+    }
+
+    template<std::endian Order, typename T>
+    void write(T value) {
+        require(sizeof(T));
+        value = host_to<Order>(value);
+        std::memcpy(cursor_, &value, sizeof(T));
+        cursor_ += sizeof(T);
+    }
+
+    void write_padding(size_t bytes) {
+        if (bytes == 0) {
+            return;
+        }
+        require(bytes);
+        std::memset(cursor_, 0, bytes);
+        cursor_ += bytes;
+    }
+
+    void write_bytes(std::span<const uint8_t> bytes) {
+        if (bytes.empty()) {
+            return;
+        }
+        require(bytes.size());
+        std::memcpy(cursor_, bytes.data(), bytes.size());
+        cursor_ += bytes.size();
+    }
+
+    void align(size_t boundary) {
+        size_t padding = (boundary - (position() % boundary)) % boundary;
+        write_padding(padding);
+    }
+
+    size_t position() const { return origin_ + static_cast<size_t>(cursor_ - begin_); }
+
+    // Bytes written since an earlier position() mark
+    std::span<const uint8_t> bytes_since(size_t mark) const {
+        return std::span<const uint8_t>(begin_ + (mark - origin_), cursor_);
+    }
+
+    // Reserves the next `bytes` bytes of output and returns them for the caller to fill,
+    // possibly from other threads. The span is valid until the next write to this writer.
+    std::span<uint8_t> claim(size_t bytes) {
+        require(bytes);
+        const std::span<uint8_t> region(cursor_, bytes);
+        cursor_ += bytes;
+        return region;
+    }
+
+    // The encoded bytes; only for writers that own their buffer
+    std::vector<uint8_t> finish() {
+        assert(!external_ && "finish() on a Writer over external memory");
+        data_.resize(static_cast<size_t>(cursor_ - begin_));
+        begin_ = cursor_ = end_ = nullptr;
+        return std::move(data_);
+    }
+
+private:
+    void require(size_t bytes) {
+        if (bytes > static_cast<size_t>(end_ - cursor_)) {
+            grow(bytes);
+        }
+    }
+
+    void grow(size_t bytes) {
+        if (external_) {
+            throw WriteError("Output buffer full: " + std::to_string(bytes) + " bytes needed at offset " + std::to_string(position()));
+        }
+        const size_t used = static_cast<size_t>(cursor_ - begin_);
+        data_.resize(std::max(used + bytes, 2 * data_.size() + 64));
+        begin_ = data_.data();
+        cursor_ = begin_ + used;
+        end_ = begin_ + data_.size();
+    }
+
+    uint8_t* begin_ = nullptr;
+    uint8_t* cursor_ = nullptr;
+    uint8_t* end_ = nullptr;
+    size_t origin_ = 0;
+    bool external_ = false;
+    std::vector<uint8_t> data_;
+};
+
+#if defined(DEZZY_PASSTHROUGH)
+// A value and the input bytes it was read from, which must outlive it. value() reads it and
+// edit() is the only way to change it, so an edit cannot go unnoticed: write() copies the
+// source bytes back until edit() is first called, as long as `align:` padding would come
+// out the same, and encodes the value otherwise.
+template<typename T>
+class Passthrough {
+public:
+    Passthrough() = default;
+    // A value built by hand, which is always encoded
+    explicit Passthrough(T value) : value_(std::move(value)) {}
+
+    template<typename Cursor>
+    static Passthrough read(BasicReader<Cursor>& reader) {
+        const size_t start = reader.position();
+        Passthrough result(T::read(reader));
+        result.source_ = reader.bytes_since(start);
+        result.offset_ = start;
+        return result;
+    }
+
+    const T& value() const { return value_; }
+    const T* operator->() const { return &value_; }
+    // Write access; from here on the value is encoded
+    T& edit() {
+        source_ = {};
+        return value_;
+    }
+
+    // Read from input and not edited since
+    bool pristine() const { return source_.data() != nullptr; }
+    std::span<const uint8_t> source() const { return source_; }
+
+    void write(Writer& writer) const {
+        if (copies_at(writer.position())) {
+            writer.write_bytes(source_);
+        } else {
+            value_.write(writer);
+        }
+    }
+    size_t serialized_size(size_t at = 0) const { return copies_at(at) ? source_.size() : value_.serialized_size(at); }
+
+private:
+    bool copies_at(size_t at) const {
+        return pristine() && at % T::passthrough_alignment == offset_ % T::passthrough_alignment;
+    }
+
+    T value_{};
+    std::span<const uint8_t> source_;
+    size_t offset_ = 0;
+};
+#endif
+
+template<typename Cursor>
+class BitReader {
+public:
+    explicit BitReader(BasicReader<Cursor>& reader) : reader_(reader), current_byte_(0), bits_remaining_(0) {}
+
+    uint32_t read_bits_msb(size_t num_bits) {
+        uint32_t result = 0;
+        while (num_bits > 0) {
+            if (bits_remaining_ == 0) {
+                current_byte_ = reader_.template read_le<uint8_t>();
+                bits_remaining_ = 8;
+            }
+            size_t bits_to_read = std::min(num_bits, bits_remaining_);
+            result = (result << bits_to_read) |
+                     ((current_byte_ >> (bits_remaining_ - bits_to_read)) & ((1 << bits_to_read) - 1));
+            bits_remaining_ -= bits_to_read;
+            num_bits -= bits_to_read;
+        }
+        return result;
+    }
+
+    // Whether `num_bits` more bits are left, counting those of the byte in hand
+    bool can_read(size_t num_bits) const {
+        return num_bits <= bits_remaining_ + 8 * reader_.remaining();
+    }
+
+    int32_t read_signed_bits_msb(size_t num_bits) {
+        uint32_t unsigned_value = read_bits_msb(num_bits);
+        // Sign extend if high bit is set
+        if (unsigned_value & (1 << (num_bits - 1))) {
+            // Set all bits above num_bits to 1
+            uint32_t sign_extend_mask = ~((1 << num_bits) - 1);
+            return static_cast<int32_t>(unsigned_value | sign_extend_mask);
+        }
+        return static_cast<int32_t>(unsigned_value);
+    }
+
+private:
+    BasicReader<Cursor>& reader_;
+    uint8_t current_byte_;
+    size_t bits_remaining_;
+};
+
+class BitWriter {
+public:
+    explicit BitWriter(Writer& writer) : writer_(writer), current_byte_(0), bits_used_(0) {}
+
+    void write_bits_msb(uint32_t value, size_t num_bits) {
+        while (num_bits > 0) {
+            size_t bits_to_write = std::min(num_bits, 8 - bits_used_);
+            uint8_t bits = (value >> (num_bits - bits_to_write)) & ((1 << bits_to_write) - 1);
+            current_byte_ = (current_byte_ << bits_to_write) | bits;
+            bits_used_ += bits_to_write;
+            num_bits -= bits_to_write;
+
+            if (bits_used_ == 8) {
+                writer_.write_le(current_byte_);
+                current_byte_ = 0;
+                bits_used_ = 0;
+            }
+        }
+    }
+
+    void flush() {
+        if (bits_used_ > 0) {
+            // Pad remaining bits with zeros
+            current_byte_ <<= (8 - bits_used_);
+            writer_.write_le(current_byte_);
+            current_byte_ = 0;
+            bits_used_ = 0;
+        }
+    }
+
+    ~BitWriter() {
+        // Auto-flush on destruction if needed
+        if (bits_used_ > 0) {
+            flush();
+        }
+    }
+
+private:
+    Writer& writer_;
+    uint8_t current_byte_;
+    size_t bits_used_;
+};
+
+// ---- Signature search ----
+
+namespace detail {
+
+inline constexpr size_t npos = static_cast<size_t>(-1);
+
+inline bool matches_at(const uint8_t* p, std::span<const uint8_t> needle) {
+    return std::memcmp(p, needle.data(), needle.size()) == 0;
+}
+
+// First occurrence of `needle` starting at or after `from`, or npos.
+// Broadcasts the needle's first and last byte and compares 16 candidate positions
+// per step; only positions where both match are verified with memcmp.
+inline size_t find_signature(std::span<const uint8_t> haystack, std::span<const uint8_t> needle, size_t from = 0) {
+    const size_t n = needle.size();
+    if (n == 0 || haystack.size() < n || from > haystack.size() - n) {
+        return npos;
+    }
+    const uint8_t* data = haystack.data();
+    const size_t last_start = haystack.size() - n;
+    size_t i = from;
+
+#if defined(DEZZY_HAVE_X86_SIMD)
+    const __m128i first = _mm_set1_epi8(static_cast<char>(needle[0]));
+    const __m128i last = _mm_set1_epi8(static_cast<char>(needle[n - 1]));
+    while (i + 16 <= last_start + 1) {
+        const __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + n - 1));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last))));
+        while (mask != 0) {
+            const size_t candidate = i + static_cast<size_t>(__builtin_ctz(mask));
+            if (matches_at(data + candidate, needle)) {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+        i += 16;
+    }
+#endif
+
+    for (; i <= last_start; ++i) {
+        if (data[i] == needle[0] && matches_at(data + i, needle)) {
+            return i;
+        }
+    }
+    return npos;
+}
+
+// Last occurrence of `needle` starting strictly before `end`, or npos.
+inline size_t rfind_signature(std::span<const uint8_t> haystack, std::span<const uint8_t> needle, size_t end = npos) {
+    const size_t n = needle.size();
+    if (n == 0 || haystack.size() < n) {
+        return npos;
+    }
+    const uint8_t* data = haystack.data();
+    // Candidates are [0, limit)
+    size_t limit = std::min(end, haystack.size() - n + 1);
+
+#if defined(DEZZY_HAVE_X86_SIMD)
+    const __m128i first = _mm_set1_epi8(static_cast<char>(needle[0]));
+    const __m128i last = _mm_set1_epi8(static_cast<char>(needle[n - 1]));
+    while (limit >= 16) {
+        const size_t base = limit - 16;
+        const __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + base));
+        const __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + base + n - 1));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last))));
+        while (mask != 0) {
+            const unsigned bit = 31u - static_cast<unsigned>(__builtin_clz(mask));
+            if (matches_at(data + base + bit, needle)) {
+                return base + bit;
+            }
+            mask &= ~(1u << bit);
+        }
+        limit = base;
+    }
+#endif
+
+    while (limit > 0) {
+        --limit;
+        if (data[limit] == needle[0] && matches_at(data + limit, needle)) {
+            return limit;
+        }
+    }
+    return npos;
+}
+
+} // namespace detail
+
+// ---- Carving ----
+
+struct ScanHit {
+    size_t offset;
+    size_t length;
+};
+
+struct ScanOptions {
+    size_t threads = 0;               // 0 = std::thread::hardware_concurrency()
+    size_t chunk_size = 64u << 20;    // bytes of candidate start offsets per task
+};
+
+// Reports every offset in `data` where T's magic bytes occur and T::validate() succeeds.
+// Chunks are scanned in parallel. A candidate belongs to the chunk containing its first
+// byte, while its magic and body may run past the chunk end, so boundary-straddling
+// matches are found exactly once. The callback runs on the calling thread, in offset order.
+template<typename T, typename Callback>
+void scan_all(std::span<const uint8_t> data, Callback&& callback, ScanOptions options = {}) {
+    const std::span<const uint8_t> magic(T::magic_bytes);
+    const size_t chunk_size = std::max<size_t>(options.chunk_size, 1);
+    const size_t chunk_count = (data.size() + chunk_size - 1) / chunk_size;
+    if (chunk_count == 0) {
+        return;
+    }
+
+    std::vector<std::vector<ScanHit>> hits(chunk_count);
+    std::atomic<size_t> next_chunk{0};
+    auto worker = [&] {
+        for (size_t chunk = next_chunk++; chunk < chunk_count; chunk = next_chunk++) {
+            const size_t begin = chunk * chunk_size;
+            const size_t end = std::min(begin + chunk_size, data.size());
+            // Extend by magic.size() - 1 so a magic starting before `end` is fully visible
+            const auto window = data.subspan(begin, std::min(end - begin + magic.size() - 1, data.size() - begin));
+            for (size_t pos = detail::find_signature(window, magic); pos != detail::npos && begin + pos < end;
+                 pos = detail::find_signature(window, magic, pos + 1)) {
+                Reader reader = Reader(data).at(begin + pos);
+                if (T::validate(reader)) {
+                    hits[chunk].push_back({begin + pos, reader.position() - (begin + pos)});
+                }
+            }
+        }
+    };
+
+    size_t threads = options.threads != 0 ? options.threads : std::thread::hardware_concurrency();
+    threads = std::clamp<size_t>(threads, 1, chunk_count);
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < threads; ++i) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+
+    for (const auto& chunk_hits : hits) {
+        for (const auto& hit : chunk_hits) {
+            callback(hit);
+        }
+    }
+}
+
+#if defined(DEZZY_ENABLE_MAPPED_FILE)
+// Read-only memory mapping of a whole file, for scanning images larger than RAM.
+class MappedFile {
+public:
+    explicit MappedFile(const char* path) {
+#if defined(_WIN32)
+        file_ = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error(std::string("Cannot open ") + path);
+        }
+        LARGE_INTEGER size;
+        GetFileSizeEx(file_, &size);
+        size_ = static_cast<size_t>(size.QuadPart);
+        if (size_ > 0) {
+            mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping_ == nullptr) {
+                CloseHandle(file_);
+                throw std::runtime_error(std::string("Cannot map ") + path);
+            }
+            data_ = static_cast<const uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+        }
+#else
+        fd_ = ::open(path, O_RDONLY);
+        if (fd_ < 0) {
+            throw std::runtime_error(std::string("Cannot open ") + path);
+        }
+        struct stat st;
+        ::fstat(fd_, &st);
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ > 0) {
+            void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+            if (mapped == MAP_FAILED) {
+                ::close(fd_);
+                throw std::runtime_error(std::string("Cannot map ") + path);
+            }
+            ::madvise(mapped, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const uint8_t*>(mapped);
+        }
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+#if defined(_WIN32)
+        if (data_ != nullptr) {
+            UnmapViewOfFile(data_);
+        }
+        if (mapping_ != nullptr) {
+            CloseHandle(mapping_);
+        }
+        CloseHandle(file_);
+#else
+        if (data_ != nullptr) {
+            ::munmap(const_cast<uint8_t*>(data_), size_);
+        }
+        ::close(fd_);
+#endif
+    }
+
+    std::span<const uint8_t> bytes() const { return {data_, size_}; }
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+#if defined(_WIN32)
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+#endif
+
+// ---- Parallel writes ----
+#if defined(DEZZY_PARALLEL_WRITE)
+
+// Encodes `values` back to back, producing exactly the bytes consecutive write() calls
+// would. serialized_size() gives every element its offset up front (sequentially, since
+// `align:` makes a size depend on where it starts); the output is claimed from `writer`
+// once and split into runs of similar byte count, which up to `threads` threads
+// (0 = std::thread::hardware_concurrency()) encode straight into place. Small inputs stay
+// on the calling thread. The first exception a worker throws is rethrown here.
+template<typename T>
+void write_each_parallel(Writer& writer, std::span<const T> values, size_t threads = 0) {
+    constexpr size_t min_bytes_per_thread = 64u << 10;
+    std::vector<size_t> offsets(values.size() + 1);
+    offsets[0] = writer.position();
+    for (size_t i = 0; i < values.size(); ++i) {
+        offsets[i + 1] = offsets[i] + values[i].serialized_size(offsets[i]);
+    }
+    const size_t total = offsets.back() - offsets.front();
+    const std::span<uint8_t> region = writer.claim(total);
+
+    threads = threads != 0 ? threads : std::thread::hardware_concurrency();
+    threads = std::clamp<size_t>(threads, 1, std::max<size_t>(std::min(values.size(), total / min_bytes_per_thread), 1));
+
+    // Part p covers the elements starting in [p, p + 1) * total / threads
+    std::vector<size_t> bounds(threads + 1, values.size());
+    for (size_t part = 0; part < threads; ++part) {
+        const size_t target = offsets.front() + total / threads * part;
+        bounds[part] = static_cast<size_t>(std::lower_bound(offsets.begin(), offsets.end() - 1, target) - offsets.begin());
+    }
+
+    std::vector<std::exception_ptr> errors(threads);
+    auto encode = [&](size_t part) {
+        const size_t first = bounds[part];
+        const size_t last = bounds[part + 1];
+        try {
+            Writer out(region.subspan(offsets[first] - offsets.front(), offsets[last] - offsets[first]), offsets[first]);
+            for (size_t i = first; i < last; ++i) {
+                values[i].write(out);
+            }
+            if (out.position() != offsets[last]) {
+                throw WriteError("serialized_size() disagrees with write()");
+            }
+        } catch (...) {
+            errors[part] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t part = 1; part < threads; ++part) {
+        pool.emplace_back(encode, part);
+    }
+    encode(0);
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+#endif
+
+#if defined(DEZZY_ASYNC)
+// ---- Async parsing ----
+
+// Lazily started coroutine result. Awaiting a Task runs it and resumes the awaiter
+// through symmetric transfer, so nested read_async() calls do not grow the stack.
+template<typename T>
+class Task {
+public:
+    struct promise_type {
+        std::optional<T> value;
+        std::exception_ptr error;
+        std::coroutine_handle<> continuation = std::noop_coroutine();
+
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        auto final_suspend() noexcept {
+            struct FinalAwaiter {
+                bool await_ready() noexcept { return false; }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> self) noexcept {
+                    return self.promise().continuation;
+                }
+                void await_resume() noexcept {}
+            };
+            return FinalAwaiter{};
+        }
+
+        void return_value(T result) { value = std::move(result); }
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+        handle_.promise().continuation = awaiter;
+        return handle_;
+    }
+    T await_resume() { return result(); }
+
+    // Driving a top-level task by hand (see EventLoop::run)
+    void start() { handle_.resume(); }
+    bool done() const { return handle_.done(); }
+    T result() {
+        if (handle_.promise().error) {
+            std::rethrow_exception(handle_.promise().error);
+        }
+        return std::move(*handle_.promise().value);
+    }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+// Non-blocking byte stream feeding an AsyncReader
+class AsyncSource {
+public:
+    virtual ~AsyncSource() = default;
+
+    // Copies up to out.size() bytes without blocking. Returns 0 when nothing is ready yet
+    // and sets `eof` once the stream has ended.
+    virtual size_t read_some(std::span<uint8_t> out, bool& eof) = 0;
+
+    // Calls `ready` once, when read_some() can make progress again
+    virtual void when_readable(std::function<void()> ready) = 0;
+};
+
+class AsyncReader {
+public:
+    explicit AsyncReader(AsyncSource& source, size_t buffer_size = 64u << 10)
+        : source_(source), buffer_(std::max<size_t>(buffer_size, 16)) {}
+
+    class Awaiter {
+    public:
+        Awaiter(AsyncReader& reader, size_t count, bool required)
+            : reader_(reader), count_(count), required_(required) {}
+
+        bool await_ready() { return reader_.fill(count_); }
+        void await_suspend(std::coroutine_handle<> waiter) { reader_.wait(count_, waiter); }
+        bool await_resume() {
+            if (reader_.available() < count_) {
+                if (required_) {
+                    throw ParseError("Unexpected end of data", ErrorKind::Truncated);
+                }
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        AsyncReader& reader_;
+        size_t count_;
+        bool required_;
+    };
+
+    // Completes once `count` bytes are buffered; suspends only if the source cannot
+    // supply them right now. Throws ParseError if the stream ends first, or (with
+    // ErrorKind::Limit) if `count` is more than max_buffer() before buffering anything.
+    Awaiter require(size_t count) {
+        if (count > max_buffer_) {
+            throw ParseError(std::to_string(count) + " bytes exceed the async buffer limit of " +
+                                 std::to_string(max_buffer_),
+                             ErrorKind::Limit);
+        }
+        return Awaiter(*this, count, true);
+    }
+
+    // Resolves to false once the stream has ended and everything was consumed
+    Awaiter more() { return Awaiter(*this, 1, false); }
+
+    size_t available() const { return end_ - begin_; }
+    std::span<const uint8_t> buffered() const { return std::span<const uint8_t>(buffer_).subspan(begin_, available()); }
+
+    // Synchronous Reader over the next `count` buffered bytes (see require()), which are consumed.
+    // Valid until the next co_await on this reader.
+    Reader take(size_t count) {
+        Reader reader(std::span<const uint8_t>(buffer_).subspan(begin_, count));
+        begin_ += count;
+        return reader;
+    }
+
+    // Absolute stream offset of the next unconsumed byte
+    size_t position() const { return offset_ + begin_; }
+
+    bool verify_checksums() const { return verify_checksums_; }
+    void set_verify_checksums(bool enabled) { verify_checksums_ = enabled; }
+
+    // Most bytes one require() may ask for, and so the most the buffer grows to; a length
+    // read from the stream cannot make it buffer more
+    size_t max_buffer() const { return max_buffer_; }
+    void set_max_buffer(size_t bytes) { max_buffer_ = bytes; }
+
+private:
+    // Tops up the buffer without blocking; true once `count` bytes are buffered or the stream ended
+    bool fill(size_t count) {
+        if (available() >= count || eof_) {
+            return true;
+        }
+        if (buffer_.size() - begin_ < count) {
+            std::memmove(buffer_.data(), buffer_.data() + begin_, available());
+            offset_ += begin_;
+            end_ -= begin_;
+            begin_ = 0;
+            if (buffer_.size() < count) {
+                buffer_.resize(std::max(count, buffer_.size() * 2));
+            }
+        }
+        while (available() < count && !eof_) {
+            const size_t received = source_.read_some(std::span<uint8_t>(buffer_).subspan(end_), eof_);
+            if (received == 0 && !eof_) {
+                return false;
+            }
+            end_ += received;
+        }
+        return true;
+    }
+
+    void wait(size_t count, std::coroutine_handle<> waiter) {
+        source_.when_readable([this, count, waiter] {
+            if (fill(count)) {
+                waiter.resume();
+            } else {
+                wait(count, waiter);
+            }
+        });
+    }
+
+    AsyncSource& source_;
+    std::vector<uint8_t> buffer_;
+    size_t begin_ = 0;
+    size_t end_ = 0;
+    size_t offset_ = 0;
+    size_t max_buffer_ = size_t{64} << 20;
+    bool eof_ = false;
+    bool verify_checksums_ = true;
+};
+
+// Single-threaded executor: runs posted callbacks and, on Linux, epoll readiness callbacks
+class EventLoop {
+public:
+    EventLoop() {
+#if defined(__linux__)
+        epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd_ < 0) {
+            throw std::runtime_error("epoll_create1 failed");
+        }
+#endif
+    }
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    ~EventLoop() {
+#if defined(__linux__)
+        ::close(epoll_fd_);
+#endif
+    }
+
+    void post(std::function<void()> callback) { ready_.push_back(std::move(callback)); }
+
+#if defined(__linux__)
+    // One-shot: calls `callback` the next time `fd` is readable (or hung up)
+    void watch_readable(int fd, std::function<void()> callback) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+            if (errno == EPERM) {
+                // Regular files are always readable and cannot be polled
+                post(std::move(callback));
+                return;
+            }
+            throw std::runtime_error("epoll_ctl failed");
+        }
+        watchers_[fd] = std::move(callback);
+    }
+#endif
+
+    // Runs `task` to completion, dispatching callbacks while it waits for input
+    template<typename T>
+    T run(Task<T> task) {
+        task.start();
+        while (!task.done()) {
+            if (!ready_.empty()) {
+                auto callback = std::move(ready_.front());
+                ready_.pop_front();
+                callback();
+            } else if (!poll()) {
+                throw std::runtime_error("EventLoop: task is suspended but nothing can resume it");
+            }
+        }
+        return task.result();
+    }
+
+private:
+    // Blocks until a watched descriptor is ready; false if nothing is watched
+    bool poll() {
+#if defined(__linux__)
+        if (watchers_.empty()) {
+            return false;
+        }
+        epoll_event events[16];
+        const int count = ::epoll_wait(epoll_fd_, events, 16, -1);
+        if (count < 0 && errno != EINTR) {
+            throw std::runtime_error("epoll_wait failed");
+        }
+        for (int i = 0; i < count; ++i) {
+            const int fd = events[i].data.fd;
+            ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+            auto callback = std::move(watchers_[fd]);
+            watchers_.erase(fd);
+            post(std::move(callback));
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    std::deque<std::function<void()>> ready_;
+#if defined(__linux__)
+    int epoll_fd_ = -1;
+    std::unordered_map<int, std::function<void()>> watchers_;
+#endif
+};
+
+// In-memory source that hands out at most `chunk` bytes per read and reports
+// would-block in between, so parsers suspend as they would on a socket
+class MemorySource : public AsyncSource {
+public:
+    MemorySource(EventLoop& loop, std::span<const uint8_t> data, size_t chunk = SIZE_MAX)
+        : loop_(loop), data_(data), chunk_(std::max<size_t>(chunk, 1)) {}
+
+    size_t read_some(std::span<uint8_t> out, bool& eof) override {
+        if (data_.empty()) {
+            eof = true;
+            return 0;
+        }
+        if (blocked_) {
+            return 0;
+        }
+        const size_t count = std::min({out.size(), data_.size(), chunk_});
+        std::memcpy(out.data(), data_.data(), count);
+        data_ = data_.subspan(count);
+        blocked_ = chunk_ != SIZE_MAX;
+        return count;
+    }
+
+    void when_readable(std::function<void()> ready) override {
+        blocked_ = false;
+        loop_.post(std::move(ready));
+    }
+
+private:
+    EventLoop& loop_;
+    std::span<const uint8_t> data_;
+    size_t chunk_;
+    bool blocked_ = false;
+};
+
+#if defined(__linux__)
+// Pipe, socket or file descriptor, switched to non-blocking mode (not owned)
+class FdSource : public AsyncSource {
+public:
+    FdSource(EventLoop& loop, int fd) : loop_(loop), fd_(fd) {
+        ::fcntl(fd_, F_SETFL, ::fcntl(fd_, F_GETFL) | O_NONBLOCK);
+    }
+
+    size_t read_some(std::span<uint8_t> out, bool& eof) override {
+        for (;;) {
+            const ssize_t received = ::read(fd_, out.data(), out.size());
+            if (received > 0) {
+                return static_cast<size_t>(received);
+            }
+            if (received == 0) {
+                eof = true;
+                return 0;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return 0;
+            }
+            if (errno != EINTR) {
+                throw std::runtime_error("read failed");
+            }
+        }
+    }
+
+    void when_readable(std::function<void()> ready) override { loop_.watch_readable(fd_, std::move(ready)); }
+
+private:
+    EventLoop& loop_;
+    int fd_;
+};
+#endif
+
+#endif // DEZZY_ASYNC
+
+#if defined(DEZZY_APPEND_WRITER)
+// ---- Append-only record files ----
+
+// A file opened for appending. write_all() retries short writes; sync() is fsync
+// (fdatasync on Linux, F_FULLFSYNC on macOS, FlushFileBuffers on Windows).
+class AppendFile {
+public:
+    explicit AppendFile(const char* path) {
+#if defined(_WIN32)
+        handle_ = CreateFileA(path, FILE_APPEND_DATA, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (handle_ == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error(std::string("Cannot open ") + path);
+        }
+        LARGE_INTEGER size;
+        GetFileSizeEx(handle_, &size);
+        initial_size_ = static_cast<size_t>(size.QuadPart);
+#else
+        fd_ = ::open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (fd_ < 0) {
+            throw std::runtime_error(std::string("Cannot open ") + path);
+        }
+        struct stat st;
+        ::fstat(fd_, &st);
+        initial_size_ = static_cast<size_t>(st.st_size);
+#endif
+    }
+
+    ~AppendFile() {
+#if defined(_WIN32)
+        CloseHandle(handle_);
+#else
+        ::close(fd_);
+#endif
+    }
+
+    AppendFile(const AppendFile&) = delete;
+    AppendFile& operator=(const AppendFile&) = delete;
+
+    // Bytes already in the file when it was opened
+    size_t initial_size() const { return initial_size_; }
+
+    void write_all(std::span<const uint8_t> bytes) {
+        while (!bytes.empty()) {
+#if defined(_WIN32)
+            DWORD written = 0;
+            const DWORD chunk = static_cast<DWORD>(std::min<size_t>(bytes.size(), 1u << 30));
+            if (!WriteFile(handle_, bytes.data(), chunk, &written, nullptr)) {
+                throw std::runtime_error("Append failed");
+            }
+#else
+            const ssize_t written = ::write(fd_, bytes.data(), bytes.size());
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error(std::string("Append failed: ") + std::strerror(errno));
+            }
+#endif
+            bytes = bytes.subspan(static_cast<size_t>(written));
+        }
+    }
+
+    void sync() {
+#if defined(_WIN32)
+        const bool ok = FlushFileBuffers(handle_) != 0;
+#elif defined(__APPLE__)
+        const bool ok = ::fcntl(fd_, F_FULLFSYNC) == 0 || ::fsync(fd_) == 0;
+#elif defined(__linux__)
+        const bool ok = ::fdatasync(fd_) == 0;
+#else
+        const bool ok = ::fsync(fd_) == 0;
+#endif
+        if (!ok) {
+            throw std::runtime_error("Sync failed");
+        }
+    }
+
+private:
+#if defined(_WIN32)
+    HANDLE handle_ = INVALID_HANDLE_VALUE;
+#else
+    int fd_ = -1;
+#endif
+    size_t initial_size_ = 0;
+};
+
+struct AppendOptions {
+    size_t buffer_size = 1u << 20;              // bytes per batch
+    size_t buffers = 4;                         // batches in flight with `background`
+    size_t max_records = 0;                     // also end a batch after this many records (0 = when full)
+    std::chrono::microseconds max_delay{0};     // or once its first record is this old (see below)
+    size_t sync_every = 0;                      // group commit: sync after this many batches
+    std::chrono::microseconds sync_interval{0}; // or after a batch once this long has passed since the last
+    bool background = false;                    // write batches on a flushing thread
+};
+
+// Appends encoded T records to a file. Records are encoded straight into page-aligned
+// batch buffers, and each batch reaches the file in one write. Batches end when the next
+// record does not fit, after max_records, or after max_delay. Without `background`,
+// max_delay is checked by append(); with it, the flushing thread also ends a batch that
+// reaches max_delay while no records arrive. Syncs are grouped: one
+// sync covers every batch since the last, and with neither sync_every nor sync_interval
+// set, data is synced only by sync() and close().
+//
+// With `background`, finished batches go to a flushing thread through a lock-free
+// single-producer/single-consumer ring of `buffers` slots. append() blocks only while
+// every slot is waiting to be written. A failure on that thread is rethrown by the next
+// append(), flush(), sync() or close(). One thread at a time may use the writer, and
+// append() after close() throws std::logic_error. Records larger than a batch are written
+// on their own.
+template<typename T>
+class AppendWriter {
+public:
+    explicit AppendWriter(const char* path, AppendOptions options = {})
+        : file_(path), options_(options), offset_(file_.initial_size()) {
+        options_.buffer_size = std::max<size_t>(options_.buffer_size, 1);
+        const size_t slots = options_.background ? std::max<size_t>(options_.buffers, 2) : 1;
+        for (size_t i = 0; i < slots; ++i) {
+            slots_.push_back({Storage(static_cast<uint8_t*>(::operator new(options_.buffer_size, page))), 0});
+        }
+        last_sync_ = std::chrono::steady_clock::now();
+        timed_ = options_.background && options_.max_delay.count() != 0;
+        if (options_.background) {
+            flusher_ = std::thread([this] { run_flusher(); });
+        }
+    }
+
+    // Unreported errors are lost here; call close() to see them
+    ~AppendWriter() {
+        try {
+            close();
+        } catch (...) {
+        }
+    }
+
+    AppendWriter(const AppendWriter&) = delete;
+    AppendWriter& operator=(const AppendWriter&) = delete;
+
+    void append(const T& record) {
+        if (closed_) {
+            throw std::logic_error("append() on a closed AppendWriter");
+        }
+        const auto lock = lock_batch();
+        rethrow_if_failed();
+        const size_t size = record.serialized_size(offset_);
+        if (size > options_.buffer_size) {
+            append_oversized(record);
+            return;
+        }
+        if (size > options_.buffer_size - current().used) {
+            submit();
+        }
+        Slot& slot = current();
+        Writer writer(std::span<uint8_t>(slot.data.get() + slot.used, size), offset_);
+        record.write(writer);
+        slot.used += size;
+        offset_ += size;
+        ++records_;
+        if (++batch_records_ == 1 && options_.max_delay.count() != 0) {
+            batch_start_ = std::chrono::steady_clock::now();
+            if (timed_) {
+                batch_deadline_.store((batch_start_ + options_.max_delay).time_since_epoch().count(),
+                                      std::memory_order_relaxed);
+                wake_flusher();
+            }
+        }
+        if ((options_.max_records != 0 && batch_records_ >= options_.max_records) ||
+            (options_.max_delay.count() != 0 && std::chrono::steady_clock::now() - batch_start_ >= options_.max_delay)) {
+            submit();
+        }
+    }
+
+    // Ends the current batch; it is written now, or queued for the flushing thread
+    void flush() {
+        const auto lock = lock_batch();
+        submit();
+        rethrow_if_failed();
+    }
+
+    // Writes and syncs everything appended so far
+    void sync() {
+        const auto lock = lock_batch();
+        submit();
+        drain();
+        rethrow_if_failed();
+        sync_file();
+    }
+
+    // Writes everything appended so far, syncs it if a sync policy is set, and stops the
+    // flushing thread. Later appends are not allowed.
+    void close() {
+        if (closed_) {
+            return;
+        }
+        closed_ = true;
+        {
+            const auto lock = lock_batch();
+            submit();
+        }
+        if (flusher_.joinable()) {
+            stop_.store(true, std::memory_order_release);
+            wake_flusher();
+            flusher_.join();
+        }
+        rethrow_if_failed();
+        if ((options_.sync_every != 0 || options_.sync_interval.count() != 0) && unsynced_ != 0) {
+            sync_file();
+        }
+    }
+
+    size_t records() const { return records_; }
+    size_t bytes() const { return offset_ - file_.initial_size(); }
+    size_t batches() const { return batches_.load(std::memory_order_relaxed); }
+    size_t syncs() const { return syncs_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr std::align_val_t page{4096};
+
+    struct Free {
+        void operator()(uint8_t* p) const { ::operator delete(p, page); }
+    };
+    using Storage = std::unique_ptr<uint8_t, Free>;
+
+    struct Slot {
+        Storage data;
+        size_t used;
+    };
+
+    Slot& current() { return slots_[head_ % slots_.size()]; }
+
+    // Held by the appending thread while it uses the current batch, when the flushing
+    // thread may also end it (background with max_delay). That thread only ever tries the
+    // lock, so waiting on it for a free slot while holding it cannot deadlock.
+    std::unique_lock<std::mutex> lock_batch() {
+        return timed_ ? std::unique_lock<std::mutex>(batch_mutex_) : std::unique_lock<std::mutex>();
+    }
+
+    // Hands the current batch over and moves to a free slot
+    void submit() {
+        if (current().used == 0) {
+            return;
+        }
+        batch_records_ = 0;
+        batch_deadline_.store(0, std::memory_order_relaxed);
+        if (!options_.background) {
+            write_batch(current());
+            return;
+        }
+        published_.store(++head_, std::memory_order_release);
+        wake_flusher();
+        for (size_t retired = retired_.load(std::memory_order_acquire); head_ - retired >= slots_.size();
+             retired = retired_.load(std::memory_order_acquire)) {
+            retired_.wait(retired, std::memory_order_acquire);
+        }
+        current().used = 0;
+    }
+
+    // Waits until the flushing thread has written every submitted batch
+    void drain() {
+        for (size_t retired = retired_.load(std::memory_order_acquire); retired != head_;
+             retired = retired_.load(std::memory_order_acquire)) {
+            retired_.wait(retired, std::memory_order_acquire);
+        }
+    }
+
+    void append_oversized(const T& record) {
+        submit();
+        drain();
+        rethrow_if_failed();
+        std::vector<uint8_t> bytes(record.serialized_size(offset_));
+        Writer out(bytes, offset_);
+        record.write(out);
+        file_.write_all(bytes);
+        offset_ += bytes.size();
+        ++records_;
+        batches_.fetch_add(1, std::memory_order_relaxed);
+        ++unsynced_;
+        maybe_sync();
+    }
+
+    void write_batch(Slot& slot) {
+        file_.write_all(std::span<const uint8_t>(slot.data.get(), slot.used));
+        slot.used = 0;
+        batches_.fetch_add(1, std::memory_order_relaxed);
+        ++unsynced_;
+        maybe_sync();
+    }
+
+    void maybe_sync() {
+        if ((options_.sync_every != 0 && unsynced_ >= options_.sync_every) ||
+            (options_.sync_interval.count() != 0 && std::chrono::steady_clock::now() - last_sync_ >= options_.sync_interval)) {
+            sync_file();
+        }
+    }
+
+    void sync_file() {
+        file_.sync();
+        unsynced_ = 0;
+        last_sync_ = std::chrono::steady_clock::now();
+        syncs_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void wake_flusher() {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            ++signal_;
+        }
+        wake_.notify_one();
+    }
+
+    // Sleeps until woken, or until the current batch reaches max_delay and is ended here
+    void wait_for_work(size_t next) {
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        const uint64_t signal = signal_;
+        if (published_.load(std::memory_order_acquire) != next || stop_.load(std::memory_order_acquire)) {
+            return;
+        }
+        const auto woken = [&] { return signal_ != signal; };
+        const auto deadline = batch_deadline_.load(std::memory_order_relaxed);
+        if (deadline == 0) {
+            wake_.wait(lock, woken);
+        } else if (!wake_.wait_until(lock, std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(deadline)),
+                                     woken)) {
+            lock.unlock();
+            end_expired_batch(next);
+        }
+    }
+
+    // On the flushing thread, with the first `next` batches written. Only while that is every
+    // published batch is the slot after the current one known to be free.
+    void end_expired_batch(size_t next) {
+        std::unique_lock<std::mutex> lock(batch_mutex_, std::try_to_lock);
+        if (!lock || head_ != next || batch_records_ == 0 ||
+            std::chrono::steady_clock::now() - batch_start_ < options_.max_delay) {
+            return;
+        }
+        batch_records_ = 0;
+        batch_deadline_.store(0, std::memory_order_relaxed);
+        published_.store(++head_, std::memory_order_release);
+    }
+
+    void run_flusher() {
+        size_t next = 0;
+        for (;;) {
+            if (published_.load(std::memory_order_acquire) == next) {
+                if (stop_.load(std::memory_order_acquire)) {
+                    return;
+                }
+                wait_for_work(next);
+                continue;
+            }
+            Slot& slot = slots_[next % slots_.size()];
+            if (!failed_.load(std::memory_order_relaxed)) {
+                try {
+                    write_batch(slot);
+                } catch (...) {
+                    error_ = std::current_exception();
+                    failed_.store(true, std::memory_order_release);
+                }
+            }
+            retired_.store(++next, std::memory_order_release);
+            retired_.notify_one();
+        }
+    }
+
+    void rethrow_if_failed() {
+        if (failed_.load(std::memory_order_acquire)) {
+            std::rethrow_exception(error_);
+        }
+    }
+
+    AppendFile file_;
+    AppendOptions options_;
+    std::vector<Slot> slots_;
+    size_t offset_;                 // file offset of the next record, for align:
+    size_t head_ = 0;               // batches submitted; the current slot is head_ % slots
+    size_t records_ = 0;
+    size_t batch_records_ = 0;
+    std::chrono::steady_clock::time_point batch_start_;
+    bool closed_ = false;
+    bool timed_ = false;            // the flushing thread enforces max_delay
+    std::mutex batch_mutex_;        // see lock_batch()
+    std::atomic<int64_t> batch_deadline_{0};  // steady_clock ticks when the current batch expires; 0 if empty
+
+    // Owned by whichever thread writes batches; handed over through published_/retired_
+    size_t unsynced_ = 0;
+    std::chrono::steady_clock::time_point last_sync_;
+    std::exception_ptr error_;
+
+    std::atomic<size_t> published_{0};
+    std::atomic<size_t> retired_{0};
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    uint64_t signal_ = 0;           // bumped under wake_mutex_ by wake_flusher()
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> failed_{false};
+    std::atomic<size_t> batches_{0};
+    std::atomic<size_t> syncs_{0};
+    std::thread flusher_;
+};
+#endif
+
+#if defined(DEZZY_RANDOM)
+// ---- Random values ----
+
+// xoshiro256** seeded through splitmix64. Integer draws are the same for a seed on every
+// platform; lengths also pass through std::exp and std::log.
+class Rng {
+public:
+    explicit Rng(uint64_t seed = 0) {
+        for (auto& word : state_) {
+            seed += 0x9E3779B97F4A7C15;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    uint64_t next() {
+        const uint64_t result = std::rotl(state_[1] * 5, 7) * 9;
+        const uint64_t t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = std::rotl(state_[3], 45);
+        return result;
+    }
+
+    // Uniform in [0, 1)
+    double unit() { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+
+    // Uniform in [lo, hi]; the modulo bias does not matter for test data
+    int64_t between(int64_t lo, int64_t hi) {
+        if (hi <= lo) {
+            return lo;
+        }
+        const uint64_t span = static_cast<uint64_t>(hi) - static_cast<uint64_t>(lo);
+        const uint64_t offset = span == std::numeric_limits<uint64_t>::max() ? next() : next() % (span + 1);
+        return static_cast<int64_t>(static_cast<uint64_t>(lo) + offset);
+    }
+
+    int64_t pick(std::initializer_list<int64_t> values) {
+        return values.begin()[next() % values.size()];
+    }
+
+    // Standard normal (Box-Muller)
+    double normal() {
+        const double u = 1.0 - unit();
+        return std::sqrt(-2.0 * std::log(u)) * std::cos(6.283185307179586 * unit());
+    }
+
+    void fill(uint8_t* data, size_t size) {
+        for (; size >= 8; data += 8, size -= 8) {
+            const uint64_t word = next();
+            std::memcpy(data, &word, 8);
+        }
+        if (size > 0) {
+            const uint64_t word = next();
+            std::memcpy(data, &word, size);
+        }
+    }
+
+private:
+    uint64_t state_[4];
+};
+
+// Log-normal lengths: half the draws fall below `median`, and `sigma` is the spread of
+// log(length), so 0 always gives the median. Draws are clamped to [min, max].
+struct LengthDistribution {
+    double median = 8;
+    double sigma = 0.5;
+    size_t min = 0;
+    size_t max = 1024;
+
+    size_t draw(Rng& rng) const {
+        const double length = sigma == 0 ? median : median * std::exp(sigma * rng.normal());
+        const double clamped = std::clamp(length, static_cast<double>(min), static_cast<double>(max));
+        return static_cast<size_t>(std::llround(clamped));
+    }
+};
+
+// Lengths of the containers in random values. Count and length fields still cap them:
+// a u8 count never gets more than 255 elements.
+struct SizeProfile {
+    LengthDistribution elements{8, 0.5, 0, 1024};        // entries of arrays
+    LengthDistribution strings{12, 0.5, 0, 255};         // characters of strings
+    LengthDistribution blobs{256, 1.0, 0, size_t{1} << 20}; // bytes of blobs
+
+    // Every array and string exactly `n` long, blobs 16 * n bytes
+    static SizeProfile fixed(size_t n) {
+        const double length = static_cast<double>(n);
+        return {{length, 0, n, n}, {length, 0, n, n}, {16 * length, 0, 16 * n, 16 * n}};
+    }
+};
+
+namespace detail {
+
+template<typename T, bool = std::is_enum_v<T>>
+struct integer_of {
+    using type = T;
+};
+template<typename T>
+struct integer_of<T, true> {
+    using type = std::underlying_type_t<T>;
+};
+
+template<typename T>
+inline void assign(T& field, int64_t value) {
+    field = static_cast<T>(value);
+}
+
+template<typename T>
+inline void assign_each(T& field, std::initializer_list<int64_t> values) {
+    std::transform(values.begin(), values.end(), field.begin(),
+                   [](int64_t value) { return static_cast<typename T::value_type>(value); });
+}
+
+template<typename T>
+inline int64_t as_int(const T& field) {
+    return static_cast<int64_t>(field);
+}
+
+// Any value of T's integer type
+template<typename T>
+inline T drawn(Rng& rng) {
+    return static_cast<T>(static_cast<typename integer_of<T>::type>(rng.next()));
+}
+
+template<typename T>
+inline void draw(T& field, Rng& rng) {
+    field = drawn<T>(rng);
+}
+
+template<typename T>
+inline int64_t max_of(const T&) {
+    using I = typename integer_of<T>::type;
+    return static_cast<int64_t>(std::min<uint64_t>(static_cast<uint64_t>(std::numeric_limits<I>::max()),
+                                                   static_cast<uint64_t>(std::numeric_limits<int64_t>::max())));
+}
+
+template<typename T>
+inline int64_t min_of(const T&) {
+    return static_cast<int64_t>(std::numeric_limits<typename integer_of<T>::type>::min());
+}
+
+inline bool contains(std::initializer_list<int64_t> values, int64_t value) {
+    return std::find(values.begin(), values.end(), value) != values.end();
+}
+
+// `length`, or the most the count field `size` can record
+template<typename T>
+inline size_t length_for(const T& size, size_t length) {
+    (void)size;
+    const auto most = static_cast<uint64_t>(std::numeric_limits<typename integer_of<T>::type>::max());
+    return static_cast<size_t>(std::min<uint64_t>(length, most));
+}
+
+inline std::string random_text(Rng& rng, size_t length) {
+    static constexpr char alphabet[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 ._-/";
+    std::string text(length, ' ');
+    for (auto& c : text) {
+        c = alphabet[rng.next() % (sizeof(alphabet) - 1)];
+    }
+    return text;
+}
+
+} // namespace detail
+#endif
+
+// ---- Push parsing ----
+#if defined(DEZZY_PUSH_PARSER)
+
+enum class ParseStatus {
+    NeedMore,
+    Done,
+    Error
+};
+
+// Specialized for every generated type: Parser<T>::feed() accepts the stream in
+// arbitrary fragments and picks up exactly where the previous fragment ended.
+template<typename T>
+class Parser;
+
+class PushParser {
+public:
+    const std::string& error() const { return error_; }
+    // Absolute stream offset of the next byte to be consumed
+    size_t position() const { return position_; }
+    // True once the current record has consumed any input
+    bool started() const { return position_ != start_ || bit_count_ != 0; }
+    bool verify_checksums() const { return verify_checksums_; }
+    void set_verify_checksums(bool enabled) { verify_checksums_ = enabled; }
+
+protected:
+    void reset_base(size_t position) {
+        position_ = position;
+        start_ = position;
+        scratch_len_ = 0;
+        bit_buffer_ = 0;
+        bit_count_ = 0;
+        index_ = 0;
+        pending_ = 0;
+        eof_ = false;
+        failed_ = false;
+        error_.clear();
+    }
+
+    // Accumulates a scalar of `count` bytes across fragments; true once it is complete
+    bool fill(std::span<const uint8_t>& input, size_t count) {
+        const size_t take = std::min(count - scratch_len_, input.size());
+        if (take == 0) {
+            return scratch_len_ == count;
+        }
+        std::memcpy(scratch_ + scratch_len_, input.data(), take);
+        scratch_len_ += take;
+        input = input.subspan(take);
+        position_ += take;
+        return scratch_len_ == count;
+    }
+
+    template<typename T>
+    T load_le() {
+        Reader reader(std::span<const uint8_t>(scratch_, sizeof(T)));
+        scratch_len_ = 0;
+        return reader.read_le<T>();
+    }
+
+    template<typename T>
+    T load_be() {
+        Reader reader(std::span<const uint8_t>(scratch_, sizeof(T)));
+        scratch_len_ = 0;
+        return reader.read_be<T>();
+    }
+
+    // Counts come off the stream unchecked, so only this much is reserved up front;
+    // containers grow past it as their elements arrive
+    static constexpr size_t max_reserve_bytes = 64 * 1024;
+
+    template<typename Container>
+    static void reserve_up_to(Container& container, size_t count) {
+        container.reserve(std::min(count, max_reserve_bytes / sizeof(typename Container::value_type)));
+    }
+
+    // Takes up to `count` bytes straight out of the fragment
+    std::span<const uint8_t> consume(std::span<const uint8_t>& input, size_t count) {
+        const auto bytes = input.first(std::min(count, input.size()));
+        input = input.subspan(bytes.size());
+        position_ += bytes.size();
+        return bytes;
+    }
+
+    // Bitfields are MSB-first and share bytes across consecutive fields
+    bool fill_bits(std::span<const uint8_t>& input, size_t num_bits) {
+        while (bit_count_ < num_bits) {
+            if (input.empty()) {
+                return false;
+            }
+            bit_buffer_ = (bit_buffer_ << 8) | input[0];
+            bit_count_ += 8;
+            input = input.subspan(1);
+            ++position_;
+        }
+        return true;
+    }
+
+    uint32_t take_bits(size_t num_bits) {
+        bit_count_ -= num_bits;
+        return static_cast<uint32_t>((bit_buffer_ >> bit_count_) & ((1u << num_bits) - 1));
+    }
+
+    int32_t take_signed_bits(size_t num_bits) {
+        const uint32_t value = take_bits(num_bits);
+        if (value & (1u << (num_bits - 1))) {
+            return static_cast<int32_t>(value | ~((1u << num_bits) - 1));
+        }
+        return static_cast<int32_t>(value);
+    }
+
+    ParseStatus fail(const std::string& message) {
+        failed_ = true;
+        error_ = message;
+        return ParseStatus::Error;
+    }
+
+    size_t position_ = 0;
+    size_t start_ = 0;
+    uint8_t scratch_[8] = {};
+    size_t scratch_len_ = 0;
+    uint32_t bit_buffer_ = 0;
+    size_t bit_count_ = 0;
+    size_t index_ = 0;      // next element of the array being filled
+    size_t pending_ = 0;    // bytes still owed to the string/skip being filled
+    bool eof_ = false;
+    bool failed_ = false;
+    bool verify_checksums_ = true;
+    std::string error_;
+};
+#endif
+
+// ---- Field ids ----
+
+enum class FieldId : uint32_t {
+    FileEntry_filename_len,
+    FileEntry_filename,
+    FileEntry_file_size,
+    FileEntry_file_data,
+    FileEntry_padding_size,
+    Container_magic,
+    Container_num_entries,
+    Container_entries,
+};
+
+constexpr std::string_view field_name(FieldId id) {
+    switch (id) {
+    case FieldId::FileEntry_filename_len: return "FileEntry.filename_len";
+    case FieldId::FileEntry_filename: return "FileEntry.filename";
+    case FieldId::FileEntry_file_size: return "FileEntry.file_size";
+    case FieldId::FileEntry_file_data: return "FileEntry.file_data";
+    case FieldId::FileEntry_padding_size: return "FileEntry.padding_size";
+    case FieldId::Container_magic: return "Container.magic";
+    case FieldId::Container_num_entries: return "Container.num_entries";
+    case FieldId::Container_entries: return "Container.entries";
+    }
+    return {};
+}
+
+// ---- Visitors ----
+#if defined(DEZZY_VISITOR)
+
+// Passed to begin_array() when the element count is only known at the end
+inline constexpr size_t unknown_count = SIZE_MAX;
+
+// Callbacks for T::visit(), called in wire order. Derive and redefine the ones you need;
+// the visitor is a template parameter, so the remaining no-ops inline away.
+struct VisitorBase {
+    void on_u8(FieldId, uint8_t) {}
+    void on_u16(FieldId, uint16_t) {}
+    void on_u32(FieldId, uint32_t) {}
+    void on_u64(FieldId, uint64_t) {}
+    void on_i8(FieldId, int8_t) {}
+    void on_i16(FieldId, int16_t) {}
+    void on_i32(FieldId, int32_t) {}
+    void on_i64(FieldId, int64_t) {}
+    void on_bits(FieldId, int64_t /*value*/, unsigned /*width*/) {}
+    // Byte arrays and blobs; the span points into the input
+    void on_bytes(FieldId, std::span<const uint8_t>) {}
+    // Strings of every kind; the view points into the input
+    void on_string(FieldId, std::string_view) {}
+    void begin_array(FieldId, size_t /*count or unknown_count*/) {}
+    void end_array(FieldId) {}
+    void begin_struct(FieldId) {}
+    void end_struct(FieldId) {}
+};
+#endif
+
+// ---- Hook ids ----
+
+enum class TypeId : uint32_t {
+    FileEntry,
+    Container,
+};
+
+inline constexpr size_t type_count = 2;
+inline constexpr size_t field_count = 8;
+
+constexpr std::string_view type_name(TypeId id) {
+    switch (id) {
+    case TypeId::FileEntry: return "FileEntry";
+    case TypeId::Container: return "Container";
+    }
+    return {};
+}
+
+#if defined(DEZZY_STATS_HOOKS)
+// Counters of one thread, laid out as [types][fields][errors]; every type has reads, bytes,
+// total_ns and the latency buckets
+struct StatsHooks::Local {
+    static constexpr size_t per_type = 3 + latency_buckets;
+    static constexpr size_t size = type_count * per_type + field_count * 2 + error_kind_count;
+
+    Local();
+    ~Local();
+    Local(const Local&) = delete;
+    Local& operator=(const Local&) = delete;
+
+    std::unique_ptr<Counter[]> counters{new Counter[size]};
+    // Reads in progress on this thread, innermost last
+    std::vector<std::pair<TypeId, std::chrono::steady_clock::time_point>> open;
+};
+
+struct StatsHooks::Registry {
+    std::mutex mutex;
+    std::vector<Local*> live;
+    std::vector<uint64_t> retired = std::vector<uint64_t>(Local::size);  // from exited threads
+};
+
+inline StatsHooks::Registry& StatsHooks::registry() {
+    static Registry instance;
+    return instance;
+}
+
+inline StatsHooks::Local::Local() {
+    open.reserve(16);
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.live.push_back(this);
+}
+
+inline StatsHooks::Local::~Local() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (size_t i = 0; i < size; ++i) {
+        r.retired[i] += counters[i].get();
+    }
+    r.live.erase(std::find(r.live.begin(), r.live.end(), this));
+}
+
+inline StatsHooks::Local& StatsHooks::local() {
+    thread_local Local instance;
+    return instance;
+}
+
+inline void StatsHooks::on_enter(TypeId type, size_t /*offset*/) {
+    local().open.emplace_back(type, std::chrono::steady_clock::now());
+}
+
+inline void StatsHooks::on_exit(TypeId type, size_t bytes) {
+    Local& l = local();
+    if (l.open.empty()) {
+        return;
+    }
+    const auto start = l.open.back().second;
+    l.open.pop_back();
+    const auto ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    Counter* c = &l.counters[static_cast<size_t>(type) * Local::per_type];
+    c[0].add(1);
+    c[1].add(bytes);
+    c[2].add(ns);
+    c[3 + std::min<size_t>(std::bit_width(ns), latency_buckets - 1)].add(1);
+}
+
+inline void StatsHooks::on_field(FieldId field, size_t bytes) {
+    Counter* c = &local().counters[type_count * Local::per_type + static_cast<size_t>(field) * 2];
+    c[0].add(1);
+    c[1].add(bytes);
+}
+
+inline void StatsHooks::on_error(ErrorKind kind) {
+    local().counters[type_count * Local::per_type + field_count * 2 + static_cast<size_t>(kind)].add(1);
+}
+
+inline void StatsHooks::on_abort(TypeId /*type*/) {
+    Local& l = local();
+    if (!l.open.empty()) {
+        l.open.pop_back();
+    }
+}
+
+inline StatsHooks::Snapshot StatsHooks::snapshot() {
+    Registry& r = registry();
+    std::vector<uint64_t> totals;
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        totals = r.retired;
+        for (const Local* l : r.live) {
+            for (size_t i = 0; i < Local::size; ++i) {
+                totals[i] += l->counters[i].get();
+            }
+        }
+    }
+    Snapshot s;
+    s.types.resize(type_count);
+    s.fields.resize(field_count);
+    const uint64_t* t = totals.data();
+    for (auto& type : s.types) {
+        type.reads = t[0];
+        type.bytes = t[1];
+        type.total_ns = t[2];
+        std::copy(t + 3, t + Local::per_type, type.latency.begin());
+        t += Local::per_type;
+    }
+    for (auto& field : s.fields) {
+        field.reads = t[0];
+        field.bytes = t[1];
+        t += 2;
+    }
+    std::copy(t, t + error_kind_count, s.errors.begin());
+    return s;
+}
+
+inline void StatsHooks::reset() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::fill(r.retired.begin(), r.retired.end(), 0);
+    for (Local* l : r.live) {
+        for (size_t i = 0; i < Local::size; ++i) {
+            l->counters[i].value.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+inline std::string StatsHooks::json() {
+    const Snapshot s = snapshot();
+    // Upper bound of the bucket that holds the q-th quantile
+    auto quantile = [](const TypeStats& type, double q) -> uint64_t {
+        const auto rank = static_cast<uint64_t>(q * static_cast<double>(type.reads));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < latency_buckets; ++i) {
+            seen += type.latency[i];
+            if (seen > rank) {
+                return uint64_t{1} << i;
+            }
+        }
+        return uint64_t{1} << (latency_buckets - 1);
+    };
+    char line[512];
+    std::string out = "{\n  \"types\": [";
+    for (size_t i = 0; i < type_count; ++i) {
+        const TypeStats& type = s.types[i];
+        std::snprintf(line, sizeof(line),
+                      "%s\n    {\"name\": \"%s\", \"reads\": %llu, \"bytes\": %llu, \"total_ns\": %llu, "
+                      "\"p50_ns\": %llu, \"p90_ns\": %llu, \"p99_ns\": %llu, \"latency\": [",
+                      i == 0 ? "" : ",", std::string(type_name(static_cast<TypeId>(i))).c_str(),
+                      static_cast<unsigned long long>(type.reads), static_cast<unsigned long long>(type.bytes),
+                      static_cast<unsigned long long>(type.total_ns),
+                      static_cast<unsigned long long>(quantile(type, 0.5)),
+                      static_cast<unsigned long long>(quantile(type, 0.9)),
+                      static_cast<unsigned long long>(quantile(type, 0.99)));
+        out += line;
+        for (size_t b = 0; b < latency_buckets; ++b) {
+            out += (b == 0 ? "" : ", ") + std::to_string(type.latency[b]);
+        }
+        out += "]}";
+    }
+    out += "\n  ],\n  \"fields\": [";
+    for (size_t i = 0; i < field_count; ++i) {
+        std::snprintf(line, sizeof(line), "%s\n    {\"name\": \"%s\", \"reads\": %llu, \"bytes\": %llu}", i == 0 ? "" : ",",
+                      std::string(field_name(static_cast<FieldId>(i))).c_str(),
+                      static_cast<unsigned long long>(s.fields[i].reads),
+                      static_cast<unsigned long long>(s.fields[i].bytes));
+        out += line;
+    }
+    std::snprintf(line, sizeof(line),
+                  "\n  ],\n  \"errors\": {\"truncated\": %llu, \"assertion\": %llu, \"checksum\": %llu, \"malformed\": %llu, "
+                  "\"limit\": %llu}\n}\n",
+                  static_cast<unsigned long long>(s.errors[0]), static_cast<unsigned long long>(s.errors[1]),
+                  static_cast<unsigned long long>(s.errors[2]), static_cast<unsigned long long>(s.errors[3]),
+                  static_cast<unsigned long long>(s.errors[4]));
+    out += line;
+    return out;
+}
+#endif
+
+#if defined(DEZZY_TRACE_HOOKS)
+// One thread's spans. Only the owning thread writes; it publishes each span by storing
+// `size` with release, so spans() can copy the published prefix at any time.
+struct TraceHooks::Buffer {
+    struct Open {
+        TypeId type;
+        uint64_t offset;
+        std::chrono::steady_clock::time_point start;
+        uint8_t error = 0;  // as in Span
+    };
+
+    Buffer(size_t capacity, uint32_t tid) : spans(new Span[capacity]), capacity(capacity), tid(tid) {
+        open.reserve(16);
+    }
+
+    void record(const Span& span) {
+        const size_t n = size.load(std::memory_order_relaxed);
+        if (n == capacity) {
+            dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return;
+        }
+        spans[n] = span;
+        size.store(n + 1, std::memory_order_release);
+    }
+
+    std::unique_ptr<Span[]> spans;
+    const size_t capacity;
+    const uint32_t tid;
+    std::atomic<size_t> size{0};
+    std::atomic<uint64_t> dropped{0};
+    // Owning thread only
+    uint64_t roots = 0;    // outermost reads started
+    uint32_t depth = 0;    // reads in progress, traced or not
+    bool sampled = false;  // whether the current outermost read is traced
+    std::vector<Open> open;
+};
+
+struct TraceHooks::Registry {
+    std::mutex mutex;
+    // Kept after their thread exits, so its spans still reach json()
+    std::vector<std::unique_ptr<Buffer>> buffers;
+    const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    std::atomic<uint32_t> every{1};
+    std::atomic<size_t> capacity{size_t{1} << 16};
+};
+
+inline TraceHooks::Registry& TraceHooks::registry() {
+    static Registry instance;
+    return instance;
+}
+
+inline TraceHooks::Buffer& TraceHooks::local() {
+    thread_local Buffer* instance = [] {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.buffers.push_back(std::make_unique<Buffer>(r.capacity.load(std::memory_order_relaxed),
+                                                     static_cast<uint32_t>(r.buffers.size() + 1)));
+        return r.buffers.back().get();
+    }();
+    return *instance;
+}
+
+inline void TraceHooks::on_enter(TypeId type, size_t offset) {
+    Buffer& b = local();
+    if (b.depth++ == 0) {
+        b.sampled = b.roots++ % registry().every.load(std::memory_order_relaxed) == 0;
+    }
+    if (b.sampled) {
+        b.open.push_back({type, offset, std::chrono::steady_clock::now()});
+    }
+}
 
-namespace testcontainer {
+inline void TraceHooks::on_exit(TypeId type, size_t bytes) {
+    Buffer& b = local();
+    if (b.depth == 0) {
+        return;
+    }
+    --b.depth;
+    if (!b.sampled || b.open.empty()) {
+        return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    const Buffer::Open span = b.open.back();
+    b.open.pop_back();
+    const auto ns = [](auto d) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+    };
+    b.record({type, 0, span.offset, bytes, ns(span.start - registry().epoch), ns(now - span.start)});
+}
 
-class ParseError : public std::runtime_error {
-public:
-    explicit ParseError(const std::string& message)
-        : std::runtime_error(message) {}
-};
+inline void TraceHooks::on_error(ErrorKind kind) {
+    Buffer& b = local();
+    if (b.depth != 0 && b.sampled && !b.open.empty()) {
+        b.open.back().error = static_cast<uint8_t>(1 + static_cast<uint8_t>(kind));
+    }
+}
 
-class Reader {
-public:
-    explicit Reader(std::span<const uint8_t> data)
-        : data_(data), position_(0) {}
+inline void TraceHooks::on_abort(TypeId type) {
+    Buffer& b = local();
+    if (b.depth == 0) {
+        return;
+    }
+    --b.depth;
+    if (!b.sampled || b.open.empty()) {
+        return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    const Buffer::Open span = b.open.back();
+    b.open.pop_back();
+    if (!b.open.empty() && b.open.back().error == 0) {
+        b.open.back().error = span.error;
+    }
+    const auto ns = [](auto d) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+    };
+    b.record({type, span.error, span.offset, 0, ns(span.start - registry().epoch), ns(now - span.start)});
+}
 
-    template<typename T>
-    T read_le() {
-        if (position_ + sizeof(T) > data_.size()) {
-            throw ParseError("Unexpected end of data");
-        }
-        T value;
-        std::memcpy(&value, &data_[position_], sizeof(T));
-        position_ += sizeof(T);
-        return value;
+inline void TraceHooks::set_sampling(uint32_t every) {
+    registry().every.store(std::max<uint32_t>(every, 1), std::memory_order_relaxed);
+}
+
+inline void TraceHooks::set_capacity(size_t spans) {
+    registry().capacity.store(std::max<size_t>(spans, 1), std::memory_order_relaxed);
+}
+
+inline std::vector<std::vector<TraceHooks::Span>> TraceHooks::spans() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::vector<std::vector<Span>> out;
+    for (const auto& b : r.buffers) {
+        const size_t n = b->size.load(std::memory_order_acquire);
+        out.emplace_back(b->spans.get(), b->spans.get() + n);
     }
+    return out;
+}
 
-    template<typename T>
-    T read_be() {
-        if (position_ + sizeof(T) > data_.size()) {
-            throw ParseError("Unexpected end of data");
+inline uint64_t TraceHooks::dropped() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    uint64_t total = 0;
+    for (const auto& b : r.buffers) {
+        total += b->dropped.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+inline void TraceHooks::reset() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const auto& b : r.buffers) {
+        b->size.store(0, std::memory_order_relaxed);
+        b->dropped.store(0, std::memory_order_relaxed);
+    }
+}
+
+inline std::string TraceHooks::json() {
+    static constexpr const char* errors[] = {"truncated", "assertion", "checksum", "malformed", "limit"};
+    const auto threads = spans();
+    char line[512];
+    std::string out = "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+    const char* separator = "\n";
+    for (size_t t = 0; t < threads.size(); ++t) {
+        std::snprintf(line, sizeof(line),
+                      "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %zu, "
+                      "\"args\": {\"name\": \"parser %zu\"}}",
+                      separator, t + 1, t + 1);
+        out += line;
+        separator = ",\n";
+        for (const Span& span : threads[t]) {
+            std::snprintf(line, sizeof(line),
+                          ",\n{\"name\": \"%s\", \"cat\": \"read\", \"ph\": \"X\", \"pid\": 1, \"tid\": %zu, "
+                          "\"ts\": %.3f, \"dur\": %.3f, \"args\": {\"offset\": %llu, \"bytes\": %llu%s%s%s}}",
+                          std::string(type_name(span.type)).c_str(), t + 1,
+                          static_cast<double>(span.start_ns) / 1e3, static_cast<double>(span.duration_ns) / 1e3,
+                          static_cast<unsigned long long>(span.offset), static_cast<unsigned long long>(span.bytes),
+                          span.error != 0 ? ", \"error\": \"" : "", span.error != 0 ? errors[span.error - 1] : "",
+                          span.error != 0 ? "\"" : "");
+            out += line;
         }
-        T value = 0;
-        for (size_t i = 0; i < sizeof(T); ++i) {
-            value = (value << 8) | data_[position_ + i];
+    }
+    std::snprintf(line, sizeof(line), "\n], \"otherData\": {\"dropped_spans\": %llu}}\n",
+                  static_cast<unsigned long long>(dropped()));
+    out += line;
+    return out;
+}
+#endif
+
+// ---- Memory accounting ----
+
+#if defined(DEZZY_HEAP_BYTES)
+namespace detail {
+
+// Heap memory a member owns: container capacity plus whatever its elements own
+template<typename T> size_t heap_bytes_of(const T& value);
+template<typename T> size_t heap_bytes_of(const std::vector<T>& values);
+template<typename T, size_t N> size_t heap_bytes_of(const std::array<T, N>& values);
+template<typename T> size_t heap_bytes_of(const std::optional<T>& value);
+
+// Short strings live inside the object (SSO) and own nothing
+inline size_t heap_bytes_of(const std::string& value) {
+    const auto self = reinterpret_cast<uintptr_t>(&value);
+    const auto data = reinterpret_cast<uintptr_t>(value.data());
+    return data >= self && data < self + sizeof(value) ? 0 : value.capacity() + 1;
+}
+
+template<typename T>
+size_t heap_bytes_of(const T& value) {
+    if constexpr (requires { value.heap_bytes(); }) {
+        return value.heap_bytes();
+    } else {
+        return 0;
+    }
+}
+
+template<typename T>
+size_t heap_bytes_of(const std::vector<T>& values) {
+    size_t bytes = values.capacity() * sizeof(T);
+    if constexpr (!std::is_arithmetic_v<T> && !std::is_enum_v<T>) {
+        for (const T& value : values) {
+            bytes += heap_bytes_of(value);
         }
-        position_ += sizeof(T);
-        return value;
     }
+    return bytes;
+}
 
-    void skip(size_t bytes) {
-        if (position_ + bytes > data_.size()) {
-            throw ParseError("Unexpected end of data during skip");
+template<typename T, size_t N>
+size_t heap_bytes_of(const std::array<T, N>& values) {
+    size_t bytes = 0;
+    if constexpr (!std::is_arithmetic_v<T> && !std::is_enum_v<T>) {
+        for (const T& value : values) {
+            bytes += heap_bytes_of(value);
         }
-        position_ += bytes;
     }
+    return bytes;
+}
 
-    size_t position() const { return position_; }
-    size_t remaining() const { return data_.size() - position_; }
+template<typename T>
+size_t heap_bytes_of(const std::optional<T>& value) {
+    return value ? heap_bytes_of(*value) : 0;
+}
 
-private:
-    std::span<const uint8_t> data_;
-    size_t position_;
+} // namespace detail
+#endif
+
+#if defined(DEZZY_COUNT_ALLOCATIONS)
+// What the most recent top-level read() on this thread allocated, nested reads included.
+// Counts stay zero unless one translation unit defines DEZZY_DEFINE_ALLOCATION_COUNTER.
+struct ReadFootprint {
+    TypeId type{};
+    uint64_t allocations = 0;
+    uint64_t allocated_bytes = 0;  // requested, whether or not it was freed again
+    bool failed = false;           // the read threw
 };
 
-class Writer {
+namespace detail {
+
+struct FootprintState {
+    uint32_t depth = 0;
+    dezzy_alloc::Counter start;
+    int exceptions = 0;
+    ReadFootprint last;
+};
+
+inline thread_local FootprintState footprint_state;
+
+// Opened by every read(); the outermost one records the footprint when it closes
+class AllocationScope {
 public:
-    template<typename T>
-    void write_le(T value) {
-        uint8_t bytes[sizeof(T)];
-        std::memcpy(bytes, &value, sizeof(T));
-        data_.insert(data_.end(), bytes, bytes + sizeof(T));
+    explicit AllocationScope(TypeId type) {
+        FootprintState& s = footprint_state;
+        if (s.depth++ == 0) {
+            s.start = dezzy_alloc::counter;
+            s.exceptions = std::uncaught_exceptions();
+            s.last.type = type;
+        }
     }
-
-    template<typename T>
-    void write_be(T value) {
-        for (size_t i = sizeof(T); i > 0; --i) {
-            data_.push_back(static_cast<uint8_t>((value >> ((i - 1) * 8)) & 0xFF));
+    ~AllocationScope() {
+        FootprintState& s = footprint_state;
+        if (--s.depth == 0) {
+            s.last.allocations = dezzy_alloc::counter.allocations - s.start.allocations;
+            s.last.allocated_bytes = dezzy_alloc::counter.bytes - s.start.bytes;
+            s.last.failed = std::uncaught_exceptions() > s.exceptions;
         }
     }
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+};
 
-    std::vector<uint8_t> finish() { return std::move(data_); }
+} // namespace detail
 
-private:
-    std::vector<uint8_t> data_;
-};
+inline const ReadFootprint& last_read_footprint() {
+    return detail::footprint_state.last;
+}
+#endif
 
 struct FileEntry {
     uint8_t filename_len;
@@ -90,72 +2826,807 @@ struct FileEntry {
     std::vector<uint8_t> file_data;
     uint16_t padding_size;
 
-    static FileEntry read(Reader& reader);
+    template<typename Cursor>
+    static FileEntry read(BasicReader<Cursor>& reader);
     void write(Writer& writer) const;
+
+    static void skip(Reader& reader);
+
+    // Whether a FileEntry parses at the reader's position, answered without throwing or
+    // allocating for the data it steps over; on success the reader is left after it
+    static bool validate(Reader& reader) noexcept;
+    // validate() that leaves the fixed-width fields it decoded in `result`
+    static bool validate_into(Reader& reader, FileEntry& result) noexcept;
+
+#if defined(DEZZY_VISITOR)
+    template<typename V>
+    static void visit(Reader& reader, V& visitor);
+#endif
+
+#if defined(DEZZY_ASYNC)
+    static Task<FileEntry> read_async(AsyncReader& in);
+#endif
+
+#if defined(DEZZY_RANDOM)
+    // A valid value with random contents and lengths drawn from `sizes`
+    static FileEntry random(Rng& rng, const SizeProfile& sizes = {});
+#endif
+
+#if defined(DEZZY_PASSTHROUGH)
+    // Boundary every `align:` in the encoding divides; copies must land on the same residue
+    static constexpr size_t passthrough_alignment = 1;
+#endif
+
+    // Bytes write() emits when it starts at output offset `at` (only `align:` cares)
+    size_t serialized_size(size_t at = 0) const;
+
+#if defined(DEZZY_HEAP_BYTES)
+    // Heap memory this value owns: capacity of its vectors and strings, nested values included
+    size_t heap_bytes() const;
+#endif
+
+    // Fewest bytes any encoding takes; counts of this struct are checked against it
+    static constexpr size_t min_encoded_size = 7;
 };
 
-inline FileEntry FileEntry::read(Reader& reader) {
+template<typename Cursor>
+inline FileEntry FileEntry::read(BasicReader<Cursor>& reader) {
+#if defined(DEZZY_COUNT_ALLOCATIONS)
+    detail::AllocationScope allocation_scope(TypeId::FileEntry);
+#endif
+    const LimitScope limit_scope(reader.limits());
     FileEntry result;
-    result.filename_len = reader.read_le<uint8_t>();
+    [[maybe_unused]] size_t hook_start = 0;
+    [[maybe_unused]] size_t hook_mark = 0;
+    if constexpr (Hooks::enabled) {
+        hook_start = hook_mark = reader.position();
+        Hooks::on_enter(TypeId::FileEntry, hook_start);
+    }
+    const HookFrame hook_frame(TypeId::FileEntry);
+    reader.validate_ahead(1);
+    result.filename_len = reader.template read_le<uint8_t>();
+    if constexpr (Hooks::enabled) {
+        Hooks::on_field(FieldId::FileEntry_filename_len, reader.position() - hook_mark);
+        hook_mark = reader.position();
+    }
     {
+        reader.admit(result.filename_len, 1, 1);
         std::vector<uint8_t> bytes(result.filename_len);
         for (size_t i = 0; i < result.filename_len; ++i) {
-            bytes[i] = reader.read_le<uint8_t>();
+            bytes[i] = reader.template read_le<uint8_t>();
         }
         result.filename = std::string(reinterpret_cast<const char*>(bytes.data()), bytes.size());
     }
-    result.file_size = reader.read_le<uint32_t>();
+    if constexpr (Hooks::enabled) {
+        Hooks::on_field(FieldId::FileEntry_filename, reader.position() - hook_mark);
+        hook_mark = reader.position();
+    }
+    reader.validate_ahead(4);
+    result.file_size = reader.template read_le<uint32_t>();
+    if constexpr (Hooks::enabled) {
+        Hooks::on_field(FieldId::FileEntry_file_size, reader.position() - hook_mark);
+        hook_mark = reader.position();
+    }
+    reader.admit(result.file_size, 1, 1);
     result.file_data.resize(result.file_size);
     for (size_t i = 0; i < result.file_size; ++i) {
-        result.file_data[i] = reader.read_le<uint8_t>();
+        result.file_data[i] = reader.template read_le<uint8_t>();
+    }
+    if constexpr (Hooks::enabled) {
+        Hooks::on_field(FieldId::FileEntry_file_data, reader.position() - hook_mark);
+        hook_mark = reader.position();
+    }
+    reader.validate_ahead(2);
+    result.padding_size = reader.template read_le<uint16_t>();
+    if constexpr (Hooks::enabled) {
+        Hooks::on_field(FieldId::FileEntry_padding_size, reader.position() - hook_mark);
+        hook_mark = reader.position();
     }
-    result.padding_size = reader.read_le<uint16_t>();
     reader.skip(result.padding_size);
+    if constexpr (Hooks::enabled) {
+        hook_mark = reader.position();
+    }
+    if constexpr (Hooks::enabled) {
+        Hooks::on_exit(TypeId::FileEntry, reader.position() - hook_start);
+    }
     return result;
 }
 
 inline void FileEntry::write(Writer& writer) const {
-    writer.write_le(filename_len);
+    const auto derived_filename_len = checked_length<uint8_t>(filename.size(), "FileEntry.filename_len");
+    const auto derived_file_size = checked_length<uint32_t>(file_data.size(), "FileEntry.file_size");
+    writer.write_le(derived_filename_len);
     for (size_t i = 0; i < filename.size(); ++i) {
         writer.write_le(static_cast<uint8_t>(filename[i]));
     }
-    writer.write_le(file_size);
-    for (size_t i = 0; i < file_data.size(); ++i) {
-        writer.write_le(file_data[i]);
-    }
+    writer.write_le(derived_file_size);
+    writer.write_bytes(file_data);
     writer.write_le(padding_size);
 }
 
+inline size_t FileEntry::serialized_size(size_t at) const {
+    size_t end = at;
+    end += 1;
+    end += filename.size();
+    end += 4;
+    end += file_data.size();
+    end += 2;
+    return end - at;
+}
+
+#if defined(DEZZY_HEAP_BYTES)
+inline size_t FileEntry::heap_bytes() const {
+    return detail::heap_bytes_of(filename) +
+           detail::heap_bytes_of(file_data);
+}
+#endif
+
+inline void FileEntry::skip(Reader& reader) {
+    struct {
+        uint8_t filename_len;
+        uint32_t file_size;
+        uint16_t padding_size;
+    } result{};
+    result.filename_len = reader.template read_le<uint8_t>();
+    reader.skip(result.filename_len);
+    result.file_size = reader.template read_le<uint32_t>();
+    reader.skip(result.file_size);
+    result.padding_size = reader.template read_le<uint16_t>();
+    reader.skip(result.padding_size);
+}
+
+inline bool FileEntry::validate(Reader& reader) noexcept {
+    FileEntry result{};
+    return validate_into(reader, result);
+}
+
+inline bool FileEntry::validate_into(Reader& reader, FileEntry& result) noexcept {
+    if (reader.remaining() < 1) {
+        return false;
+    }
+    result.filename_len = reader.template read_le<uint8_t>();
+    if (result.filename_len > reader.remaining()) {
+        return false;
+    }
+    reader.skip(result.filename_len);
+    if (reader.remaining() < 4) {
+        return false;
+    }
+    result.file_size = reader.template read_le<uint32_t>();
+    if (result.file_size > reader.remaining()) {
+        return false;
+    }
+    reader.skip(result.file_size);
+    if (reader.remaining() < 2) {
+        return false;
+    }
+    result.padding_size = reader.template read_le<uint16_t>();
+    if (result.padding_size > reader.remaining()) {
+        return false;
+    }
+    reader.skip(result.padding_size);
+    return true;
+}
+
+#if defined(DEZZY_VISITOR)
+template<typename V>
+inline void FileEntry::visit(Reader& reader, V& visitor) {
+    struct {
+        uint8_t filename_len;
+        std::string_view filename;
+        uint32_t file_size;
+        std::span<const uint8_t> file_data;
+        uint16_t padding_size;
+    } result{};
+    result.filename_len = reader.read_le<uint8_t>();
+    visitor.on_u8(FieldId::FileEntry_filename_len, result.filename_len);
+    {
+        const auto bytes = reader.read_bytes(static_cast<size_t>(result.filename_len));
+        result.filename = std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    }
+    visitor.on_string(FieldId::FileEntry_filename, result.filename);
+    result.file_size = reader.read_le<uint32_t>();
+    visitor.on_u32(FieldId::FileEntry_file_size, result.file_size);
+    result.file_data = reader.read_bytes(static_cast<size_t>(result.file_size));
+    visitor.on_bytes(FieldId::FileEntry_file_data, result.file_data);
+    result.padding_size = reader.read_le<uint16_t>();
+    visitor.on_u16(FieldId::FileEntry_padding_size, result.padding_size);
+    reader.skip(result.padding_size);
+}
+#endif
+
+#if defined(DEZZY_ASYNC)
+inline Task<FileEntry> FileEntry::read_async(AsyncReader& in) {
+    FileEntry result;
+    {
+        const size_t run_size = 1;
+        co_await in.require(run_size);
+        Reader reader = in.take(run_size);
+        result.filename_len = reader.template read_le<uint8_t>();
+    }
+    {
+        const size_t run_size = static_cast<size_t>(result.filename_len) + 4;
+        co_await in.require(run_size);
+        Reader reader = in.take(run_size);
+        {
+            reader.admit(result.filename_len, 1, 1);
+            std::vector<uint8_t> bytes(result.filename_len);
+            for (size_t i = 0; i < result.filename_len; ++i) {
+                bytes[i] = reader.template read_le<uint8_t>();
+            }
+            result.filename = std::string(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        }
+        result.file_size = reader.template read_le<uint32_t>();
+    }
+    {
+        const size_t run_size = static_cast<size_t>(result.file_size) + 2;
+        co_await in.require(run_size);
+        Reader reader = in.take(run_size);
+        reader.admit(result.file_size, 1, 1);
+        result.file_data.resize(result.file_size);
+        for (size_t i = 0; i < result.file_size; ++i) {
+            result.file_data[i] = reader.template read_le<uint8_t>();
+        }
+        result.padding_size = reader.template read_le<uint16_t>();
+    }
+    {
+        const size_t run_size = static_cast<size_t>(result.padding_size);
+        co_await in.require(run_size);
+        Reader reader = in.take(run_size);
+        reader.skip(result.padding_size);
+    }
+    co_return result;
+}
+#endif
+
+#if defined(DEZZY_PUSH_PARSER)
+template<>
+class Parser<FileEntry> : public PushParser {
+public:
+    ParseStatus feed(std::span<const uint8_t>& input);
+    ParseStatus finish();
+    const FileEntry& value() const { return result_; }
+    FileEntry take() {
+        FileEntry value = std::move(result_);
+        reset(position_);
+        return value;
+    }
+    void reset(size_t position = 0) {
+        reset_base(position);
+        result_ = {};
+        state_ = 0;
+    }
+
+private:
+    FileEntry result_{};
+    size_t state_ = 0;
+};
+
+inline ParseStatus Parser<FileEntry>::feed(std::span<const uint8_t>& input) {
+    if (failed_) {
+        return ParseStatus::Error;
+    }
+    auto& result = result_;
+    try {
+        for (;;) {
+            switch (state_) {
+            case 0:
+                if (!fill(input, 1)) {
+                    return ParseStatus::NeedMore;
+                }
+                result.filename_len = load_le<uint8_t>();
+                state_ = 1;
+                [[fallthrough]];
+            case 1:
+                pending_ = result.filename_len;
+                reserve_up_to(result.filename, pending_);
+                state_ = 2;
+                [[fallthrough]];
+            case 2:
+                {
+                    auto bytes = consume(input, pending_);
+                    result.filename.append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+                    pending_ -= bytes.size();
+                }
+                if (pending_ != 0) {
+                    return ParseStatus::NeedMore;
+                }
+                state_ = 3;
+                [[fallthrough]];
+            case 3:
+                if (!fill(input, 4)) {
+                    return ParseStatus::NeedMore;
+                }
+                result.file_size = load_le<uint32_t>();
+                state_ = 4;
+                [[fallthrough]];
+            case 4:
+                result.file_data.clear();
+                reserve_up_to(result.file_data, result.file_size);
+                index_ = 0;
+                state_ = 5;
+                [[fallthrough]];
+            case 5:
+                {
+                    auto bytes = consume(input, result.file_size - index_);
+                    result.file_data.insert(result.file_data.end(), bytes.begin(), bytes.end());
+                    index_ += bytes.size();
+                }
+                if (index_ < static_cast<size_t>(result.file_size)) {
+                    return ParseStatus::NeedMore;
+                }
+                state_ = 6;
+                [[fallthrough]];
+            case 6:
+                if (!fill(input, 2)) {
+                    return ParseStatus::NeedMore;
+                }
+                result.padding_size = load_le<uint16_t>();
+                state_ = 7;
+                [[fallthrough]];
+            case 7:
+                pending_ = static_cast<size_t>(result.padding_size);
+                state_ = 8;
+                [[fallthrough]];
+            case 8:
+                pending_ -= consume(input, pending_).size();
+                if (pending_ != 0) {
+                    return ParseStatus::NeedMore;
+                }
+                state_ = 9;
+                [[fallthrough]];
+            case 9:
+            default:
+                return ParseStatus::Done;
+            }
+        }
+    } catch (const ParseError& e) {
+        return fail(e.what());
+    }
+}
+
+inline ParseStatus Parser<FileEntry>::finish() {
+    eof_ = true;
+    std::span<const uint8_t> none;
+    const ParseStatus status = feed(none);
+    return status == ParseStatus::NeedMore ? fail("Unexpected end of data") : status;
+}
+#endif
+
+// Reads and patches the fixed-offset fields of an encoded FileEntry in place
+class FileEntryMutView {
+public:
+    // Bytes from the start of the struct to the end of the last field the view covers
+    static constexpr size_t fixed_size = 1;
+
+    explicit FileEntryMutView(std::span<uint8_t> bytes) : data_(bytes.data()) {
+        if (bytes.size() < fixed_size) {
+            throw ParseError("FileEntryMutView needs " + std::to_string(fixed_size) + " bytes, got " + std::to_string(bytes.size()), ErrorKind::Truncated);
+        }
+    }
+
+    uint8_t filename_len() const {
+        return load_wire<std::endian::little, uint8_t>(data_ + 0);
+    }
+
+private:
+    uint8_t* data_;
+};
+
+#if defined(DEZZY_RANDOM)
+inline FileEntry FileEntry::random(Rng& rng, const SizeProfile& sizes) {
+    FileEntry result{};
+    detail::draw(result.filename_len, rng);
+    result.filename = detail::random_text(rng, detail::length_for(result.filename_len, sizes.strings.draw(rng)));
+    detail::assign(result.filename_len, result.filename.size());
+    detail::draw(result.file_size, rng);
+    result.file_data.resize(detail::length_for(result.file_size, sizes.blobs.draw(rng)));
+    rng.fill(result.file_data.data(), result.file_data.size());
+    detail::assign(result.file_size, result.file_data.size());
+    detail::assign(result.padding_size, 0);
+    (void)rng;
+    (void)sizes;
+    return result;
+}
+#endif
+
 struct Container {
     uint32_t magic;
     uint16_t num_entries;
     std::vector<FileEntry> entries;
 
-    static Container read(Reader& reader);
+    template<typename Cursor>
+    static Container read(BasicReader<Cursor>& reader);
     void write(Writer& writer) const;
+
+    static void skip(Reader& reader);
+
+    // Whether a Container parses at the reader's position, answered without throwing or
+    // allocating for the data it steps over; on success the reader is left after it
+    static bool validate(Reader& reader) noexcept;
+    // validate() that leaves the fixed-width fields it decoded in `result`
+    static bool validate_into(Reader& reader, Container& result) noexcept;
+
+#if defined(DEZZY_VISITOR)
+    template<typename V>
+    static void visit(Reader& reader, V& visitor);
+#endif
+
+#if defined(DEZZY_ASYNC)
+    static Task<Container> read_async(AsyncReader& in);
+#endif
+
+#if defined(DEZZY_RANDOM)
+    // A valid value with random contents and lengths drawn from `sizes`
+    static Container random(Rng& rng, const SizeProfile& sizes = {});
+#endif
+
+    // Leading magic; find_* scan for it and confirm each hit with validate()
+    static constexpr std::array<uint8_t, 4> magic_bytes{{0x52, 0x54, 0x4e, 0x43}};
+    static std::optional<size_t> find_first(std::span<const uint8_t> data, size_t window = SIZE_MAX);
+    static std::optional<size_t> find_last(std::span<const uint8_t> data, size_t window = SIZE_MAX);
+
+#if defined(DEZZY_PASSTHROUGH)
+    // Boundary every `align:` in the encoding divides; copies must land on the same residue
+    static constexpr size_t passthrough_alignment = FileEntry::passthrough_alignment;
+#endif
+
+    // Bytes write() emits when it starts at output offset `at` (only `align:` cares)
+    size_t serialized_size(size_t at = 0) const;
+#if defined(DEZZY_PARALLEL_WRITE)
+    // Same bytes as write(), with arrays of structs encoded on up to `threads` threads
+    void write_parallel(Writer& writer, size_t threads = 0) const;
+#endif
+
+#if defined(DEZZY_HEAP_BYTES)
+    // Heap memory this value owns: capacity of its vectors and strings, nested values included
+    size_t heap_bytes() const;
+#endif
+
+    // Fewest bytes any encoding takes; counts of this struct are checked against it
+    static constexpr size_t min_encoded_size = 6;
 };
 
-inline Container Container::read(Reader& reader) {
+template<typename Cursor>
+inline Container Container::read(BasicReader<Cursor>& reader) {
+#if defined(DEZZY_COUNT_ALLOCATIONS)
+    detail::AllocationScope allocation_scope(TypeId::Container);
+#endif
+    const LimitScope limit_scope(reader.limits());
     Container result;
+    [[maybe_unused]] size_t hook_start = 0;
+    [[maybe_unused]] size_t hook_mark = 0;
+    if constexpr (Hooks::enabled) {
+        hook_start = hook_mark = reader.position();
+        Hooks::on_enter(TypeId::Container, hook_start);
+    }
+    const HookFrame hook_frame(TypeId::Container);
+    reader.validate_ahead(6);
+    result.magic = reader.template read_le<uint32_t>();
+    if (result.magic != 1129206866) {
+        throw ParseError("Field 'magic' must equal 1129206866, got " + std::to_string(result.magic), ErrorKind::Assertion);
+    }
+    if constexpr (Hooks::enabled) {
+        Hooks::on_field(FieldId::Container_magic, reader.position() - hook_mark);
+        hook_mark = reader.position();
+    }
+    result.num_entries = reader.template read_le<uint16_t>();
+    if constexpr (Hooks::enabled) {
+        Hooks::on_field(FieldId::Container_num_entries, reader.position() - hook_mark);
+        hook_mark = reader.position();
+    }
+    reader.admit(result.num_entries, FileEntry::min_encoded_size, sizeof(FileEntry));
+    if (reader.recovery() == nullptr) {
+        result.entries.resize(result.num_entries);
+        for (size_t i = 0; i < result.num_entries; ++i) {
+            result.entries[i] = FileEntry::read(reader);
+        }
+    } else {
+        result.entries.reserve(result.num_entries);
+        for (size_t i = 0; i < result.num_entries; ++i) {
+            if (!detail::read_recovering<FileEntry>(reader, result.entries)) {
+                break;
+            }
+        }
+    }
+    if constexpr (Hooks::enabled) {
+        Hooks::on_field(FieldId::Container_entries, reader.position() - hook_mark);
+        hook_mark = reader.position();
+    }
+    if constexpr (Hooks::enabled) {
+        Hooks::on_exit(TypeId::Container, reader.position() - hook_start);
+    }
+    return result;
+}
+
+inline void Container::write(Writer& writer) const {
+    const auto derived_num_entries = checked_length<uint16_t>(entries.size(), "Container.num_entries");
+    writer.write_le(magic);
+    writer.write_le(derived_num_entries);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        entries[i].write(writer);
+    }
+}
+
+#if defined(DEZZY_PARALLEL_WRITE)
+inline void Container::write_parallel(Writer& writer, size_t threads) const {
+    const auto derived_num_entries = checked_length<uint16_t>(entries.size(), "Container.num_entries");
+    writer.write_le(magic);
+    writer.write_le(derived_num_entries);
+    write_each_parallel(writer, std::span<const FileEntry>(entries), threads);
+}
+
+#endif
+
+inline size_t Container::serialized_size(size_t at) const {
+    size_t end = at;
+    end += 6;
+    for (const auto& element : entries) {
+        end += element.serialized_size(end);
+    }
+    return end - at;
+}
+
+#if defined(DEZZY_HEAP_BYTES)
+inline size_t Container::heap_bytes() const {
+    return detail::heap_bytes_of(entries);
+}
+#endif
+
+inline void Container::skip(Reader& reader) {
+    struct {
+        uint16_t num_entries;
+    } result{};
+    reader.skip(4);
+    result.num_entries = reader.template read_le<uint16_t>();
+    reader.admit(result.num_entries, FileEntry::min_encoded_size, 0);
+    for (size_t i = 0; i < result.num_entries; ++i) {
+        FileEntry::skip(reader);
+    }
+}
+
+inline bool Container::validate(Reader& reader) noexcept {
+    Container result{};
+    return validate_into(reader, result);
+}
+
+inline bool Container::validate_into(Reader& reader, Container& result) noexcept {
+    if (reader.remaining() < 6) {
+        return false;
+    }
+    result.magic = reader.template read_le<uint32_t>();
+    if (result.magic != 1129206866) {
+        return false;
+    }
+    result.num_entries = reader.template read_le<uint16_t>();
+    if (FileEntry::min_encoded_size > 0 ? result.num_entries > reader.remaining() / FileEntry::min_encoded_size : result.num_entries > reader.remaining() + Reader::max_empty_elements) {
+        return false;
+    }
+    for (size_t i = 0; i < result.num_entries; ++i) {
+        if (!FileEntry::validate(reader)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#if defined(DEZZY_VISITOR)
+template<typename V>
+inline void Container::visit(Reader& reader, V& visitor) {
+    struct {
+        uint32_t magic;
+        uint16_t num_entries;
+    } result{};
     result.magic = reader.read_le<uint32_t>();
+    visitor.on_u32(FieldId::Container_magic, result.magic);
     if (result.magic != 1129206866) {
-        throw ParseError("Field 'magic' must equal 1129206866, got " + std::to_string(result.magic));
+        throw ParseError("Field 'magic' must equal 1129206866, got " + std::to_string(result.magic), ErrorKind::Assertion);
     }
     result.num_entries = reader.read_le<uint16_t>();
+    visitor.on_u16(FieldId::Container_num_entries, result.num_entries);
+    reader.admit(static_cast<size_t>(result.num_entries), FileEntry::min_encoded_size, 0);
+    visitor.begin_array(FieldId::Container_entries, static_cast<size_t>(result.num_entries));
+    for (size_t i = 0; i < static_cast<size_t>(result.num_entries); ++i) {
+        visitor.begin_struct(FieldId::Container_entries);
+        FileEntry::visit(reader, visitor);
+        visitor.end_struct(FieldId::Container_entries);
+    }
+    visitor.end_array(FieldId::Container_entries);
+}
+#endif
+
+#if defined(DEZZY_ASYNC)
+inline Task<Container> Container::read_async(AsyncReader& in) {
+    Container result;
+    {
+        const size_t run_size = 4 + 2;
+        co_await in.require(run_size);
+        Reader reader = in.take(run_size);
+        result.magic = reader.template read_le<uint32_t>();
+        if (result.magic != 1129206866) {
+            throw ParseError("Field 'magic' must equal 1129206866, got " + std::to_string(result.magic), ErrorKind::Assertion);
+        }
+        result.num_entries = reader.template read_le<uint16_t>();
+    }
     result.entries.resize(result.num_entries);
     for (size_t i = 0; i < result.num_entries; ++i) {
-        result.entries[i] = FileEntry::read(reader);
+        result.entries[i] = co_await FileEntry::read_async(in);
+    }
+    co_return result;
+}
+#endif
+
+#if defined(DEZZY_PUSH_PARSER)
+template<>
+class Parser<Container> : public PushParser {
+public:
+    ParseStatus feed(std::span<const uint8_t>& input);
+    ParseStatus finish();
+    const Container& value() const { return result_; }
+    Container take() {
+        Container value = std::move(result_);
+        reset(position_);
+        return value;
     }
+    void reset(size_t position = 0) {
+        reset_base(position);
+        result_ = {};
+        state_ = 0;
+    }
+
+private:
+    Container result_{};
+    size_t state_ = 0;
+    Parser<FileEntry> entries_parser_;
+};
+
+inline ParseStatus Parser<Container>::feed(std::span<const uint8_t>& input) {
+    if (failed_) {
+        return ParseStatus::Error;
+    }
+    auto& result = result_;
+    try {
+        for (;;) {
+            switch (state_) {
+            case 0:
+                if (!fill(input, 4)) {
+                    return ParseStatus::NeedMore;
+                }
+                result.magic = load_le<uint32_t>();
+                if (result.magic != 1129206866) {
+                    throw ParseError("Field 'magic' must equal 1129206866, got " + std::to_string(result.magic), ErrorKind::Assertion);
+                }
+                state_ = 1;
+                [[fallthrough]];
+            case 1:
+                if (!fill(input, 2)) {
+                    return ParseStatus::NeedMore;
+                }
+                result.num_entries = load_le<uint16_t>();
+                state_ = 2;
+                [[fallthrough]];
+            case 2:
+                result.entries.clear();
+                reserve_up_to(result.entries, result.num_entries);
+                index_ = 0;
+                entries_parser_.reset(position_);
+                entries_parser_.set_verify_checksums(verify_checksums_);
+                state_ = 3;
+                [[fallthrough]];
+            case 3:
+                while (index_ < static_cast<size_t>(result.num_entries)) {
+                    {
+                        const size_t available = input.size();
+                        ParseStatus status = entries_parser_.feed(input);
+                        position_ += available - input.size();
+                        if (status == ParseStatus::NeedMore) {
+                            if (!eof_) {
+                                return ParseStatus::NeedMore;
+                            }
+                            status = entries_parser_.finish();
+                        }
+                        if (status == ParseStatus::Error) {
+                            return fail(entries_parser_.error());
+                        }
+                    }
+                    result.entries.push_back(entries_parser_.take());
+                    ++index_;
+                }
+                state_ = 4;
+                [[fallthrough]];
+            case 4:
+            default:
+                return ParseStatus::Done;
+            }
+        }
+    } catch (const ParseError& e) {
+        return fail(e.what());
+    }
+}
+
+inline ParseStatus Parser<Container>::finish() {
+    eof_ = true;
+    std::span<const uint8_t> none;
+    const ParseStatus status = feed(none);
+    return status == ParseStatus::NeedMore ? fail("Unexpected end of data") : status;
+}
+#endif
+
+// Reads and patches the fixed-offset fields of an encoded Container in place
+class ContainerMutView {
+public:
+    // Bytes from the start of the struct to the end of the last field the view covers
+    static constexpr size_t fixed_size = 6;
+
+    explicit ContainerMutView(std::span<uint8_t> bytes) : data_(bytes.data()) {
+        if (bytes.size() < fixed_size) {
+            throw ParseError("ContainerMutView needs " + std::to_string(fixed_size) + " bytes, got " + std::to_string(bytes.size()), ErrorKind::Truncated);
+        }
+    }
+
+    uint32_t magic() const {
+        return load_wire<std::endian::little, uint32_t>(data_ + 0);
+    }
+    uint16_t num_entries() const {
+        return load_wire<std::endian::little, uint16_t>(data_ + 4);
+    }
+
+private:
+    uint8_t* data_;
+};
+
+#if defined(DEZZY_RANDOM)
+inline Container Container::random(Rng& rng, const SizeProfile& sizes) {
+    Container result{};
+    detail::assign(result.magic, 1129206866);
+    detail::draw(result.num_entries, rng);
+    result.entries.resize(detail::length_for(result.num_entries, sizes.elements.draw(rng)));
+    for (auto& element : result.entries) {
+        element = FileEntry::random(rng, sizes);
+    }
+    detail::assign(result.num_entries, result.entries.size());
+    (void)rng;
+    (void)sizes;
     return result;
 }
+#endif
 
-inline void Container::write(Writer& writer) const {
-    writer.write_le(magic);
-    writer.write_le(num_entries);
-    for (size_t i = 0; i < num_entries; ++i) {
-        entries[i].write(writer);
+inline std::optional<size_t> Container::find_first(std::span<const uint8_t> data, size_t window) {
+    const auto region = data.first(std::min(window, data.size()));
+    for (size_t pos = detail::find_signature(region, magic_bytes); pos != detail::npos;
+         pos = detail::find_signature(region, magic_bytes, pos + 1)) {
+        Reader reader = Reader(data).at(pos);
+        if (validate(reader)) {
+            return pos;
+        }
+    }
+    return std::nullopt;
+}
+
+inline std::optional<size_t> Container::find_last(std::span<const uint8_t> data, size_t window) {
+    const size_t base = data.size() - std::min(window, data.size());
+    const auto region = data.subspan(base);
+    for (size_t pos = detail::rfind_signature(region, magic_bytes); pos != detail::npos;
+         pos = detail::rfind_signature(region, magic_bytes, pos)) {
+        Reader reader = Reader(data).at(base + pos);
+        if (validate(reader)) {
+            return base + pos;
+        }
     }
+    return std::nullopt;
 }
 
+#if defined(DEZZY_INSTANTIATE_TEMPLATES)
+#define DEZZY_READ_INSTANTIATION template
+#elif defined(DEZZY_EXTERN_TEMPLATES)
+#define DEZZY_READ_INSTANTIATION extern template
+#endif
+#if defined(DEZZY_READ_INSTANTIATION)
+DEZZY_READ_INSTANTIATION FileEntry FileEntry::read(Reader& reader);
+DEZZY_READ_INSTANTIATION FileEntry FileEntry::read(TrustedReader& reader);
+DEZZY_READ_INSTANTIATION Container Container::read(Reader& reader);
+DEZZY_READ_INSTANTIATION Container Container::read(TrustedReader& reader);
+#undef DEZZY_READ_INSTANTIATION
+#endif
 
 } // namespace testcontainer
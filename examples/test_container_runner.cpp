@@ -1,3 +1,4 @@
+#define DEZZY_PARALLEL_WRITE
 #include "test_container.hpp"
 #include <iostream>
 #include <cassert>
@@ -116,6 +117,86 @@ int main() {
     assert(parsed.entries[2].padding_size == 16);
     std::cout << "✓ Entry 3 correct (filename: " << parsed.entries[2].filename << ")" << std::endl;
 
+    // Lengths and counts are derived from the containers on write
+    {
+        Container unsized_container;
+        unsized_container.magic = 0x434E5452;
+        unsized_container.num_entries = 0;
+        for (auto entry : {entry1, entry2}) {
+            entry.filename_len = 0;
+            entry.file_size = 0;
+            unsized_container.entries.push_back(entry);
+        }
+
+        Writer unsized_writer;
+        unsized_container.write(unsized_writer);
+        const std::vector<uint8_t> unsized_data = unsized_writer.finish();
+        std::vector<uint8_t> padded(unsized_data.begin(), unsized_data.begin() + offset_entry1_padding);
+        padded.insert(padded.end(), 3, 0x00);
+        padded.insert(padded.end(), unsized_data.begin() + offset_entry1_padding, unsized_data.end());
+
+        Reader unsized_reader(padded);
+        Container reparsed = Container::read(unsized_reader);
+        assert(reparsed.num_entries == 2);
+        assert(reparsed.entries[0].filename_len == 8 && reparsed.entries[0].file_size == 13);
+        assert(reparsed.entries[1].filename == "data.bin" && reparsed.entries[1].file_size == 5);
+        std::cout << "✓ Lengths and counts filled in by write()" << std::endl;
+    }
+
+    // A length that does not fit its field is a WriteError
+    {
+        FileEntry oversized = entry2;
+        oversized.filename = std::string(256, 'x');
+        Writer oversized_writer;
+        bool threw = false;
+        try {
+            oversized.write(oversized_writer);
+        } catch (const WriteError&) {
+            threw = true;
+        }
+        assert(threw && "256-byte filename does not fit filename_len (u8)");
+        std::cout << "✓ Oversized filename rejected" << std::endl;
+    }
+
+    // write_parallel() splits the entries across threads and matches write() byte for byte
+    {
+        Container large;
+        large.magic = 0x434E5452;
+        for (size_t i = 0; i < 3000; ++i) {
+            FileEntry entry;
+            entry.filename = "file" + std::to_string(i) + ".bin";
+            entry.file_data.assign(100 + (i * 37) % 400, static_cast<uint8_t>(i));
+            entry.padding_size = 0;
+            large.entries.push_back(entry);
+        }
+
+        Writer serial_writer;
+        large.write(serial_writer);
+        const std::vector<uint8_t> serial = serial_writer.finish();
+        assert(large.serialized_size() == serial.size());
+
+        Writer parallel_writer;
+        large.write_parallel(parallel_writer, 8);
+        assert(parallel_writer.finish() == serial);
+
+        // Into caller-owned memory sized up front, e.g. a mapped output file
+        std::vector<uint8_t> target(large.serialized_size());
+        Writer external(target);
+        large.write_parallel(external, 8);
+        assert(external.position() == target.size() && target == serial);
+
+        bool threw = false;
+        try {
+            std::vector<uint8_t> short_target(target.size() - 1);
+            Writer short_writer(short_target);
+            large.write_parallel(short_writer, 8);
+        } catch (const WriteError&) {
+            threw = true;
+        }
+        assert(threw && "Writing past the end of caller-owned memory should throw");
+        std::cout << "✓ Parallel write of " << large.entries.size() << " entries matches write()" << std::endl;
+    }
+
     std::cout << std::endl << "All tests passed!" << std::endl;
 
     return 0;
@@ -0,0 +1,88 @@
+#include "binarylog.hpp"
+#include "bitfieldtest.hpp"
+#include "png.hpp"
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+int main() {
+    // Test 1: TrustedReader parses exactly what Reader parses
+    {
+        std::ifstream file("examples/logo.png", std::ios::binary);
+        const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        png::Reader checked(bytes);
+        png::TrustedReader trusted(bytes);
+        const auto expected = png::PNG::read(checked);
+        const auto image = png::PNG::read(trusted);
+        assert(trusted.position() == checked.position());
+        assert(image.chunks.size() == expected.chunks.size());
+        for (size_t i = 0; i < image.chunks.size(); ++i) {
+            assert(image.chunks[i].data == expected.chunks[i].data);
+            assert(image.chunks[i].crc == expected.chunks[i].crc);
+        }
+        std::cout << "[OK] TrustedReader matches Reader on a " << bytes.size() << "-byte PNG\n";
+    }
+
+    // Test 2: fixed-size runs are still validated once on a trusted cursor
+    {
+        binarylog::LogEntry entry;
+        entry.timestamp = 1;
+        entry.level = 2;
+        entry.message_length = 3;
+        entry.message = {'a', 'b', 'c'};
+        binarylog::Writer writer;
+        entry.write(writer);
+        const auto bytes = writer.finish();
+
+        binarylog::TrustedReader truncated(std::span<const uint8_t>(bytes).first(6));
+        bool threw = false;
+        try {
+            binarylog::LogEntry::read(truncated);
+        } catch (const binarylog::ParseError&) {
+            threw = true;
+        }
+        assert(threw && "Truncated fixed-size run should throw even when trusted");
+
+        binarylog::TrustedReader short_message(std::span<const uint8_t>(bytes).first(bytes.size() - 1));
+        threw = false;
+        try {
+            binarylog::LogEntry::read(short_message);
+        } catch (const binarylog::ParseError&) {
+            threw = true;
+        }
+        assert(threw && "Array counts are checked even when trusted");
+        std::cout << "[OK] Trusted reads validate runs and counts up front\n";
+    }
+
+    // Test 3: each read()/write() has its own bit cursor
+    {
+        bitfieldtest::Flags first{};
+        first.version = 5;
+        first.compressed = 1;
+        first.value = 0x11111111;
+        bitfieldtest::Flags second{};
+        second.version = 2;
+        second.reserved = 7;
+        second.value = 0x22222222;
+
+        bitfieldtest::Writer first_writer;
+        first.write(first_writer);
+        bitfieldtest::Writer second_writer;
+        second.write(second_writer);
+        const auto first_bytes = first_writer.finish();
+        const auto second_bytes = second_writer.finish();
+        assert(first_bytes.size() == 5 && second_bytes.size() == 5);
+
+        bitfieldtest::Reader first_reader(first_bytes);
+        bitfieldtest::TrustedReader second_reader(second_bytes);
+        const auto a = bitfieldtest::Flags::read(first_reader);
+        const auto b = bitfieldtest::Flags::read(second_reader);
+        assert(a.version == 5 && a.compressed == 1 && a.value == 0x11111111);
+        assert(b.version == 2 && b.reserved == 7 && b.value == 0x22222222);
+        std::cout << "[OK] Bitfields round-trip through separate readers and writers\n";
+    }
+
+    std::cout << "\nAll tests passed!\n";
+    return 0;
+}
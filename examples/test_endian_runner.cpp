@@ -0,0 +1,105 @@
+#include "firmwareimage.hpp"
+#include "png.hpp"
+#include <cassert>
+#include <iostream>
+
+template<typename View>
+concept CanSetSectionCount = requires(View view) { view.set_section_count(uint16_t{3}); };
+
+template<typename View>
+concept CanSetMagic = requires(View view) { view.set_magic(uint32_t{0}); };
+
+template<typename View>
+concept CanSetChunkType = requires(View view) { view.set_chunk_type(std::array<uint8_t, 4>{}); };
+
+template<typename View>
+concept ViewsChecksums = requires(View view) { view.checksums(); };
+
+int main() {
+    using namespace firmwareimage;
+
+    // Hand-packed image: big-endian vendor fields inside a little-endian header
+    const std::vector<uint8_t> bytes = {
+        0x46, 0x57, 0x4D, 0x47,                         // magic (BE) "FWMG"
+        0x03, 0x00,                                     // version (LE) 3
+        0x00, 0xF3,                                     // arch (BE) RISCV
+        0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, // entry_point (LE) 0x80001000
+        0x00, 0x02,                                     // section_count (BE) 2
+        0xDE, 0xAD, 0xBE, 0xEF, 0x01, 0x02, 0x03, 0x04, // checksums (BE)
+        0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x01, 0x00, // sections[0]: load_address (LE), size (BE) 256
+        0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0x20, 0x00, // sections[1]
+    };
+
+    // Test 1: each field is decoded in its own byte order
+    {
+        Reader reader(bytes);
+        const auto header = ImageHeader::read(reader);
+        assert(header.magic == 0x46574D47);
+        assert(header.version == 3);
+        assert(header.arch == Arch::RISCV);
+        assert(header.entry_point == 0x80001000);
+        assert(header.section_count == 2);
+        assert(header.checksums[0] == 0xDEADBEEF && header.checksums[1] == 0x01020304);
+        assert(header.sections[0].load_address == 0x80000000 && header.sections[0].size == 0x100);
+        assert(header.sections[1].load_address == 0x80001000 && header.sections[1].size == 0x2000);
+        assert(reader.remaining() == 0);
+        std::cout << "[OK] Mixed-endian header decodes\n";
+    }
+
+    // Test 2: write() reproduces the original bytes
+    {
+        Reader reader(bytes);
+        const auto header = ImageHeader::read(reader);
+        Writer writer;
+        header.write(writer);
+        assert(writer.finish() == bytes);
+        std::cout << "[OK] Round trip is byte-identical\n";
+    }
+
+    // Test 3: the big-endian magic is the search signature
+    {
+        std::vector<uint8_t> padded(37, 0xFF);
+        padded.insert(padded.end(), bytes.begin(), bytes.end());
+        assert(ImageHeader::magic_bytes[0] == 'F' && ImageHeader::magic_bytes[3] == 'G');
+        const auto offset = ImageHeader::find_first(padded);
+        assert(offset && *offset == 37);
+        std::cout << "[OK] find_first() locates the header at offset " << *offset << "\n";
+    }
+
+    // Test 4: a mutable view patches fixed-offset fields in their own byte order
+    {
+        std::vector<uint8_t> patched = bytes;
+        ImageHeaderMutView view(patched);
+        assert(view.arch() == Arch::RISCV && view.entry_point() == 0x80001000);
+        view.set_arch(Arch::ARM);
+        view.set_entry_point(0x0000000100002000);
+        assert(patched[6] == 0x00 && patched[7] == 0x28);
+        assert(patched[8] == 0x00 && patched[9] == 0x20 && patched[12] == 0x01);
+
+        Reader reader(patched);
+        const auto header = ImageHeader::read(reader);
+        assert(header.arch == Arch::ARM && header.entry_point == 0x0000000100002000);
+        assert(std::equal(patched.begin() + 16, patched.end(), bytes.begin() + 16));
+
+        // Counts are read-only, and fields after variable-length data are not in the view
+        static_assert(ImageHeaderMutView::fixed_size == 18);
+        static_assert(!CanSetSectionCount<ImageHeaderMutView>);
+        static_assert(!ViewsChecksums<ImageHeaderMutView>);
+
+        // Stores that would break an assertion or a checksum are not offered either
+        static_assert(!CanSetMagic<ImageHeaderMutView>);
+        static_assert(!CanSetChunkType<png::ChunkMutView>);
+
+        bool threw = false;
+        try {
+            ImageHeaderMutView short_view(std::span<uint8_t>(patched).first(17));
+        } catch (const ParseError&) {
+            threw = true;
+        }
+        assert(threw && "View over a truncated header should throw");
+        std::cout << "[OK] Mutable view patches fields in place\n";
+    }
+
+    std::cout << "\nAll tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,308 @@
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Records every hook call as text; `auto` ids work for any format
+struct RecordingHooks {
+    static constexpr bool enabled = true;
+    static inline std::vector<std::string> events;
+    static void on_enter(auto type, size_t offset) {
+        events.push_back("enter " + std::string(type_name(type)) + " @" + std::to_string(offset));
+    }
+    static void on_exit(auto type, size_t bytes) {
+        events.push_back("exit " + std::string(type_name(type)) + " " + std::to_string(bytes));
+    }
+    static void on_field(auto field, size_t bytes) {
+        events.push_back(std::string(field_name(field)) + " " + std::to_string(bytes));
+    }
+    static void on_error(auto kind) { events.push_back("error " + std::to_string(static_cast<int>(kind))); }
+    static void on_abort(auto type) { events.push_back("abort " + std::string(type_name(type))); }
+};
+
+#define DEZZY_HOOKS ::RecordingHooks
+#include "png.hpp"
+#undef DEZZY_HOOKS
+#define DEZZY_STATS_HOOKS
+#include "container_fixtures.hpp"
+#undef DEZZY_STATS_HOOKS
+#define DEZZY_TRACE_HOOKS
+#include "log_fixtures.hpp"
+#include <cassert>
+#include <iostream>
+#include <thread>
+
+namespace {
+
+std::vector<uint8_t> make_png() {
+    png::PNG image{};
+    image.signature = png::PNG::magic_bytes;
+    for (const char* type : {"IHDR", "IDAT", "IEND"}) {
+        png::Chunk chunk{};
+        std::copy(type, type + 4, chunk.chunk_type.begin());
+        chunk.data.assign(type[1] == 'D' ? 100 : type[1] == 'H' ? 13 : 0, 0x42);
+        image.chunks.push_back(chunk);
+    }
+    png::Writer writer;
+    image.write(writer);
+    return writer.finish();
+}
+
+// Entries named file0, file1, ... holding 0, 10, 20, ... bytes
+std::vector<uint8_t> make_container(size_t entries) {
+    return fixtures::make_container(
+        entries, [](size_t i) { return "file" + std::to_string(i); }, [](size_t i) { return 10 * i; });
+}
+
+// `entries` log entries with messages of 0, 1, 2, ... bytes
+std::vector<uint8_t> make_log(size_t entries) {
+    return fixtures::make_log(entries, [](size_t i) { return std::vector<uint8_t>(i, 'x'); });
+}
+
+} // namespace
+
+int main() {
+    // Test 1: enter/exit nest around each struct, and field bytes add up to the struct's
+    {
+        const auto bytes = make_png();
+        png::Reader reader(bytes);
+        png::PNG::read(reader);
+        const auto& events = RecordingHooks::events;
+        assert(events.front() == "enter PNG @0" && events[1] == "PNG.signature 8");
+        assert(events[2] == "enter Chunk @8" && events[3] == "Chunk.length 4" && events[4] == "Chunk.chunk_type 4");
+        assert(events[5] == "Chunk.data 13" && events[6] == "Chunk.crc 4" && events[7] == "exit Chunk 25");
+        assert(events[8] == "enter Chunk @33");
+        assert(events[events.size() - 2] == "PNG.chunks " + std::to_string(bytes.size() - 8));
+        assert(events.back() == "exit PNG " + std::to_string(bytes.size()));
+        std::cout << "[OK] Hooks see structs, fields and their sizes in order\n";
+    }
+
+    // Test 2: errors are reported with their kind, then each struct the exception leaves aborts
+    {
+        auto bytes = make_png();
+        bytes[8 + 8 + 13] ^= 0xFF;  // IHDR CRC
+        RecordingHooks::events.clear();
+        try {
+            png::Reader reader(bytes);
+            png::PNG::read(reader);
+            assert(false);
+        } catch (const png::ParseError& e) {
+            assert(e.kind() == png::ErrorKind::Checksum);
+            const auto& events = RecordingHooks::events;
+            assert(events.size() >= 3 && events[events.size() - 3] == "error 2");
+            assert(events[events.size() - 2] == "abort Chunk" && events.back() == "abort PNG");
+        }
+
+        bytes.resize(30);
+        try {
+            png::Reader reader(bytes);
+            png::PNG::read(reader);
+            assert(false);
+        } catch (const png::ParseError& e) {
+            assert(e.kind() == png::ErrorKind::Truncated);
+        }
+
+        // validate() turns both down without raising an error
+        RecordingHooks::events.clear();
+        png::Reader truncated(bytes);
+        assert(!png::PNG::validate(truncated));
+        bytes = make_png();
+        bytes[8 + 8 + 13] ^= 0xFF;
+        png::Reader corrupt(bytes);
+        assert(!png::PNG::validate(corrupt));
+        assert(RecordingHooks::events.empty());
+        bytes[8 + 8 + 13] ^= 0xFF;
+        png::Reader intact(bytes);
+        assert(png::PNG::validate(intact) && intact.remaining() == 0);
+        std::cout << "[OK] Errors carry their kind\n";
+    }
+
+    // Test 3: StatsHooks adds up counters from every thread, including finished ones
+    {
+        using testcontainer::StatsHooks;
+        const auto bytes = make_container(10);
+        auto parse = [&](size_t times) {
+            for (size_t i = 0; i < times; ++i) {
+                testcontainer::Reader reader(bytes);
+                testcontainer::Container::read(reader);
+            }
+        };
+        parse(5);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back(parse, 25);
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        const auto stats = StatsHooks::snapshot();
+        const auto& container = stats.types[static_cast<size_t>(testcontainer::TypeId::Container)];
+        const auto& entry = stats.types[static_cast<size_t>(testcontainer::TypeId::FileEntry)];
+        assert(container.reads == 105 && container.bytes == 105 * bytes.size());
+        assert(entry.reads == 1050);
+        uint64_t histogram = 0;
+        for (uint64_t count : container.latency) {
+            histogram += count;
+        }
+        assert(histogram == 105);
+        const auto& data = stats.fields[static_cast<size_t>(testcontainer::FieldId::FileEntry_file_data)];
+        assert(data.reads == 1050 && data.bytes == 105 * 450);
+        std::cout << "[OK] StatsHooks counts reads, bytes and latency across threads\n";
+    }
+
+    // Test 4: failed reads count by kind and do not disturb later ones; json() and reset()
+    {
+        using testcontainer::StatsHooks;
+        auto bytes = make_container(3);
+        bytes[0] ^= 0xFF;  // magic
+        try {
+            testcontainer::Reader reader(bytes);
+            testcontainer::Container::read(reader);
+            assert(false);
+        } catch (const testcontainer::ParseError& e) {
+            assert(e.kind() == testcontainer::ErrorKind::Assertion);
+        }
+        bytes[0] ^= 0xFF;
+        testcontainer::Reader reader(bytes);
+        testcontainer::Container::read(reader);
+
+        const auto stats = StatsHooks::snapshot();
+        assert(stats.errors[static_cast<size_t>(testcontainer::ErrorKind::Assertion)] == 1);
+        assert(stats.types[static_cast<size_t>(testcontainer::TypeId::Container)].reads == 106);
+        const std::string json = StatsHooks::json();
+        assert(json.find("{\"name\": \"FileEntry\", \"reads\": 1053,") != std::string::npos);
+        assert(json.find("\"name\": \"FileEntry.filename\"") != std::string::npos);
+        assert(json.find("\"assertion\": 1") != std::string::npos);
+
+        StatsHooks::reset();
+        assert(StatsHooks::snapshot().types[0].reads == 0);
+        std::cout << "[OK] Errors, JSON report and reset\n";
+    }
+
+    // Test 5: TraceHooks records a span per struct with its offset and size
+    {
+        using binarylog::TraceHooks;
+        const auto bytes = make_log(10);
+        binarylog::Reader reader(bytes);
+        binarylog::LogFile::read(reader);
+
+        const auto threads = TraceHooks::spans();
+        assert(threads.size() == 1 && threads[0].size() == 11);
+        const auto& spans = threads[0];
+        size_t offset = 0;
+        for (size_t i = 0; i < 10; ++i) {
+            assert(spans[i].type == binarylog::TypeId::LogEntry && spans[i].error == 0);
+            assert(spans[i].offset == offset && spans[i].bytes == 11 + i);
+            assert(spans[i].start_ns >= spans[10].start_ns);
+            assert(spans[i].start_ns + spans[i].duration_ns <= spans[10].start_ns + spans[10].duration_ns);
+            offset += spans[i].bytes;
+        }
+        assert(spans[10].type == binarylog::TypeId::LogFile && spans[10].bytes == bytes.size());
+
+        const std::string json = TraceHooks::json();
+        assert(json.find("\"traceEvents\": [") != std::string::npos);
+        assert(json.find("{\"name\": \"LogEntry\", \"cat\": \"read\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1,") !=
+               std::string::npos);
+        assert(json.find("\"args\": {\"offset\": 11, \"bytes\": 12}") != std::string::npos);
+        assert(json.find("\"dropped_spans\": 0") != std::string::npos);
+        std::cout << "[OK] TraceHooks records nested spans with offsets and sizes\n";
+    }
+
+    // Test 6: failed reads end their spans with the error
+    {
+        using binarylog::TraceHooks;
+        TraceHooks::reset();
+        auto bytes = make_log(4);
+        bytes.resize(bytes.size() - 1);
+        try {
+            binarylog::Reader reader(bytes);
+            binarylog::LogFile::read(reader);
+            assert(false);
+        } catch (const binarylog::ParseError&) {
+        }
+        const auto spans = TraceHooks::spans()[0];
+        assert(spans.size() == 5);
+        assert(spans[3].type == binarylog::TypeId::LogEntry && spans[3].offset == 11 + 12 + 13);
+        assert(spans[3].error == 1 + static_cast<uint8_t>(binarylog::ErrorKind::Truncated));
+        assert(spans[4].type == binarylog::TypeId::LogFile && spans[4].error == spans[3].error);
+        assert(TraceHooks::json().find("\"error\": \"truncated\"") != std::string::npos);
+        std::cout << "[OK] Failed reads are traced with their error\n";
+    }
+
+    // Test 7: sampling keeps every nth outermost read; full buffers drop and count
+    {
+        using binarylog::TraceHooks;
+        TraceHooks::reset();
+        TraceHooks::set_sampling(4);
+        const auto bytes = make_log(100);
+        auto parse = [&] {
+            binarylog::Reader reader(bytes);
+            while (reader.remaining() > 0) {
+                binarylog::LogEntry::read(reader);
+            }
+        };
+        parse();
+        assert(TraceHooks::spans()[0].size() == 25);
+        assert(TraceHooks::spans()[0][1].bytes == TraceHooks::spans()[0][0].bytes + 4);
+
+        TraceHooks::set_capacity(10);
+        std::thread(parse).join();
+        const auto threads = TraceHooks::spans();
+        assert(threads.size() == 2 && threads[1].size() == 10);
+        assert(TraceHooks::dropped() == 15);
+        assert(TraceHooks::json().find("\"tid\": 2,") != std::string::npos);
+        std::cout << "[OK] Sampling, per-thread buffers and dropped spans\n";
+    }
+
+    // Test 8: an error recovery mode catches ends only the element it was raised in
+    {
+        using testcontainer::StatsHooks;
+        StatsHooks::reset();
+        auto bytes = make_container(5);
+        std::fill_n(bytes.begin() + 6 + 12 + 22 + 6, 4, 0xFF);  // third entry's file_size
+        testcontainer::RecoveryLog log;
+        testcontainer::Reader reader(bytes);
+        reader.set_recovery(&log);
+        const auto container = testcontainer::Container::read(reader);
+        assert(container.entries.size() == 2 && log.errors.size() == 1);
+
+        const auto stats = StatsHooks::snapshot();
+        assert(stats.types[static_cast<size_t>(testcontainer::TypeId::Container)].reads == 1);
+        assert(stats.types[static_cast<size_t>(testcontainer::TypeId::FileEntry)].reads == 2);
+        // The entry's error, and the skip() that could not get past it
+        assert(stats.errors[static_cast<size_t>(testcontainer::ErrorKind::Truncated)] == 2);
+        std::cout << "[OK] StatsHooks keeps counting the reads around a recovered error\n";
+    }
+
+    // Test 9: traced, the recovered element carries the error and the rest stay clean
+    {
+        using binarylog::TraceHooks;
+        TraceHooks::reset();
+        TraceHooks::set_sampling(2);
+        auto bytes = fixtures::make_uniform_log(5);
+        bytes[2 * 19 + 9] = 0xFF;  // third entry's message_length
+        bytes[2 * 19 + 10] = 0xFF;
+        for (int i = 0; i < 4; ++i) {
+            binarylog::RecoveryLog log;
+            binarylog::Reader reader(bytes);
+            reader.set_recovery(&log);
+            assert(binarylog::LogFile::read(reader).entries.size() == 2);
+        }
+
+        // Every other outermost read is traced: two of LogEntry, LogEntry, failed LogEntry, LogFile
+        const auto spans = TraceHooks::spans()[0];
+        assert(spans.size() == 8);
+        for (size_t i = 0; i < spans.size(); i += 4) {
+            assert(spans[i].error == 0 && spans[i + 1].error == 0);
+            assert(spans[i + 2].type == binarylog::TypeId::LogEntry && spans[i + 2].offset == 2 * 19);
+            assert(spans[i + 2].error == 1 + static_cast<uint8_t>(binarylog::ErrorKind::Truncated));
+            assert(spans[i + 3].type == binarylog::TypeId::LogFile && spans[i + 3].error == 0);
+            assert(spans[i + 3].bytes > 2 * 19);
+        }
+        TraceHooks::set_sampling(1);
+        std::cout << "[OK] TraceHooks marks only the recovered element\n";
+    }
+
+    std::cout << "\nAll tests passed!\n";
+    return 0;
+}
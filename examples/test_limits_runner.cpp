@@ -0,0 +1,168 @@
+#define DEZZY_COUNT_ALLOCATIONS
+#define DEZZY_DEFINE_ALLOCATION_COUNTER
+#include "container_fixtures.hpp"
+#include "log_fixtures.hpp"
+#include "png.hpp"
+#include <cassert>
+#include <iostream>
+
+namespace {
+
+std::vector<uint8_t> make_container(size_t entries, size_t data_size) {
+    return fixtures::make_container(
+        entries, [](size_t i) { return "f" + std::to_string(i); }, [&](size_t) { return data_size; });
+}
+
+template<typename Error, typename F>
+Error expect_error(F&& parse) {
+    try {
+        parse();
+    } catch (const Error& e) {
+        return e;
+    }
+    assert(false && "expected a ParseError");
+    return Error("unreachable");
+}
+
+} // namespace
+
+int main() {
+    // Test 1: hostile counts fail against the remaining input before anything is allocated
+    {
+        // 65535 entries of at least 7 bytes each, in 16 bytes
+        std::vector<uint8_t> bytes = {0x52, 0x54, 0x4E, 0x43, 0xFF, 0xFF, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+        const auto error = expect_error<testcontainer::ParseError>([&] {
+            testcontainer::Reader reader(bytes);
+            testcontainer::Container::read(reader);
+        });
+        assert(error.kind() == testcontainer::ErrorKind::Truncated);
+        assert(testcontainer::last_read_footprint().allocated_bytes < 1024);
+        static_assert(testcontainer::FileEntry::min_encoded_size == 7);
+        static_assert(testcontainer::Container::min_encoded_size == 6);
+
+        // A FileEntry claiming 4 GiB of data
+        std::vector<uint8_t> entry = {1, 'x', 0xFF, 0xFF, 0xFF, 0xFF, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+        expect_error<testcontainer::ParseError>([&] {
+            testcontainer::Reader reader(entry);
+            testcontainer::FileEntry::read(reader);
+        });
+        assert(testcontainer::last_read_footprint().allocated_bytes < 1024);
+        std::cout << "[OK] Impossible counts fail before allocating\n";
+    }
+
+    // Test 2: element and allocation bounds, counted over the whole parse
+    {
+        const auto log = fixtures::make_uniform_log(100);
+        binarylog::ParseLimits limits;
+        limits.max_elements = 50;
+        const auto error = expect_error<binarylog::ParseError>([&] {
+            binarylog::Reader reader(log);
+            reader.set_limits(&limits);
+            binarylog::LogFile::read(reader);
+        });
+        assert(error.kind() == binarylog::ErrorKind::Limit);
+        assert(limits.depth == 0);
+
+        const auto container = make_container(10, 1000);
+        testcontainer::ParseLimits budget;
+        budget.max_allocation = 10 * 1000 + 10 * sizeof(testcontainer::FileEntry) + 20;
+        {
+            testcontainer::Reader reader(container);
+            reader.set_limits(&budget);
+            testcontainer::Container::read(reader);
+            assert(budget.allocated <= budget.max_allocation);
+        }
+        budget.reset();
+        budget.max_allocation = 5000;
+        const auto over = expect_error<testcontainer::ParseError>([&] {
+            testcontainer::Reader reader(container);
+            reader.set_limits(&budget);
+            testcontainer::Container::read(reader);
+        });
+        assert(over.kind() == testcontainer::ErrorKind::Limit);
+        assert(std::string(over.what()).find("Allocation limit") != std::string::npos);
+
+        // Copies and at() readers keep the limits
+        budget.reset();
+        budget.max_elements = 999;
+        testcontainer::Reader outer(container);
+        outer.set_limits(&budget);
+        expect_error<testcontainer::ParseError>([&] {
+            testcontainer::Reader reader = outer.at(6);
+            testcontainer::FileEntry::read(reader);
+        });
+        std::cout << "[OK] Element and allocation limits\n";
+    }
+
+    // Test 3: nesting depth, cancellation and deadlines
+    {
+        png::PNG image{};
+        image.signature = png::PNG::magic_bytes;
+        image.chunks.resize(2);
+        image.chunks[1].chunk_type = {{'I', 'E', 'N', 'D'}};
+        png::Writer writer;
+        image.write(writer);
+        const auto bytes = writer.finish();
+
+        png::ParseLimits limits;
+        limits.max_depth = 1;
+        auto parse = [&] {
+            png::Reader reader(bytes);
+            reader.set_limits(&limits);
+            return png::PNG::read(reader);
+        };
+        assert(expect_error<png::ParseError>(parse).kind() == png::ErrorKind::Limit);
+        limits.reset();
+        limits.max_depth = 2;
+        assert(parse().chunks.size() == 2);
+
+        std::atomic<bool> cancel{true};
+        limits.reset();
+        limits.cancel = &cancel;
+        assert(std::string(expect_error<png::ParseError>(parse).what()) == "Parse cancelled");
+        cancel = false;
+        parse();
+
+        limits.reset();
+        limits.deadline = std::chrono::steady_clock::now() - std::chrono::seconds(1);
+        assert(std::string(expect_error<png::ParseError>(parse).what()) == "Parse deadline passed");
+        limits.deadline = std::chrono::steady_clock::now() + std::chrono::hours(1);
+        parse();
+        std::cout << "[OK] Depth, cancellation and deadline\n";
+    }
+
+    // Test 4: trusted readers honour limits too; without limits nothing changes
+    {
+        const auto log = fixtures::make_uniform_log(10);
+        binarylog::ParseLimits limits;
+        limits.max_allocation = 9 * sizeof(binarylog::LogEntry);
+        expect_error<binarylog::ParseError>([&] {
+            binarylog::TrustedReader reader(log);
+            reader.set_limits(&limits);
+            binarylog::LogFile::read(reader);
+        });
+        binarylog::TrustedReader reader(log);
+        assert(reader.limits() == nullptr);
+        assert(binarylog::LogFile::read(reader).entries.size() == 10);
+        std::cout << "[OK] Trusted readers and the default\n";
+    }
+
+    // Test 5: counts of elements that may encode to nothing are capped as well
+    {
+        const std::vector<uint8_t> bytes(16);
+        binarylog::Reader reader(bytes);
+        reader.admit(16 + binarylog::Reader::max_empty_elements, 0, 1);
+        const auto empty = expect_error<binarylog::ParseError>([&] {
+            reader.admit(uint64_t{1} << 40, 0, 1);
+        });
+        assert(empty.kind() == binarylog::ErrorKind::Limit);
+        const auto sized = expect_error<binarylog::ParseError>([&] {
+            reader.admit(5, 4, 0);
+        });
+        assert(sized.kind() == binarylog::ErrorKind::Truncated);
+        std::cout << "[OK] Possibly empty elements are capped\n";
+    }
+
+    std::cout << "\nAll tests passed!\n";
+    return 0;
+}
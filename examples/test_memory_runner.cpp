@@ -0,0 +1,100 @@
+#define DEZZY_HEAP_BYTES
+#define DEZZY_COUNT_ALLOCATIONS
+#define DEZZY_DEFINE_ALLOCATION_COUNTER
+#include "png.hpp"
+#include "container_fixtures.hpp"
+#include <cassert>
+#include <iostream>
+
+namespace {
+
+// Even entries have a short name, odd ones a name too long for the small-string buffer
+std::vector<uint8_t> make_container(size_t entries) {
+    return fixtures::make_container(
+        entries,
+        [](size_t i) {
+            return i % 2 == 0 ? std::string("short")
+                              : "a file name too long for any small-string buffer " + std::to_string(i);
+        },
+        [](size_t i) { return 100 * (i + 1); });
+}
+
+} // namespace
+
+int main() {
+    // Test 1: heap_bytes() adds up vector and string capacity, nested structs included
+    {
+        const auto bytes = make_container(6);
+        testcontainer::Reader reader(bytes);
+        auto container = testcontainer::Container::read(reader);
+
+        size_t expected = container.entries.capacity() * sizeof(testcontainer::FileEntry);
+        for (const auto& entry : container.entries) {
+            assert(entry.heap_bytes() ==
+                   entry.file_data.capacity() + (entry.filename == "short" ? 0 : entry.filename.capacity() + 1));
+            expected += entry.heap_bytes();
+        }
+        assert(container.heap_bytes() == expected);
+        assert(expected >= 6 * sizeof(testcontainer::FileEntry) + 2100);
+
+        container.entries.reserve(100);
+        assert(container.heap_bytes() == expected + 94 * sizeof(testcontainer::FileEntry));
+
+        png::PNG image{};
+        assert(image.heap_bytes() == 0);
+        std::cout << "[OK] heap_bytes() reports owned capacity\n";
+    }
+
+    // Test 2: the outermost read() records what it allocated, nested reads included
+    {
+        const auto bytes = make_container(10);
+        testcontainer::Reader reader(bytes);
+        const auto container = testcontainer::Container::read(reader);
+        const auto& footprint = testcontainer::last_read_footprint();
+        assert(footprint.type == testcontainer::TypeId::Container);
+        assert(!footprint.failed);
+        // The entries vector, ten data vectors and five long names
+        assert(footprint.allocations >= 16);
+        assert(footprint.allocated_bytes >= container.heap_bytes());
+
+        testcontainer::Reader entry_reader(bytes);
+        entry_reader.skip(6);
+        testcontainer::FileEntry::read(entry_reader);
+        assert(footprint.type == testcontainer::TypeId::FileEntry);
+        assert(footprint.allocations >= 1 && footprint.allocated_bytes >= 100);
+        assert(footprint.allocated_bytes < container.heap_bytes());
+        std::cout << "[OK] Reads record their allocations\n";
+    }
+
+    // Test 3: reads that throw still record what they allocated; formats share the counter
+    {
+        auto bytes = make_container(10);
+        bytes.resize(bytes.size() / 2);
+        try {
+            testcontainer::Reader reader(bytes);
+            testcontainer::Container::read(reader);
+            assert(false);
+        } catch (const testcontainer::ParseError&) {
+        }
+        const auto& footprint = testcontainer::last_read_footprint();
+        assert(footprint.failed && footprint.allocations > 0);
+
+        png::PNG image{};
+        image.signature = png::PNG::magic_bytes;
+        image.chunks.resize(3);
+        image.chunks[0].data.assign(5000, 1);
+        image.chunks[2].chunk_type = {{'I', 'E', 'N', 'D'}};
+        png::Writer writer;
+        image.write(writer);
+        const auto encoded = writer.finish();
+        png::Reader reader(encoded);
+        png::PNG::read(reader);
+        assert(png::last_read_footprint().type == png::TypeId::PNG);
+        assert(png::last_read_footprint().allocated_bytes >= 5000);
+        assert(testcontainer::last_read_footprint().failed);
+        std::cout << "[OK] Failed reads and several formats\n";
+    }
+
+    std::cout << "\nAll tests passed!\n";
+    return 0;
+}
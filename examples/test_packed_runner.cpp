@@ -1,4 +1,6 @@
+#define DEZZY_PARALLEL_WRITE
 #include "test_packed_format.h"
+#include <cassert>
 #include <iostream>
 #include <vector>
 
@@ -43,6 +45,27 @@ int main() {
         std::cout << "Flags: " << (int)read_header.flags << std::endl;
         std::cout << "Checksum: 0x" << std::hex << read_header.checksum << std::endl;
 
+        // serialized_size() follows align: from wherever the header starts
+        assert(header.serialized_size() == data.size());
+        Writer offset_writer;
+        offset_writer.write_padding(3);
+        header.write(offset_writer);
+        assert(offset_writer.position() - 3 == header.serialized_size(3));
+        assert(header.serialized_size(3) != header.serialized_size(0));
+
+        // Parallel encoding of a run of headers matches writing them one by one
+        const std::vector<PackedHeader> headers(5, header);
+        Writer serial_writer;
+        serial_writer.write_padding(3);
+        for (const auto& h : headers) {
+            h.write(serial_writer);
+        }
+        Writer parallel_writer;
+        parallel_writer.write_padding(3);
+        write_each_parallel(parallel_writer, std::span<const PackedHeader>(headers), 4);
+        assert(parallel_writer.finish() == serial_writer.finish());
+        std::cout << "serialized_size() and write_each_parallel() agree with write()" << std::endl;
+
         std::cout << "\nTest passed!" << std::endl;
     } catch (const ParseError& e) {
         std::cerr << "Parse error: " << e.what() << std::endl;
@@ -0,0 +1,115 @@
+#define DEZZY_PASSTHROUGH
+#include "png.hpp"
+#include "test_packed_format.h"
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+int main() {
+    using namespace png;
+
+    std::ifstream file("examples/logo.png", std::ios::binary);
+    const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    // Test 1: an unedited image is copied back verbatim
+    {
+        Reader reader(bytes);
+        const auto image = Passthrough<PNG>::read(reader);
+        assert(image.pristine() && image->chunks.size() > 2);
+        assert(image.source().data() == bytes.data());
+        assert(image.source().size() == reader.position());
+        assert(image.serialized_size() == reader.position());
+        Writer writer;
+        image.write(writer);
+        assert(writer.finish() == std::vector<uint8_t>(bytes.begin(), bytes.begin() + reader.position()));
+        std::cout << "[OK] Pristine image written as its source bytes\n";
+    }
+
+    // Test 2: records read one by one; only the edited chunk is re-encoded (length and CRC included)
+    {
+        Reader reader(bytes);
+        const auto signature = reader.read_bytes(8);
+        std::vector<Passthrough<Chunk>> chunks;
+        while (chunks.empty() || chunks.back()->chunk_type != std::array<uint8_t, 4>{{'I', 'E', 'N', 'D'}}) {
+            chunks.push_back(Passthrough<Chunk>::read(reader));
+        }
+        const size_t edited = chunks.size() - 2;
+        Chunk& chunk = chunks[edited].edit();
+        chunk.data.push_back(0x42);
+        chunk.length = static_cast<uint32_t>(chunk.data.size());
+        const auto data = chunk.data;
+        assert(!chunks[edited].pristine() && chunks[0].pristine());
+
+        Writer writer;
+        writer.write_bytes(signature);
+        for (const auto& c : chunks) {
+            c.write(writer);
+        }
+        const auto rewritten = writer.finish();
+        assert(rewritten.size() == reader.position() + 1);
+
+        Reader check(rewritten);
+        const auto reread = PNG::read(check);
+        assert(reread.chunks[edited].length == data.size());
+        assert(reread.chunks[edited].data == data);
+        size_t copied = 8;
+        for (size_t i = 0; i < edited; ++i) {
+            copied += chunks[i].source().size();
+        }
+        assert(std::equal(bytes.begin(), bytes.begin() + copied, rewritten.begin()));
+        std::cout << "[OK] Only the edited chunk is re-encoded\n";
+    }
+
+    // Test 3: edits only go through edit(); values built by hand are always encoded
+    {
+        static_assert(std::is_same_v<decltype(std::declval<Passthrough<PNG>&>().value()), const PNG&>);
+        Passthrough<Chunk> chunk(Chunk{});
+        chunk.edit().chunk_type = {'I', 'E', 'N', 'D'};
+        assert(!chunk.pristine());
+        Writer writer;
+        chunk.write(writer);
+        assert(writer.finish().size() == 12);
+
+        Reader reader(bytes);
+        auto image = Passthrough<PNG>::read(reader);
+        image.edit().signature[0] = 0;
+        assert(!image.pristine());
+        Writer dirty_writer;
+        image.write(dirty_writer);
+        assert(dirty_writer.finish()[0] == 0);
+        std::cout << "[OK] Edited and constructed values are encoded\n";
+    }
+
+    // Test 4: aligned values are copied only where their padding comes out the same
+    {
+        packedformat::PackedHeader header{};
+        header.magic = 0x50414B44;
+        packedformat::Writer source_writer;
+        header.write(source_writer);
+        const auto source = source_writer.finish();
+        packedformat::Reader reader(source);
+        const auto clean = packedformat::Passthrough<packedformat::PackedHeader>::read(reader);
+        assert(clean.pristine() && packedformat::PackedHeader::passthrough_alignment == 8);
+
+        packedformat::Writer shifted;
+        shifted.write_padding(1);
+        clean.write(shifted);
+        assert(shifted.position() - 1 == header.serialized_size(1));
+        assert(clean.serialized_size(1) == header.serialized_size(1));
+        assert(clean.serialized_size(1) != source.size());
+
+        packedformat::Writer aligned;
+        aligned.write_padding(8);
+        clean.write(aligned);
+        const auto copied = aligned.finish();
+        assert(std::equal(source.begin(), source.end(), copied.begin() + 8, copied.end()));
+        assert(clean.serialized_size(8) == source.size());
+        std::cout << "[OK] Aligned values are re-encoded at a different alignment\n";
+    }
+
+    std::cout << "\nAll tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include "pcap.hpp"
+#include <cassert>
+#include <iostream>
+
+namespace {
+
+// Appends value in the given byte order
+void put(std::vector<uint8_t>& out, uint64_t value, size_t size, bool big) {
+    for (size_t i = 0; i < size; ++i) {
+        const size_t shift = big ? (size - 1 - i) * 8 : i * 8;
+        out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+// A capture with two packets, as written by a host of the given byte order
+std::vector<uint8_t> capture(bool big) {
+    std::vector<uint8_t> bytes;
+    put(bytes, 0xA1B2C3D4, 4, big);
+    put(bytes, 2, 2, big);
+    put(bytes, 4, 2, big);
+    put(bytes, static_cast<uint32_t>(-3600), 4, big);
+    put(bytes, 0, 4, big);
+    put(bytes, 65535, 4, big);
+    put(bytes, 1, 4, big);
+    for (uint32_t length : {3u, 5u}) {
+        put(bytes, 1700000000 + length, 4, big);
+        put(bytes, 250000, 4, big);
+        put(bytes, length, 4, big);
+        put(bytes, 1500, 4, big);
+        for (uint32_t i = 0; i < length; ++i) {
+            bytes.push_back(static_cast<uint8_t>(0x10 + i));
+        }
+    }
+    return bytes;
+}
+
+void check(const pcap::CaptureFile& file) {
+    assert(file.header.version_major == 2 && file.header.version_minor == 4);
+    assert(file.header.thiszone == -3600);
+    assert(file.header.snaplen == 65535 && file.header.network == 1);
+    assert(file.packets.size() == 2);
+    assert(file.packets[0].ts_sec == 1700000003 && file.packets[0].ts_usec == 250000);
+    assert(file.packets[0].incl_len == 3 && file.packets[0].orig_len == 1500);
+    assert(file.packets[1].incl_len == 5);
+    assert((file.packets[1].data == std::vector<uint8_t>{0x10, 0x11, 0x12, 0x13, 0x14}));
+}
+
+} // namespace
+
+int main() {
+    using namespace pcap;
+
+    // Test 1: the magic number picks the byte order
+    {
+        const auto little = capture(false);
+        const auto big = capture(true);
+        Reader little_reader(little);
+        Reader big_reader(big);
+        assert(GlobalHeader::byte_order(little_reader) == std::endian::little);
+        assert(CaptureFile::byte_order(big_reader) == std::endian::big);
+        assert(little_reader.position() == 0 && big_reader.position() == 0);
+        std::cout << "[OK] byte_order() probes without consuming input\n";
+    }
+
+    // Test 2: both byte orders decode to the same values
+    for (bool big : {false, true}) {
+        const auto bytes = capture(big);
+        Reader reader(bytes);
+        const auto file = CaptureFile::read(reader);
+        check(file);
+        assert(file.byte_order() == (big ? std::endian::big : std::endian::little));
+        assert(reader.remaining() == 0);
+
+        TrustedReader trusted(bytes);
+        check(CaptureFile::read(trusted));
+        std::cout << "[OK] " << (big ? "Big" : "Little") << "-endian capture decodes\n";
+    }
+
+    // Test 3: write() keeps the byte order the capture was read in
+    for (bool big : {false, true}) {
+        const auto bytes = capture(big);
+        Reader reader(bytes);
+        const auto file = CaptureFile::read(reader);
+        Writer writer;
+        file.write(writer);
+        assert(writer.finish() == bytes);
+        std::cout << "[OK] " << (big ? "Big" : "Little") << "-endian round trip is byte-identical\n";
+    }
+
+    // Test 4: a record read on its own is little-endian; read_in<> picks the order explicitly
+    {
+        std::vector<uint8_t> record;
+        put(record, 1, 4, true);
+        put(record, 2, 4, true);
+        put(record, 0, 4, true);
+        put(record, 60, 4, true);
+        Reader big_reader(record);
+        const auto packet = PacketRecord::read_in<std::endian::big>(big_reader);
+        assert(packet.ts_sec == 1 && packet.ts_usec == 2 && packet.orig_len == 60);
+        Reader little_reader(record);
+        assert(PacketRecord::read(little_reader).ts_sec == 0x01000000);
+        std::cout << "[OK] Nested structs default to little-endian\n";
+    }
+
+    std::cout << "\nAll tests passed!\n";
+    return 0;
+}
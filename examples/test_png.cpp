@@ -24,7 +24,7 @@ int main() {
     ihdr.data[4] = 0; ihdr.data[5] = 0; ihdr.data[6] = 0; ihdr.data[7] = 1;
     ihdr.data[8] = 8; ihdr.data[9] = 2; ihdr.data[10] = 0;
     ihdr.data[11] = 0; ihdr.data[12] = 0;
-    ihdr.crc = 0;  // Simplified
+    ihdr.crc = 0;  // Filled in by write()
 
     // Create IEND chunk
     Chunk iend;
@@ -68,10 +68,31 @@ int main() {
            "Last chunk should be IEND");
     assert(parsed_png.chunks[1].length == 0 && "IEND should have no data");
 
+    // CRCs are computed on write and verified on read
+    assert(parsed_png.chunks[1].crc == 0xAE426082 && "IEND CRC mismatch");
+
+    // Corrupting a covered byte must fail verification...
+    auto corrupt = png_bytes;
+    corrupt[8 + 8] ^= 0xFF;  // first IHDR data byte
+    bool rejected = false;
+    try {
+        Reader corrupt_reader(corrupt);
+        PNG::read(corrupt_reader);
+    } catch (const ParseError&) {
+        rejected = true;
+    }
+    assert(rejected && "Corrupted chunk should fail CRC verification");
+
+    // ...unless verification is switched off for this reader
+    Reader lenient_reader(corrupt);
+    lenient_reader.set_verify_checksums(false);
+    PNG::read(lenient_reader);
+
     std::cout << "[OK] PNG signature correct\n";
     std::cout << "[OK] Chunk count correct (until-condition stopped at IEND)\n";
     std::cout << "[OK] IHDR chunk parsed correctly\n";
     std::cout << "[OK] IEND chunk parsed correctly\n";
+    std::cout << "[OK] Chunk CRCs filled on write and verified on read\n";
     std::cout << "\nAll tests passed!\n";
 
     return 0;
@@ -0,0 +1,76 @@
+#include "zip.hpp"
+#include "png.hpp"
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace {
+
+std::vector<uint8_t> read_file(const char* filename) {
+    std::ifstream file(filename, std::ios::binary);
+    return std::vector<uint8_t>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+} // namespace
+
+int main() {
+    // Test 1: the projection agrees with the full header on every selected field
+    {
+        const auto data = read_file("examples/test.zip");
+        const auto eocd_offset = zip::EndOfCentralDirectory::find_last(data, 22 + 65535);
+        assert(eocd_offset && "EOCD should be found");
+        zip::Reader eocd_reader = zip::Reader(data).at(*eocd_offset);
+        const auto eocd = zip::EndOfCentralDirectory::read(eocd_reader);
+        const auto& headers = eocd.central_directory();
+        assert(!headers.empty());
+
+        zip::Reader full = zip::Reader(data).at(eocd.cd_offset);
+        zip::Reader slim = zip::Reader(data).at(eocd.cd_offset);
+        zip::Reader skipped = zip::Reader(data).at(eocd.cd_offset);
+        for (const auto& header : headers) {
+            zip::CentralDirectoryHeader::read(full);
+            const auto entry = zip::CentralDirectoryEntry::read(slim);
+            assert(entry.filename == header.filename);
+            assert(entry.compressed_size == header.compressed_size);
+            assert(entry.local_header_offset == header.local_header_offset);
+            assert(slim.position() == full.position() && "Projection should consume the whole header");
+
+            zip::CentralDirectoryHeader::skip(skipped);
+            assert(skipped.position() == full.position() && "skip() should land where read() does");
+        }
+        std::cout << "[OK] CentralDirectoryEntry matches " << headers.size() << " full headers\n";
+    }
+
+    // Test 2: skip() over a PNG stops after IEND, like read()
+    {
+        const auto data = read_file("examples/logo.png");
+        png::Reader full(data);
+        png::PNG::read(full);
+        png::Reader skipped(data);
+        png::PNG::skip(skipped);
+        assert(skipped.position() == full.position());
+        std::cout << "[OK] PNG::skip() consumes " << skipped.position() << " bytes\n";
+    }
+
+    // Test 3: skipped sizes are still bounds-checked
+    {
+        const auto data = read_file("examples/test.zip");
+        const auto eocd_offset = zip::EndOfCentralDirectory::find_last(data, 22 + 65535);
+        zip::Reader eocd_reader = zip::Reader(data).at(*eocd_offset);
+        const auto eocd = zip::EndOfCentralDirectory::read(eocd_reader);
+        auto truncated = std::span<const uint8_t>(data).first(eocd.cd_offset + 50);
+        zip::Reader reader = zip::Reader(truncated).at(eocd.cd_offset);
+        bool threw = false;
+        try {
+            zip::CentralDirectoryEntry::read(reader);
+        } catch (const zip::ParseError&) {
+            threw = true;
+        }
+        assert(threw && "Truncated header should throw ParseError");
+        std::cout << "[OK] Truncated header throws ParseError\n";
+    }
+
+    std::cout << "\nAll tests passed!\n";
+    return 0;
+}
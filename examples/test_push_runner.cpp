@@ -0,0 +1,160 @@
+#define DEZZY_PUSH_PARSER
+#include "log_fixtures.hpp"
+#include "png.hpp"
+#include <cassert>
+#include <iostream>
+#include <random>
+
+namespace {
+
+// Feeds `data` in fragments whose sizes come from `next_size`, collecting LogEntry frames
+template<typename NextSize>
+std::vector<binarylog::LogEntry> push_entries(std::span<const uint8_t> data, NextSize&& next_size) {
+    binarylog::Parser<binarylog::LogEntry> parser;
+    std::vector<binarylog::LogEntry> entries;
+    while (!data.empty()) {
+        auto fragment = data.first(std::min(next_size(), data.size()));
+        data = data.subspan(fragment.size());
+        while (!fragment.empty()) {
+            auto status = parser.feed(fragment);
+            assert(status != binarylog::ParseStatus::Error && "Valid log must not fail");
+            if (status == binarylog::ParseStatus::Done) {
+                entries.push_back(parser.take());
+            }
+        }
+    }
+    assert(!parser.started() && "No partial frame should be left over");
+    return entries;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(42);
+    const auto log = fixtures::make_random_log(rng, 200);
+
+    binarylog::Reader reader(log);
+    const auto expected = binarylog::LogFile::read(reader);
+
+    // Test 1: one byte at a time, then random fragment sizes
+    {
+        auto entries = push_entries(log, [] { return size_t{1}; });
+        assert(entries.size() == expected.entries.size());
+        for (size_t i = 0; i < entries.size(); ++i) {
+            assert(fixtures::same_entry(entries[i], expected.entries[i]) && "Byte-wise push parse should match read()");
+        }
+        std::cout << "[OK] " << entries.size() << " frames parsed from 1-byte fragments\n";
+
+        for (int round = 0; round < 20; ++round) {
+            entries = push_entries(log, [&] { return size_t{1} + rng() % 97; });
+            assert(entries.size() == expected.entries.size());
+            for (size_t i = 0; i < entries.size(); ++i) {
+                assert(fixtures::same_entry(entries[i], expected.entries[i]) && "Fragmented push parse should match read()");
+            }
+        }
+        std::cout << "[OK] Random fragment sizes match read()\n";
+    }
+
+    // Test 2: until-eof array completes on finish(), truncated frames are reported
+    {
+        binarylog::Parser<binarylog::LogFile> parser;
+        std::span<const uint8_t> data(log);
+        while (!data.empty()) {
+            auto fragment = data.first(std::min<size_t>(1 + rng() % 4000, data.size()));
+            data = data.subspan(fragment.size());
+            assert(parser.feed(fragment) == binarylog::ParseStatus::NeedMore && "LogFile only ends at eof");
+            assert(fragment.empty() && "feed() consumes the whole fragment");
+        }
+        assert(parser.finish() == binarylog::ParseStatus::Done);
+        assert(parser.position() == log.size());
+        assert(parser.value().entries.size() == expected.entries.size());
+        std::cout << "[OK] LogFile completes on finish()\n";
+
+        parser.reset();
+        std::span<const uint8_t> truncated = std::span<const uint8_t>(log).first(log.size() - 3);
+        assert(parser.feed(truncated) == binarylog::ParseStatus::NeedMore);
+        assert(parser.finish() == binarylog::ParseStatus::Error);
+        assert(parser.error() == "Unexpected end of data");
+        std::cout << "[OK] Truncated stream reported on finish()\n";
+    }
+
+    // Test 3: assertions and checksums are checked as fields complete
+    {
+        png::PNG image;
+        image.signature = {137, 80, 78, 71, 13, 10, 26, 10};
+        png::Chunk iend;
+        iend.length = 0;
+        iend.chunk_type = {73, 69, 78, 68};  // 'IEND'
+        iend.crc = 0;
+        image.chunks = {iend};
+        png::Writer writer;
+        image.write(writer);
+        auto bytes = writer.finish();
+
+        // The chunk list ends at IEND, so Done arrives with the last fragment
+        png::Parser<png::PNG> parser;
+        std::span<const uint8_t> input(bytes);
+        auto status = png::ParseStatus::NeedMore;
+        while (!input.empty()) {
+            auto fragment = input.first(std::min<size_t>(3, input.size()));
+            input = input.subspan(fragment.size());
+            status = parser.feed(fragment);
+            assert((status == png::ParseStatus::NeedMore) == !input.empty());
+        }
+        assert(status == png::ParseStatus::Done);
+        assert(parser.value().chunks.size() == 1 && parser.value().chunks[0].crc == 0xAE426082);
+
+        bytes.back() ^= 0xFF;
+        parser.reset();
+        input = bytes;
+        assert(parser.feed(input) == png::ParseStatus::Error);
+        assert(parser.error().find("Checksum mismatch") != std::string::npos);
+
+        parser.reset();
+        parser.set_verify_checksums(false);
+        input = bytes;
+        assert(parser.feed(input) == png::ParseStatus::Done);
+
+        bytes[0] = 0;
+        parser.reset();
+        input = bytes;
+        assert(parser.feed(input) == png::ParseStatus::Error);
+        assert(parser.error().find("signature") != std::string::npos);
+        std::cout << "[OK] Checksum and assertion failures surface as ParseStatus::Error\n";
+    }
+
+    // Test 4: finish() reaches nested parsers, so a nested until-eof array can end
+    {
+        binarylog::Writer writer;
+        writer.write_le(uint16_t{3});
+        writer.write_bytes(log);
+        const auto archive = writer.finish();
+
+        binarylog::Parser<binarylog::LogArchive> parser;
+        std::span<const uint8_t> input(archive);
+        assert(parser.feed(input) == binarylog::ParseStatus::NeedMore);
+        assert(parser.finish() == binarylog::ParseStatus::Done);
+        assert(parser.value().version == 3);
+        assert(parser.value().log.entries.size() == expected.entries.size());
+
+        parser.reset();
+        input = std::span<const uint8_t>(archive).first(archive.size() - 3);
+        assert(parser.feed(input) == binarylog::ParseStatus::NeedMore);
+        assert(parser.finish() == binarylog::ParseStatus::Error);
+        std::cout << "[OK] Nested until-eof arrays complete on finish()\n";
+    }
+
+    // Test 5: a hostile length is not allocated up front; the data is taken as it arrives
+    {
+        const uint8_t header[] = {0xFF, 0xFF, 0xFF, 0xF0, 'I', 'D', 'A', 'T', 1, 2, 3};
+        png::Parser<png::Chunk> parser;
+        std::span<const uint8_t> input(header);
+        assert(parser.feed(input) == png::ParseStatus::NeedMore);
+        assert(parser.value().data.size() == 3 && parser.value().data.capacity() <= 64 * 1024);
+        assert(parser.finish() == png::ParseStatus::Error);
+        std::cout << "[OK] Untrusted counts are not reserved in full\n";
+    }
+
+    std::cout << "\nAll tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,118 @@
+#define DEZZY_RANDOM
+#include "binarylog.hpp"
+#include "png.hpp"
+#include "simpleconditional.hpp"
+#include "testcontainer.hpp"
+#include "testenum.hpp"
+#include "zip.hpp"
+#include <cassert>
+#include <iostream>
+
+namespace {
+
+template<typename Writer, typename T>
+std::vector<uint8_t> encode(const T& value) {
+    Writer writer;
+    value.write(writer);
+    return writer.finish();
+}
+
+// Random values must decode and re-encode to the same bytes
+template<typename Reader, typename Writer, typename T>
+void round_trips(const T& value) {
+    const auto bytes = encode<Writer>(value);
+    Reader reader(bytes);
+    const T decoded = T::read(reader);
+    assert(reader.remaining() == 0);
+    assert(encode<Writer>(decoded) == bytes);
+}
+
+} // namespace
+
+int main() {
+    // Test 1: every type round-trips across many seeds, with default log-normal sizes
+    {
+        for (uint64_t seed = 0; seed < 200; ++seed) {
+            png::Rng png_rng(seed);
+            round_trips<png::Reader, png::Writer>(png::PNG::random(png_rng));
+            zip::Rng zip_rng(seed);
+            round_trips<zip::Reader, zip::Writer>(zip::LocalFileHeader::random(zip_rng));
+            round_trips<zip::Reader, zip::Writer>(zip::CentralDirectoryHeader::random(zip_rng));
+            round_trips<zip::Reader, zip::Writer>(zip::EndOfCentralDirectory::random(zip_rng));
+            testcontainer::Rng container_rng(seed);
+            round_trips<testcontainer::Reader, testcontainer::Writer>(testcontainer::Container::random(container_rng));
+            binarylog::Rng log_rng(seed);
+            round_trips<binarylog::Reader, binarylog::Writer>(binarylog::LogFile::random(log_rng));
+            testenum::Rng enum_rng(seed);
+            round_trips<testenum::Reader, testenum::Writer>(testenum::Message::random(enum_rng));
+        }
+        std::cout << "[OK] Random values of every type round-trip\n";
+    }
+
+    // Test 2: assertions, enums and until: terminators hold
+    {
+        png::Rng png_rng(7);
+        testenum::Rng enum_rng(7);
+        for (int i = 0; i < 100; ++i) {
+            const auto image = png::PNG::random(png_rng);
+            assert(image.signature[0] == 0x89 && image.signature[1] == 'P');
+            assert(!image.chunks.empty() && image.chunks.back().chunk_type[0] == 'I');
+            for (size_t c = 0; c + 1 < image.chunks.size(); ++c) {
+                assert(image.chunks[c].chunk_type != image.chunks.back().chunk_type);
+            }
+            const auto message = testenum::Message::random(enum_rng);
+            assert(static_cast<uint8_t>(message.status) <= 2);
+        }
+        std::cout << "[OK] Assertions, enums and terminators are satisfied\n";
+    }
+
+    // Test 3: if: fields are present exactly when their condition holds, and both ways occur
+    {
+        simpleconditional::Rng rng(3);
+        size_t with_extra = 0;
+        for (int i = 0; i < 1000; ++i) {
+            const auto message = simpleconditional::VersionedMessage::random(rng);
+            assert(message.v1_data.has_value() == (message.version == 1));
+            assert(message.v2_data.has_value() == (message.version == 2));
+            assert(message.extra_info.has_value() == (message.flags > 0));
+            with_extra += message.extra_info.has_value() ? 1 : 0;
+            round_trips<simpleconditional::Reader, simpleconditional::Writer>(message);
+        }
+        assert(with_extra > 900 && with_extra < 1000);
+        std::cout << "[OK] Conditional fields follow their conditions\n";
+    }
+
+    // Test 4: the same seed gives the same value, another seed a different one
+    {
+        testcontainer::Rng a(42);
+        testcontainer::Rng b(42);
+        testcontainer::Rng c(43);
+        const auto first = encode<testcontainer::Writer>(testcontainer::Container::random(a));
+        assert(first == encode<testcontainer::Writer>(testcontainer::Container::random(b)));
+        assert(first != encode<testcontainer::Writer>(testcontainer::Container::random(c)));
+        std::cout << "[OK] Generation is deterministic per seed\n";
+    }
+
+    // Test 5: SizeProfile sets lengths, and count fields cap them
+    {
+        testcontainer::Rng rng(1);
+        const auto container = testcontainer::Container::random(rng, testcontainer::SizeProfile::fixed(300));
+        assert(container.entries.size() == 300);
+        for (const auto& entry : container.entries) {
+            assert(entry.filename.size() == 255);  // filename_len is a u8
+            assert(entry.file_data.size() == 4800 && entry.file_size == 4800);
+        }
+        round_trips<testcontainer::Reader, testcontainer::Writer>(container);
+
+        testcontainer::SizeProfile sizes;
+        sizes.elements = {100, 1.0, 10, 20};
+        for (int i = 0; i < 50; ++i) {
+            const auto clamped = testcontainer::Container::random(rng, sizes);
+            assert(clamped.entries.size() >= 10 && clamped.entries.size() <= 20);
+        }
+        std::cout << "[OK] Size profiles control container lengths\n";
+    }
+
+    std::cout << "\nAll tests passed!\n";
+    return 0;
+}
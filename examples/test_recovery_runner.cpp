@@ -0,0 +1,153 @@
+#include "log_fixtures.hpp"
+#include "pngfile.hpp"
+#include "zip.hpp"
+#include <cassert>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// Chunks of 0, 10, 20, ... data bytes; each is 12 + data bytes long
+std::vector<uint8_t> make_png(size_t chunks) {
+    pngfile::PNGFile file{};
+    for (size_t i = 0; i < chunks; ++i) {
+        pngfile::Chunk chunk{};
+        chunk.chunk_type = {{'t', 'E', 'X', 't'}};
+        chunk.data.assign(10 * i, static_cast<uint8_t>(i));
+        file.chunks.push_back(chunk);
+    }
+    pngfile::Writer writer;
+    file.write(writer);
+    return writer.finish();
+}
+
+size_t chunk_offset(size_t index) {
+    size_t offset = 12;
+    for (size_t i = 0; i < index; ++i) {
+        offset += 12 + 10 * i;
+    }
+    return offset;
+}
+
+// Flips a bit of the CRC that ends chunk `index`
+void corrupt_crc(std::vector<uint8_t>& bytes, size_t index) {
+    bytes[chunk_offset(index + 1) - 1] ^= 0x01;
+}
+
+template<typename Error, typename F>
+Error expect_error(F&& parse) {
+    try {
+        parse();
+    } catch (const Error& e) {
+        return e;
+    }
+    assert(false && "expected a ParseError");
+    return Error("unreachable");
+}
+
+} // namespace
+
+int main() {
+    // Test 1: a bad element is recorded and skipped by its length; the rest of the array is kept
+    {
+        auto bytes = make_png(5);
+        corrupt_crc(bytes, 1);
+        corrupt_crc(bytes, 3);
+
+        const auto strict = expect_error<pngfile::ParseError>([&] {
+            pngfile::Reader reader(bytes);
+            pngfile::PNGFile::read(reader);
+        });
+        assert(strict.kind() == pngfile::ErrorKind::Checksum);
+
+        pngfile::RecoveryLog log;
+        pngfile::Reader reader(bytes);
+        reader.set_recovery(&log);
+        const auto file = pngfile::PNGFile::read(reader);
+        assert(reader.remaining() == 0);
+        assert(file.chunks.size() == 3);
+        assert(file.chunks[0].data.empty() && file.chunks[1].data.size() == 20 && file.chunks[2].data.size() == 40);
+        assert(log.errors.size() == 2);
+        assert(log.errors[0].offset == chunk_offset(1) && log.errors[1].offset == chunk_offset(3));
+        assert(log.errors[0].kind == pngfile::ErrorKind::Checksum);
+        assert(log.errors[0].message == std::string(strict.what()));
+        std::cout << "[OK] Bad elements are skipped by length and recorded\n";
+    }
+
+    // Test 2: where the element's own length cannot be trusted the array ends at the damage
+    {
+        auto bytes = fixtures::make_uniform_log(5);
+        bytes[2 * 19 + 9] = 0xFF;  // third entry's message_length
+        bytes[2 * 19 + 10] = 0xFF;
+
+        binarylog::RecoveryLog log;
+        binarylog::Reader reader(bytes);
+        reader.set_recovery(&log);
+        const auto file = binarylog::LogFile::read(reader);
+        assert(file.entries.size() == 2);
+        assert(file.entries[1].timestamp == 1);
+        assert(log.errors.size() == 1);
+        assert(log.errors[0].offset == 2 * 19 && log.errors[0].kind == binarylog::ErrorKind::Truncated);
+        std::cout << "[OK] Unframeable damage ends the array with what was read\n";
+    }
+
+    // Test 3: max_errors and limit violations still throw
+    {
+        auto bytes = make_png(5);
+        corrupt_crc(bytes, 1);
+        corrupt_crc(bytes, 3);
+        pngfile::RecoveryLog log;
+        log.max_errors = 1;
+        const auto error = expect_error<pngfile::ParseError>([&] {
+            pngfile::Reader reader(bytes);
+            reader.set_recovery(&log);
+            pngfile::PNGFile::read(reader);
+        });
+        assert(error.kind() == pngfile::ErrorKind::Checksum);
+        assert(log.errors.size() == 1 && log.errors[0].offset == chunk_offset(1));
+
+        pngfile::RecoveryLog unbounded;
+        pngfile::ParseLimits limits;
+        limits.max_allocation = 40;
+        const auto limit = expect_error<pngfile::ParseError>([&] {
+            pngfile::Reader reader(bytes);
+            reader.set_recovery(&unbounded);
+            reader.set_limits(&limits);
+            pngfile::PNGFile::read(reader);
+        });
+        assert(limit.kind() == pngfile::ErrorKind::Limit);
+        std::cout << "[OK] Error budget and limits are not recovered from\n";
+    }
+
+    // Test 4: elements with a signature resynchronize on the next one
+    {
+        zip::Writer writer;
+        for (const char* name : {"a.txt", "bb.txt"}) {
+            zip::LocalFileHeader header{};
+            header.signature = 0x04034b50;
+            header.filename.assign(name, name + std::strlen(name));
+            header.filename_length = static_cast<uint16_t>(header.filename.size());
+            header.write(writer);
+            const uint8_t junk[] = {'P', 'K', 0x07, 0x08, 0x00, 0x11, 0x22};
+            writer.write_bytes(junk);
+        }
+        const auto bytes = writer.finish();
+
+        zip::RecoveryLog log;
+        zip::Reader reader(bytes);
+        reader.set_recovery(&log);
+        assert(reader.recovery() == &log && reader.at(0).recovery() == &log);
+        std::vector<zip::LocalFileHeader> headers;
+        while (reader.remaining() > 0 && zip::detail::read_recovering<zip::LocalFileHeader>(reader, headers)) {
+        }
+        assert(headers.size() == 2);
+        assert(headers[1].filename.size() == 6);
+        assert(log.errors.size() == 2);
+        assert(log.errors[0].offset == 35 && log.errors[0].kind == zip::ErrorKind::Assertion);
+        assert(log.errors[1].offset == 35 + 7 + 36 && log.errors[1].kind == zip::ErrorKind::Assertion);
+        std::cout << "[OK] Signed elements resynchronize on the next signature\n";
+    }
+
+    std::cout << "\nAll tests passed!\n";
+    return 0;
+}
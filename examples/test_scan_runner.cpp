@@ -0,0 +1,128 @@
+#define DEZZY_ENABLE_MAPPED_FILE
+#define DEZZY_COUNT_ALLOCATIONS
+#define DEZZY_DEFINE_ALLOCATION_COUNTER
+#include "png.hpp"
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+using namespace png;
+
+// Minimal valid PNG: signature, one data chunk of `payload` bytes, IEND
+std::vector<uint8_t> make_png(std::mt19937& rng, size_t payload) {
+    PNG png;
+    png.signature = {137, 80, 78, 71, 13, 10, 26, 10};
+
+    Chunk data;
+    data.length = static_cast<uint32_t>(payload);
+    data.chunk_type = {73, 68, 65, 84};  // 'IDAT'
+    data.data.resize(payload);
+    for (auto& byte : data.data) {
+        byte = static_cast<uint8_t>(rng());
+    }
+    data.crc = 0;
+
+    Chunk iend;
+    iend.length = 0;
+    iend.chunk_type = {73, 69, 78, 68};  // 'IEND'
+    iend.crc = 0;
+
+    png.chunks = {data, iend};
+
+    Writer writer;
+    png.write(writer);
+    return writer.finish();
+}
+
+int main() {
+    std::mt19937 rng(1234);
+
+    // Random noise with PNGs embedded at random offsets, plus truncated decoys
+    std::vector<uint8_t> image(1 << 20);
+    for (auto& byte : image) {
+        byte = static_cast<uint8_t>(rng());
+    }
+
+    std::vector<ScanHit> expected;
+    size_t offset = 1000;
+    while (offset + 4096 < image.size()) {
+        auto file = make_png(rng, 64 + rng() % 1500);
+        std::copy(file.begin(), file.end(), image.begin() + offset);
+        expected.push_back({offset, file.size()});
+        offset += file.size() + rng() % 20000;
+
+        // Decoy: valid signature, corrupted first chunk
+        auto decoy = make_png(rng, 32);
+        decoy[20] ^= 0xFF;
+        std::copy(decoy.begin(), decoy.end(), image.begin() + offset);
+        offset += decoy.size() + rng() % 20000;
+    }
+
+    // Small chunks so plenty of PNGs (and signatures) straddle a chunk boundary
+    auto scan = [&](std::span<const uint8_t> bytes, size_t threads) {
+        std::vector<ScanHit> hits;
+        scan_all<PNG>(bytes, [&](const ScanHit& hit) { hits.push_back(hit); }, {threads, 4093});
+        return hits;
+    };
+
+    for (size_t threads : {1, 4, 16}) {
+        auto hits = scan(image, threads);
+        assert(hits.size() == expected.size() && "Every embedded PNG should be found exactly once");
+        for (size_t i = 0; i < hits.size(); ++i) {
+            assert(hits[i].offset == expected[i].offset && "Hit offset mismatch");
+            assert(hits[i].length == expected[i].length && "Hit length mismatch");
+        }
+    }
+    std::cout << "[OK] Found " << expected.size() << " embedded PNGs, rejected decoys, with 1/4/16 threads\n";
+
+    // Same scan over a memory-mapped copy of the image
+    const char* path = "test_scan_image.bin";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size()));
+    }
+    {
+        MappedFile mapped(path);
+        auto hits = scan(mapped.bytes(), 4);
+        assert(hits.size() == expected.size() && "Mapped scan should match in-memory scan");
+    }
+    std::remove(path);
+    std::cout << "[OK] Memory-mapped scan matches\n";
+
+    // Signatures followed by a bad CRC or an impossible length: every hit is rejected, and
+    // rejecting them allocates nothing beyond what scanning a buffer without any costs
+    {
+        const auto decoy = [&](bool truncated) {
+            auto bytes = make_png(rng, 100);
+            if (truncated) {
+                bytes[8] = 0x7F;  // first chunk length
+            } else {
+                bytes[8 + 8 + 100] ^= 0xFF;  // first chunk CRC
+            }
+            return bytes;
+        };
+        std::vector<uint8_t> decoys;
+        size_t count = 0;
+        for (size_t i = 0; decoys.size() < (1 << 20); ++i, ++count) {
+            const auto bytes = decoy(i % 2 == 1);
+            decoys.insert(decoys.end(), bytes.begin(), bytes.end());
+        }
+        const std::vector<uint8_t> zeros(decoys.size());
+
+        auto allocations = [&](std::span<const uint8_t> bytes) {
+            const uint64_t before = dezzy_alloc::counter.allocations;
+            size_t hits = 0;
+            scan_all<PNG>(bytes, [&](const ScanHit&) { ++hits; }, {1, bytes.size()});
+            assert(hits == 0);
+            return dezzy_alloc::counter.allocations - before;
+        };
+        const uint64_t baseline = allocations(zeros);
+        assert(allocations(decoys) == baseline);
+        std::cout << "[OK] " << count << " false signature hits rejected without allocating\n";
+    }
+
+    std::cout << "\nAll tests passed!\n";
+    return 0;
+}
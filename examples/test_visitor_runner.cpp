@@ -0,0 +1,138 @@
+#define DEZZY_VISITOR
+#include "log_fixtures.hpp"
+#include "png.hpp"
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+
+// Count heap allocations so the test can prove visit() materializes nothing
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    ++allocations;
+    if (void* p = std::malloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+// Only cares about levels; every other callback is VisitorBase's no-op
+struct LevelHistogram : binarylog::VisitorBase {
+    size_t counts[4] = {};
+    void on_u8(binarylog::FieldId id, uint8_t value) {
+        if (id == binarylog::FieldId::LogEntry_level) {
+            ++counts[value & 3];
+        }
+    }
+};
+
+// Records every event as text, to check ordering
+struct Recorder {
+    std::ostringstream out;
+    void on_u8(png::FieldId id, uint8_t v) { out << png::field_name(id) << "=" << int(v) << "\n"; }
+    void on_u16(png::FieldId id, uint16_t v) { out << png::field_name(id) << "=" << v << "\n"; }
+    void on_u32(png::FieldId id, uint32_t v) { out << png::field_name(id) << "=" << v << "\n"; }
+    void on_u64(png::FieldId id, uint64_t v) { out << png::field_name(id) << "=" << v << "\n"; }
+    void on_i8(png::FieldId, int8_t) {}
+    void on_i16(png::FieldId, int16_t) {}
+    void on_i32(png::FieldId, int32_t) {}
+    void on_i64(png::FieldId, int64_t) {}
+    void on_bits(png::FieldId, int64_t, unsigned) {}
+    void on_bytes(png::FieldId id, std::span<const uint8_t> b) { out << png::field_name(id) << "[" << b.size() << "]\n"; }
+    void on_string(png::FieldId, std::string_view) {}
+    void begin_array(png::FieldId id, size_t) { out << "begin_array " << png::field_name(id) << "\n"; }
+    void end_array(png::FieldId id) { out << "end_array " << png::field_name(id) << "\n"; }
+    void begin_struct(png::FieldId id) { out << "begin_struct " << png::field_name(id) << "\n"; }
+    void end_struct(png::FieldId id) { out << "end_struct " << png::field_name(id) << "\n"; }
+};
+
+} // namespace
+
+int main() {
+    // Test 1: statistics over a whole log without allocating
+    {
+        std::mt19937 rng(5);
+        const auto log = fixtures::make_random_log(rng, 1000, 64);
+        binarylog::Reader reader(log);
+        const auto parsed = binarylog::LogFile::read(reader);
+        size_t expected[4] = {};
+        for (const auto& entry : parsed.entries) {
+            ++expected[entry.level];
+        }
+
+        LevelHistogram histogram;
+        binarylog::Reader visit_reader(log);
+        const size_t before = allocations;
+        binarylog::LogFile::visit(visit_reader, histogram);
+        assert(allocations == before && "visit() must not allocate");
+        assert(visit_reader.remaining() == 0);
+        for (int level = 0; level < 4; ++level) {
+            assert(histogram.counts[level] == expected[level]);
+        }
+        std::cout << "[OK] Level histogram over 1000 entries, zero allocations\n";
+    }
+
+    // Test 2: event order for nested arrays, with the until-condition and checksum
+    {
+        png::PNG image;
+        image.signature = {137, 80, 78, 71, 13, 10, 26, 10};
+        png::Chunk text;
+        text.length = 3;
+        text.chunk_type = {116, 69, 88, 116};  // 'tEXt'
+        text.data = {1, 2, 3};
+        text.crc = 0;
+        png::Chunk iend;
+        iend.length = 0;
+        iend.chunk_type = {73, 69, 78, 68};  // 'IEND'
+        iend.crc = 0;
+        image.chunks = {text, iend};
+        png::Writer writer;
+        image.write(writer);
+        auto bytes = writer.finish();
+
+        Recorder recorder;
+        png::Reader reader(bytes);
+        png::PNG::visit(reader, recorder);
+        const std::string expected =
+            "PNG.signature[8]\n"
+            "begin_array PNG.chunks\n"
+            "begin_struct PNG.chunks\n"
+            "Chunk.length=3\n"
+            "Chunk.chunk_type[4]\n"
+            "Chunk.data[3]\n"
+            "Chunk.crc=" + std::to_string(png::Crc32::compute(std::vector<uint8_t>{116, 69, 88, 116, 1, 2, 3})) + "\n"
+            "end_struct PNG.chunks\n"
+            "begin_struct PNG.chunks\n"
+            "Chunk.length=0\n"
+            "Chunk.chunk_type[4]\n"
+            "Chunk.data[0]\n"
+            "Chunk.crc=2923585666\n"
+            "end_struct PNG.chunks\n"
+            "end_array PNG.chunks\n";
+        assert(recorder.out.str() == expected && "Events should arrive in wire order");
+        std::cout << "[OK] PNG events arrive in wire order\n";
+
+        bytes[bytes.size() - 13] ^= 0xFF;  // last byte of the tEXt CRC
+        png::Reader corrupt(bytes);
+        png::VisitorBase ignore;
+        bool threw = false;
+        try {
+            png::PNG::visit(corrupt, ignore);
+        } catch (const png::ParseError& e) {
+            threw = std::string(e.what()).find("Checksum mismatch") != std::string::npos;
+        }
+        assert(threw && "visit() verifies checksums like read()");
+        std::cout << "[OK] visit() verifies checksums\n";
+    }
+
+    std::cout << "\nAll tests passed!\n";
+    return 0;
+}
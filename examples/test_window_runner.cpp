@@ -0,0 +1,178 @@
+#define DEZZY_ASYNC
+#define DEZZY_PUSH_PARSER
+#define DEZZY_VISITOR
+#include "testwindow.hpp"
+#include <cassert>
+#include <iostream>
+#include <string>
+
+namespace {
+
+// Record i carries a header written by a newer version: i extra bytes after the name
+std::vector<uint8_t> make_archive(size_t records) {
+    testwindow::Writer writer;
+    writer.write_le(static_cast<uint8_t>(records));
+    for (size_t i = 0; i < records; ++i) {
+        const std::string name = "record" + std::to_string(i);
+        writer.write_le(static_cast<uint16_t>(5 + name.size() + i));
+        writer.write_le(static_cast<uint32_t>(100 + i));
+        writer.write_le(static_cast<uint8_t>(name.size()));
+        writer.write_bytes({reinterpret_cast<const uint8_t*>(name.data()), name.size()});
+        for (size_t extra = 0; extra < i; ++extra) {
+            writer.write_le(static_cast<uint8_t>(0xEE));
+        }
+        writer.write_le(static_cast<uint8_t>(3));
+        const uint8_t payload[] = {1, 2, static_cast<uint8_t>(i)};
+        writer.write_bytes(payload);
+    }
+    return writer.finish();
+}
+
+bool same_archive(const testwindow::Archive& a, const testwindow::Archive& b) {
+    if (a.records.size() != b.records.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.records.size(); ++i) {
+        const auto& x = a.records[i];
+        const auto& y = b.records[i];
+        if (x.header_size != y.header_size || x.header.id != y.header.id || x.header.name != y.header.name ||
+            x.payload != y.payload) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename Error, typename F>
+Error expect_error(F&& run) {
+    try {
+        run();
+    } catch (const Error& e) {
+        return e;
+    }
+    assert(false && "expected an error");
+    return Error("unreachable");
+}
+
+// Counts headers and checks every one is followed by its record's payload
+struct HeaderCounter : testwindow::VisitorBase {
+    size_t headers = 0;
+    size_t payloads = 0;
+    void on_u32(testwindow::FieldId field, uint32_t value) {
+        if (field == testwindow::FieldId::Header_id) {
+            assert(value == 100 + headers);
+            ++headers;
+        }
+    }
+    void on_bytes(testwindow::FieldId field, std::span<const uint8_t> bytes) {
+        if (field == testwindow::FieldId::Record_payload) {
+            assert(bytes.size() == 3 && bytes[2] == payloads);
+            ++payloads;
+        }
+    }
+};
+
+} // namespace
+
+int main() {
+    const auto bytes = make_archive(6);
+
+    // Test 1: what a header leaves of its window is skipped
+    testwindow::Reader reader(bytes);
+    const auto archive = testwindow::Archive::read(reader);
+    {
+        assert(reader.remaining() == 0);
+        assert(archive.records.size() == 6);
+        for (size_t i = 0; i < archive.records.size(); ++i) {
+            const auto& record = archive.records[i];
+            assert(record.header.id == 100 + i);
+            assert(record.header.name == "record" + std::to_string(i));
+            assert(record.payload.size() == 3 && record.payload[2] == i);
+        }
+        std::cout << "[OK] Unknown header bytes are skipped\n";
+    }
+
+    // Test 2: writing pads each header to its window, so the bytes round-trip in size
+    {
+        testwindow::Writer writer;
+        archive.write(writer);
+        const auto written = writer.finish();
+        assert(written.size() == bytes.size());
+        assert(archive.serialized_size() == bytes.size());
+        testwindow::Reader again(written);
+        assert(same_archive(testwindow::Archive::read(again), archive));
+        // Record i is 18 + i bytes; record 3's window ends in three zeros where the newer fields were
+        const size_t end_of_name = 1 + 18 + 19 + 20 + 2 + 12;
+        assert(written[end_of_name] == 0 && written[end_of_name + 1] == 0 && written[end_of_name + 2] == 0);
+        assert(bytes[end_of_name] == 0xEE && written[end_of_name + 3] == 3);
+
+        auto record = archive.records[0];
+        record.header.name = "a longer name than the window has room for";
+        const auto error = expect_error<testwindow::WriteError>([&] {
+            testwindow::Writer small;
+            record.write(small);
+        });
+        assert(std::string(error.what()).find("header_size") != std::string::npos);
+        std::cout << "[OK] Writes pad to the window and refuse to overflow it\n";
+    }
+
+    // Test 3: a header cannot read past its window, nor a window past the input
+    {
+        auto overrun = make_archive(1);
+        overrun[1] = 4;  // header_size too small for id, length and name
+        const auto inner = expect_error<testwindow::ParseError>([&] {
+            testwindow::Reader r(overrun);
+            testwindow::Archive::read(r);
+        });
+        assert(inner.kind() == testwindow::ErrorKind::Truncated);
+
+        auto past_end = make_archive(1);
+        past_end[1] = 200;
+        const auto outer = expect_error<testwindow::ParseError>([&] {
+            testwindow::Reader r(past_end);
+            testwindow::Archive::read(r);
+        });
+        assert(outer.kind() == testwindow::ErrorKind::Truncated);
+
+        testwindow::Parser<testwindow::Archive> parser;
+        std::span<const uint8_t> input(overrun);
+        assert(parser.feed(input) == testwindow::ParseStatus::Error);
+        std::cout << "[OK] Windows bound reads on both sides\n";
+    }
+
+    // Test 4: skip(), visit(), the push parser and read_async agree with read()
+    {
+        testwindow::Reader skipped(bytes);
+        testwindow::Archive::skip(skipped);
+        assert(skipped.position() == bytes.size());
+
+        HeaderCounter counter;
+        testwindow::Reader visited(bytes);
+        testwindow::Archive::visit(visited, counter);
+        assert(counter.headers == 6 && counter.payloads == 6);
+        assert(visited.remaining() == 0);
+
+        for (size_t chunk : {size_t{1}, size_t{5}, bytes.size()}) {
+            testwindow::Parser<testwindow::Archive> parser;
+            std::span<const uint8_t> data(bytes);
+            testwindow::ParseStatus status = testwindow::ParseStatus::NeedMore;
+            while (!data.empty()) {
+                auto fragment = data.first(std::min(chunk, data.size()));
+                data = data.subspan(fragment.size());
+                status = parser.feed(fragment);
+                assert(status != testwindow::ParseStatus::Error);
+            }
+            assert(status == testwindow::ParseStatus::Done);
+            assert(same_archive(parser.take(), archive));
+
+            testwindow::EventLoop loop;
+            testwindow::MemorySource source(loop, bytes, chunk);
+            testwindow::AsyncReader in(source, 64);
+            assert(same_archive(loop.run(testwindow::Archive::read_async(in)), archive));
+        }
+        std::cout << "[OK] skip, visit, push and async read windows alike\n";
+    }
+
+    std::cout << "\nAll tests passed!\n";
+    return 0;
+}
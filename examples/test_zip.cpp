@@ -23,24 +23,6 @@ std::vector<uint8_t> read_file(const char* filename) {
     return buffer;
 }
 
-// Find End of Central Directory by searching for signature from end
-size_t find_eocd(const std::vector<uint8_t>& data) {
-    const uint32_t eocd_sig = 0x06054b50;
-
-    // Search from end, going backwards
-    // EOCD is at least 22 bytes, max comment is 65535 bytes
-    size_t search_start = data.size() >= 65557 ? data.size() - 65557 : 0;
-
-    for (size_t i = data.size() - 22; i >= search_start && i < data.size(); i--) {
-        uint32_t sig = data[i] | (data[i+1] << 8) | (data[i+2] << 16) | (data[i+3] << 24);
-        if (sig == eocd_sig) {
-            return i;
-        }
-    }
-
-    throw std::runtime_error("EOCD signature not found");
-}
-
 int main(int argc, char* argv[]) {
     try {
         const char* filename = argc > 1 ? argv[1] : "examples/test.zip";
@@ -50,12 +32,14 @@ int main(int argc, char* argv[]) {
         auto data = read_file(filename);
         std::cout << "File size: " << data.size() << " bytes\n\n";
 
-        // Find and parse End of Central Directory
-        size_t eocd_offset = find_eocd(data);
-        std::cout << "Found EOCD at offset: " << eocd_offset << "\n";
+        // Find End of Central Directory: it sits within the last 22 + 65535 bytes
+        auto eocd_offset = EndOfCentralDirectory::find_last(data, 22 + 65535);
+        if (!eocd_offset) {
+            throw std::runtime_error("EOCD signature not found");
+        }
+        std::cout << "Found EOCD at offset: " << *eocd_offset << "\n";
 
-        std::vector<uint8_t> eocd_data(data.begin() + eocd_offset, data.end());
-        Reader reader(eocd_data);
+        Reader reader = Reader(data).at(*eocd_offset);
         EndOfCentralDirectory eocd = EndOfCentralDirectory::read(reader);
 
         std::cout << "\nEnd of Central Directory:\n";
@@ -76,26 +60,41 @@ int main(int argc, char* argv[]) {
             std::cout << "\n";
         }
 
-        // Try to parse a central directory entry
-        if (eocd.cd_offset < data.size() && eocd.num_entries_total > 0) {
-            std::cout << "\nFirst Central Directory Entry:\n";
-            std::vector<uint8_t> cd_data(data.begin() + eocd.cd_offset, data.end());
-            Reader cd_reader(cd_data);
-
+        // Central directory and local headers are pos: instances over the same buffer
+        if (eocd.num_entries_total > 0) {
             try {
-                CentralDirectoryHeader cd_header = CentralDirectoryHeader::read(cd_reader);
-                std::cout << "  Version made by: " << cd_header.version_made_by << "\n";
-                std::cout << "  Version needed: " << cd_header.version_needed << "\n";
-                std::cout << "  Compression: " << cd_header.compression_method << "\n";
-                std::cout << "  Compressed size: " << cd_header.compressed_size << " bytes\n";
-                std::cout << "  Uncompressed size: " << cd_header.uncompressed_size << " bytes\n";
-                std::cout << "  Filename: ";
-                for (uint16_t i = 0; i < cd_header.filename_length && i < cd_header.filename.size(); i++) {
-                    char c = cd_header.filename[i];
-                    std::cout << (c >= 32 && c < 127 ? c : '?');
+                const auto& entries = eocd.central_directory();
+                std::cout << "\nCentral Directory (" << entries.size() << " entries):\n";
+
+                // Read once and kept; a copy starts empty and reads its own
+                const EndOfCentralDirectory copy = eocd;
+                if (&eocd.central_directory() != &entries || &copy.central_directory() == &entries ||
+                    copy.central_directory().size() != entries.size()) {
+                    std::cerr << "Central directory should be read once per struct\n";
+                    return 1;
+                }
+
+                for (const auto& cd_header : entries) {
+                    std::cout << "  Filename: ";
+                    for (uint16_t i = 0; i < cd_header.filename_length && i < cd_header.filename.size(); i++) {
+                        char c = cd_header.filename[i];
+                        std::cout << (c >= 32 && c < 127 ? c : '?');
+                    }
+                    std::cout << "\n";
+                    std::cout << "    Version made by: " << cd_header.version_made_by << "\n";
+                    std::cout << "    Version needed: " << cd_header.version_needed << "\n";
+                    std::cout << "    Compression: " << cd_header.compression_method << "\n";
+                    std::cout << "    Compressed size: " << cd_header.compressed_size << " bytes\n";
+                    std::cout << "    Uncompressed size: " << cd_header.uncompressed_size << " bytes\n";
+                    std::cout << "    Local header offset: " << cd_header.local_header_offset << "\n";
+
+                    const LocalFileHeader& local = cd_header.local_header();
+                    if (local.crc32 != cd_header.crc32 || local.filename != cd_header.filename) {
+                        std::cerr << "Local header does not match central directory entry\n";
+                        return 1;
+                    }
+                    std::cout << "    Local header: OK (crc32 " << std::hex << local.crc32 << std::dec << ")\n";
                 }
-                std::cout << "\n";
-                std::cout << "  Local header offset: " << cd_header.local_header_offset << "\n";
             } catch (const ParseError& e) {
                 std::cout << "  (Could not parse: " << e.what() << ")\n";
             }
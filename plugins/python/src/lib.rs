@@ -119,6 +119,10 @@ fn generate_enum(enum_def: &HirEnum) -> String {
 }
 
 fn generate_python(lir: &LirFormat) -> Result<String, String> {
+    if lir.endianness == Endianness::Runtime {
+        return Err("Runtime-selected endianness is not supported by the Python backend".to_string());
+    }
+
     let mut code = String::new();
 
     // Header
@@ -152,8 +156,8 @@ fn generate_type(lir_type: &LirType, endianness: Endianness, enums: &[HirEnum])
 
     // Fields (exclude skip fields)
     for field in &lir_type.fields {
-        if field.skip.is_some() {
-            continue;  // Skip fields are not part of the struct
+        if field.skip.is_some() || field.instance.is_some() {
+            continue;  // Skip and pos: fields are not part of the struct
         }
         let mut py_type = lir_type_to_python(&field.type_info);
         // Wrap conditional fields in Optional
@@ -186,7 +190,7 @@ fn generate_type(lir_type: &LirType, endianness: Endianness, enums: &[HirEnum])
 
     // Create instance with collected fields (exclude skip fields)
     let field_names: Vec<_> = lir_type.fields.iter()
-        .filter(|f| f.skip.is_none())
+        .filter(|f| f.skip.is_none() && f.instance.is_none())
         .map(|f| f.name.as_str())
         .collect();
     code.push_str(&format!("        return {}({}), pos - offset\n", lir_type.name, field_names.join(", ")));
@@ -359,7 +363,7 @@ fn generate_read_from_operations(
             }
             LirOperation::ReadU16 { dest, .. } => {
                 let field_name = var_to_field.get(dest).ok_or("Unknown var_id")?;
-                let endian_char = endian_to_char(endianness);
+                let endian_char = endian_to_char(op.endianness().unwrap_or(endianness));
                 code.push_str(&format!("        {} = struct.unpack_from('{}H', buffer, pos)[0]\n", field_name, endian_char));
                 code.push_str("        pos += 2\n");
                 if let Some(field) = fields.iter().find(|f| f.var_id == *dest) {
@@ -370,7 +374,7 @@ fn generate_read_from_operations(
             }
             LirOperation::ReadU32 { dest, .. } => {
                 let field_name = var_to_field.get(dest).ok_or("Unknown var_id")?;
-                let endian_char = endian_to_char(endianness);
+                let endian_char = endian_to_char(op.endianness().unwrap_or(endianness));
                 code.push_str(&format!("        {} = struct.unpack_from('{}I', buffer, pos)[0]\n", field_name, endian_char));
                 code.push_str("        pos += 4\n");
                 if let Some(field) = fields.iter().find(|f| f.var_id == *dest) {
@@ -381,7 +385,7 @@ fn generate_read_from_operations(
             }
             LirOperation::ReadU64 { dest, .. } => {
                 let field_name = var_to_field.get(dest).ok_or("Unknown var_id")?;
-                let endian_char = endian_to_char(endianness);
+                let endian_char = endian_to_char(op.endianness().unwrap_or(endianness));
                 code.push_str(&format!("        {} = struct.unpack_from('{}Q', buffer, pos)[0]\n", field_name, endian_char));
                 code.push_str("        pos += 8\n");
                 if let Some(field) = fields.iter().find(|f| f.var_id == *dest) {
@@ -402,7 +406,7 @@ fn generate_read_from_operations(
             }
             LirOperation::ReadI16 { dest, .. } => {
                 let field_name = var_to_field.get(dest).ok_or("Unknown var_id")?;
-                let endian_char = endian_to_char(endianness);
+                let endian_char = endian_to_char(op.endianness().unwrap_or(endianness));
                 code.push_str(&format!("        {} = struct.unpack_from('{}h', buffer, pos)[0]\n", field_name, endian_char));
                 code.push_str("        pos += 2\n");
                 if let Some(field) = fields.iter().find(|f| f.var_id == *dest) {
@@ -413,7 +417,7 @@ fn generate_read_from_operations(
             }
             LirOperation::ReadI32 { dest, .. } => {
                 let field_name = var_to_field.get(dest).ok_or("Unknown var_id")?;
-                let endian_char = endian_to_char(endianness);
+                let endian_char = endian_to_char(op.endianness().unwrap_or(endianness));
                 code.push_str(&format!("        {} = struct.unpack_from('{}i', buffer, pos)[0]\n", field_name, endian_char));
                 code.push_str("        pos += 4\n");
                 if let Some(field) = fields.iter().find(|f| f.var_id == *dest) {
@@ -424,7 +428,7 @@ fn generate_read_from_operations(
             }
             LirOperation::ReadI64 { dest, .. } => {
                 let field_name = var_to_field.get(dest).ok_or("Unknown var_id")?;
-                let endian_char = endian_to_char(endianness);
+                let endian_char = endian_to_char(op.endianness().unwrap_or(endianness));
                 code.push_str(&format!("        {} = struct.unpack_from('{}q', buffer, pos)[0]\n", field_name, endian_char));
                 code.push_str("        pos += 8\n");
                 if let Some(field) = fields.iter().find(|f| f.var_id == *dest) {
@@ -609,19 +613,19 @@ fn generate_array_element_read_multiline(
             code.push_str(&format!("{}{}.append(val)\n", indent, array_name));
         }
         LirOperation::ReadU16 { .. } => {
-            let endian_char = endian_to_char(endianness);
+            let endian_char = endian_to_char(element_op.endianness().unwrap_or(endianness));
             code.push_str(&format!("{}val = struct.unpack_from('{}H', buffer, pos)[0]\n", indent, endian_char));
             code.push_str(&format!("{}pos += 2\n", indent));
             code.push_str(&format!("{}{}.append(val)\n", indent, array_name));
         }
         LirOperation::ReadU32 { .. } => {
-            let endian_char = endian_to_char(endianness);
+            let endian_char = endian_to_char(element_op.endianness().unwrap_or(endianness));
             code.push_str(&format!("{}val = struct.unpack_from('{}I', buffer, pos)[0]\n", indent, endian_char));
             code.push_str(&format!("{}pos += 4\n", indent));
             code.push_str(&format!("{}{}.append(val)\n", indent, array_name));
         }
         LirOperation::ReadU64 { .. } => {
-            let endian_char = endian_to_char(endianness);
+            let endian_char = endian_to_char(element_op.endianness().unwrap_or(endianness));
             code.push_str(&format!("{}val = struct.unpack_from('{}Q', buffer, pos)[0]\n", indent, endian_char));
             code.push_str(&format!("{}pos += 8\n", indent));
             code.push_str(&format!("{}{}.append(val)\n", indent, array_name));
@@ -632,19 +636,19 @@ fn generate_array_element_read_multiline(
             code.push_str(&format!("{}{}.append(val)\n", indent, array_name));
         }
         LirOperation::ReadI16 { .. } => {
-            let endian_char = endian_to_char(endianness);
+            let endian_char = endian_to_char(element_op.endianness().unwrap_or(endianness));
             code.push_str(&format!("{}val = struct.unpack_from('{}h', buffer, pos)[0]\n", indent, endian_char));
             code.push_str(&format!("{}pos += 2\n", indent));
             code.push_str(&format!("{}{}.append(val)\n", indent, array_name));
         }
         LirOperation::ReadI32 { .. } => {
-            let endian_char = endian_to_char(endianness);
+            let endian_char = endian_to_char(element_op.endianness().unwrap_or(endianness));
             code.push_str(&format!("{}val = struct.unpack_from('{}i', buffer, pos)[0]\n", indent, endian_char));
             code.push_str(&format!("{}pos += 4\n", indent));
             code.push_str(&format!("{}{}.append(val)\n", indent, array_name));
         }
         LirOperation::ReadI64 { .. } => {
-            let endian_char = endian_to_char(endianness);
+            let endian_char = endian_to_char(element_op.endianness().unwrap_or(endianness));
             code.push_str(&format!("{}val = struct.unpack_from('{}q', buffer, pos)[0]\n", indent, endian_char));
             code.push_str(&format!("{}pos += 8\n", indent));
             code.push_str(&format!("{}{}.append(val)\n", indent, array_name));
@@ -665,6 +669,8 @@ fn endian_to_char(endianness: Endianness) -> char {
         Endianness::Little => '<',
         Endianness::Big => '>',
         Endianness::Native => '=',
+        // Rejected in generate_python()
+        Endianness::Runtime => '<',
     }
 }
 
@@ -674,7 +680,6 @@ fn generate_write_from_operations(
     enums: &[HirEnum],
 ) -> Result<String, String> {
     let mut code = String::new();
-    let endian_char = endian_to_char(endianness);
 
     // Build var_to_field map
     let mut var_to_field = std::collections::HashMap::new();
@@ -699,6 +704,7 @@ fn generate_write_from_operations(
         if !in_write_section {
             continue;
         }
+        let endian_char = endian_to_char(op.endianness().unwrap_or(endianness));
 
         match op {
             LirOperation::WriteU8 { src } => {
@@ -802,6 +808,7 @@ fn generate_write_from_operations(
                     }
 
                     // Generate code for the write operation
+                    let endian_char = endian_to_char(inner_op.endianness().unwrap_or(endianness));
                     match inner_op {
                         LirOperation::WriteU8 { src } => {
                             let field_name = local_var_to_field.get(src).ok_or("Unknown var_id")?;
@@ -856,6 +863,7 @@ fn generate_read_impl(lir_type: &LirType, endianness: Endianness) -> Result<Stri
         Endianness::Little => '<',
         Endianness::Big => '>',
         Endianness::Native => '=',
+        Endianness::Runtime => '<',
     };
 
     // Collect field values
@@ -942,6 +950,7 @@ fn generate_write_impl(lir_type: &LirType, endianness: Endianness, enums: &[HirE
         Endianness::Little => '<',
         Endianness::Big => '>',
         Endianness::Native => '=',
+        Endianness::Runtime => '<',
     };
 
     // Build a map of enum names to their underlying types